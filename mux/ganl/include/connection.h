@@ -3,6 +3,7 @@
 
 #include <network_types.h>
 #include <io_buffer.h>
+#include <deque>
 #include <memory>
 #include <string>
 #include <cstring>
@@ -14,6 +15,19 @@ class NetworkEngine;
 class SecureTransport;
 class ProtocolHandler;
 class SessionManager;
+class TlsWorkerPool;
+struct TlsChannel;
+struct TlsCompletion;
+
+/**
+ * OutputSegment - Immutable, reference-counted run of output bytes
+ *
+ * The application renders a line once and hands the same segment to every
+ * connection it is meant for.  On a plaintext readiness connection the
+ * segment is queued as-is and written with writev(), so its bytes are not
+ * copied again on the way to the socket.
+ */
+using OutputSegment = std::shared_ptr<const std::string>;
 
 /**
  * Connection - Central class managing a single client connection
@@ -54,6 +68,15 @@ public:
      */
     bool initialize(bool useTls = true);
 
+    /**
+     * Run this connection's TLS work on a worker pool instead of inline.
+     * Call before initialize(); the pool must outlive the connection's
+     * TLS session.
+     *
+     * @param pool Worker pool, or nullptr for inline TLS
+     */
+    void setTlsWorkerPool(TlsWorkerPool* pool) { tlsPool_ = pool; }
+
     /**
      * Handle a network event for this connection
      *
@@ -68,6 +91,14 @@ public:
      */
     void sendDataToClient(const std::string& data);
 
+    /**
+     * Send a shared segment to the client, without copying it when the
+     * connection can write it directly
+     *
+     * @param segment Data to send
+     */
+    void sendDataToClient(const OutputSegment& segment);
+
     /**
      * Close the connection
      *
@@ -110,12 +141,13 @@ public:
 
     /**
      * Bytes currently queued for transmission to the client (formatted/
-     * encrypted output not yet written to the socket).  Read-only; used for
+     * encrypted output not yet written to the socket, including plaintext
+     * handed to a TLS worker and not yet encrypted).  Read-only; used for
      * output backpressure / high-water enforcement (#794).
      *
      * @return Pending outbound byte count
      */
-    size_t pendingOutputBytes() const { return encryptedOutput_.readableBytes(); }
+    size_t pendingOutputBytes() const { return wireOutputBytes() + tlsPendingBytes_; }
 
     /**
      * Get remote address
@@ -138,6 +170,11 @@ private:
     bool processApplicationData();
     void transitionToState(ConnectionState newState);
 
+    // Results from the TLS worker pool, on the game thread.
+    friend class TlsWorkerPool;
+    void handleTlsCompletion(TlsCompletion& results);
+    bool tlsEstablished() const;
+
     // Member variables
     SessionId sessionId_{InvalidSessionId};
 
@@ -159,6 +196,17 @@ protected:
     bool postRead();
     bool postWrite();
 
+    // Outgoing bytes are encryptedOutput_ followed by the output chain of
+    // shared segments.  Only connections that can write scattered buffers
+    // accept segments onto the chain; the rest copy them into the buffers.
+    //
+    size_t wireOutputBytes() const { return encryptedOutput_.readableBytes() + outputChainBytes_; }
+    bool hasPendingOutput() const { return wireOutputBytes() > 0; }
+    virtual bool supportsOutputChain() const { return false; }
+    int gatherOutput(const char** bufs, size_t* lens, int maxBufs) const;
+    void consumeOutput(size_t bytes);
+    void clearOutput();
+
     // These buffer access methods are used by derived classes
     IoBuffer& getEncryptedInputBuffer() { return encryptedInput_; }
     IoBuffer& getDecryptedInputBuffer() { return decryptedInput_; }
@@ -192,6 +240,11 @@ protected:
     // remaining capacity of a multi-megabyte buffer.
     //
     static constexpr size_t kMaxReadChunk = 16 * 1024;
+    // Stop reading after this many bytes per readiness event and ask the
+    // engine to report the socket again, so one flooding peer yields to the
+    // other ready connections instead of being drained to EAGAIN.
+    //
+    static constexpr size_t kMaxReadPerEvent = 64 * 1024;
 
     // Single egress path for protocol/application bytes (#950).  TLS +
     // established → encrypt into encryptedOutput_; non-TLS → plain append;
@@ -220,6 +273,17 @@ private:
     IoBuffer encryptedInput_;    // Raw data from network
     IoBuffer decryptedInput_;    // After TLS decryption
     IoBuffer encryptedOutput_;   // After TLS encryption
+    std::deque<OutputSegment> outputChain_; // Plaintext segments after encryptedOutput_
+    size_t outputChainHead_{0};  // Bytes of outputChain_.front() already written
+    size_t outputChainBytes_{0}; // Bytes in outputChain_ not yet written
+
+    // Offloaded TLS.  tlsEstablished_ stands in for isEstablished(), which
+    // would race the worker running the session.
+    TlsWorkerPool* tlsPool_{nullptr};
+    std::shared_ptr<TlsChannel> tlsChannel_;
+    bool tlsEstablished_{false};
+    bool tlsShutdownPending_{false}; // close_notify requested, not yet back
+    size_t tlsPendingBytes_{0};      // Plaintext submitted, not yet encrypted
 
     // State management
     ConnectionState state_{ ConnectionState::Initializing };
@@ -258,6 +322,9 @@ public:
     void handleRead(size_t bytesTransferred) override;
     void handleWrite(size_t bytesTransferred) override;
 
+protected:
+    bool supportsOutputChain() const override;
+
 private:
     // Any members specific only to readiness model connections (if any)
 };
@@ -41,6 +41,7 @@ public:
 
     // postRead is mostly a no-op for epoll since connections are always registered for read interest
     bool postRead(ConnectionHandle conn, IoBuffer& buffer, ErrorCode& error) override;
+    void rearmRead(ConnectionHandle conn) override;
     // postWrite enables EPOLLOUT interest to indicate the connection wants to write
     // Write interest is automatically disabled in processEvents after handleWrite is called
     bool postWrite(ConnectionHandle conn, const char* data, size_t length, void* userContext, ErrorCode& error) override;
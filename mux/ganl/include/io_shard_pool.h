@@ -0,0 +1,134 @@
+#ifndef GANL_IO_SHARD_POOL_H
+#define GANL_IO_SHARD_POOL_H
+
+#include <network_types.h>
+#include <network_engine_factory.h>
+#include <connection.h>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ganl {
+
+class ProtocolHandler;
+class SecureTransport;
+class SessionManager;
+struct IoShard;
+struct ShardCommand;
+struct ShardLink;
+
+// What a shard reported about one connection.  Data is the bytes as read
+// from the socket (after TLS), not decoded in any way.
+//
+struct ShardEvent {
+    enum class Kind { Data, Closed };
+
+    Kind kind{Kind::Data};
+    ConnectionHandle handle{InvalidConnectionHandle};
+    std::string data;
+    DisconnectReason reason{DisconnectReason::Unknown};
+};
+
+// Runs the socket I/O for connections on a few threads ("shards"), each
+// with its own network engine, so reads, writes and TLS for thousands of
+// sockets do not all happen on the game thread.  That is all a shard does:
+// no protocol work is offloaded.
+//
+// The game thread still accepts, and a connection keeps the handle it was
+// accepted on.  adopt() gives the shard a duplicate of that descriptor and
+// the shard runs an ordinary ConnectionBase on it.  The original stays open,
+// owned by the pool, until the game thread has seen the connection close, so
+// the descriptor number -- which is also the handle -- cannot be reused by
+// a new accept while the game still knows the old connection by it.
+//
+// A shard posts the bytes a connection delivers, and its close, to one
+// completion list; runCompletions() hands them to a SessionManager on the
+// game thread, in the order each shard posted them.  The bytes are not
+// decoded: telnet and WebSocket state live with the game's connection
+// record, so protocol detection, the WebSocket handshake and framing, and
+// telnet all stay on the game thread.  Output arrives already rendered and
+// framed.  send() and close() are queued to the owning shard.  The wake callback is invoked from a shard
+// when the completion list goes from empty to non-empty, and when a TLS
+// handshake finishes, so the owner can break out of its poll.
+//
+// Everything but the shard threads themselves is game-thread only.  The
+// protocol handler and secure transport are shared by every shard, so the
+// handler must keep no state of its own; the game passes a raw pass-through.
+//
+class IoShardPool {
+public:
+    IoShardPool(NetworkEngineType type, SecureTransport* transport,
+                ProtocolHandler& protocol, std::function<void()> wake);
+    ~IoShardPool();
+
+    IoShardPool(const IoShardPool&) = delete;
+    IoShardPool& operator=(const IoShardPool&) = delete;
+
+    // Returns the number of shards started: all of them, or 0 if the engine
+    // type cannot adopt sockets or any shard could not be set up, in which
+    // case those already started have been stopped and joined.
+    int start(int shards);
+
+    // Close every connection, let their output drain briefly, and join the
+    // shards.  The closes are left on the completion list.
+    void stop();
+
+    int shardCount() const { return static_cast<int>(shards_.size()); }
+
+    // Hand an accepted connection to a shard.  On success the pool owns the
+    // handle's descriptor; on failure nothing has changed.
+    bool adopt(ConnectionHandle handle, bool useTls);
+    bool owns(ConnectionHandle handle) const;
+
+    void send(ConnectionHandle handle, const OutputSegment& segment);
+    void close(ConnectionHandle handle, DisconnectReason reason);
+
+    // Output submitted and not yet written to the socket.
+    size_t pendingOutputBytes(ConnectionHandle handle) const;
+
+    // The connection's TLS handshake (if any) is done.
+    bool isRunning(ConnectionHandle handle) const;
+
+    // Deliver posted events.  A connection's Closed is its last event; its
+    // descriptor is closed after the session manager has seen it.
+    void runCompletions(SessionManager& sessions);
+
+    // Wait until every shard has applied what was queued to it.
+    void waitIdle();
+
+    // Take every connection back from the shards without closing it, for
+    // @restart.  The shards drop their copies; the original descriptors
+    // stay open and become the caller's, except for connections close() was
+    // called on, whose descriptors are closed.
+    void releaseAll();
+
+private:
+    friend struct IoShard;
+    friend class ShardSessions;
+
+    void shardMain(IoShard& shard);
+    void post(ShardEvent&& event);
+    void queue(IoShard& shard, ShardCommand&& command);
+    void runCommands(IoShard& shard);
+    void reap(IoShard& shard);
+    void drainShard(IoShard& shard);
+
+    NetworkEngineType type_;
+    SecureTransport* transport_;
+    ProtocolHandler& protocol_;
+    std::function<void()> wake_;
+
+    std::vector<std::unique_ptr<IoShard>> shards_;
+    std::unordered_map<ConnectionHandle, std::shared_ptr<ShardLink>> links_;
+
+    std::mutex mutex_;
+    std::vector<ShardEvent> completed_;
+};
+
+} // namespace ganl
+
+#endif // GANL_IO_SHARD_POOL_H
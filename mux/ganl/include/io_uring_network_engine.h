@@ -0,0 +1,190 @@
+#ifndef GANL_IO_URING_NETWORK_ENGINE_H
+#define GANL_IO_URING_NETWORK_ENGINE_H
+
+// The engine needs multishot accept and recv, provided buffer rings, and
+// synchronous cancel, which all arrived in the Linux 6.0 uapi headers.
+// IORING_RECV_MULTISHOT is the newest of the macros among them.
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(IORING_RECV_MULTISHOT)
+#define GANL_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+#if defined(GANL_HAVE_IO_URING)
+
+#include <network_engine.h>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ganl {
+
+// Completion engine built on io_uring.
+//
+// Listeners use one multishot accept each.  A connection starts out in
+// readiness mode -- one-shot poll requests, re-armed after every event, so
+// callers that read and write the socket themselves (the DNS slave, the
+// email channel's writes) see the same level-triggered Read/Write events
+// select gives them.  The first postRead() switches its reads to completion
+// mode: a multishot recv fills buffers from a ring registered with the
+// kernel, and each Read event copies what arrived into the IoBuffer handed
+// to postRead().  postWrite() with data copies it into an engine-owned
+// buffer and sends it as a chain of linked sends, reporting one Write event
+// with the byte count once the whole chain has gone out.
+//
+// Submissions are batched: requests made between processEvents() calls go
+// to the kernel in the same io_uring_enter() that waits for completions.
+//
+class IoUringNetworkEngine : public NetworkEngine {
+public:
+    IoUringNetworkEngine();
+    ~IoUringNetworkEngine() override;
+
+    IoModel getIoModelType() const override {
+        return IoModel::Completion;
+    }
+
+    // True if the running kernel offers everything initialize() requires.
+    static bool isSupported();
+
+    // --- NetworkEngine Interface ---
+    bool initialize() override;
+    void shutdown() override;
+
+    ListenerHandle createListener(const std::string& host, uint16_t port, ErrorCode& error) override;
+    ListenerHandle adoptListener(int fd, ErrorCode& error) override;
+    ConnectionHandle adoptConnection(int fd, void* connectionContext, ErrorCode& error) override;
+    ConnectionHandle initiateConnect(const std::string& host, uint16_t port,
+                                     void* connectionContext, ErrorCode& error) override;
+    ConnectionHandle initiateUnixConnect(const std::string& path,
+                                         void* connectionContext, ErrorCode& error) override;
+    ConnectionHandle spawnSlave(const SlaveSpawnOptions& options, ErrorCode& error) override;
+    bool startListening(ListenerHandle listener, void* listenerContext, ErrorCode& error) override;
+    void closeListener(ListenerHandle listener) override;
+
+    bool associateContext(ConnectionHandle conn, void* context, ErrorCode& error) override;
+    void closeConnection(ConnectionHandle conn) override;
+    void detachConnection(ConnectionHandle conn) override;
+    void detachListener(ListenerHandle listener) override;
+
+    // postRead switches the connection's reads to completion mode; the next
+    // Read event carries this buffer with the received bytes already copied
+    // to its writePtr() (not yet committed).
+    bool postRead(ConnectionHandle conn, IoBuffer& buffer, ErrorCode& error) override;
+    // postWrite with data sends a copy of it; with no data it registers
+    // one-shot write interest, as the readiness engines do.
+    bool postWrite(ConnectionHandle conn, const char* data, size_t length, void* userContext, ErrorCode& error) override;
+    bool postWrite(ConnectionHandle conn, const char* data, size_t length, ErrorCode& error) override;
+
+    int processEvents(int timeoutMs, IoEvent* events, int maxEvents) override;
+
+    std::string getRemoteAddress(ConnectionHandle conn) override;
+    NetworkAddress getRemoteNetworkAddress(ConnectionHandle conn) override;
+    std::string getErrorString(ErrorCode error) override;
+
+private:
+    struct Ring;
+
+    enum class SocketType { Listener, Connection, OutboundConnecting };
+    enum class OpKind { Accept, PollIn, PollOut, Recv, Send };
+
+    struct SocketInfo {
+        SocketType type;
+        void* context{nullptr};
+        uint64_t generation{0};
+        bool listening{false};
+        bool queued{false};         // In ready_
+        bool armQueued{false};      // In armPending_
+
+        // Listener: the multishot accept and what it has produced.
+        uint64_t acceptOp{0};
+        std::deque<int> accepted;
+        ErrorCode acceptError{0};
+
+        // Outbound connect result, from a POLLOUT on the connecting socket.
+        bool connectDone{false};
+        ErrorCode connectError{0};
+
+        // Readiness mode.
+        uint64_t pollInOp{0};
+        uint64_t pollOutOp{0};
+        bool readable{false};
+        bool hangup{false};
+        bool wantWrite{false};
+        bool writable{false};
+        void* writeUserContext{nullptr};
+
+        // Completion-mode reads.
+        bool completionReads{false};
+        uint64_t recvOp{0};
+        bool recvPaused{false};     // Cancelled for backpressure
+        IoBuffer* activeReadBuffer{nullptr};
+        std::string received;
+        size_t receivedHead{0};
+        bool eof{false};
+        ErrorCode readError{0};
+        bool terminalReported{false};
+
+        // Completion-mode writes.
+        std::shared_ptr<std::string> sendData;
+        size_t sendDone{0};
+        int sendOpsInFlight{0};
+        bool sendBroken{false};
+        std::string sendQueued;
+        void* sendContext{nullptr};
+        size_t sendReport{0};       // Bytes sent and not yet reported
+        ErrorCode sendError{0};
+    };
+
+    struct Op {
+        OpKind kind;
+        int fd;
+        uint64_t generation;
+        size_t length{0};                  // Send: bytes in this link
+        std::shared_ptr<std::string> data; // Send: keeps the bytes alive
+    };
+
+    std::mutex mutex_;
+    std::unique_ptr<Ring> ring_;
+    std::map<int, SocketInfo> sockets_;
+    std::unordered_map<uint64_t, Op> ops_;
+    std::deque<int> ready_;
+    std::vector<int> armPending_;
+    uint64_t nextOpId_{1};
+    uint64_t nextGeneration_{1};
+
+    bool setNonBlocking(int fd, ErrorCode& error);
+    SocketInfo& registerSocket(int fd, SocketType type, void* context);
+    void requestArm(int fd, SocketInfo& si);
+    void markReady(int fd, SocketInfo& si);
+    bool hasEvents(const SocketInfo& si) const;
+    size_t receivedBytes(const SocketInfo& si) const {
+        return si.received.size() - si.receivedHead;
+    }
+
+    void armPending();
+    void armSocket(int fd, SocketInfo& si);
+    uint64_t submitOp(int fd, const SocketInfo& si, OpKind kind, uint8_t opcode);
+    void submitSendChain(int fd, SocketInfo& si);
+    void submitCancel(uint64_t opId);
+    bool flushSubmissions();
+    void cancelAll(int fd);
+    void reapCompletions();
+    void handleCompletion(uint64_t userData, int32_t res, uint32_t flags);
+    int emitEvents(int fd, SocketInfo& si, IoEvent* events, int maxEvents, bool& erased);
+    void forgetSocket(int fd, bool closeFd);
+};
+
+} // namespace ganl
+
+#endif // GANL_HAVE_IO_URING
+
+#endif // GANL_IO_URING_NETWORK_ENGINE_H
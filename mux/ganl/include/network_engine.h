@@ -200,6 +200,18 @@ public:
      */
     virtual bool postRead(ConnectionHandle conn, IoBuffer& buffer, ErrorCode& error) = 0;
 
+    /**
+     * Report a connection as readable again on a later processEvents() call.
+     *
+     * @param conn Connection handle
+     *
+     * Readiness connections call this when they stop reading before the
+     * socket would block (the per-event read budget).  Level-triggered
+     * engines report a readable socket again on their own, so the default is
+     * a no-op; edge-triggered engines must re-arm the registration.
+     */
+    virtual void rearmRead(ConnectionHandle conn) { (void)conn; }
+
     /**
      * Post an asynchronous write operation with application context
      *
@@ -19,7 +19,8 @@ enum class NetworkEngineType {
     WSelect,    // Use Windows select() (Windows-specific implementation)
     Epoll,      // Use epoll() (Linux only)
     Kqueue,     // Use kqueue() (BSD, macOS)
-    IOCP        // Use I/O Completion Ports (Windows only)
+    IOCP,       // Use I/O Completion Ports (Windows only)
+    IoUring     // Use io_uring (Linux 6.0 or later; never chosen by Auto)
 };
 
 /**
@@ -176,7 +176,7 @@ constexpr ProtocolStateChangeFlags ProtocolStateChangeMxp      = 1u << 8;
 enum class IoModel {
     Unknown,
     Readiness,  // select, poll, epoll, kqueue
-    Completion  // IOCP, io_uring (potentially)
+    Completion  // IOCP, io_uring
 };
 
 // --- Dependency-injected logging ---
@@ -69,6 +69,14 @@ public:
     virtual bool formatOutput(ConnectionHandle conn, IoBuffer& app_data_in,
                              IoBuffer& formatted_out, bool consumeInput = true) = 0;
 
+    /**
+     * Whether formatOutput() copies its input through unchanged.  If so, a
+     * connection may skip it and write application segments directly.
+     *
+     * @return true if formatOutput() is the identity
+     */
+    virtual bool passesOutputThrough() const { return false; }
+
     // Add this method:
     /**
      * @brief Checks the status of the initial mandatory Telnet negotiation phase.
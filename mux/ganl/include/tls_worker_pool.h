@@ -0,0 +1,100 @@
+#ifndef GANL_TLS_WORKER_POOL_H
+#define GANL_TLS_WORKER_POOL_H
+
+#include <network_types.h>
+#include <io_buffer.h>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ganl {
+
+class ConnectionBase;
+class SecureTransport;
+struct TlsChannel;
+
+// What a worker did for one channel since the game thread last looked.
+//
+struct TlsCompletion {
+    IoBuffer decrypted{0};          // Plaintext from the peer
+    IoBuffer encrypted{0};          // Records for the wire, in order
+    size_t plaintextConsumed{0};    // Submitted output now encrypted
+    bool established{false};        // The handshake finished
+    bool shutdownDone{false};       // close_notify is in encrypted
+    TlsResult failure{TlsResult::Success};  // Error or Closed ends the session
+    std::string error;
+};
+
+// Runs TLS handshakes and record encryption/decryption for connections on a
+// few worker threads, so a burst of handshakes does not stall the game loop.
+//
+// Each connection gets a channel.  The game thread submits ciphertext read
+// from the socket and plaintext it wants to send; a worker feeds them
+// through the connection's session and posts the results back.  A channel is
+// run by at most one worker at a time and its input is taken in submission
+// order, so each connection's byte stream keeps its order in both
+// directions.  Results wait on a completion list until the game thread calls
+// runCompletions(), which hands them to the owning ConnectionBase.  The wake
+// callback is invoked from a worker when that list goes from empty to
+// non-empty, so the owner can break out of its poll.
+//
+class TlsWorkerPool {
+public:
+    TlsWorkerPool(SecureTransport& transport, std::function<void()> wake);
+    ~TlsWorkerPool();
+
+    TlsWorkerPool(const TlsWorkerPool&) = delete;
+    TlsWorkerPool& operator=(const TlsWorkerPool&) = delete;
+
+    // Returns false if no thread could be started.
+    bool start(int threads);
+    void stop();
+
+    // Game thread only.  The session for handle must already exist.
+    std::shared_ptr<TlsChannel> attach(ConnectionHandle handle,
+                                       const std::shared_ptr<ConnectionBase>& owner);
+
+    void submitInput(TlsChannel& channel, IoBuffer& encrypted);
+    void submitOutput(TlsChannel& channel, IoBuffer& plaintext);
+    void submitShutdown(TlsChannel& channel);
+
+    // Ciphertext submitted and not yet fed to the session.
+    size_t pendingInputBytes(TlsChannel& channel);
+
+    // Stop the channel and wait for a worker that is running it, so the
+    // session can be destroyed (and the handle reused) once this returns.
+    void detach(TlsChannel& channel);
+
+    // Deliver posted results to their connections.
+    void runCompletions();
+
+    // Wait until no channel is queued or running.
+    void waitIdle();
+
+private:
+    void workerMain();
+    void runChannel(const std::shared_ptr<TlsChannel>& channel);
+    void schedule(const std::shared_ptr<TlsChannel>& channel);
+
+    SecureTransport& transport_;
+    std::function<void()> wake_;
+
+    std::mutex mutex_;
+    std::condition_variable workCv_;
+    std::condition_variable idleCv_;
+    std::deque<std::shared_ptr<TlsChannel>> runQueue_;
+    std::vector<std::shared_ptr<TlsChannel>> completed_;
+    std::vector<std::thread> threads_;
+    int busy_{0};
+    bool stopping_{false};
+};
+
+} // namespace ganl
+
+#endif // GANL_TLS_WORKER_POOL_H
@@ -3,6 +3,7 @@
 #include <secure_transport.h>
 #include <protocol_handler.h>
 #include <session_manager.h>
+#include <tls_worker_pool.h>
 
 #include <iomanip>
 #include <memory>
@@ -41,6 +42,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #define MIN std::min
 #endif
 
@@ -267,8 +269,7 @@ void ConnectionBase::handleNetworkEvent(const IoEvent& event) {
     // After handling an event, check if more writing is needed (e.g., TLS generated data during read processing)
     // Do this check only if the connection wasn't closed by the event handler.
     if (!isClosingOrClosed()) {
-        IoBuffer& encryptedOutput = encryptedOutput_;
-        if (encryptedOutput.readableBytes() > 0 && !pendingWriteFlag()) {
+        if (hasPendingOutput() && !pendingWriteFlag()) {
              GANL_CONN_DEBUG(handle_, "Data found in encryptedOutput_ after event processing. Posting write.");
              postWrite();
          }
@@ -292,7 +293,14 @@ bool ConnectionBase::egressToWire(IoBuffer& source, bool retainIfTlsNotReady,
     }
 
     if (useTls_ && secureTransport_ != nullptr) {
-        if (secureTransport_->isEstablished(handle_)) {
+        if (tlsChannel_ && tlsEstablished_) {
+            GANL_CONN_DEBUG(handle_, "Handing " << source.readableBytes()
+                      << " bytes of " << what << " to a TLS worker.");
+            tlsPendingBytes_ += source.readableBytes();
+            tlsPool_->submitOutput(*tlsChannel_, source);
+            return true;
+        }
+        if (tlsEstablished()) {
             GANL_CONN_DEBUG(handle_, "Encrypting " << source.readableBytes()
                       << " bytes of " << what << " through TLS.");
             TlsResult result = secureTransport_->processOutgoing(
@@ -326,6 +334,19 @@ bool ConnectionBase::egressToWire(IoBuffer& source, bool retainIfTlsNotReady,
         return true;
     }
 
+    if (outputChainBytes_ > 0) {
+        // Segments are already queued behind encryptedOutput_, so these
+        // bytes must follow them on the chain to keep the stream in order.
+        GANL_CONN_DEBUG(handle_, "TLS not used. Queuing " << source.readableBytes()
+                  << " bytes of " << what << " behind the output chain.");
+        const OutputSegment segment = std::make_shared<const std::string>(
+            source.readPtr(), source.readableBytes());
+        outputChain_.push_back(segment);
+        outputChainBytes_ += segment->size();
+        source.clear();
+        return true;
+    }
+
     GANL_CONN_DEBUG(handle_, "TLS not used. Copying " << source.readableBytes()
               << " bytes of " << what << " directly to encryptedOutput_.");
     encryptedOutput_.append(source.readPtr(), source.readableBytes());
@@ -333,6 +354,58 @@ bool ConnectionBase::egressToWire(IoBuffer& source, bool retainIfTlsNotReady,
     return true;
 }
 
+// Describe the pending output as up to maxBufs scattered buffers, in the
+// order they go to the wire.
+//
+int ConnectionBase::gatherOutput(const char** bufs, size_t* lens, int maxBufs) const
+{
+    int n = 0;
+    if (n < maxBufs && encryptedOutput_.readableBytes() > 0) {
+        bufs[n] = encryptedOutput_.readPtr();
+        lens[n] = encryptedOutput_.readableBytes();
+        n++;
+    }
+    size_t head = outputChainHead_;
+    for (const auto& segment : outputChain_) {
+        if (n >= maxBufs) {
+            break;
+        }
+        bufs[n] = segment->data() + head;
+        lens[n] = segment->size() - head;
+        head = 0;
+        n++;
+    }
+    return n;
+}
+
+void ConnectionBase::consumeOutput(size_t bytes)
+{
+    const size_t buffered = std::min(bytes, encryptedOutput_.readableBytes());
+    encryptedOutput_.consumeRead(buffered);
+    bytes -= buffered;
+
+    while (bytes > 0 && !outputChain_.empty()) {
+        const size_t left = outputChain_.front()->size() - outputChainHead_;
+        if (bytes < left) {
+            outputChainHead_ += bytes;
+            outputChainBytes_ -= bytes;
+            break;
+        }
+        bytes -= left;
+        outputChainBytes_ -= left;
+        outputChain_.pop_front();
+        outputChainHead_ = 0;
+    }
+}
+
+void ConnectionBase::clearOutput()
+{
+    encryptedOutput_.clear();
+    outputChain_.clear();
+    outputChainHead_ = 0;
+    outputChainBytes_ = 0;
+}
+
 void ConnectionBase::sendDataToClient(const std::string& data) {
     GANL_CONN_DEBUG(handle_, "Received " << data.length() << " bytes from application to send.");
 
@@ -395,12 +468,53 @@ void ConnectionBase::sendDataToClient(const std::string& data) {
     }
 }
 
+void ConnectionBase::sendDataToClient(const OutputSegment& segment) {
+    if (!segment || segment->empty()) {
+        GANL_CONN_DEBUG(handle_, "Ignoring empty segment send request.");
+        return;
+    }
+
+    // The segment can go to the socket as-is only if nothing would change
+    // or reorder its bytes on the way: no TLS, a protocol handler that
+    // passes output through untouched, and no application bytes still
+    // waiting in the formatting buffers.  Otherwise take the copying path.
+    if (  useTls_
+       || !supportsOutputChain()
+       || !protocolHandler_.passesOutputThrough()
+       || applicationOutput_.readableBytes() > 0
+       || formattedOutput_.readableBytes() > 0
+       || (  getState() != ConnectionState::Running
+          && getState() != ConnectionState::TelnetNegotiating)) {
+        sendDataToClient(*segment);
+        return;
+    }
+
+    GANL_CONN_DEBUG(handle_, "Queuing " << segment->size() << " byte segment from application.");
+    outputChain_.push_back(segment);
+    outputChainBytes_ += segment->size();
+    if (!pendingWrite_) {
+        postWrite();
+    }
+}
+
 void ConnectionBase::processSecureData() {
     // Called when encryptedInput_ has data (or during handshake start)
     IoBuffer& encryptedInput = encryptedInput_;
     IoBuffer& decryptedInput = decryptedInput_;
     IoBuffer& encryptedOutput = encryptedOutput_;
 
+    // Offloaded: queue the ciphertext for the worker, handshake or not.  The
+    // results come back through handleTlsCompletion().  The backlog stands
+    // in for encryptedInput_ in the #1856 ingress high-water.
+    if (tlsChannel_) {
+        tlsPool_->submitInput(*tlsChannel_, encryptedInput);
+        if (tlsPool_->pendingInputBytes(*tlsChannel_) >= kMaxEncryptedIngress) {
+            GANL_CONN_DEBUG(handle_, "TLS worker backlog exceeds the ingress high-water. Closing.");
+            close(DisconnectReason::NetworkError);
+        }
+        return;
+    }
+
     if (getState() == ConnectionState::TlsHandshaking) {
         GANL_CONN_DEBUG(handle_, "Continuing TLS Handshake...");
         continueTlsHandshake();
@@ -456,7 +570,6 @@ void ConnectionBase::processSecureData() {
 bool ConnectionBase::processProtocolData() {
     // Called when decryptedInput_ has data
     IoBuffer& decryptedInput = decryptedInput_;
-    IoBuffer& encryptedOutput = encryptedOutput_;
 
     IoBuffer telnetResponses(1024); // Buffer for responses generated by processInput
 
@@ -487,7 +600,7 @@ bool ConnectionBase::processProtocolData() {
                           "telnet responses")) {
             return false;
         }
-        if (encryptedOutput.readableBytes() > 0 && !pendingWriteFlag()) {
+        if (hasPendingOutput() && !pendingWriteFlag()) {
             postWrite();
         }
     }
@@ -550,7 +663,10 @@ bool ConnectionBase::processProtocolData() {
 }
 
 void ConnectionBase::closeNetworkAfterDrain() {
-    if (!closeAfterWriteDrain_ || pendingWriteFlag() || encryptedOutput_.readableBytes() > 0) {
+    if (  !closeAfterWriteDrain_
+       || tlsShutdownPending_
+       || pendingWriteFlag()
+       || hasPendingOutput()) {
         return;
     }
 
@@ -580,8 +696,9 @@ void ConnectionBase::forceCloseAfterIoFailure() {
         GANL_CONN_DEBUG(handle_,
             "forceCloseAfterIoFailure: aborting write drain after I/O failure.");
         closeAfterWriteDrain_ = false;
+        tlsShutdownPending_ = false;
         pendingWrite_ = false;
-        encryptedOutput_.clear();
+        clearOutput();
         // Keep disconnectReason_ from the original close() (e.g. UserQuit).
         //
         if (!socketClosed_) {
@@ -712,8 +829,17 @@ void ConnectionBase::close(DisconnectReason reason) {
     transitionToState(ConnectionState::Closing);
     disconnectReason_ = reason;
 
-    // 2. Attempt graceful TLS shutdown (if applicable and established)
-    if (useTls_ && secureTransport_ != nullptr && secureTransport_->isEstablished(handle_)) {
+    // 2. Attempt graceful TLS shutdown (if applicable and established).  An
+    // offloaded session sends its close_notify behind any output the worker
+    // has not encrypted yet; the network close waits for it to come back.
+    if (useTls_ && secureTransport_ != nullptr && tlsChannel_ && tlsEstablished_) {
+        GANL_CONN_DEBUG(handle_, "Requesting graceful TLS shutdown from the worker.");
+        tlsShutdownPending_ = true;
+        closeAfterWriteDrain_ = true;
+        tlsPool_->submitShutdown(*tlsChannel_);
+        return;
+    }
+    else if (useTls_ && secureTransport_ != nullptr && tlsEstablished()) {
         GANL_CONN_DEBUG(handle_, "Attempting graceful TLS shutdown.");
         // Ensure output buffer is clear of app data first? Maybe not necessary.
         TlsResult shutdownResult = secureTransport_->shutdownSession(handle_, encryptedOutput_);
@@ -738,7 +864,7 @@ void ConnectionBase::close(DisconnectReason reason) {
         }
         // If result is Success or Closed, TLS shutdown is done or already happened.
     }
-    else if (encryptedOutput_.readableBytes() > 0)
+    else if (hasPendingOutput())
     {
         // Plaintext (or TLS-not-established) connection with output still
         // queued.  Drain it before closing the socket rather than dropping it
@@ -749,7 +875,7 @@ void ConnectionBase::close(DisconnectReason reason) {
         // post the write, and let handleWrite -> closeNetworkAfterDrain()
         // finish the close once the buffer empties.
         GANL_CONN_DEBUG(handle_, "Deferring network close until "
-            << encryptedOutput_.readableBytes() << " queued bytes drain.");
+            << pendingOutputBytes() << " queued bytes drain.");
         closeAfterWriteDrain_ = true;
         if (!pendingWrite_ && !postWrite())
         {
@@ -807,6 +933,13 @@ void ConnectionBase::startTlsHandshake() {
     }
     GANL_CONN_DEBUG(handle_, "TLS session context created.");
 
+    if (tlsPool_ != nullptr) {
+        std::shared_ptr<ConnectionBase> self = weak_from_this().lock();
+        if (self) {
+            tlsChannel_ = tlsPool_->attach(handle_, self);
+        }
+    }
+
     // For server-side TLS, the first step often involves the server potentially sending
     // a ServerHello after receiving the ClientHello. Since we haven't received anything yet,
     // we might need to post a read first, or call processIncoming to see if the TLS lib
@@ -902,6 +1035,72 @@ void ConnectionBase::continueTlsHandshake() {
     }
 }
 
+bool ConnectionBase::tlsEstablished() const {
+    if (tlsChannel_) {
+        return tlsEstablished_;
+    }
+    return secureTransport_->isEstablished(handle_);
+}
+
+// The game-thread half of an offloaded TLS pass: the same steps
+// processSecureData(), continueTlsHandshake() and egressToWire() take
+// inline, applied to what the worker produced.
+//
+void ConnectionBase::handleTlsCompletion(TlsCompletion& results) {
+    if (getState() == ConnectionState::Closed || resourcesCleanedUp_) {
+        return;
+    }
+
+    tlsPendingBytes_ -= std::min(tlsPendingBytes_, results.plaintextConsumed);
+    if (results.encrypted.readableBytes() > 0) {
+        encryptedOutput_.append(results.encrypted.readPtr(), results.encrypted.readableBytes());
+    }
+
+    if (results.failure != TlsResult::Success) {
+        GANL_CONN_DEBUG(handle_, "TLS worker reported " << static_cast<int>(results.failure)
+                  << ": " << results.error << ". Closing.");
+        if (getState() == ConnectionState::TlsHandshaking) {
+            ganl::logMessage("TLS[%u] handshake error: %s", (unsigned)handle_, results.error.c_str());
+        }
+        // The session is finished; there is no close_notify to wait for.
+        tlsEstablished_ = false;
+        tlsPendingBytes_ = 0;
+        if (getState() == ConnectionState::Closing) {
+            forceCloseAfterIoFailure();
+        } else {
+            close(results.failure == TlsResult::Closed ? DisconnectReason::UserQuit
+                                                       : DisconnectReason::TlsError);
+        }
+        return;
+    }
+
+    if (results.established && !tlsEstablished_) {
+        tlsEstablished_ = true;
+        if (getState() == ConnectionState::TlsHandshaking) {
+            GANL_CONN_DEBUG(handle_, "TLS handshake COMPLETE on a worker.");
+            startTelnetNegotiation();
+        }
+    }
+    if (results.shutdownDone) {
+        tlsShutdownPending_ = false;
+    }
+
+    if (!isClosingOrClosed() && results.decrypted.readableBytes() > 0) {
+        decryptedInput_.append(results.decrypted.readPtr(), results.decrypted.readableBytes());
+        processProtocolData();
+    }
+
+    if (getState() == ConnectionState::Closing) {
+        if (hasPendingOutput() && !pendingWrite_ && !postWrite()) {
+            forceCloseAfterIoFailure();
+            return;
+        }
+        closeNetworkAfterDrain();
+    } else if (!isClosingOrClosed() && hasPendingOutput() && !pendingWrite_) {
+        postWrite();
+    }
+}
+
 void ConnectionBase::startTelnetNegotiation() {
     GANL_CONN_DEBUG(handle_, "Starting Telnet negotiation.");
     transitionToState(ConnectionState::TelnetNegotiating);
@@ -927,7 +1126,7 @@ void ConnectionBase::startTelnetNegotiation() {
                            "initial Telnet options")) {
              return; // TLS error closed the connection
          }
-         if (encryptedOutput_.readableBytes() > 0 && !pendingWrite_) {
+         if (hasPendingOutput() && !pendingWrite_) {
              postWrite();
          }
     } else {
@@ -1015,7 +1214,7 @@ bool ConnectionBase::postWrite() {
     }
 
     IoBuffer& encryptedOutput = encryptedOutput_;
-    if (encryptedOutput.readableBytes() == 0) {
+    if (!hasPendingOutput()) {
          GANL_CONN_DEBUG(handle_, "postWrite called, but encryptedOutput_ is empty. Ignoring.");
          return false;
     }
@@ -1066,6 +1265,14 @@ void ConnectionBase::cleanupResources(DisconnectReason reason) {
     if (useTls_ && secureTransport_ != nullptr) {
         // It's important that destroySessionContext is safe to call even if the context
         // doesn't exist or was already destroyed (idempotent).
+        // A worker may be running this session; wait it out so a new
+        // connection on the same handle never meets a stale worker.
+        if (tlsChannel_) {
+            tlsPool_->detach(*tlsChannel_);
+            tlsChannel_.reset();
+            tlsPendingBytes_ = 0;
+            tlsShutdownPending_ = false;
+        }
         GANL_CONN_DEBUG(handle_, "Destroying TLS session context.");
         secureTransport_->destroySessionContext(handle_);
     }
@@ -1135,14 +1342,22 @@ void ReadinessConnection::handleRead(size_t bytesTransferred)
     std::string lastErrorString;
 
     IoBuffer& encryptedInput = getEncryptedInputBuffer();
-    IoBuffer& encryptedOutput = getEncryptedOutputBuffer();
 
     // #1856: still drain to EAGAIN (required for EPOLLET), but never stage
     // an unbounded socket drain before processing.  Cap read chunks, feed
     // TLS/protocol after each chunk, and close if encrypted ingress exceeds
     // kMaxEncryptedIngress.
     //
+    // Stopping at kMaxReadPerEvent is the one exception to draining: the
+    // engine is asked to report the socket again so the rest is read on a
+    // later pass, after the other ready connections have had their turn.
+    //
+    bool budgetExhausted = false;
     while (true) {
+        if (static_cast<size_t>(totalBytesReadInCall) >= kMaxReadPerEvent) {
+            budgetExhausted = true;
+            break;
+        }
         if (encryptedInput.readableBytes() >= kMaxEncryptedIngress) {
             lastErrorString = "Encrypted ingress high-water exceeded";
             GANL_CONN_DEBUG(handle_, "Error: " << lastErrorString
@@ -1239,6 +1454,9 @@ void ReadinessConnection::handleRead(size_t bytesTransferred)
     }
     else {
         success = true; // Read attempts finished normally (hit EAGAIN or read some data)
+        if (budgetExhausted) {
+            networkEngine_.rearmRead(handle_);
+        }
     }
 
     if (needsClose) {
@@ -1265,26 +1483,32 @@ void ReadinessConnection::handleRead(size_t bytesTransferred)
 
     // Final check: If processing generated output, trigger a write
     if (!isClosingOrClosed()) {
-        if (encryptedOutput.readableBytes() > 0 && !pendingWriteFlag()) {
+        if (hasPendingOutput() && !pendingWriteFlag()) {
             GANL_CONN_DEBUG(handle_, "Data found in encryptedOutput_ after read processing. Posting write.");
             postWrite();
         }
     }
 }
 
+bool ReadinessConnection::supportsOutputChain() const
+{
+#ifdef _WIN32
+    return false;
+#else
+    return true;
+#endif
+}
+
 void ReadinessConnection::handleWrite(size_t bytesTransferred)
 {
     GANL_CONN_DEBUG(handle_, "handleWrite event. Bytes from event: " << bytesTransferred << ".");
     pendingWriteFlag() = false; // Event arrived, no longer pending in engine's view
 
-    // Get reference to output buffer
-    IoBuffer& encryptedOutput = getEncryptedOutputBuffer();
-
     // --- Select / Epoll / Kqueue / Readiness Model Logic ---
     GANL_CONN_DEBUG(handle_, "Readiness event (Write Ready). Trying to write remaining "
-        << encryptedOutput.readableBytes() << " bytes.");
+        << pendingOutputBytes() << " bytes.");
 
-    if (encryptedOutput.readableBytes() == 0) {
+    if (!hasPendingOutput()) {
         GANL_CONN_DEBUG(handle_, "Readiness Write event, but encryptedOutput_ is empty. False trigger or race condition?");
         // No need to do anything since there's no data to write
         // The network engine will automatically unregister write interest after this call
@@ -1295,20 +1519,37 @@ void ReadinessConnection::handleWrite(size_t bytesTransferred)
     bool socketBufferFull = false;
     std::string lastErrorString;
 
-    // Loop: write until buffer empty or EAGAIN/EWOULDBLOCK
-    while (encryptedOutput.readableBytes() > 0) {
-        const char* dataPtr = encryptedOutput.readPtr();
-        size_t dataSize = encryptedOutput.readableBytes();
+    // Loop: write until buffer empty or EAGAIN/EWOULDBLOCK.  The buffered
+    // bytes and any queued segments go out together in one writev().
+    constexpr int kMaxWriteBuffers = 64;
+    const char* bufs[kMaxWriteBuffers];
+    size_t lens[kMaxWriteBuffers];
+    while (hasPendingOutput()) {
+        const int nBufs = gatherOutput(bufs, lens, kMaxWriteBuffers);
 #ifdef _WIN32
         SOCKET fd = static_cast<SOCKET>(handle_);
 #else
         int fd = static_cast<int>(handle_);
 #endif
 
-        SocketReturnType bytesWrittenThisOp = GANL_WRITE(fd, dataPtr, dataSize);
+        SocketReturnType bytesWrittenThisOp;
+#ifdef _WIN32
+        bytesWrittenThisOp = GANL_WRITE(fd, bufs[0], lens[0]);
+#else
+        if (1 == nBufs) {
+            bytesWrittenThisOp = GANL_WRITE(fd, bufs[0], lens[0]);
+        } else {
+            struct iovec iov[kMaxWriteBuffers];
+            for (int i = 0; i < nBufs; i++) {
+                iov[i].iov_base = const_cast<char*>(bufs[i]);
+                iov[i].iov_len = lens[i];
+            }
+            bytesWrittenThisOp = ::writev(fd, iov, nBufs);
+        }
+#endif
 
         if (bytesWrittenThisOp > 0) {
-            encryptedOutput.consumeRead(bytesWrittenThisOp);
+            consumeOutput(static_cast<size_t>(bytesWrittenThisOp));
             totalBytesWrittenInCall += bytesWrittenThisOp;
         }
         else if (bytesWrittenThisOp == 0) {
@@ -1341,11 +1582,11 @@ void ReadinessConnection::handleWrite(size_t bytesTransferred)
     } // end while readiness write loop
 
     GANL_CONN_DEBUG(handle_, "Readiness write loop finished. Total written: " << totalBytesWrittenInCall
-        << ", SocketFull=" << socketBufferFull << ", Remaining=" << encryptedOutput.readableBytes());
+        << ", SocketFull=" << socketBufferFull << ", Remaining=" << pendingOutputBytes());
 
     // If we couldn't write everything because the socket buffer was full,
     // we need to re-register write interest to receive another write event when ready
-    if (encryptedOutput.readableBytes() > 0 && socketBufferFull) {
+    if (hasPendingOutput() && socketBufferFull) {
         GANL_CONN_DEBUG(handle_, "Data remains and socket buffer was full. Re-registering write interest.");
         if (!pendingWriteFlag()) {
             ErrorCode error = 0;
@@ -803,6 +803,26 @@ bool EpollNetworkEngine::postRead(ConnectionHandle conn, IoBuffer& buffer, Error
     return true;
 }
 
+// rearmRead: The connection stopped short of EAGAIN, so the EPOLLET edge that
+//            reported it is consumed.  An identical-mask EPOLL_CTL_MOD makes the
+//            kernel re-poll the fd and queue it again if data remains, behind
+//            whatever else is already ready.
+void EpollNetworkEngine::rearmRead(ConnectionHandle conn) {
+    int fd = static_cast<int>(conn);
+    uint32_t storedEvents = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto sockIt = sockets_.find(fd);
+        if (sockIt == sockets_.end() || sockIt->second.type != SocketType::Connection) {
+            return;
+        }
+        storedEvents = sockIt->second.events;
+    }
+    GANL_EPOLL_DEBUG(fd, "Read budget exhausted; re-arming via MOD to re-fire next poll.");
+    ErrorCode modError = 0;
+    modifyEpollFlags(fd, storedEvents, modError);
+}
+
 // postWrite: Called by Connection when it has data to write with user context.
 //            This function ensures EPOLLOUT is registered for the socket to indicate write interest.
 //            It does NOT perform the write itself.
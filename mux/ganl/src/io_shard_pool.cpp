@@ -0,0 +1,736 @@
+#include <io_shard_pool.h>
+#include <network_engine.h>
+#include <session_manager.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#if !defined(_WIN32) && !defined(WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace ganl {
+
+// One connection as both sides see it.  handle, shard and tls never change.
+// The atomics are written by the shard and read by the game thread; closing
+// belongs to the game thread and the rest to the shard.
+//
+struct ShardLink {
+    ShardLink(ConnectionHandle h, int s, bool t) : handle(h), shard(s), tls(t) {}
+
+    const ConnectionHandle handle;      // The game's handle (the original fd)
+    const int shard;
+    const bool tls;
+    int dupFd{-1};                      // What the shard runs it on
+
+    std::atomic<size_t> queued{0};      // Sent, not yet given to the connection
+    std::atomic<size_t> wire{0};        // pendingOutputBytes() when last seen
+    std::atomic<bool> running{false};
+
+    bool closing{false};                // close() has been queued
+    bool closePosted{false};            // Closed is on the completion list
+    bool released{false};               // Dropped for @restart; post nothing
+};
+
+enum class ShardCommandKind { Adopt, Send, Close, ReleaseAll, Stop };
+
+struct ShardCommand {
+    ShardCommandKind kind{ShardCommandKind::Send};
+    std::shared_ptr<ShardLink> link;
+    OutputSegment segment;
+    DisconnectReason reason{DisconnectReason::Unknown};
+};
+
+// The session manager each shard's connections report to.  The session id
+// is the game's handle, so it can be posted as-is.
+//
+class ShardSessions : public SessionManager {
+public:
+    ShardSessions(IoShardPool& pool, IoShard& shard) : pool_(pool), shard_(shard) {}
+
+    bool initialize() override { return true; }
+    void shutdown() override {}
+
+    SessionId onConnectionOpen(ConnectionHandle conn, const std::string& remoteAddress) override;
+    void onDataReceived(SessionId sessionId, const std::string& data) override;
+    void onConnectionClose(SessionId sessionId, DisconnectReason reason) override;
+
+    bool sendToSession(SessionId, const std::string&) override { return false; }
+    bool broadcastMessage(const std::string&, SessionId) override { return false; }
+    bool disconnectSession(SessionId, DisconnectReason) override { return false; }
+    bool authenticateSession(SessionId, ConnectionHandle, const std::string&,
+                             const std::string&) override { return false; }
+    void onAuthenticationSuccess(SessionId, int) override {}
+    int getPlayerId(SessionId) override { return -1; }
+    SessionState getSessionState(SessionId) override { return SessionState::Connected; }
+    SessionStats getSessionStats(SessionId) override { return SessionStats(); }
+    ConnectionHandle getConnectionHandle(SessionId sessionId) override;
+    bool isAddressAllowed(const std::string&) override { return true; }
+    bool isAddressRegistered(const std::string&) override { return false; }
+    bool isAddressForbidden(const std::string&) override { return false; }
+    bool isAddressSuspect(const std::string&) override { return false; }
+    std::string getLastSessionErrorString(SessionId) override { return std::string(); }
+
+private:
+    std::shared_ptr<ShardLink> find(SessionId sessionId);
+
+    IoShardPool& pool_;
+    IoShard& shard_;
+};
+
+struct ShardEntry {
+    std::shared_ptr<ConnectionBase> conn;
+    std::shared_ptr<ShardLink> link;
+};
+
+// A thread, its engine, and the connections it runs.  The maps are the
+// shard thread's alone; commands and the sequence numbers are guarded by
+// mutex.
+//
+struct IoShard {
+    IoShard(IoShardPool& pool) : sessions(pool, *this) {}
+
+    std::unique_ptr<NetworkEngine> engine;
+    ShardSessions sessions;
+    std::thread thread;
+    int wakeRead{-1};
+    int wakeWrite{-1};
+
+    std::unordered_map<ConnectionHandle, ShardEntry> conns;        // By shard handle
+    std::unordered_map<ConnectionHandle, ConnectionHandle> bySession;
+    std::vector<ConnectionHandle> finished;  // Reported Closed; reap after the call
+
+    std::mutex mutex;
+    std::condition_variable idle;   // Signalled when applied catches up
+    std::vector<ShardCommand> commands;
+    uint64_t submitted{0};
+    uint64_t applied{0};
+    bool exited{false};
+};
+
+SessionId ShardSessions::onConnectionOpen(ConnectionHandle conn, const std::string&)
+{
+    auto it = shard_.conns.find(conn);
+    if (it == shard_.conns.end()) {
+        return InvalidSessionId;
+    }
+    return static_cast<SessionId>(it->second.link->handle);
+}
+
+std::shared_ptr<ShardLink> ShardSessions::find(SessionId sessionId)
+{
+    auto it = shard_.bySession.find(static_cast<ConnectionHandle>(sessionId));
+    if (it == shard_.bySession.end()) {
+        return nullptr;
+    }
+    auto entry = shard_.conns.find(it->second);
+    return (entry == shard_.conns.end()) ? nullptr : entry->second.link;
+}
+
+void ShardSessions::onDataReceived(SessionId sessionId, const std::string& data)
+{
+    auto link = find(sessionId);
+    if (!link || link->released || link->closePosted) {
+        return;
+    }
+    ShardEvent event;
+    event.kind = ShardEvent::Kind::Data;
+    event.handle = link->handle;
+    event.data = data;
+    pool_.post(std::move(event));
+}
+
+void ShardSessions::onConnectionClose(SessionId sessionId, DisconnectReason reason)
+{
+    auto link = find(sessionId);
+    if (!link || link->released || link->closePosted) {
+        return;
+    }
+    link->closePosted = true;
+    shard_.finished.push_back(shard_.bySession[link->handle]);
+
+    ShardEvent event;
+    event.kind = ShardEvent::Kind::Closed;
+    event.handle = link->handle;
+    event.reason = reason;
+    pool_.post(std::move(event));
+}
+
+ConnectionHandle ShardSessions::getConnectionHandle(SessionId sessionId)
+{
+    return static_cast<ConnectionHandle>(sessionId);
+}
+
+IoShardPool::IoShardPool(NetworkEngineType type, SecureTransport* transport,
+                         ProtocolHandler& protocol, std::function<void()> wake)
+    : type_(type), transport_(transport), protocol_(protocol), wake_(std::move(wake))
+{
+}
+
+// Descriptors of connections whose close was never delivered are still the
+// pool's.
+//
+IoShardPool::~IoShardPool()
+{
+    stop();
+#if !defined(_WIN32) && !defined(WIN32)
+    for (auto& pair : links_) {
+        ::close(static_cast<int>(pair.first));
+    }
+#endif
+    links_.clear();
+}
+
+int IoShardPool::start(int shards)
+{
+#if defined(_WIN32) || defined(WIN32)
+    (void)shards;
+    return 0;
+#else
+    if (!NetworkEngineFactory::supportsConnectionAdoption(type_)) {
+        return 0;
+    }
+
+    // All or nothing: a shard that cannot be set up stops the ones already
+    // running.
+    //
+    for (int i = 0; i < shards; i++) {
+        std::unique_ptr<IoShard> shard;
+        try {
+            shard.reset(new IoShard(*this));
+        } catch (...) {
+            break;
+        }
+
+        shard->engine = NetworkEngineFactory::createEngine(type_);
+        if (!shard->engine || !shard->engine->initialize()) {
+            break;
+        }
+
+        // The shard's wake channel: non-blocking, so a full pipe (a wake
+        // already pending) never blocks the game thread, and CLOEXEC.
+        //
+        int sv[2] = {-1, -1};
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+            shard->engine->shutdown();
+            break;
+        }
+        bool ok = true;
+        for (int fd : sv) {
+            const int fl = fcntl(fd, F_GETFL, 0);
+            const int fdflags = fcntl(fd, F_GETFD, 0);
+            if (  fl < 0
+               || fcntl(fd, F_SETFL, fl | O_NONBLOCK) < 0
+               || fdflags < 0
+               || fcntl(fd, F_SETFD, fdflags | FD_CLOEXEC) < 0) {
+                ok = false;
+            }
+        }
+        ErrorCode error = 0;
+        if (  !ok
+           || InvalidConnectionHandle == shard->engine->adoptConnection(sv[0], shard.get(), error)) {
+            ::close(sv[0]);
+            ::close(sv[1]);
+            shard->engine->shutdown();
+            break;
+        }
+        shard->wakeRead = sv[0];
+        shard->wakeWrite = sv[1];
+
+        IoShard* p = shard.get();
+        try {
+            shard->thread = std::thread(&IoShardPool::shardMain, this, std::ref(*p));
+        } catch (const std::system_error&) {
+            shard->engine->shutdown();
+            ::close(sv[1]);
+            break;
+        }
+        shards_.push_back(std::move(shard));
+    }
+    if (static_cast<int>(shards_.size()) < shards) {
+        stop();
+    }
+    return static_cast<int>(shards_.size());
+#endif
+}
+
+void IoShardPool::stop()
+{
+    for (auto& shard : shards_) {
+        ShardCommand command;
+        command.kind = ShardCommandKind::Stop;
+        queue(*shard, std::move(command));
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+#if !defined(_WIN32) && !defined(WIN32)
+        if (0 <= shard->wakeWrite) {
+            ::close(shard->wakeWrite);
+        }
+#endif
+    }
+    shards_.clear();
+}
+
+void IoShardPool::queue(IoShard& shard, ShardCommand&& command)
+{
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.exited) {
+            return;
+        }
+        first = shard.commands.empty();
+        shard.commands.push_back(std::move(command));
+        shard.submitted++;
+    }
+#if !defined(_WIN32) && !defined(WIN32)
+    if (first) {
+        const char ch = 0;
+        ssize_t n;
+        do {
+            n = write(shard.wakeWrite, &ch, 1);
+        } while (n < 0 && EINTR == errno);
+    }
+#else
+    (void)first;
+#endif
+}
+
+void IoShardPool::post(ShardEvent&& event)
+{
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        first = completed_.empty();
+        completed_.push_back(std::move(event));
+    }
+    if (first && wake_) {
+        wake_();
+    }
+}
+
+bool IoShardPool::adopt(ConnectionHandle handle, bool useTls)
+{
+#if defined(_WIN32) || defined(WIN32)
+    (void)handle;
+    (void)useTls;
+    return false;
+#else
+    if (shards_.empty() || links_.count(handle)) {
+        return false;
+    }
+    const int dupFd = fcntl(static_cast<int>(handle), F_DUPFD_CLOEXEC, 0);
+    if (dupFd < 0) {
+        return false;
+    }
+
+    const int index = static_cast<int>(handle % shards_.size());
+    std::shared_ptr<ShardLink> link;
+    try {
+        link = std::make_shared<ShardLink>(handle, index, useTls);
+        link->dupFd = dupFd;
+        links_[handle] = link;
+    } catch (...) {
+        ::close(dupFd);
+        links_.erase(handle);
+        return false;
+    }
+
+    ShardCommand command;
+    command.kind = ShardCommandKind::Adopt;
+    command.link = link;
+    queue(*shards_[index], std::move(command));
+    return true;
+#endif
+}
+
+bool IoShardPool::owns(ConnectionHandle handle) const
+{
+    return links_.count(handle) != 0;
+}
+
+void IoShardPool::send(ConnectionHandle handle, const OutputSegment& segment)
+{
+    auto it = links_.find(handle);
+    if (it == links_.end() || it->second->closing || !segment) {
+        return;
+    }
+    it->second->queued += segment->size();
+
+    ShardCommand command;
+    command.kind = ShardCommandKind::Send;
+    command.link = it->second;
+    command.segment = segment;
+    queue(*shards_[it->second->shard], std::move(command));
+}
+
+void IoShardPool::close(ConnectionHandle handle, DisconnectReason reason)
+{
+    auto it = links_.find(handle);
+    if (it == links_.end() || it->second->closing) {
+        return;
+    }
+    it->second->closing = true;
+
+    ShardCommand command;
+    command.kind = ShardCommandKind::Close;
+    command.link = it->second;
+    command.reason = reason;
+    queue(*shards_[it->second->shard], std::move(command));
+}
+
+size_t IoShardPool::pendingOutputBytes(ConnectionHandle handle) const
+{
+    auto it = links_.find(handle);
+    if (it == links_.end()) {
+        return 0;
+    }
+    return it->second->queued.load() + it->second->wire.load();
+}
+
+bool IoShardPool::isRunning(ConnectionHandle handle) const
+{
+    auto it = links_.find(handle);
+    return it != links_.end() && it->second->running.load();
+}
+
+void IoShardPool::runCompletions(SessionManager& sessions)
+{
+    std::vector<ShardEvent> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done.swap(completed_);
+    }
+
+    for (auto& event : done) {
+        auto it = links_.find(event.handle);
+        if (it == links_.end()) {
+            continue;
+        }
+        if (ShardEvent::Kind::Data == event.kind) {
+            if (!it->second->closing) {
+                sessions.onDataReceived(static_cast<SessionId>(event.handle), event.data);
+            }
+        } else {
+            links_.erase(it);
+            sessions.onConnectionClose(static_cast<SessionId>(event.handle), event.reason);
+#if !defined(_WIN32) && !defined(WIN32)
+            ::close(static_cast<int>(event.handle));
+#endif
+        }
+    }
+}
+
+void IoShardPool::waitIdle()
+{
+    for (auto& shard : shards_) {
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        IoShard* p = shard.get();
+        shard->idle.wait(lock, [p] { return p->exited || p->applied >= p->submitted; });
+    }
+}
+
+void IoShardPool::releaseAll()
+{
+    for (auto& shard : shards_) {
+        ShardCommand command;
+        command.kind = ShardCommandKind::ReleaseAll;
+        queue(*shard, std::move(command));
+    }
+    waitIdle();
+#if !defined(_WIN32) && !defined(WIN32)
+    for (const auto& pair : links_) {
+        if (pair.second->closing) {
+            ::close(static_cast<int>(pair.first));
+        }
+    }
+#endif
+    links_.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    completed_.clear();
+}
+
+// Drop connections that have reported their close.  The entry is emptied
+// before it is erased so that a destructor reporting late still finds it.
+//
+void IoShardPool::reap(IoShard& shard)
+{
+    while (!shard.finished.empty()) {
+        std::vector<ConnectionHandle> finished;
+        finished.swap(shard.finished);
+        for (ConnectionHandle h : finished) {
+            auto it = shard.conns.find(h);
+            if (it == shard.conns.end()) {
+                continue;
+            }
+            std::shared_ptr<ConnectionBase> conn = std::move(it->second.conn);
+            conn.reset();
+            it = shard.conns.find(h);
+            if (it != shard.conns.end()) {
+                shard.bySession.erase(it->second.link->handle);
+                shard.conns.erase(it);
+            }
+        }
+    }
+}
+
+static void note_progress(ConnectionBase& conn, ShardLink& link, const std::function<void()>& wake)
+{
+    link.wire = conn.pendingOutputBytes();
+    if (!link.running && ConnectionState::Running == conn.getState()) {
+        link.running = true;
+        if (link.tls && wake) {
+            wake();
+        }
+    }
+}
+
+void IoShardPool::runCommands(IoShard& shard)
+{
+    std::vector<ShardCommand> commands;
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        commands.swap(shard.commands);
+        seq = shard.submitted;
+    }
+
+    for (auto& command : commands) {
+        if (shard.wakeRead < 0) {
+            break;      // Stopped; the engine is gone.
+        }
+        const std::shared_ptr<ShardLink>& link = command.link;
+        switch (command.kind) {
+        case ShardCommandKind::Adopt:
+            {
+                ErrorCode error = 0;
+                const ConnectionHandle h = shard.engine->adoptConnection(link->dupFd, nullptr, error);
+                std::shared_ptr<ConnectionBase> conn;
+                if (InvalidConnectionHandle != h) {
+                    try {
+                        conn = ConnectionFactory::createConnection(h, *shard.engine,
+                            link->tls ? transport_ : nullptr, protocol_, shard.sessions);
+                        if (conn) {
+                            shard.conns[h] = ShardEntry{conn, link};
+                            shard.bySession[link->handle] = h;
+                        }
+                    } catch (...) {
+                        shard.conns.erase(h);
+                        shard.bySession.erase(link->handle);
+                        conn.reset();
+                    }
+                }
+
+                bool ok = false;
+                if (conn) {
+                    try {
+                        ok = conn->initialize(link->tls);
+                    } catch (...) {
+                        ok = false;
+                    }
+                } else if (InvalidConnectionHandle != h) {
+                    shard.engine->closeConnection(h);
+                } else {
+#if !defined(_WIN32) && !defined(WIN32)
+                    ::close(link->dupFd);
+#endif
+                }
+
+                if (ok) {
+                    note_progress(*conn, *link, wake_);
+                } else if (!link->closePosted) {
+                    link->closePosted = true;
+                    if (conn) {
+                        shard.finished.push_back(h);
+                    }
+                    ShardEvent event;
+                    event.kind = ShardEvent::Kind::Closed;
+                    event.handle = link->handle;
+                    event.reason = DisconnectReason::NetworkError;
+                    post(std::move(event));
+                }
+            }
+            break;
+
+        case ShardCommandKind::Send:
+        case ShardCommandKind::Close:
+            {
+                if (ShardCommandKind::Send == command.kind) {
+                    link->queued -= command.segment->size();
+                }
+                auto itSession = shard.bySession.find(link->handle);
+                if (itSession == shard.bySession.end()) {
+                    break;
+                }
+                auto it = shard.conns.find(itSession->second);
+                if (it == shard.conns.end() || !it->second.conn) {
+                    break;
+                }
+                std::shared_ptr<ConnectionBase> conn = it->second.conn;
+                try {
+                    if (ShardCommandKind::Send == command.kind) {
+                        conn->sendDataToClient(command.segment);
+                    } else {
+                        conn->close(command.reason);
+                    }
+                } catch (...) {
+                    try {
+                        conn->close(DisconnectReason::NetworkError);
+                    } catch (...) {
+                        ; // Nothing.
+                    }
+                }
+                note_progress(*conn, *link, wake_);
+            }
+            break;
+
+        case ShardCommandKind::ReleaseAll:
+            for (auto& pair : shard.conns) {
+                pair.second.link->released = true;
+                shard.engine->detachConnection(pair.first);
+            }
+            for (auto& pair : shard.conns) {
+                std::shared_ptr<ConnectionBase> conn = std::move(pair.second.conn);
+                conn.reset();
+#if !defined(_WIN32) && !defined(WIN32)
+                ::close(static_cast<int>(pair.first));
+#endif
+            }
+            shard.conns.clear();
+            shard.bySession.clear();
+            shard.finished.clear();
+            break;
+
+        case ShardCommandKind::Stop:
+            drainShard(shard);
+            break;
+        }
+    }
+    reap(shard);
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.applied = seq;
+    }
+    shard.idle.notify_all();
+}
+
+// Close everything, give the output a moment to reach the wire, then drop
+// whatever is left.  Destroying a connection still reports its close.
+//
+void IoShardPool::drainShard(IoShard& shard)
+{
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.exited = true;
+    }
+
+    std::vector<std::shared_ptr<ConnectionBase>> conns;
+    for (auto& pair : shard.conns) {
+        if (pair.second.conn) {
+            conns.push_back(pair.second.conn);
+        }
+    }
+    for (auto& conn : conns) {
+        try {
+            conn->close(DisconnectReason::ServerShutdown);
+        } catch (...) {
+            ; // Nothing.
+        }
+    }
+    conns.clear();
+    reap(shard);
+
+    constexpr int MAX_EVENTS = 64;
+    IoEvent events[MAX_EVENTS];
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    while (!shard.conns.empty() && std::chrono::steady_clock::now() < deadline) {
+        const int n = shard.engine->processEvents(10, events, MAX_EVENTS);
+        for (int i = 0; i < n; i++) {
+            auto it = shard.conns.find(events[i].connection);
+            if (it != shard.conns.end() && it->second.conn && events[i].context == it->second.conn.get()) {
+                std::shared_ptr<ConnectionBase> conn = it->second.conn;
+                try {
+                    conn->handleNetworkEvent(events[i]);
+                } catch (...) {
+                    ; // Nothing.
+                }
+            }
+        }
+        reap(shard);
+    }
+
+    for (auto& pair : shard.conns) {
+        shard.finished.push_back(pair.first);
+    }
+    reap(shard);
+
+    // The engine closes the wake channel's read end with everything else.
+    //
+    shard.engine->shutdown();
+    shard.wakeRead = -1;
+}
+
+void IoShardPool::shardMain(IoShard& shard)
+{
+    constexpr int MAX_EVENTS = 64;
+    IoEvent events[MAX_EVENTS];
+    for (;;) {
+        const int n = shard.engine->processEvents(1000, events, MAX_EVENTS);
+        for (int i = 0; i < n; i++) {
+            if (events[i].context == &shard) {
+#if !defined(_WIN32) && !defined(WIN32)
+                char buf[256];
+                for (;;) {
+                    const ssize_t got = read(shard.wakeRead, buf, sizeof(buf));
+                    if (0 < got || (got < 0 && EINTR == errno)) {
+                        continue;
+                    }
+                    break;
+                }
+#endif
+                continue;
+            }
+
+            auto it = shard.conns.find(events[i].connection);
+            if (it == shard.conns.end() || !it->second.conn || events[i].context != it->second.conn.get()) {
+                continue;
+            }
+            std::shared_ptr<ConnectionBase> conn = it->second.conn;
+            std::shared_ptr<ShardLink> link = it->second.link;
+            try {
+                conn->handleNetworkEvent(events[i]);
+            } catch (...) {
+                try {
+                    conn->close(DisconnectReason::NetworkError);
+                } catch (...) {
+                    ; // Nothing.
+                }
+            }
+            note_progress(*conn, *link, wake_);
+        }
+        reap(shard);
+
+        runCommands(shard);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.exited) {
+            shard.idle.notify_all();
+            return;
+        }
+    }
+}
+
+} // namespace ganl
@@ -0,0 +1,1480 @@
+#include "io_uring_network_engine.h"
+
+#if defined(GANL_HAVE_IO_URING)
+
+#include "slave_spawn_posix.h"
+#include <io_buffer.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h> // For TCP_NODELAY
+#include <arpa/inet.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// Debug logging is OFF unless the build defines GANL_DEBUG; see the note on
+// GANL_EPOLL_DEBUG in epoll_network_engine.cpp (#2049).
+#ifdef GANL_DEBUG
+#define GANL_URING_DEBUG(fd, x) \
+    do { std::cerr << "[IoUring:" << std::to_string(fd) << "] " << x << std::endl; } while (0)
+#else
+#define GANL_URING_DEBUG(fd, x) do {} while (0)
+#endif
+
+namespace ganl {
+
+namespace {
+
+// Submission queue depth.  Requests are only queued between processEvents()
+// calls, and a full queue is flushed early, so this bounds batching rather
+// than the number of connections.
+constexpr unsigned kRingEntries = 1024;
+
+// Completion queue depth.  Multishot requests post many completions per
+// submission; the kernel holds any overflow (IORING_FEAT_NODROP) until the
+// next reap.
+constexpr unsigned kCompletionEntries = 8192;
+
+// Provided buffer ring that multishot recv fills.  Each completion's bytes
+// are copied out and the buffer handed back at once, so the ring only has to
+// cover the completions that arrive between two reaps.
+constexpr uint16_t kBufferGroup = 0;
+constexpr unsigned kBufferCount = 256;      // Must be a power of two
+constexpr size_t kBufferSize = 16 * 1024;
+
+// Sends go out as a chain of linked requests of at most kSendLinkBytes each,
+// and at most kSendChainLinks links per chain; a longer write is sent as
+// several chains, one after the other.
+constexpr size_t kSendLinkBytes = 64 * 1024;
+constexpr size_t kSendChainLinks = 16;
+
+// Received bytes held for a connection that has not posted a read.  Past
+// this, its multishot recv is cancelled until the caller catches up, so a
+// flooding peer meets TCP flow control rather than unbounded memory.  Same
+// ceiling as the connection's own encrypted-ingress cap.
+constexpr size_t kMaxReceived = 256 * 1024;
+
+// user_data for requests whose completions are ignored (cancellations).
+constexpr uint64_t kIgnoredOp = 0;
+
+int sysIoUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sysIoUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags,
+                    const void* arg, size_t argSize) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete,
+                                    flags, arg, argSize));
+}
+
+int sysIoUringRegister(int fd, unsigned opcode, const void* arg, unsigned nrArgs) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+// poll32_events is word-swapped on big-endian machines.
+uint32_t pollMask(uint32_t events) {
+#if __BYTE_ORDER == __BIG_ENDIAN
+    events = (events << 16) | (events >> 16);
+#endif
+    return events;
+}
+
+} // namespace
+
+// The mapped submission and completion rings, and the provided buffer ring
+// multishot recv draws from.
+//
+struct IoUringNetworkEngine::Ring {
+    int fd{-1};
+    unsigned features{0};
+
+    void* ringMap{MAP_FAILED};
+    size_t ringMapLength{0};
+    io_uring_sqe* sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+    size_t sqesLength{0};
+
+    unsigned* sqHead{nullptr};
+    unsigned* sqTail{nullptr};
+    unsigned* sqFlags{nullptr};
+    unsigned* sqArray{nullptr};
+    unsigned sqMask{0};
+    unsigned sqEntries{0};
+    unsigned sqLocalTail{0};    // Prepared entries, published by publish()
+
+    unsigned* cqHead{nullptr};
+    unsigned* cqTail{nullptr};
+    unsigned cqMask{0};
+    io_uring_cqe* cqes{nullptr};
+
+    void* bufRing{MAP_FAILED};
+    size_t bufRingLength{0};
+    char* bufBase{static_cast<char*>(MAP_FAILED)};
+    uint16_t bufTail{0};
+    bool bufRegistered{false};
+
+    ~Ring() { close(); }
+
+    bool open(ErrorCode& error);
+    void close();
+
+    unsigned sqSpace() const {
+        return sqEntries - (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE));
+    }
+
+    io_uring_sqe* getSqe() {
+        if (sqSpace() == 0) {
+            return nullptr;
+        }
+        io_uring_sqe* sqe = &sqes[sqLocalTail & sqMask];
+        sqLocalTail++;
+        memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    // Make prepared entries visible to the kernel; returns how many it has
+    // yet to consume.
+    unsigned publish() {
+        __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+        return sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    }
+
+    const char* buffer(uint16_t bid) const {
+        return bufBase + static_cast<size_t>(bid) * kBufferSize;
+    }
+
+    // Queue a buffer back onto the provided ring; publishBuffers() hands the
+    // queued ones to the kernel.  The entries are addressed by hand: in C++
+    // the flexible array in io_uring_buf_ring sits eight bytes past where
+    // the kernel expects it.
+    void recycleBuffer(uint16_t bid) {
+        io_uring_buf* entry = static_cast<io_uring_buf*>(bufRing) + (bufTail & (kBufferCount - 1));
+        entry->addr = reinterpret_cast<uint64_t>(buffer(bid));
+        entry->len = static_cast<uint32_t>(kBufferSize);
+        entry->bid = bid;
+        bufTail++;
+    }
+
+    void publishBuffers() {
+        __atomic_store_n(&static_cast<io_uring_buf_ring*>(bufRing)->tail, bufTail, __ATOMIC_RELEASE);
+    }
+};
+
+bool IoUringNetworkEngine::Ring::open(ErrorCode& error) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = kCompletionEntries;
+
+    fd = sysIoUringSetup(kRingEntries, &params);
+    if (fd < 0) {
+        error = errno;
+        return false;
+    }
+    features = params.features;
+
+    // Waiting with a timeout needs EXT_ARG, and multishot requests need a
+    // completion queue that cannot drop entries.
+    const unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((features & required) != required) {
+        error = ENOTSUP;
+        close();
+        return false;
+    }
+
+    // IORING_OP_SEND_ZC arrived in the same release (6.0) as multishot recv
+    // and synchronous cancel; its presence is how the probe tells them apart
+    // from the 5.19 kernels that have provided buffer rings but not those.
+    {
+        const size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+        std::vector<char> probeStorage(probeSize, 0);
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeStorage.data());
+        if (sysIoUringRegister(fd, IORING_REGISTER_PROBE, probe, 256) < 0
+            || probe->last_op < IORING_OP_SEND_ZC) {
+            error = ENOTSUP;
+            close();
+            return false;
+        }
+    }
+
+    ringMapLength = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                             params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    ringMap = mmap(nullptr, ringMapLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   fd, IORING_OFF_SQ_RING);
+    if (ringMap == MAP_FAILED) {
+        error = errno;
+        close();
+        return false;
+    }
+    sqesLength = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesLength, PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED) {
+        error = errno;
+        close();
+        return false;
+    }
+
+    char* base = static_cast<char*>(ringMap);
+    sqHead = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+    sqFlags = reinterpret_cast<unsigned*>(base + params.sq_off.flags);
+    sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+    sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+    sqLocalTail = *sqTail;
+    for (unsigned i = 0; i < sqEntries; i++) {
+        sqArray[i] = i;
+    }
+    cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    bufRingLength = (kBufferCount * sizeof(io_uring_buf) + pageSize - 1) & ~(pageSize - 1);
+    bufRing = mmap(nullptr, bufRingLength, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    bufBase = static_cast<char*>(mmap(nullptr, kBufferCount * kBufferSize, PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (bufRing == MAP_FAILED || bufBase == MAP_FAILED) {
+        error = ENOMEM;
+        close();
+        return false;
+    }
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(bufRing);
+    reg.ring_entries = kBufferCount;
+    reg.bgid = kBufferGroup;
+    if (sysIoUringRegister(fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        error = errno;
+        close();
+        return false;
+    }
+    bufRegistered = true;
+    for (unsigned bid = 0; bid < kBufferCount; bid++) {
+        recycleBuffer(static_cast<uint16_t>(bid));
+    }
+    publishBuffers();
+    return true;
+}
+
+void IoUringNetworkEngine::Ring::close() {
+    if (fd >= 0) {
+        // Cancel anything still in flight and wait for it, so the kernel is
+        // done with the provided buffers before they are unmapped.
+        io_uring_sync_cancel_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.fd = -1;
+        reg.flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+        reg.timeout.tv_sec = -1;
+        reg.timeout.tv_nsec = -1;
+        sysIoUringRegister(fd, IORING_REGISTER_SYNC_CANCEL, &reg, 1);
+        ::close(fd);
+        fd = -1;
+    }
+    bufRegistered = false;
+    if (bufBase != MAP_FAILED) {
+        munmap(bufBase, kBufferCount * kBufferSize);
+        bufBase = static_cast<char*>(MAP_FAILED);
+    }
+    if (bufRing != MAP_FAILED) {
+        munmap(bufRing, bufRingLength);
+        bufRing = MAP_FAILED;
+    }
+    if (sqes != MAP_FAILED) {
+        munmap(sqes, sqesLength);
+        sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    }
+    if (ringMap != MAP_FAILED) {
+        munmap(ringMap, ringMapLength);
+        ringMap = MAP_FAILED;
+    }
+}
+
+IoUringNetworkEngine::IoUringNetworkEngine() {
+    GANL_URING_DEBUG(0, "Engine Created.");
+}
+
+IoUringNetworkEngine::~IoUringNetworkEngine() {
+    GANL_URING_DEBUG(0, "Engine Destroyed.");
+    shutdown();
+}
+
+bool IoUringNetworkEngine::isSupported() {
+    Ring ring;
+    ErrorCode error = 0;
+    return ring.open(error);
+}
+
+bool IoUringNetworkEngine::initialize() {
+    GANL_URING_DEBUG(0, "Initializing...");
+    if (ring_) {
+        return true;
+    }
+    auto ring = std::make_unique<Ring>();
+    ErrorCode error = 0;
+    if (!ring->open(error)) {
+        std::cerr << "[IoUring:CTL] io_uring unavailable: " << strerror(error) << std::endl;
+        return false;
+    }
+    ring_ = std::move(ring);
+    GANL_URING_DEBUG(ring_->fd, "io_uring_setup successful.");
+    return true;
+}
+
+void IoUringNetworkEngine::shutdown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ring_) {
+        return;
+    }
+    GANL_URING_DEBUG(0, "Closing " << sockets_.size() << " sockets...");
+    while (!sockets_.empty()) {
+        forgetSocket(sockets_.begin()->first, true);
+    }
+    ring_->close();
+    ring_.reset();
+    ops_.clear();
+    ready_.clear();
+    armPending_.clear();
+    GANL_URING_DEBUG(0, "Shutdown complete.");
+}
+
+// --- Listener Management ---
+
+ListenerHandle IoUringNetworkEngine::createListener(const std::string& host, uint16_t port, ErrorCode& error) {
+    GANL_URING_DEBUG(0, "Creating listener for " << host << ":" << port);
+    error = 0;
+    if (!ring_) {
+        error = EINVAL;
+        return InvalidListenerHandle;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    hints.ai_flags = AI_PASSIVE; // Allow binding when host empty
+
+    const char* hostCStr = host.empty() ? nullptr : host.c_str();
+    std::string portStr = std::to_string(port);
+    addrinfo* results = nullptr;
+    int gaiResult = ::getaddrinfo(hostCStr, portStr.c_str(), &hints, &results);
+    if (gaiResult != 0) {
+        error = (gaiResult == EAI_SYSTEM) ? errno : EINVAL;
+        return InvalidListenerHandle;
+    }
+
+    int fd = -1;
+    int lastErr = 0;
+    for (addrinfo* ai = results; ai != nullptr; ai = ai->ai_next) {
+        // #1823: steady-state listeners must not survive panic exec.
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd == -1) {
+            lastErr = errno;
+            continue;
+        }
+
+        int opt = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1) {
+            lastErr = errno;
+            ::close(fd);
+            fd = -1;
+            continue;
+        }
+
+        if (ai->ai_family == AF_INET6) {
+            int disable = 0;
+            if (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &disable, sizeof(disable)) == -1) {
+                int v6Err = errno;
+                std::cerr << "[IoUring:" << fd << "] WARNING: setsockopt(IPV6_V6ONLY=0) failed; "
+                          << "listener will accept IPv6 only: " << strerror(v6Err) << std::endl;
+            }
+        }
+
+        if (bind(fd, ai->ai_addr, static_cast<socklen_t>(ai->ai_addrlen)) == -1) {
+            lastErr = errno;
+            GANL_URING_DEBUG(fd, "bind() failed: " << strerror(lastErr));
+            ::close(fd);
+            fd = -1;
+            continue;
+        }
+        lastErr = 0;
+        break;
+    }
+    ::freeaddrinfo(results);
+
+    if (fd == -1) {
+        error = lastErr != 0 ? lastErr : EADDRNOTAVAIL;
+        return InvalidListenerHandle;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    registerSocket(fd, SocketType::Listener, nullptr);
+    GANL_URING_DEBUG(fd, "Listener created successfully.");
+    return static_cast<ListenerHandle>(fd);
+}
+
+ListenerHandle IoUringNetworkEngine::adoptListener(int fd, ErrorCode& error) {
+    error = 0;
+    if (fd < 0) {
+        error = EBADF;
+        return InvalidListenerHandle;
+    }
+    if (!ring_) {
+        error = EINVAL;
+        return InvalidListenerHandle;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sockets_.find(fd) != sockets_.end()) {
+        error = EEXIST;
+        return InvalidListenerHandle;
+    }
+    if (!setNonBlocking(fd, error)) {
+        return InvalidListenerHandle;
+    }
+    registerSocket(fd, SocketType::Listener, nullptr);
+    GANL_URING_DEBUG(fd, "Adopted external listener successfully.");
+    return static_cast<ListenerHandle>(fd);
+}
+
+bool IoUringNetworkEngine::startListening(ListenerHandle listener, void* listenerContext, ErrorCode& error) {
+    int fd = static_cast<int>(listener);
+    error = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sockets_.find(fd);
+    if (it == sockets_.end() || it->second.type != SocketType::Listener) {
+        error = EINVAL;
+        return false;
+    }
+    if (listen(fd, SOMAXCONN) == -1) {
+        error = errno;
+        GANL_URING_DEBUG(fd, "listen() failed: " << strerror(error));
+        return false;
+    }
+    it->second.context = listenerContext;
+    it->second.listening = true;
+    requestArm(fd, it->second);
+    GANL_URING_DEBUG(fd, "Listener started successfully.");
+    return true;
+}
+
+void IoUringNetworkEngine::closeListener(ListenerHandle listener) {
+    int fd = static_cast<int>(listener);
+    GANL_URING_DEBUG(fd, "Closing listener...");
+    std::lock_guard<std::mutex> lock(mutex_);
+    forgetSocket(fd, true);
+}
+
+void IoUringNetworkEngine::detachListener(ListenerHandle listener) {
+    int fd = static_cast<int>(listener);
+    GANL_URING_DEBUG(fd, "Detaching listener (no close)...");
+    std::lock_guard<std::mutex> lock(mutex_);
+    forgetSocket(fd, false);
+}
+
+// --- Connection Management ---
+
+ConnectionHandle IoUringNetworkEngine::adoptConnection(int fd, void* connectionContext, ErrorCode& error) {
+    error = 0;
+    if (fd < 0) {
+        error = EBADF;
+        return InvalidConnectionHandle;
+    }
+    if (!ring_) {
+        error = EINVAL;
+        return InvalidConnectionHandle;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sockets_.find(fd) != sockets_.end()) {
+        error = EEXIST;
+        return InvalidConnectionHandle;
+    }
+    if (!setNonBlocking(fd, error)) {
+        return InvalidConnectionHandle;
+    }
+    SocketInfo& si = registerSocket(fd, SocketType::Connection, connectionContext);
+    requestArm(fd, si);
+    GANL_URING_DEBUG(fd, "Adopted external connection successfully.");
+    return static_cast<ConnectionHandle>(fd);
+}
+
+ConnectionHandle IoUringNetworkEngine::initiateConnect(const std::string& host, uint16_t port,
+                                                       void* connectionContext, ErrorCode& error) {
+    error = 0;
+    GANL_URING_DEBUG(0, "Initiating outbound connect to " << host << ":" << port);
+    if (!ring_) {
+        error = EINVAL;
+        return InvalidConnectionHandle;
+    }
+
+    // Resolve hostname (blocking, as the other engines do).
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    std::string portStr = std::to_string(port);
+    addrinfo* results = nullptr;
+    int gaiResult = ::getaddrinfo(host.c_str(), portStr.c_str(), &hints, &results);
+    if (gaiResult != 0) {
+        error = (gaiResult == EAI_SYSTEM) ? errno : EINVAL;
+        return InvalidConnectionHandle;
+    }
+
+    int fd = -1;
+    int lastErr = 0;
+    for (addrinfo* ai = results; ai != nullptr; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd == -1) {
+            lastErr = errno;
+            continue;
+        }
+        if (::connect(fd, ai->ai_addr, static_cast<socklen_t>(ai->ai_addrlen)) == 0
+            || errno == EINPROGRESS || errno == EWOULDBLOCK) {
+            break;
+        }
+        lastErr = errno;
+        GANL_URING_DEBUG(fd, "connect() failed: " << strerror(lastErr));
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(results);
+
+    if (fd == -1) {
+        error = lastErr != 0 ? lastErr : ECONNREFUSED;
+        return InvalidConnectionHandle;
+    }
+
+    // Immediate or in progress, the result comes from SO_ERROR once the
+    // socket polls writable (#942).
+    std::lock_guard<std::mutex> lock(mutex_);
+    SocketInfo& si = registerSocket(fd, SocketType::OutboundConnecting, connectionContext);
+    requestArm(fd, si);
+    return static_cast<ConnectionHandle>(fd);
+}
+
+ConnectionHandle IoUringNetworkEngine::initiateUnixConnect(const std::string& path,
+                                                           void* connectionContext, ErrorCode& error) {
+    error = 0;
+    GANL_URING_DEBUG(0, "Initiating outbound Unix connect to " << path);
+    if (!ring_) {
+        error = EINVAL;
+        return InvalidConnectionHandle;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        error = ENAMETOOLONG;
+        return InvalidConnectionHandle;
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        error = errno;
+        return InvalidConnectionHandle;
+    }
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0
+        && errno != EINPROGRESS && errno != EWOULDBLOCK) {
+        error = errno;
+        GANL_URING_DEBUG(fd, "Unix connect() failed: " << strerror(error));
+        ::close(fd);
+        return InvalidConnectionHandle;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    SocketInfo& si = registerSocket(fd, SocketType::OutboundConnecting, connectionContext);
+    requestArm(fd, si);
+    return static_cast<ConnectionHandle>(fd);
+}
+
+ConnectionHandle IoUringNetworkEngine::spawnSlave(const SlaveSpawnOptions& options, ErrorCode& error) {
+    return spawnSlavePosix(*this, options, error);
+}
+
+bool IoUringNetworkEngine::associateContext(ConnectionHandle conn, void* context, ErrorCode& error) {
+    int fd = static_cast<int>(conn);
+    error = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sockets_.find(fd);
+    if (it == sockets_.end()) {
+        error = EBADF;
+        return false;
+    }
+    if (it->second.type != SocketType::Connection) {
+        error = EINVAL;
+        return false;
+    }
+    it->second.context = context;
+    return true;
+}
+
+void IoUringNetworkEngine::closeConnection(ConnectionHandle conn) {
+    int fd = static_cast<int>(conn);
+    GANL_URING_DEBUG(fd, "Closing connection...");
+    std::lock_guard<std::mutex> lock(mutex_);
+    forgetSocket(fd, true);
+}
+
+// Bytes the multishot recv already took off the socket but no Read event
+// has delivered are lost here: unlike the readiness engines, they cannot be
+// left in the kernel for the next process to read.
+void IoUringNetworkEngine::detachConnection(ConnectionHandle conn) {
+    int fd = static_cast<int>(conn);
+    GANL_URING_DEBUG(fd, "Detaching connection (no close)...");
+    std::lock_guard<std::mutex> lock(mutex_);
+    forgetSocket(fd, false);
+}
+
+// --- I/O Operations ---
+
+bool IoUringNetworkEngine::postRead(ConnectionHandle conn, IoBuffer& buffer, ErrorCode& error) {
+    int fd = static_cast<int>(conn);
+    error = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sockets_.find(fd);
+    if (it == sockets_.end() || it->second.type != SocketType::Connection) {
+        error = EBADF;
+        return false;
+    }
+    SocketInfo& si = it->second;
+    si.activeReadBuffer = &buffer;
+    if (!si.completionReads) {
+        // Switch from poll readiness to multishot recv.  A readiness Read
+        // not yet reported is dropped: the recv will deliver those bytes.
+        GANL_URING_DEBUG(fd, "Switching to completion-mode reads.");
+        si.completionReads = true;
+        si.readable = false;
+        if (si.pollInOp != 0) {
+            submitCancel(si.pollInOp);
+        }
+    }
+    requestArm(fd, si);
+    if (hasEvents(si)) {
+        markReady(fd, si);
+    }
+    return true;
+}
+
+bool IoUringNetworkEngine::postWrite(ConnectionHandle conn, const char* data, size_t length, void* userContext, ErrorCode& error) {
+    int fd = static_cast<int>(conn);
+    error = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sockets_.find(fd);
+    if (it == sockets_.end() || it->second.type != SocketType::Connection) {
+        error = EBADF;
+        return false;
+    }
+    SocketInfo& si = it->second;
+
+    if (data == nullptr || length == 0) {
+        // Write interest only: the caller writes the socket itself.
+        si.wantWrite = true;
+        si.writeUserContext = userContext;
+        requestArm(fd, si);
+        return true;
+    }
+
+    if (si.sendError != 0) {
+        error = si.sendError;
+        return false;
+    }
+    if (si.sendData) {
+        // A send is still in flight; these bytes follow it.
+        si.sendQueued.append(data, length);
+    } else {
+        si.sendData = std::make_shared<std::string>(data, length);
+        si.sendDone = 0;
+    }
+    si.sendContext = userContext;
+    requestArm(fd, si);
+    return true;
+}
+
+bool IoUringNetworkEngine::postWrite(ConnectionHandle conn, const char* data, size_t length, ErrorCode& error) {
+    return postWrite(conn, data, length, nullptr, error);
+}
+
+// --- Event Processing ---
+
+int IoUringNetworkEngine::processEvents(int timeoutMs, IoEvent* events, int maxEvents) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!ring_) {
+        return -1;
+    }
+
+    // Everything requested since the last call goes to the kernel in the
+    // same io_uring_enter() that waits for completions.
+    armPending();
+    const unsigned toSubmit = ring_->publish();
+    const bool wait = ready_.empty() && timeoutMs != 0;
+    const int ringFd = ring_->fd;
+    lock.unlock();
+
+    __kernel_timespec ts{};
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    unsigned flags = IORING_ENTER_GETEVENTS;
+    const void* argp = nullptr;
+    size_t argSize = 0;
+    if (wait && timeoutMs > 0) {
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argSize = sizeof(arg);
+    }
+
+    if (sysIoUringEnter(ringFd, toSubmit, wait ? 1 : 0, flags, argp, argSize) < 0) {
+        // ETIME is the timeout; EINTR a signal; EBUSY/EAGAIN mean completions
+        // must be reaped before the kernel takes more submissions, which the
+        // reap below does (the unconsumed entries stay published).
+        if (errno != ETIME && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+            std::cerr << "[IoUring:CTL] CRITICAL: io_uring_enter() failed: "
+                      << strerror(errno) << std::endl;
+            return -1;
+        }
+    }
+
+    lock.lock();
+    if (!ring_) {
+        return 0;
+    }
+    reapCompletions();
+
+    // Sockets with something to report are served in turn.  One that still
+    // has events when the budget runs out keeps its place, and the next call
+    // returns at once instead of waiting.
+    int eventCount = 0;
+    size_t rounds = ready_.size();
+    while (rounds-- > 0 && eventCount < maxEvents) {
+        int fd = ready_.front();
+        ready_.pop_front();
+        auto it = sockets_.find(fd);
+        if (it == sockets_.end()) {
+            continue;
+        }
+        SocketInfo& si = it->second;
+        si.queued = false;
+        bool erased = false;
+        eventCount += emitEvents(fd, si, events + eventCount, maxEvents - eventCount, erased);
+        if (!erased && hasEvents(si)) {
+            markReady(fd, si);
+        }
+    }
+    return eventCount;
+}
+
+// --- Utility Methods ---
+
+std::string IoUringNetworkEngine::getRemoteAddress(ConnectionHandle conn) {
+    return getRemoteNetworkAddress(conn).toString();
+}
+
+NetworkAddress IoUringNetworkEngine::getRemoteNetworkAddress(ConnectionHandle conn) {
+    int fd = static_cast<int>(conn);
+    sockaddr_storage addrStorage;
+    socklen_t addrLen = sizeof(addrStorage);
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&addrStorage), &addrLen) == -1) {
+        GANL_URING_DEBUG(fd, "getpeername failed: " << strerror(errno));
+        return NetworkAddress();
+    }
+    return NetworkAddress(reinterpret_cast<sockaddr*>(&addrStorage), addrLen);
+}
+
+std::string IoUringNetworkEngine::getErrorString(ErrorCode error) {
+    return strerror(error);
+}
+
+// #1823: CLOEXEC is the steady-state default so panic exec inherits nothing;
+// planned @restart clears CLOEXEC only on the selected survivor set.
+//
+bool IoUringNetworkEngine::setNonBlocking(int fd, ErrorCode& error) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        error = errno;
+        return false;
+    }
+    int fdFlags = fcntl(fd, F_GETFD);
+    if (fdFlags == -1 || fcntl(fd, F_SETFD, fdFlags | FD_CLOEXEC) == -1) {
+        error = errno;
+        return false;
+    }
+    return true;
+}
+
+// --- Internals (mutex_ held) ---
+
+IoUringNetworkEngine::SocketInfo& IoUringNetworkEngine::registerSocket(int fd, SocketType type, void* context) {
+    SocketInfo& si = sockets_[fd];
+    si = SocketInfo{};
+    si.type = type;
+    si.context = context;
+    si.generation = nextGeneration_++;
+    return si;
+}
+
+void IoUringNetworkEngine::requestArm(int fd, SocketInfo& si) {
+    if (!si.armQueued) {
+        si.armQueued = true;
+        armPending_.push_back(fd);
+    }
+}
+
+void IoUringNetworkEngine::markReady(int fd, SocketInfo& si) {
+    if (!si.queued) {
+        si.queued = true;
+        ready_.push_back(fd);
+    }
+}
+
+bool IoUringNetworkEngine::hasEvents(const SocketInfo& si) const {
+    switch (si.type) {
+    case SocketType::Listener:
+        return !si.accepted.empty() || si.acceptError != 0;
+    case SocketType::OutboundConnecting:
+        return si.connectDone;
+    case SocketType::Connection:
+        break;
+    }
+    if (si.completionReads) {
+        if (si.activeReadBuffer && receivedBytes(si) > 0) {
+            return true;
+        }
+        if (  !si.terminalReported
+           && receivedBytes(si) == 0
+           && (si.eof || si.readError != 0)) {
+            return true;
+        }
+    } else if (si.readable || (si.hangup && !si.terminalReported)) {
+        return true;
+    }
+    return si.sendReport > 0
+        || si.writable
+        || (si.sendError != 0 && !si.terminalReported);
+}
+
+void IoUringNetworkEngine::armPending() {
+    std::vector<int> pending;
+    pending.swap(armPending_);
+    for (int fd : pending) {
+        auto it = sockets_.find(fd);
+        if (it == sockets_.end()) {
+            continue;
+        }
+        it->second.armQueued = false;
+        armSocket(fd, it->second);
+    }
+}
+
+// Put in whatever requests the socket's state calls for and does not have.
+//
+void IoUringNetworkEngine::armSocket(int fd, SocketInfo& si) {
+    switch (si.type) {
+    case SocketType::Listener:
+        if (si.listening && si.acceptOp == 0) {
+            si.acceptOp = submitOp(fd, si, OpKind::Accept, IORING_OP_ACCEPT);
+        }
+        return;
+
+    case SocketType::OutboundConnecting:
+        if (!si.connectDone && si.pollOutOp == 0) {
+            si.pollOutOp = submitOp(fd, si, OpKind::PollOut, IORING_OP_POLL_ADD);
+        }
+        return;
+
+    case SocketType::Connection:
+        break;
+    }
+
+    if (si.completionReads) {
+        if (  si.recvOp == 0
+           && !si.recvPaused
+           && !si.eof
+           && si.readError == 0) {
+            si.recvOp = submitOp(fd, si, OpKind::Recv, IORING_OP_RECV);
+        }
+    } else if (si.pollInOp == 0 && !si.readable && !si.hangup) {
+        si.pollInOp = submitOp(fd, si, OpKind::PollIn, IORING_OP_POLL_ADD);
+    }
+    if (si.wantWrite && !si.writable && si.pollOutOp == 0) {
+        si.pollOutOp = submitOp(fd, si, OpKind::PollOut, IORING_OP_POLL_ADD);
+    }
+    if (si.sendData && si.sendOpsInFlight == 0 && si.sendError == 0) {
+        submitSendChain(fd, si);
+    }
+}
+
+uint64_t IoUringNetworkEngine::submitOp(int fd, const SocketInfo& si, OpKind kind, uint8_t opcode) {
+    io_uring_sqe* sqe = ring_->getSqe();
+    if (!sqe) {
+        flushSubmissions();
+        sqe = ring_->getSqe();
+        if (!sqe) {
+            // Still full; try again on the next pass.
+            requestArm(fd, sockets_[fd]);
+            return 0;
+        }
+    }
+
+    const uint64_t id = nextOpId_++;
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->user_data = id;
+    switch (kind) {
+    case OpKind::Accept:
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        break;
+    case OpKind::PollIn:
+        sqe->poll32_events = pollMask(POLLIN);
+        break;
+    case OpKind::PollOut:
+        sqe->poll32_events = pollMask(POLLOUT);
+        break;
+    case OpKind::Recv:
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        break;
+    case OpKind::Send:
+        break;
+    }
+    ops_.emplace(id, Op{kind, fd, si.generation, 0, nullptr});
+    return id;
+}
+
+// Send what is left of sendData as one chain of linked sends.  Links run in
+// order, and a failed link cancels the rest of its chain, so the bytes reach
+// the socket in order however the kernel schedules the requests.
+//
+void IoUringNetworkEngine::submitSendChain(int fd, SocketInfo& si) {
+    const std::string& data = *si.sendData;
+    size_t offset = si.sendDone;
+    size_t links = std::min(kSendChainLinks,
+                            (data.size() - offset + kSendLinkBytes - 1) / kSendLinkBytes);
+
+    // The whole chain must go to the kernel in one submission: a link left
+    // dangling at the end of a batch does not wait for the next one.
+    if (ring_->sqSpace() < links) {
+        flushSubmissions();
+        links = std::min<size_t>(links, ring_->sqSpace());
+        if (links == 0) {
+            requestArm(fd, si);
+            return;
+        }
+    }
+
+    io_uring_sqe* last = nullptr;
+    for (size_t i = 0; i < links; i++) {
+        io_uring_sqe* sqe = ring_->getSqe();
+        const size_t length = std::min(kSendLinkBytes, data.size() - offset);
+        const uint64_t id = nextOpId_++;
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(data.data() + offset);
+        sqe->len = static_cast<uint32_t>(length);
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = id;
+        ops_.emplace(id, Op{OpKind::Send, fd, si.generation, length, si.sendData});
+        offset += length;
+        last = sqe;
+    }
+    last->flags &= static_cast<uint8_t>(~IOSQE_IO_LINK);
+    si.sendOpsInFlight = static_cast<int>(links);
+    si.sendBroken = false;
+    GANL_URING_DEBUG(fd, "Submitted " << links << " linked sends through byte " << offset << ".");
+}
+
+void IoUringNetworkEngine::submitCancel(uint64_t opId) {
+    io_uring_sqe* sqe = ring_->getSqe();
+    if (!sqe) {
+        flushSubmissions();
+        sqe = ring_->getSqe();
+        if (!sqe) {
+            return;
+        }
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = opId;
+    sqe->user_data = kIgnoredOp;
+    if (ring_->features & IORING_FEAT_CQE_SKIP) {
+        sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    }
+}
+
+// Hand everything prepared so far to the kernel without waiting.  Returns
+// false if the kernel would not take it yet (a full completion queue);
+// the caller reaps and the entries go with the next submission.
+//
+bool IoUringNetworkEngine::flushSubmissions() {
+    const unsigned pending = ring_->publish();
+    if (pending == 0) {
+        return true;
+    }
+    for (;;) {
+        if (sysIoUringEnter(ring_->fd, pending, 0, 0, nullptr, 0) >= 0) {
+            return true;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EBUSY || errno == EAGAIN) {
+            reapCompletions();
+        } else {
+            std::cerr << "[IoUring:CTL] io_uring_enter() submit failed: "
+                      << strerror(errno) << std::endl;
+        }
+        return false;
+    }
+}
+
+// Cancel every request on fd and wait for the cancellations, so nothing
+// still in the kernel refers to the descriptor once it is closed or handed
+// on.  Their completions arrive later and are ignored: the socket is gone.
+//
+void IoUringNetworkEngine::cancelAll(int fd) {
+    flushSubmissions();
+    io_uring_sync_cancel_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.fd = fd;
+    reg.flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    reg.timeout.tv_sec = -1;
+    reg.timeout.tv_nsec = -1;
+    if (  sysIoUringRegister(ring_->fd, IORING_REGISTER_SYNC_CANCEL, &reg, 1) < 0
+       && errno != ENOENT) {
+        GANL_URING_DEBUG(fd, "Synchronous cancel failed: " << strerror(errno));
+    }
+}
+
+void IoUringNetworkEngine::reapCompletions() {
+    for (;;) {
+        unsigned head = *ring_->cqHead;
+        const unsigned tail = __atomic_load_n(ring_->cqTail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            break;
+        }
+        while (head != tail) {
+            const io_uring_cqe& cqe = ring_->cqes[head & ring_->cqMask];
+            const uint64_t userData = cqe.user_data;
+            const int32_t res = cqe.res;
+            const uint32_t flags = cqe.flags;
+            head++;
+            __atomic_store_n(ring_->cqHead, head, __ATOMIC_RELEASE);
+            handleCompletion(userData, res, flags);
+        }
+    }
+    ring_->publishBuffers();
+
+    // Completions the kernel had to hold back for lack of room are moved in
+    // by the next GETEVENTS enter; do that now rather than a loop later.
+    if (__atomic_load_n(ring_->sqFlags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) {
+        if (sysIoUringEnter(ring_->fd, 0, 0, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0) {
+            reapCompletions();
+        }
+    }
+}
+
+void IoUringNetworkEngine::handleCompletion(uint64_t userData, int32_t res, uint32_t flags) {
+    if (userData == kIgnoredOp) {
+        return;
+    }
+
+    // Provided buffers go back on the ring whoever the completion is for.
+    const bool hasBuffer = (flags & IORING_CQE_F_BUFFER) != 0;
+    const uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+
+    auto opIt = ops_.find(userData);
+    if (opIt == ops_.end()) {
+        if (hasBuffer) {
+            ring_->recycleBuffer(bid);
+        }
+        return;
+    }
+    const bool more = (flags & IORING_CQE_F_MORE) != 0;
+    Op op = opIt->second;
+    if (!more) {
+        ops_.erase(opIt);
+    }
+
+    // A completion for a socket since closed, or for an earlier socket that
+    // had the same descriptor, only releases its resources.
+    auto sockIt = sockets_.find(op.fd);
+    SocketInfo* si = (sockIt != sockets_.end() && sockIt->second.generation == op.generation)
+                   ? &sockIt->second : nullptr;
+    const int fd = op.fd;
+
+    switch (op.kind) {
+    case OpKind::Accept:
+        if (!si) {
+            if (res >= 0) {
+                ::close(res);
+            }
+            break;
+        }
+        if (!more && si->acceptOp == userData) {
+            si->acceptOp = 0;
+            if (res != -ECANCELED) {
+                requestArm(fd, *si);
+            }
+        }
+        if (res >= 0) {
+            si->accepted.push_back(res);
+            markReady(fd, *si);
+        } else if (res != -ECANCELED && res != -EAGAIN && res != -EINTR) {
+            // Surfaced as a listener Error event (NET/LERR), as epoll does.
+            std::cerr << "[IoUring:CTL] accept() on listener fd " << fd
+                      << " failed: " << strerror(-res) << std::endl;
+            si->acceptError = -res;
+            markReady(fd, *si);
+        }
+        break;
+
+    case OpKind::PollIn:
+        if (!si || si->pollInOp != userData) {
+            break;
+        }
+        si->pollInOp = 0;
+        if (si->completionReads || res == -ECANCELED) {
+            break;
+        }
+        if (res < 0 || (res & (POLLERR | POLLHUP))) {
+            si->hangup = true;
+        } else if (res & POLLIN) {
+            si->readable = true;
+        } else {
+            requestArm(fd, *si);
+            break;
+        }
+        markReady(fd, *si);
+        break;
+
+    case OpKind::PollOut:
+        if (!si || si->pollOutOp != userData) {
+            break;
+        }
+        si->pollOutOp = 0;
+        if (res == -ECANCELED) {
+            break;
+        }
+        if (si->type == SocketType::OutboundConnecting) {
+            int sockerr = 0;
+            socklen_t errlen = sizeof(sockerr);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &sockerr, &errlen);
+            if (sockerr == 0 && res < 0) {
+                sockerr = -res;
+            }
+            si->connectDone = true;
+            si->connectError = sockerr;
+            markReady(fd, *si);
+        } else if (si->wantWrite) {
+            si->writable = true;
+            markReady(fd, *si);
+        }
+        break;
+
+    case OpKind::Recv:
+        if (hasBuffer) {
+            if (si && res > 0) {
+                if (si->receivedHead > 0 && si->receivedHead == si->received.size()) {
+                    si->received.clear();
+                    si->receivedHead = 0;
+                }
+                si->received.append(ring_->buffer(bid), static_cast<size_t>(res));
+            }
+            ring_->recycleBuffer(bid);
+        }
+        if (!si) {
+            break;
+        }
+        if (!more && si->recvOp == userData) {
+            si->recvOp = 0;
+        }
+        if (res > 0) {
+            if (receivedBytes(*si) >= kMaxReceived && si->recvOp != 0 && !si->recvPaused) {
+                GANL_URING_DEBUG(fd, "Receive backlog full; pausing recv.");
+                si->recvPaused = true;
+                submitCancel(si->recvOp);
+            } else if (si->recvOp == 0 && !si->recvPaused) {
+                requestArm(fd, *si);
+            }
+            markReady(fd, *si);
+        } else if (res == 0) {
+            si->eof = true;
+            markReady(fd, *si);
+        } else if (res == -ENOBUFS || res == -ECANCELED) {
+            // Out of provided buffers, or cancelled for a pause or the
+            // switch from poll readiness: the next pass re-arms it if the
+            // socket still wants it.
+            if (!si->recvPaused) {
+                requestArm(fd, *si);
+            }
+        } else {
+            si->readError = -res;
+            markReady(fd, *si);
+        }
+        break;
+
+    case OpKind::Send:
+        if (!si) {
+            break;
+        }
+        si->sendOpsInFlight--;
+        if (res < 0) {
+            // -ECANCELED is a later link of a chain whose earlier link failed
+            // or fell short; the remainder is resubmitted below.
+            if (res != -ECANCELED && si->sendError == 0) {
+                si->sendError = -res;
+            }
+            si->sendBroken = true;
+        } else {
+            if (!si->sendBroken) {
+                si->sendDone += static_cast<size_t>(res);
+            }
+            if (static_cast<size_t>(res) < op.length) {
+                si->sendBroken = true;
+            }
+        }
+        if (si->sendOpsInFlight > 0) {
+            break;
+        }
+        if (si->sendError != 0) {
+            si->sendData.reset();
+            si->sendQueued.clear();
+            markReady(fd, *si);
+        } else if (si->sendDone < si->sendData->size()) {
+            requestArm(fd, *si);
+        } else {
+            si->sendReport += si->sendData->size();
+            si->sendData.reset();
+            si->sendDone = 0;
+            if (!si->sendQueued.empty()) {
+                si->sendData = std::make_shared<std::string>(std::move(si->sendQueued));
+                si->sendQueued.clear();
+                requestArm(fd, *si);
+            }
+            markReady(fd, *si);
+        }
+        break;
+    }
+}
+
+// Fill events for one socket, up to maxEvents.  Returns the number filled;
+// sets erased if the socket is gone afterwards (a failed connect).
+//
+int IoUringNetworkEngine::emitEvents(int fd, SocketInfo& si, IoEvent* events, int maxEvents, bool& erased) {
+    int n = 0;
+    // Zero every field -- slots are reused across polls (contract §2).
+    auto next = [&]() -> IoEvent& {
+        IoEvent& ev = events[n++];
+        ev = IoEvent{};
+        return ev;
+    };
+    const ConnectionHandle handle = static_cast<ConnectionHandle>(fd);
+
+    if (si.type == SocketType::Listener) {
+        while (n < maxEvents && !si.accepted.empty()) {
+            const int clientFd = si.accepted.front();
+            si.accepted.pop_front();
+
+            // #2194: Disable Nagle on accepted client sockets, matching IOCP
+            // and the readiness engines.  Non-fatal.
+            int opt = 1;
+            if (setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt)) == -1) {
+                GANL_URING_DEBUG(clientFd, "setsockopt(TCP_NODELAY) failed: " << strerror(errno));
+            }
+            SocketInfo& client = registerSocket(clientFd, SocketType::Connection, nullptr);
+            requestArm(clientFd, client);
+
+            IoEvent& ev = next();
+            ev.type = IoEventType::Accept;
+            ev.listener = static_cast<ListenerHandle>(fd);
+            ev.connection = static_cast<ConnectionHandle>(clientFd);
+            ev.context = si.context;
+            ev.remoteAddress = getRemoteNetworkAddress(ev.connection);
+        }
+        if (n < maxEvents && si.acceptError != 0) {
+            IoEvent& ev = next();
+            ev.type = IoEventType::Error;
+            ev.listener = static_cast<ListenerHandle>(fd);
+            ev.context = si.context;
+            ev.error = si.acceptError;
+            si.acceptError = 0;
+        }
+        return n;
+    }
+
+    if (si.type == SocketType::OutboundConnecting) {
+        if (n < maxEvents && si.connectDone) {
+            IoEvent& ev = next();
+            ev.connection = handle;
+            ev.context = si.context;
+            if (si.connectError == 0) {
+                GANL_URING_DEBUG(fd, "Outbound connect succeeded.");
+                ev.type = IoEventType::ConnectSuccess;
+                si.type = SocketType::Connection;
+                si.connectDone = false;
+                requestArm(fd, si);
+            } else {
+                GANL_URING_DEBUG(fd, "Outbound connect failed: " << strerror(si.connectError));
+                ev.type = IoEventType::ConnectFail;
+                ev.error = si.connectError;
+                forgetSocket(fd, true);
+                erased = true;
+            }
+        }
+        return n;
+    }
+
+    if (si.completionReads) {
+        const size_t available = receivedBytes(si);
+        if (n < maxEvents && si.activeReadBuffer && available > 0) {
+            IoBuffer* buffer = si.activeReadBuffer;
+            const size_t length = std::min(available, buffer->writableBytes());
+            if (length > 0) {
+                // Copied, not committed: CompletionConnection::handleRead
+                // commits bytesTransferred itself, as with IOCP.
+                memcpy(buffer->writePtr(), si.received.data() + si.receivedHead, length);
+                si.receivedHead += length;
+                if (si.receivedHead == si.received.size()) {
+                    si.received.clear();
+                    si.receivedHead = 0;
+                }
+                si.activeReadBuffer = nullptr;
+
+                IoEvent& ev = next();
+                ev.type = IoEventType::Read;
+                ev.connection = handle;
+                ev.context = si.context;
+                ev.buffer = buffer;
+                ev.bytesTransferred = length;
+
+                if (si.recvPaused && receivedBytes(si) < kMaxReceived / 2) {
+                    GANL_URING_DEBUG(fd, "Receive backlog drained; resuming recv.");
+                    si.recvPaused = false;
+                    requestArm(fd, si);
+                }
+            }
+        }
+    } else if (si.hangup) {
+        if (n < maxEvents && !si.terminalReported) {
+            IoEvent& ev = next();
+            ev.type = IoEventType::Close;
+            ev.connection = handle;
+            ev.context = si.context;
+            ev.buffer = si.activeReadBuffer;
+            si.activeReadBuffer = nullptr;
+            si.terminalReported = true;
+        }
+    } else if (n < maxEvents && si.readable) {
+        // Readiness Read: the caller reads the socket.  The poll is re-armed
+        // for the next pass, so unread bytes are reported again.
+        IoEvent& ev = next();
+        ev.type = IoEventType::Read;
+        ev.connection = handle;
+        ev.context = si.context;
+        ev.buffer = si.activeReadBuffer;
+        si.activeReadBuffer = nullptr;
+        si.readable = false;
+        requestArm(fd, si);
+    }
+
+    if (n < maxEvents && si.sendReport > 0) {
+        IoEvent& ev = next();
+        ev.type = IoEventType::Write;
+        ev.connection = handle;
+        ev.context = si.sendContext ? si.sendContext : si.context;
+        ev.bytesTransferred = si.sendReport;
+        si.sendReport = 0;
+    }
+
+    if (n < maxEvents && si.writable) {
+        IoEvent& ev = next();
+        ev.type = IoEventType::Write;
+        ev.connection = handle;
+        ev.context = si.writeUserContext ? si.writeUserContext : si.context;
+        si.writable = false;
+        si.wantWrite = false;
+        si.writeUserContext = nullptr;
+    }
+
+    if (n < maxEvents && !si.terminalReported) {
+        ErrorCode error = 0;
+        bool terminal = false;
+        if (si.completionReads && receivedBytes(si) == 0 && (si.eof || si.readError != 0)) {
+            terminal = true;
+            error = si.readError;
+        } else if (si.sendError != 0) {
+            terminal = true;
+            error = si.sendError;
+        }
+        if (terminal) {
+            // EOF, or a reset, is a Close; anything else an Error (as IOCP).
+            IoEvent& ev = next();
+            const bool reset = (error == ECONNRESET || error == ECONNABORTED || error == EPIPE);
+            ev.type = (error == 0 || reset) ? IoEventType::Close : IoEventType::Error;
+            ev.connection = handle;
+            ev.context = si.context;
+            ev.error = error;
+            ev.buffer = si.activeReadBuffer;
+            si.activeReadBuffer = nullptr;
+            si.terminalReported = true;
+        }
+    }
+    return n;
+}
+
+// Drop the engine's record of fd, cancel its requests, and close it if
+// asked.  A no-op for an fd the engine does not know (#947).
+//
+void IoUringNetworkEngine::forgetSocket(int fd, bool closeFd) {
+    auto it = sockets_.find(fd);
+    if (it == sockets_.end()) {
+        GANL_URING_DEBUG(fd, "Socket not found in map, likely already closed.");
+        return;
+    }
+    const bool isConnection = (it->second.type != SocketType::Listener);
+    for (int clientFd : it->second.accepted) {
+        ::close(clientFd);
+    }
+    sockets_.erase(it);
+
+    if (ring_) {
+        cancelAll(fd);
+    }
+    if (closeFd) {
+        if (isConnection && ::shutdown(fd, SHUT_RDWR) == -1
+            && errno != ENOTCONN && errno != EBADF) {
+            GANL_URING_DEBUG(fd, "Warning: shutdown(fd, SHUT_RDWR) failed: " << strerror(errno));
+        }
+        if (::close(fd) == -1) {
+            GANL_URING_DEBUG(fd, "Warning: close(fd) failed: " << strerror(errno));
+        }
+    }
+}
+
+} // namespace ganl
+
+#endif // GANL_HAVE_IO_URING
@@ -8,6 +8,13 @@
     #define HAVE_EPOLL 0
 #endif
 
+#include "io_uring_network_engine.h"
+#if defined(GANL_HAVE_IO_URING)
+    #define HAVE_IO_URING 1
+#else
+    #define HAVE_IO_URING 0
+#endif
+
 #if defined(__FreeBSD__) || defined(__APPLE__) || defined(__NetBSD__) || defined(__OpenBSD__)
     #include "kqueue_network_engine.h"
     #define HAVE_KQUEUE 1
@@ -87,6 +94,13 @@ std::unique_ptr<NetworkEngine> NetworkEngineFactory::createEngine(NetworkEngineT
                 return nullptr;
             #endif
 
+        case NetworkEngineType::IoUring:
+            #if HAVE_IO_URING
+                return std::make_unique<IoUringNetworkEngine>();
+            #else
+                return nullptr;
+            #endif
+
         default:
             return nullptr;
     }
@@ -125,6 +139,14 @@ bool NetworkEngineFactory::isEngineTypeAvailable(NetworkEngineType type) {
                 return false;
             #endif
 
+        case NetworkEngineType::IoUring:
+            // The headers are not enough; the running kernel must have it.
+            #if HAVE_IO_URING
+                return IoUringNetworkEngine::isSupported();
+            #else
+                return false;
+            #endif
+
         case NetworkEngineType::Auto:
             return true; // Always "available" as it selects a real one
 
@@ -148,6 +170,12 @@ std::string NetworkEngineFactory::getAvailableEngineTypes() {
         oss << ", epoll";
     #endif
 
+    #if HAVE_IO_URING
+        if (IoUringNetworkEngine::isSupported()) {
+            oss << ", io_uring";
+        }
+    #endif
+
     #if HAVE_KQUEUE
         oss << ", kqueue";
     #endif
@@ -181,6 +209,7 @@ bool NetworkEngineFactory::supportsConnectionAdoption(NetworkEngineType type) {
     case NetworkEngineType::Epoll:
     case NetworkEngineType::Kqueue:
     case NetworkEngineType::Select:
+    case NetworkEngineType::IoUring:
         return true;
     default:
         return false;
@@ -0,0 +1,347 @@
+#include <tls_worker_pool.h>
+#include <connection.h>
+#include <secure_transport.h>
+
+#include <system_error>
+#include <utility>
+
+namespace ganl {
+
+// One connection's queue into the pool.  Everything but handle is guarded
+// by mutex.
+//
+struct TlsChannel : public std::enable_shared_from_this<TlsChannel> {
+    explicit TlsChannel(ConnectionHandle h) : handle(h) {}
+
+    const ConnectionHandle handle;
+    std::weak_ptr<ConnectionBase> owner;
+
+    std::mutex mutex;
+    std::condition_variable idle;   // Signalled when running goes false
+    IoBuffer input{0};              // Ciphertext from the socket
+    IoBuffer output{0};             // Plaintext for the peer
+    bool shutdownRequested{false};
+    TlsCompletion results;          // Not yet seen by the game thread
+
+    bool queued{false};             // In runQueue_
+    bool running{false};            // A worker has it
+    bool posted{false};             // In completed_
+    bool dead{false};               // Detached; drop everything
+    bool failed{false};             // The session reported Error or Closed
+    bool established{false};
+    bool shutdownIssued{false};
+
+    bool hasWork() const {
+        return input.readableBytes() > 0
+            || (established && output.readableBytes() > 0)
+            || (shutdownRequested && !shutdownIssued);
+    }
+};
+
+TlsWorkerPool::TlsWorkerPool(SecureTransport& transport, std::function<void()> wake)
+    : transport_(transport), wake_(std::move(wake))
+{
+}
+
+TlsWorkerPool::~TlsWorkerPool()
+{
+    stop();
+}
+
+bool TlsWorkerPool::start(int threads)
+{
+    for (int i = 0; i < threads; i++) {
+        try {
+            threads_.emplace_back(&TlsWorkerPool::workerMain, this);
+        } catch (const std::system_error&) {
+            break;
+        }
+    }
+    return !threads_.empty();
+}
+
+// Channels still queued are abandoned; their connections are expected to be
+// gone or about to be.
+//
+void TlsWorkerPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workCv_.notify_all();
+    for (auto& t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    runQueue_.clear();
+    completed_.clear();
+    idleCv_.notify_all();
+}
+
+std::shared_ptr<TlsChannel> TlsWorkerPool::attach(ConnectionHandle handle,
+                                                  const std::shared_ptr<ConnectionBase>& owner)
+{
+    auto channel = std::make_shared<TlsChannel>(handle);
+    channel->owner = owner;
+    return channel;
+}
+
+void TlsWorkerPool::schedule(const std::shared_ptr<TlsChannel>& channel)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        runQueue_.push_back(channel);
+    }
+    workCv_.notify_one();
+}
+
+void TlsWorkerPool::submitInput(TlsChannel& channel, IoBuffer& encrypted)
+{
+    bool claim = false;
+    {
+        std::lock_guard<std::mutex> lock(channel.mutex);
+        if (!channel.dead && !channel.failed) {
+            channel.input.append(encrypted.readPtr(), encrypted.readableBytes());
+            claim = !channel.queued && !channel.running;
+            channel.queued = channel.queued || claim;
+        }
+    }
+    encrypted.consumeRead(encrypted.readableBytes());
+    if (claim) {
+        schedule(channel.shared_from_this());
+    }
+}
+
+void TlsWorkerPool::submitOutput(TlsChannel& channel, IoBuffer& plaintext)
+{
+    bool claim = false;
+    {
+        std::lock_guard<std::mutex> lock(channel.mutex);
+        if (!channel.dead && !channel.failed) {
+            channel.output.append(plaintext.readPtr(), plaintext.readableBytes());
+            claim = !channel.queued && !channel.running && channel.hasWork();
+            channel.queued = channel.queued || claim;
+        }
+    }
+    plaintext.consumeRead(plaintext.readableBytes());
+    if (claim) {
+        schedule(channel.shared_from_this());
+    }
+}
+
+void TlsWorkerPool::submitShutdown(TlsChannel& channel)
+{
+    bool claim = false;
+    {
+        std::lock_guard<std::mutex> lock(channel.mutex);
+        if (!channel.dead && !channel.failed) {
+            channel.shutdownRequested = true;
+            claim = !channel.queued && !channel.running;
+            channel.queued = channel.queued || claim;
+        }
+    }
+    if (claim) {
+        schedule(channel.shared_from_this());
+    }
+}
+
+size_t TlsWorkerPool::pendingInputBytes(TlsChannel& channel)
+{
+    std::lock_guard<std::mutex> lock(channel.mutex);
+    return channel.input.readableBytes();
+}
+
+void TlsWorkerPool::detach(TlsChannel& channel)
+{
+    std::unique_lock<std::mutex> lock(channel.mutex);
+    channel.dead = true;
+    channel.idle.wait(lock, [&channel] { return !channel.running; });
+    channel.input.clear();
+    channel.output.clear();
+    channel.results = TlsCompletion();
+}
+
+void TlsWorkerPool::runCompletions()
+{
+    std::vector<std::shared_ptr<TlsChannel>> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done.swap(completed_);
+    }
+
+    for (const auto& channel : done) {
+        TlsCompletion results;
+        std::shared_ptr<ConnectionBase> owner;
+        {
+            std::lock_guard<std::mutex> lock(channel->mutex);
+            channel->posted = false;
+            if (channel->dead) {
+                continue;
+            }
+            results = std::move(channel->results);
+            channel->results = TlsCompletion();
+            owner = channel->owner.lock();
+        }
+        if (owner) {
+            owner->handleTlsCompletion(results);
+        }
+    }
+}
+
+void TlsWorkerPool::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCv_.wait(lock, [this] {
+        return threads_.empty() || (0 == busy_ && runQueue_.empty());
+    });
+}
+
+void TlsWorkerPool::workerMain()
+{
+    for (;;) {
+        std::shared_ptr<TlsChannel> channel;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workCv_.wait(lock, [this] { return stopping_ || !runQueue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            channel = std::move(runQueue_.front());
+            runQueue_.pop_front();
+            busy_++;
+        }
+
+        runChannel(channel);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_--;
+        if (0 == busy_ && runQueue_.empty()) {
+            idleCv_.notify_all();
+        }
+    }
+}
+
+// Take everything submitted so far, run it through the session outside the
+// channel lock, and post what came out.  The order within a pass -- input,
+// then output, then close_notify -- is the order the inline path uses for a
+// read that is followed by a send and a close.
+//
+void TlsWorkerPool::runChannel(const std::shared_ptr<TlsChannel>& channel)
+{
+    IoBuffer input(0);
+    IoBuffer output(0);
+    bool established;
+    bool shutdown;
+    {
+        std::lock_guard<std::mutex> lock(channel->mutex);
+        channel->queued = false;
+        if (channel->dead || channel->failed) {
+            return;
+        }
+        channel->running = true;
+        std::swap(input, channel->input);
+        std::swap(output, channel->output);
+        established = channel->established;
+        shutdown = channel->shutdownRequested && !channel->shutdownIssued;
+    }
+
+    const ConnectionHandle h = channel->handle;
+    TlsCompletion r;
+    if (input.readableBytes() > 0) {
+        TlsResult result = transport_.processIncoming(h, input, r.decrypted, r.encrypted, true);
+        if (TlsResult::Error == result || TlsResult::Closed == result) {
+            r.failure = result;
+            r.error = transport_.getLastTlsErrorString(h);
+        } else if (!established && transport_.isEstablished(h)) {
+            established = true;
+            r.established = true;
+        }
+    }
+
+    if (  TlsResult::Success == r.failure
+       && established
+       && output.readableBytes() > 0) {
+        const size_t before = output.readableBytes();
+        TlsResult result = transport_.processOutgoing(h, output, r.encrypted, true);
+        r.plaintextConsumed = before - output.readableBytes();
+        if (TlsResult::Error == result || TlsResult::Closed == result) {
+            r.failure = TlsResult::Error;
+            r.error = transport_.getLastTlsErrorString(h);
+        }
+    }
+
+    if (TlsResult::Success == r.failure && shutdown) {
+        if (established) {
+            transport_.shutdownSession(h, r.encrypted);
+        }
+        r.shutdownDone = true;
+    }
+
+    bool post = false;
+    bool requeue = false;
+    {
+        std::lock_guard<std::mutex> lock(channel->mutex);
+        channel->running = false;
+        channel->established = established;
+        channel->shutdownIssued = channel->shutdownIssued || shutdown;
+        channel->failed = (TlsResult::Success != r.failure);
+
+        // Plaintext the session did not take goes back in front of
+        // anything submitted meanwhile.
+        //
+        if (output.readableBytes() > 0) {
+            output.append(channel->output.readPtr(), channel->output.readableBytes());
+            std::swap(output, channel->output);
+        }
+
+        if (!channel->dead) {
+            TlsCompletion& pending = channel->results;
+            pending.decrypted.append(r.decrypted.readPtr(), r.decrypted.readableBytes());
+            pending.encrypted.append(r.encrypted.readPtr(), r.encrypted.readableBytes());
+            pending.plaintextConsumed += r.plaintextConsumed;
+            pending.established = pending.established || r.established;
+            pending.shutdownDone = pending.shutdownDone || r.shutdownDone;
+            if (  TlsResult::Success == pending.failure
+               && TlsResult::Success != r.failure) {
+                pending.failure = r.failure;
+                pending.error = r.error;
+            }
+
+            const bool report = r.decrypted.readableBytes() > 0
+                || r.encrypted.readableBytes() > 0
+                || r.plaintextConsumed > 0
+                || r.established
+                || r.shutdownDone
+                || TlsResult::Success != r.failure;
+            if (report && !channel->posted) {
+                channel->posted = true;
+                post = true;
+            }
+            if (!channel->failed && !channel->queued && channel->hasWork()) {
+                channel->queued = true;
+                requeue = true;
+            }
+        }
+        channel->idle.notify_all();
+    }
+
+    if (post) {
+        bool first;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            first = completed_.empty();
+            completed_.push_back(channel);
+        }
+        if (first && wake_) {
+            wake_();
+        }
+    }
+    if (requeue) {
+        schedule(channel);
+    }
+}
+
+} // namespace ganl
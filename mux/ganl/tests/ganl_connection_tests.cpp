@@ -7,6 +7,10 @@
 //
 //   #1855  write/error during close-with-drain must abort teardown
 //   #1856  encrypted ingress high-water closes a non-consuming TLS peer
+//          shared output segments reach the socket in order via writev
+//          a read stops at the per-event budget and re-arms the socket
+//          offloaded TLS keeps each direction in order and counts plaintext
+//          still with a worker as pending output
 //
 // Build/run: POSIX `make -C mux/ganl/tests check` (runs after engine tests);
 // Windows: `run-msvc.bat` builds ganl_connection_tests.vcxproj too.
@@ -32,13 +36,16 @@
 #include <secure_transport.h>
 #include <session_manager.h>
 #include <io_buffer.h>
+#include <tls_worker_pool.h>
 
 #if !defined(_WIN32)
 #include <select_network_engine.h>
 #endif
 
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -104,6 +111,8 @@ public:
         return postWriteOk_;
     }
 
+    void rearmRead(ConnectionHandle) override { rearmReadCalls_++; }
+
     int processEvents(int, IoEvent*, int) override { return 0; }
 
     std::string getRemoteAddress(ConnectionHandle) override {
@@ -121,6 +130,7 @@ public:
     int closeCalls_{0};
     int postReadCalls_{0};
     int postWriteCalls_{0};
+    int rearmReadCalls_{0};
     bool postReadOk_{true};
     bool postWriteOk_{true};
 };
@@ -173,9 +183,11 @@ public:
     std::string getLastProtocolErrorString(ConnectionHandle) override {
         return {};
     }
+    bool passesOutputThrough() const override { return passThrough_; }
 
     size_t bytesToApp_{0};
     int destroyCalls_{0};
+    bool passThrough_{false};
 };
 
 class FakeSession : public SessionManager {
@@ -259,6 +271,55 @@ public:
     int destroyCalls_{0};
 };
 
+// Stand-in TLS for the worker pool: "HELLO" completes the handshake and
+// draws "WELCOME", records are bracketed as "[...]", and close_notify is
+// "BYE".  Sessions are only touched by the worker running the channel.
+//
+class BracketTls : public SecureTransport {
+public:
+    bool initialize(const TlsConfig&) override { return true; }
+    void shutdown() override {}
+    bool createSessionContext(ConnectionHandle h, bool) override {
+        established_[h] = false;
+        return true;
+    }
+    void destroySessionContext(ConnectionHandle) override { destroyCalls_++; }
+    TlsResult processIncoming(ConnectionHandle h, IoBuffer& in,
+                              IoBuffer& decrypted, IoBuffer& out,
+                              bool) override {
+        std::string data = in.consumeReadAllAsString();
+        if (!established_[h]) {
+            if (data.compare(0, 5, "HELLO") != 0) {
+                return TlsResult::WantRead;
+            }
+            established_[h] = true;
+            out.append("WELCOME", 7);
+            data.erase(0, 5);
+        }
+        decrypted.append(data.data(), data.size());
+        return TlsResult::Success;
+    }
+    TlsResult processOutgoing(ConnectionHandle, IoBuffer& plain,
+                              IoBuffer& out, bool) override {
+        const std::string record = "[" + plain.consumeReadAllAsString() + "]";
+        out.append(record.data(), record.size());
+        return TlsResult::WantWrite;
+    }
+    TlsResult shutdownSession(ConnectionHandle, IoBuffer& out) override {
+        out.append("BYE", 3);
+        return TlsResult::WantWrite;
+    }
+    bool isEstablished(ConnectionHandle h) override { return established_[h]; }
+    bool needsNetworkRead(ConnectionHandle) override { return true; }
+    bool needsNetworkWrite(ConnectionHandle) override { return false; }
+    std::string getLastTlsErrorString(ConnectionHandle) override {
+        return "bracket-tls";
+    }
+
+    std::map<ConnectionHandle, bool> established_;
+    std::atomic<int> destroyCalls_{0};
+};
+
 // ---------------------------------------------------------------------------
 // #1855 — forceCloseAfterIoFailure while Closing + drain pending
 // ---------------------------------------------------------------------------
@@ -432,6 +493,331 @@ Result scenarioIngressHighWaterTls() {
 }
 #endif
 
+// ---------------------------------------------------------------------------
+// Output chain — shared segments are queued by reference and drained with
+// writev behind bytes already in encryptedOutput_.
+// ---------------------------------------------------------------------------
+
+#if !defined(_WIN32)
+Result scenarioOutputChainOrder() {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        return fail("socketpair failed");
+    }
+    int fl = fcntl(sv[1], F_GETFL, 0);
+    fcntl(sv[1], F_SETFL, fl | O_NONBLOCK);
+
+    FakeEngine eng;
+    FakeProtocol proto;
+    proto.passThrough_ = true;
+    FakeSession sess;
+
+    const ConnectionHandle h = static_cast<ConnectionHandle>(sv[0]);
+    auto conn = std::make_shared<ReadinessConnection>(
+        h, eng, nullptr, proto, sess);
+    if (!conn->initialize(/*useTls=*/false)) {
+        ::close(sv[0]);
+        ::close(sv[1]);
+        return fail("plaintext initialize failed");
+    }
+
+    // A copied write first, then two shared segments, then another copied
+    // write that must land behind the segments.
+    //
+    conn->sendDataToClient("head|");
+    const OutputSegment seg1 = std::make_shared<const std::string>("one|");
+    const OutputSegment seg2 = std::make_shared<const std::string>("two|");
+    conn->sendDataToClient(seg1);
+    conn->sendDataToClient(seg2);
+    conn->sendDataToClient("tail");
+
+    std::string detail;
+    if (seg1.use_count() != 2 || seg2.use_count() != 2) {
+        detail = "segments were copied instead of queued by reference";
+    } else if (conn->pendingOutputBytes() != 17) {
+        detail = "expected 17 pending bytes, got "
+            + std::to_string(conn->pendingOutputBytes());
+    }
+
+    IoEvent wrEv{};
+    wrEv.type = IoEventType::Write;
+    wrEv.connection = h;
+    wrEv.context = conn.get();
+    conn->handleNetworkEvent(wrEv);
+
+    char buf[64];
+    ssize_t n = ::read(sv[1], buf, sizeof(buf));
+    const std::string got = (n > 0) ? std::string(buf, static_cast<size_t>(n))
+                                    : std::string();
+    if (detail.empty()) {
+        if (got != "head|one|two|tail") {
+            detail = "wire bytes out of order: '" + got + "'";
+        } else if (conn->pendingOutputBytes() != 0) {
+            detail = "output left pending after drain";
+        } else if (seg1.use_count() != 1 || seg2.use_count() != 1) {
+            detail = "written segments were not released";
+        }
+    }
+
+    conn->close(DisconnectReason::UserQuit);
+    ::close(sv[0]);
+    ::close(sv[1]);
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass("4 writes, 1 writev");
+}
+#else
+Result scenarioOutputChainOrder() {
+    return skip("output chain is used by POSIX readiness engines only");
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Read budget — a peer with more than one event's worth of input is read in
+// slices, and the engine is asked to report it again after each full slice.
+// ---------------------------------------------------------------------------
+
+#if !defined(_WIN32)
+Result scenarioReadBudgetRearm() {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        return fail("socketpair failed");
+    }
+    int fl = fcntl(sv[0], F_GETFL, 0);
+    fcntl(sv[0], F_SETFL, fl | O_NONBLOCK);
+    fl = fcntl(sv[1], F_GETFL, 0);
+    fcntl(sv[1], F_SETFL, fl | O_NONBLOCK);
+
+    FakeEngine eng;
+    FakeProtocol proto;
+    FakeSession sess;
+
+    const ConnectionHandle h = static_cast<ConnectionHandle>(sv[0]);
+    auto conn = std::make_shared<ReadinessConnection>(
+        h, eng, nullptr, proto, sess);
+    if (!conn->initialize(/*useTls=*/false)) {
+        ::close(sv[0]);
+        ::close(sv[1]);
+        return fail("plaintext initialize failed");
+    }
+
+    const size_t target = 96 * 1024;
+    std::vector<char> chunk(16 * 1024, 'R');
+    size_t written = 0;
+    while (written < target) {
+        ssize_t n = ::write(sv[1], chunk.data(), chunk.size());
+        if (n <= 0) {
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    IoEvent rdEv{};
+    rdEv.type = IoEventType::Read;
+    rdEv.connection = h;
+    rdEv.context = conn.get();
+
+    std::string detail;
+    conn->handleNetworkEvent(rdEv);
+    const size_t first = sess.received_.size();
+    if (written <= 64 * 1024) {
+        detail = "socketpair accepted only " + std::to_string(written)
+            + " bytes; cannot exceed the read budget";
+    } else if (first != 64 * 1024) {
+        detail = "first event read " + std::to_string(first)
+            + " bytes, expected the 65536-byte budget";
+    } else if (eng.rearmReadCalls_ != 1) {
+        detail = "budget stop did not re-arm ("
+            + std::to_string(eng.rearmReadCalls_) + " calls)";
+    }
+
+    if (detail.empty()) {
+        conn->handleNetworkEvent(rdEv);
+        if (sess.received_.size() != written) {
+            detail = "second event read to "
+                + std::to_string(sess.received_.size()) + " of "
+                + std::to_string(written) + " bytes";
+        } else if (eng.rearmReadCalls_ != 1) {
+            detail = "read that reached EAGAIN re-armed anyway";
+        }
+    }
+
+    conn->close(DisconnectReason::UserQuit);
+    ::close(sv[0]);
+    ::close(sv[1]);
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass(std::to_string(written) + " bytes in 2 events, 1 re-arm");
+}
+#else
+Result scenarioReadBudgetRearm() {
+    return skip("read budget applies to POSIX readiness engines only");
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// TLS worker pool — the handshake, decryption and encryption happen on a
+// worker; the connection sees the results in submission order, and output
+// a worker holds still counts toward pendingOutputBytes().
+// ---------------------------------------------------------------------------
+
+#if !defined(_WIN32)
+Result scenarioTlsWorkerOrder() {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        return fail("socketpair failed");
+    }
+    int fl = fcntl(sv[0], F_GETFL, 0);
+    fcntl(sv[0], F_SETFL, fl | O_NONBLOCK);
+    fl = fcntl(sv[1], F_GETFL, 0);
+    fcntl(sv[1], F_SETFL, fl | O_NONBLOCK);
+
+    FakeEngine eng;
+    FakeProtocol proto;
+    FakeSession sess;
+    BracketTls tls;
+    std::atomic<int> wakes{0};
+    TlsWorkerPool pool(tls, [&wakes] { wakes++; });
+    if (!pool.start(2)) {
+        ::close(sv[0]);
+        ::close(sv[1]);
+        return fail("could not start TLS workers");
+    }
+
+    const ConnectionHandle h = static_cast<ConnectionHandle>(sv[0]);
+    auto conn = std::make_shared<ReadinessConnection>(
+        h, eng, &tls, proto, sess);
+    conn->setTlsWorkerPool(&pool);
+
+    IoEvent rdEv{};
+    rdEv.type = IoEventType::Read;
+    rdEv.connection = h;
+    rdEv.context = conn.get();
+    IoEvent wrEv = rdEv;
+    wrEv.type = IoEventType::Write;
+
+    auto settle = [&pool]() {
+        pool.waitIdle();
+        pool.runCompletions();
+    };
+
+    std::string detail;
+    std::string expected = "WELCOME";
+    size_t queued = 0;
+    if (!conn->initialize(/*useTls=*/true)) {
+        detail = "TLS connection initialize failed";
+    } else {
+        if (::write(sv[1], "HELLOearly", 10) != 10) {
+            detail = "could not write the client hello";
+        }
+        conn->handleNetworkEvent(rdEv);
+        settle();
+        if (detail.empty() && conn->getState() != ConnectionState::Running) {
+            detail = "handshake on the worker did not reach Running (state "
+                + std::to_string(static_cast<int>(conn->getState())) + ")";
+        }
+    }
+
+    if (detail.empty()) {
+        for (int i = 0; i < 100; i++) {
+            char line[16];
+            snprintf(line, sizeof(line), "m%03d", i);
+            conn->sendDataToClient(line);
+            expected += std::string("[") + line + "]";
+            queued += 4;
+            if (i == 50) {
+                if (::write(sv[1], "ping", 4) != 4) {
+                    detail = "could not write client data";
+                }
+                conn->handleNetworkEvent(rdEv);
+            }
+        }
+        if (detail.empty() && conn->pendingOutputBytes() < queued) {
+            detail = "pendingOutputBytes " + std::to_string(conn->pendingOutputBytes())
+                + " misses plaintext still with the workers (" + std::to_string(queued) + ")";
+        }
+        settle();
+    }
+
+    std::string got;
+    auto drain = [&]() {
+        conn->handleNetworkEvent(wrEv);
+        char buf[4096];
+        ssize_t n;
+        while ((n = ::read(sv[1], buf, sizeof(buf))) > 0) {
+            got.append(buf, static_cast<size_t>(n));
+        }
+    };
+    if (detail.empty()) {
+        drain();
+        if (got.compare(0, 7, "WELCOME") != 0) {
+            detail = "wire does not start with the handshake reply";
+        } else if (got.size() < 7 + queued) {
+            detail = "only " + std::to_string(got.size()) + " bytes reached the wire";
+        } else if (sess.received_ != "earlyping") {
+            detail = "session received '" + sess.received_ + "'";
+        } else if (conn->pendingOutputBytes() != 0) {
+            detail = "output left pending after drain: "
+                + std::to_string(conn->pendingOutputBytes());
+        } else if (wakes.load() == 0) {
+            detail = "workers never woke the game thread";
+        }
+    }
+
+    // The records may be batched differently from the sends; only the
+    // plaintext order matters.
+    if (detail.empty()) {
+        std::string plain;
+        std::string want;
+        for (char c : got.substr(7)) {
+            if (c != '[' && c != ']') {
+                plain += c;
+            }
+        }
+        for (char c : expected.substr(7)) {
+            if (c != '[' && c != ']') {
+                want += c;
+            }
+        }
+        if (plain != want) {
+            detail = "records out of order";
+        }
+    }
+
+    if (detail.empty()) {
+        conn->close(DisconnectReason::UserQuit);
+        if (sess.closeCalls_ != 0) {
+            detail = "closed before close_notify came back from the worker";
+        } else {
+            settle();
+            got.clear();
+            drain();
+            if (got != "BYE") {
+                detail = "expected close_notify on the wire, got '" + got + "'";
+            } else if (sess.closeCalls_ != 1 || tls.destroyCalls_.load() != 1) {
+                detail = "close did not finish after close_notify drained";
+            }
+        }
+    }
+
+    conn.reset();
+    pool.stop();
+    ::close(sv[0]);
+    ::close(sv[1]);
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass("100 sends + 2 reads on 2 workers, "
+        + std::to_string(wakes.load()) + " wakes");
+}
+#else
+Result scenarioTlsWorkerOrder() {
+    return skip("socketpair harness is POSIX only");
+}
+#endif
+
 // ---------------------------------------------------------------------------
 // Runner
 // ---------------------------------------------------------------------------
@@ -444,6 +830,9 @@ struct Scenario {
 const Scenario kScenarios[] = {
     {"close-drain-write-failure", scenarioCloseDrainWriteFailure},
     {"ingress-high-water-tls",    scenarioIngressHighWaterTls},
+    {"output-chain-order",        scenarioOutputChainOrder},
+    {"read-budget-rearm",         scenarioReadBudgetRearm},
+    {"tls-worker-order",          scenarioTlsWorkerOrder},
 };
 
 } // namespace
@@ -15,6 +15,13 @@
 //   #2194 accepted client sockets must have TCP_NODELAY set (accept path, so
 //         adoptConnection cannot stand in for it)
 //
+// Linux io_uring also runs the above (connections start in readiness mode),
+// plus its completion paths, which skip on the readiness engines:
+//
+//   postRead: Read event carries the posted IoBuffer, bytes at writePtr()
+//   postWrite: a send longer than one linked chain arrives whole and in order
+//   multishot accept: a burst of connects yields one Accept each
+//
 // Windows (wselect + iocp) — accept-path scenarios for inbound connections
 // (socketpair/adopt is still ENOTSUP).  Outbound TCP uses initiateConnect:
 //
@@ -52,6 +59,7 @@
 #include <select_network_engine.h>
 #if defined(__linux__)
 #include <epoll_network_engine.h>
+#include <io_uring_network_engine.h>
 #endif
 #if defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
 #include <kqueue_network_engine.h>
@@ -1083,6 +1091,58 @@ Result scenarioHupWithData(const EngineUnderTest& eut) {
     return r;
 }
 
+// A consumer that stops reading before EAGAIN (the per-event read budget) and
+// calls rearmRead must get another Read event for the bytes it left behind.
+// Edge-triggered engines would otherwise never report the fd again.
+Result scenarioRearmReadRefires(const EngineUnderTest& eut) {
+    auto eng = eut.make();
+    if (!eng->initialize()) return fail("engine init failed");
+
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) return fail("socketpair failed");
+    ErrorCode err = 0;
+    ConnectionHandle ch = eng->adoptConnection(pair[0], nullptr, err);
+    if (ch == InvalidConnectionHandle) {
+        ::close(pair[0]); ::close(pair[1]);
+        return (err == ENOTSUP) ? skip("adoptConnection not supported")
+                                : fail("adoptConnection failed");
+    }
+
+    if (write(pair[1], "0123456789", 10) != 10) return fail("peer write failed");
+
+    // Returns true once a Read event for ch arrives within the window.
+    auto waitRead = [&](int windowMs) {
+        IoEvent events[8];
+        for (int waited = 0; waited < windowMs; waited += 50) {
+            int n = eng->processEvents(50, events, 8);
+            for (int i = 0; i < n; i++) {
+                if (events[i].connection == ch && events[i].type == IoEventType::Read) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    Result r = pass();
+    char buf[4];
+    if (!waitRead(2000)) {
+        r = fail("no Read event for the initial data");
+    } else if (read(pair[0], buf, sizeof(buf)) != 4) {
+        r = fail("partial read failed");
+    } else {
+        eng->rearmRead(ch);
+        if (!waitRead(1000)) {
+            r = fail("rearmRead after a partial read did not re-report the fd");
+        }
+    }
+
+    ::close(pair[1]);
+    eng->closeConnection(ch);
+    eng->shutdown();
+    return r;
+}
+
 // #947 harmonization: after a terminal Close/Error event the fd must still be
 // OPEN — close ownership belongs to the application (handleError/handleClose
 // -> closeConnection), never the engine.  select historically self-closed
@@ -1239,6 +1299,181 @@ Result scenarioAcceptTcpNodelay(const EngineUnderTest& eut) {
     return r;
 }
 
+// Completion-model reads: the Read event must carry the IoBuffer handed to
+// postRead() with the bytes copied to its writePtr() and not committed, and
+// the peer's close must follow as a Close once those bytes are delivered.
+//
+Result scenarioCompletionPostRead(const EngineUnderTest& eut) {
+    auto eng = eut.make();
+    if (eng->getIoModelType() != IoModel::Completion) return skip("readiness engine");
+    if (!eng->initialize()) return fail("engine init failed");
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) return fail("socketpair failed");
+    ErrorCode err = 0;
+    ConnectionHandle ch = eng->adoptConnection(sv[0], nullptr, err);
+    if (ch == InvalidConnectionHandle) {
+        ::close(sv[0]); ::close(sv[1]);
+        return fail("adoptConnection failed");
+    }
+
+    IoBuffer buf;
+    buf.ensureWritable(4096);
+    if (!eng->postRead(ch, buf, err)) {
+        ::close(sv[1]);
+        eng->shutdown();
+        return fail("postRead failed");
+    }
+    const char msg[] = "completion read";
+    if (::write(sv[1], msg, sizeof(msg) - 1) != static_cast<ssize_t>(sizeof(msg) - 1)) {
+        ::close(sv[1]);
+        eng->shutdown();
+        return fail("peer write failed");
+    }
+
+    IoEvent got{};
+    Result r = pass();
+    if (!pollFor(*eng, 3000, 8, [&](const IoEvent& e) {
+            return e.type == IoEventType::Read && e.connection == ch;
+        }, &got)) {
+        r = fail("Read event never emitted");
+    } else if (got.buffer != &buf) {
+        r = fail("Read event does not carry the posted IoBuffer");
+    } else if (got.bytesTransferred != sizeof(msg) - 1
+               || memcmp(buf.writePtr(), msg, sizeof(msg) - 1) != 0) {
+        r = fail("received bytes not at writePtr()");
+    } else if (buf.readableBytes() != 0) {
+        r = fail("engine committed the bytes itself");
+    } else {
+        buf.commitWrite(got.bytesTransferred);
+        eng->postRead(ch, buf, err);
+        ::close(sv[1]);
+        sv[1] = -1;
+        if (!pollFor(*eng, 3000, 8, [&](const IoEvent& e) {
+                return e.type == IoEventType::Close && e.connection == ch;
+            })) {
+            r = fail("peer close not reported as Close");
+        }
+    }
+    if (sv[1] >= 0) ::close(sv[1]);
+    eng->closeConnection(ch);
+    eng->shutdown();
+    return r;
+}
+
+// Completion-model writes: a postWrite() larger than one chain of linked
+// sends must reach the peer whole and in order, and be reported as one
+// Write event for the full length.
+//
+Result scenarioCompletionLargeWrite(const EngineUnderTest& eut) {
+    auto eng = eut.make();
+    if (eng->getIoModelType() != IoModel::Completion) return skip("readiness engine");
+    if (!eng->initialize()) return fail("engine init failed");
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) return fail("socketpair failed");
+    ErrorCode err = 0;
+    ConnectionHandle ch = eng->adoptConnection(sv[0], nullptr, err);
+    if (ch == InvalidConnectionHandle) {
+        ::close(sv[0]); ::close(sv[1]);
+        return fail("adoptConnection failed");
+    }
+
+    std::string payload(1200 * 1024, '\0');
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = static_cast<char>('a' + (i * 7 + i / 4096) % 26);
+    }
+    if (!eng->postWrite(ch, payload.data(), payload.size(), err)) {
+        ::close(sv[1]);
+        eng->shutdown();
+        return fail("postWrite failed");
+    }
+
+    // Drain the peer while polling; the socket buffer is far smaller than
+    // the payload, so the sends only finish if the peer keeps reading.
+    int peerFlags = fcntl(sv[1], F_GETFL, 0);
+    fcntl(sv[1], F_SETFL, peerFlags | O_NONBLOCK);
+    std::string received;
+    size_t reported = 0;
+    IoEvent events[8];
+    for (int i = 0; i < 300 && (received.size() < payload.size() || reported < payload.size()); i++) {
+        char chunk[65536];
+        ssize_t n;
+        while ((n = ::read(sv[1], chunk, sizeof(chunk))) > 0) {
+            received.append(chunk, static_cast<size_t>(n));
+        }
+        int count = eng->processEvents(10, events, 8);
+        for (int k = 0; k < count; k++) {
+            if (events[k].type == IoEventType::Write && events[k].connection == ch) {
+                reported += events[k].bytesTransferred;
+            }
+        }
+    }
+
+    Result r = pass();
+    if (received.size() != payload.size()) {
+        r = fail("peer received " + std::to_string(received.size()) + " of "
+                 + std::to_string(payload.size()) + " bytes");
+    } else if (received != payload) {
+        r = fail("bytes arrived out of order");
+    } else if (reported != payload.size()) {
+        r = fail("Write events reported " + std::to_string(reported) + " bytes");
+    }
+    ::close(sv[1]);
+    eng->closeConnection(ch);
+    eng->shutdown();
+    return r;
+}
+
+// Completion-model accept: several clients connecting before the engine
+// polls must each produce an Accept (a multishot accept keeps going).
+//
+Result scenarioCompletionAcceptBurst(const EngineUnderTest& eut) {
+    auto eng = eut.make();
+    if (eng->getIoModelType() != IoModel::Completion) return skip("readiness engine");
+    if (!eng->initialize()) return fail("engine init failed");
+
+    ErrorCode err = 0;
+    ListenerHandle lh = eng->createListener("127.0.0.1", 0, err);
+    if (lh == InvalidListenerHandle) return fail("createListener failed");
+    if (!eng->startListening(lh, nullptr, err)) return fail("startListening failed");
+
+    sockaddr_in dst{};
+    socklen_t alen = sizeof(dst);
+    getsockname(static_cast<int>(lh), reinterpret_cast<sockaddr*>(&dst), &alen);
+
+    IoEvent events[8];
+    eng->processEvents(0, events, 8);   // Submit the accept
+
+    const int kClients = 3;
+    int clients[kClients];
+    for (int i = 0; i < kClients; i++) {
+        clients[i] = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::connect(clients[i], reinterpret_cast<sockaddr*>(&dst), sizeof(dst));
+    }
+
+    int accepts = 0;
+    for (int i = 0; i < 30 && accepts < kClients; i++) {
+        int n = eng->processEvents(100, events, 8);
+        for (int k = 0; k < n; k++) {
+            if (events[k].type == IoEventType::Accept) {
+                accepts++;
+                eng->closeConnection(events[k].connection);
+            }
+        }
+    }
+
+    Result r = pass();
+    if (accepts != kClients) {
+        r = fail(std::to_string(accepts) + " Accept events for "
+                 + std::to_string(kClients) + " connects");
+    }
+    for (int fd : clients) ::close(fd);
+    eng->closeListener(lh);
+    eng->shutdown();
+    return r;
+}
+
 #endif // !defined(_WIN32)
 
 // #953: IoBuffer::ensureWritable must reject a size that wraps
@@ -1289,8 +1524,12 @@ const Scenario kScenarios[] = {
     {"emfile-listener-error",    scenarioEmfileListenerError,  true},
     {"fd-setsize-reject",        scenarioFdSetsizeReject,      true},
     {"hup-with-data",            scenarioHupWithData,          true},
+    {"rearm-read-refires",       scenarioRearmReadRefires,     true},
     {"conn-error-defer-close",   scenarioConnErrorDeferClose,  true},
     {"accept-tcp-nodelay",       scenarioAcceptTcpNodelay,     true},  // #2194
+    {"completion-post-read",     scenarioCompletionPostRead,   true},
+    {"completion-large-write",   scenarioCompletionLargeWrite, true},
+    {"completion-accept-burst",  scenarioCompletionAcceptBurst, true},
 #endif
     {"ensure-writable-cap",      scenarioEnsureWritableCap,    false},
 };
@@ -1319,6 +1558,13 @@ int main() {
     engines.push_back({"epoll", [] {
         return std::unique_ptr<NetworkEngine>(new EpollNetworkEngine());
     }});
+#if defined(GANL_HAVE_IO_URING)
+    if (IoUringNetworkEngine::isSupported()) {
+        engines.push_back({"io_uring", [] {
+            return std::unique_ptr<NetworkEngine>(new IoUringNetworkEngine());
+        }});
+    }
+#endif
 #endif
 #if defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
     engines.push_back({"kqueue", [] {
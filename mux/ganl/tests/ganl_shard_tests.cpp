@@ -0,0 +1,719 @@
+// GANL IoShardPool regression harness.
+//
+// The game side of each scenario is this thread: it adopts one end of a
+// socketpair as if it had just been accepted, queues sends and closes, and
+// collects what the shards post with runCompletions().  The other end is the
+// client.  Each scenario runs with select and with the platform's default
+// engine.
+//
+//   adopt: bytes from every client reach the game under its own handle
+//   cross-shard send: interleaved sends to connections on different shards
+//          arrive in order, and pendingOutputBytes() drains to 0
+//   close: queued output is written before the shard closes the socket; the
+//          game sees one Closed and the pool closes the original descriptor
+//   peer close: a client hanging up is posted as Closed
+//   releaseAll: connections come back open and are no longer read; one the
+//          game had closed has its descriptor closed
+//   stop/restart: stop() closes what is left, and the same pool starts
+//          again and takes back descriptors released for @restart
+//   partial start: a shard that cannot be set up stops the ones already
+//          running
+//
+// POSIX only; IoShardPool does not start on Windows.
+// Build/run: `make -C mux/ganl/tests check`.
+
+#include <io_shard_pool.h>
+#include <network_engine_factory.h>
+#include <protocol_handler.h>
+#include <session_manager.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ganl;
+
+namespace {
+
+enum class Outcome { Pass, Fail, Skip };
+struct Result {
+    Outcome outcome;
+    std::string detail;
+};
+Result pass(const std::string& d = "") { return {Outcome::Pass, d}; }
+Result fail(const std::string& d) { return {Outcome::Fail, d}; }
+Result skip(const std::string& d) { return {Outcome::Skip, d}; }
+
+// ---------------------------------------------------------------------------
+// Fakes
+// ---------------------------------------------------------------------------
+
+class RawProtocol : public ProtocolHandler {
+public:
+    bool createProtocolContext(ConnectionHandle) override { return true; }
+    void destroyProtocolContext(ConnectionHandle) override {}
+    void startNegotiation(ConnectionHandle, IoBuffer&) override {}
+    bool processInput(ConnectionHandle, IoBuffer& in, IoBuffer& app,
+                      IoBuffer&, bool consumeInput) override {
+        app.append(in.readPtr(), in.readableBytes());
+        if (consumeInput) {
+            in.consumeRead(in.readableBytes());
+        }
+        return true;
+    }
+    bool formatOutput(ConnectionHandle, IoBuffer& app, IoBuffer& out,
+                      bool consumeInput) override {
+        out.append(app.readPtr(), app.readableBytes());
+        if (consumeInput) {
+            app.consumeRead(app.readableBytes());
+        }
+        return true;
+    }
+    bool passesOutputThrough() const override { return true; }
+    NegotiationStatus getNegotiationStatus(ConnectionHandle) override {
+        return NegotiationStatus::Completed;
+    }
+    bool consumeStateChanges(ConnectionHandle, ProtocolState&,
+                             ProtocolStateChangeFlags&) override {
+        return false;
+    }
+    bool setEncoding(ConnectionHandle, EncodingType) override { return true; }
+    EncodingType getEncoding(ConnectionHandle) override { return EncodingType::Utf8; }
+    ProtocolState getProtocolState(ConnectionHandle) override { return ProtocolState{}; }
+    void updateWidth(ConnectionHandle, uint16_t) override {}
+    void updateHeight(ConnectionHandle, uint16_t) override {}
+    std::string getLastProtocolErrorString(ConnectionHandle) override { return {}; }
+};
+
+// What the game thread was told, by handle.
+//
+class GameSessions : public SessionManager {
+public:
+    bool initialize() override { return true; }
+    void shutdown() override {}
+    SessionId onConnectionOpen(ConnectionHandle h, const std::string&) override {
+        return static_cast<SessionId>(h);
+    }
+    void onDataReceived(SessionId id, const std::string& data) override {
+        received_[static_cast<ConnectionHandle>(id)] += data;
+        dataCalls_++;
+    }
+    void onConnectionClose(SessionId id, DisconnectReason reason) override {
+        closes_[static_cast<ConnectionHandle>(id)]++;
+        reasons_[static_cast<ConnectionHandle>(id)] = reason;
+    }
+    bool sendToSession(SessionId, const std::string&) override { return true; }
+    bool broadcastMessage(const std::string&, SessionId) override { return true; }
+    bool disconnectSession(SessionId, DisconnectReason) override { return true; }
+    bool authenticateSession(SessionId, ConnectionHandle, const std::string&,
+                             const std::string&) override {
+        return false;
+    }
+    void onAuthenticationSuccess(SessionId, int) override {}
+    int getPlayerId(SessionId) override { return -1; }
+    SessionState getSessionState(SessionId) override { return SessionState::Connected; }
+    SessionStats getSessionStats(SessionId) override { return SessionStats{}; }
+    ConnectionHandle getConnectionHandle(SessionId) override { return InvalidConnectionHandle; }
+    bool isAddressAllowed(const std::string&) override { return true; }
+    bool isAddressRegistered(const std::string&) override { return false; }
+    bool isAddressForbidden(const std::string&) override { return false; }
+    bool isAddressSuspect(const std::string&) override { return false; }
+    std::string getLastSessionErrorString(SessionId) override { return {}; }
+
+    std::map<ConnectionHandle, std::string> received_;
+    std::map<ConnectionHandle, int> closes_;
+    std::map<ConnectionHandle, DisconnectReason> reasons_;
+    int dataCalls_{0};
+};
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+// One accepted connection: game is the handle the pool adopts, client the
+// peer.  The client end is non-blocking.
+//
+struct Pair {
+    int game{-1};
+    int client{-1};
+};
+
+bool openPair(Pair& p) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        return false;
+    }
+    fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL, 0) | O_NONBLOCK);
+    fcntl(sv[1], F_SETFL, fcntl(sv[1], F_GETFL, 0) | O_NONBLOCK);
+    p.game = sv[0];
+    p.client = sv[1];
+    return true;
+}
+
+void closeClients(std::vector<Pair>& pairs) {
+    for (auto& p : pairs) {
+        if (0 <= p.client) {
+            ::close(p.client);
+            p.client = -1;
+        }
+    }
+}
+
+bool isOpen(int fd) {
+    return 0 <= fd && 0 <= fcntl(fd, F_GETFD);
+}
+
+// Run the game side until done() holds or two seconds pass.
+//
+bool pump(IoShardPool& pool, GameSessions& sessions, const std::function<bool()>& done) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    for (;;) {
+        pool.runCompletions(sessions);
+        if (done()) {
+            return true;
+        }
+        if (deadline < std::chrono::steady_clock::now()) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Read what the client has until want bytes, EOF, or two seconds.  Returns
+// false on EOF.
+//
+bool clientRead(int fd, std::string& got, size_t want) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (got.size() < want && std::chrono::steady_clock::now() < deadline) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, 10) <= 0) {
+            continue;
+        }
+        char buf[4096];
+        const ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (0 < n) {
+            got.append(buf, static_cast<size_t>(n));
+        } else if (0 == n) {
+            return false;
+        } else if (EAGAIN != errno && EINTR != errno) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// True once the client sees EOF (or a reset) within two seconds; anything
+// still to read is appended to got.
+//
+bool clientSeesEof(int fd, std::string& got) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, 10) <= 0) {
+            continue;
+        }
+        char buf[4096];
+        const ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (0 < n) {
+            got.append(buf, static_cast<size_t>(n));
+        } else if (0 == n || (EAGAIN != errno && EINTR != errno)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+OutputSegment segment(const std::string& s) {
+    return std::make_shared<const std::string>(s);
+}
+
+// A pool with its fakes, started with two shards.
+//
+struct Harness {
+    explicit Harness(NetworkEngineType type)
+        : pool(type, nullptr, protocol, [this] { wakes++; }) {}
+
+    RawProtocol protocol;
+    GameSessions sessions;
+    std::atomic<int> wakes{0};
+    IoShardPool pool;
+};
+
+// ---------------------------------------------------------------------------
+// Scenarios
+// ---------------------------------------------------------------------------
+
+Result scenarioAdopt(NetworkEngineType type) {
+    Harness h(type);
+    if (h.pool.start(2) != 2) {
+        return fail("could not start 2 shards");
+    }
+
+    std::vector<Pair> pairs(6);
+    for (auto& p : pairs) {
+        if (!openPair(p) || !h.pool.adopt(p.game, false)) {
+            closeClients(pairs);
+            return fail("could not adopt a connection");
+        }
+    }
+    if (h.pool.adopt(pairs[0].game, false)) {
+        closeClients(pairs);
+        return fail("adopted the same handle twice");
+    }
+
+    for (auto& p : pairs) {
+        const std::string line = "hello " + std::to_string(p.game) + "\n";
+        if (::write(p.client, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+            closeClients(pairs);
+            return fail("client write failed");
+        }
+    }
+    const bool ok = pump(h.pool, h.sessions, [&] {
+        for (auto& p : pairs) {
+            if (h.sessions.received_[p.game] != "hello " + std::to_string(p.game) + "\n") {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    std::string detail;
+    if (!ok) {
+        detail = "input did not reach the game under its own handle";
+    } else if (h.wakes.load() == 0) {
+        detail = "shards never woke the game thread";
+    } else {
+        for (auto& p : pairs) {
+            if (!h.pool.owns(p.game) || !h.pool.isRunning(p.game)) {
+                detail = "adopted connection not owned and running";
+                break;
+            }
+        }
+    }
+
+    h.pool.stop();
+    h.pool.runCompletions(h.sessions);
+    closeClients(pairs);
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass("6 connections on 2 shards");
+}
+
+Result scenarioCrossShardSend(NetworkEngineType type) {
+    Harness h(type);
+    if (h.pool.start(2) != 2) {
+        return fail("could not start 2 shards");
+    }
+
+    // Handles are assigned to shards by value, so consecutive descriptors
+    // land on both.
+    //
+    std::vector<Pair> pairs(4);
+    for (auto& p : pairs) {
+        if (!openPair(p) || !h.pool.adopt(p.game, false)) {
+            closeClients(pairs);
+            return fail("could not adopt a connection");
+        }
+    }
+    bool bothShards = false;
+    for (auto& p : pairs) {
+        bothShards = bothShards || (p.game % 2) != (pairs[0].game % 2);
+    }
+
+    std::map<int, std::string> expected;
+    for (int i = 0; i < 200; i++) {
+        for (auto& p : pairs) {
+            char line[32];
+            snprintf(line, sizeof(line), "%d:%03d|", p.game, i);
+            h.pool.send(p.game, segment(line));
+            expected[p.game] += line;
+        }
+    }
+    h.pool.waitIdle();
+
+    std::string detail;
+    if (!bothShards) {
+        detail = "connections all landed on one shard";
+    }
+    for (auto& p : pairs) {
+        std::string got;
+        clientRead(p.client, got, expected[p.game].size());
+        if (detail.empty() && got != expected[p.game]) {
+            detail = "handle " + std::to_string(p.game) + " got "
+                + std::to_string(got.size()) + " bytes, out of order or short";
+        }
+    }
+    if (detail.empty()) {
+        const bool drained = pump(h.pool, h.sessions, [&] {
+            for (auto& p : pairs) {
+                if (h.pool.pendingOutputBytes(p.game) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        if (!drained) {
+            detail = "pendingOutputBytes did not drain to 0";
+        }
+    }
+
+    h.pool.stop();
+    h.pool.runCompletions(h.sessions);
+    closeClients(pairs);
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass("800 sends to 4 connections on 2 shards");
+}
+
+Result scenarioClose(NetworkEngineType type) {
+    Harness h(type);
+    if (h.pool.start(2) != 2) {
+        return fail("could not start 2 shards");
+    }
+
+    std::vector<Pair> pairs(2);
+    for (auto& p : pairs) {
+        if (!openPair(p) || !h.pool.adopt(p.game, false)) {
+            closeClients(pairs);
+            return fail("could not adopt a connection");
+        }
+    }
+    const int closed = pairs[0].game;
+    const int hungUp = pairs[1].game;
+
+    std::string detail;
+    h.pool.send(closed, segment("goodbye"));
+    h.pool.close(closed, DisconnectReason::UserQuit);
+    h.pool.send(closed, segment("late"));
+
+    std::string got;
+    if (!clientSeesEof(pairs[0].client, got)) {
+        detail = "client never saw the close";
+    } else if (got != "goodbye") {
+        detail = "expected the queued output before the close, got '" + got + "'";
+    }
+
+    ::close(pairs[1].client);
+    pairs[1].client = -1;
+
+    if (detail.empty()) {
+        const bool ok = pump(h.pool, h.sessions, [&] {
+            return h.sessions.closes_[closed] == 1 && h.sessions.closes_[hungUp] == 1;
+        });
+        if (!ok) {
+            detail = "the game did not see both closes";
+        } else if (h.sessions.reasons_[closed] != DisconnectReason::UserQuit) {
+            detail = "close reason not carried through";
+        } else if (h.pool.owns(closed) || h.pool.owns(hungUp)) {
+            detail = "pool still owns a closed connection";
+        } else if (isOpen(closed) || isOpen(hungUp)) {
+            detail = "original descriptor left open after Closed";
+        }
+    }
+    if (detail.empty()) {
+        h.pool.runCompletions(h.sessions);
+        if (h.sessions.closes_[closed] != 1 || h.sessions.closes_[hungUp] != 1) {
+            detail = "Closed delivered more than once";
+        }
+    }
+
+    h.pool.stop();
+    h.pool.runCompletions(h.sessions);
+    closeClients(pairs);
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass("game close and peer close");
+}
+
+Result scenarioReleaseAll(NetworkEngineType type) {
+    Harness h(type);
+    if (h.pool.start(2) != 2) {
+        return fail("could not start 2 shards");
+    }
+
+    std::vector<Pair> pairs(3);
+    for (auto& p : pairs) {
+        if (!openPair(p) || !h.pool.adopt(p.game, false)) {
+            closeClients(pairs);
+            return fail("could not adopt a connection");
+        }
+    }
+    h.pool.waitIdle();
+    const int dropped = pairs[2].game;
+    h.pool.close(dropped, DisconnectReason::ServerShutdown);
+    h.pool.releaseAll();
+
+    std::string detail;
+    for (int i = 0; i < 2 && detail.empty(); i++) {
+        const Pair& p = pairs[i];
+        if (h.pool.owns(p.game)) {
+            detail = "pool still owns a released connection";
+        } else if (!isOpen(p.game)) {
+            detail = "released descriptor was closed";
+        } else if (::write(p.game, "kept", 4) != 4) {
+            detail = "released descriptor not writable";
+        } else {
+            std::string got;
+            clientRead(p.client, got, 4);
+            if (got != "kept") {
+                detail = "released connection lost its peer";
+            }
+        }
+    }
+    if (detail.empty() && isOpen(dropped)) {
+        detail = "descriptor of a closed connection survived releaseAll";
+    }
+
+    // Nothing reads the released sockets now.
+    //
+    if (detail.empty()) {
+        if (::write(pairs[0].client, "unread", 6) != 6) {
+            detail = "client write failed";
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            h.pool.runCompletions(h.sessions);
+            char buf[16];
+            if (h.sessions.dataCalls_ != 0) {
+                detail = "a shard delivered input after releaseAll";
+            } else if (::read(pairs[0].game, buf, sizeof(buf)) != 6) {
+                detail = "input on a released socket was consumed";
+            }
+        }
+    }
+
+    h.pool.stop();
+    h.pool.runCompletions(h.sessions);
+    if (!h.sessions.closes_.empty() && detail.empty()) {
+        detail = "stop() reported released connections as closed";
+    }
+    for (int i = 0; i < 2; i++) {
+        ::close(pairs[i].game);
+    }
+    closeClients(pairs);
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass("2 kept, 1 closed");
+}
+
+Result scenarioStopRestart(NetworkEngineType type) {
+    Harness h(type);
+    if (h.pool.start(2) != 2) {
+        return fail("could not start 2 shards");
+    }
+
+    std::vector<Pair> pairs(4);
+    for (auto& p : pairs) {
+        if (!openPair(p) || !h.pool.adopt(p.game, false)) {
+            closeClients(pairs);
+            return fail("could not adopt a connection");
+        }
+    }
+
+    // stop() closes what is still running; the closes wait on the
+    // completion list.
+    //
+    std::string detail;
+    h.pool.send(pairs[0].game, segment("bye"));
+    h.pool.stop();
+    if (h.pool.shardCount() != 0) {
+        detail = "shards left after stop";
+    }
+    h.pool.runCompletions(h.sessions);
+    if (detail.empty()) {
+        for (auto& p : pairs) {
+            std::string got;
+            if (h.sessions.closes_[p.game] != 1) {
+                detail = "stop() did not report every close";
+            } else if (!clientSeesEof(p.client, got)) {
+                detail = "client not closed by stop()";
+            } else if (p.game == pairs[0].game && got != "bye") {
+                detail = "output queued before stop() was lost";
+            }
+            if (!detail.empty()) {
+                break;
+            }
+        }
+    }
+    closeClients(pairs);
+
+    // The same pool starts again, and takes back descriptors that an
+    // earlier run released, as the successor of an @restart does.
+    //
+    if (detail.empty() && h.pool.start(2) != 2) {
+        detail = "could not restart the shards";
+    }
+    Pair carried;
+    if (detail.empty()) {
+        Pair fresh;
+        if (  !openPair(carried) || !openPair(fresh)
+           || !h.pool.adopt(carried.game, false)) {
+            detail = "could not adopt after restart";
+        } else {
+            h.pool.waitIdle();
+            h.pool.releaseAll();
+            h.pool.stop();
+            if (  h.pool.start(2) != 2
+               || !h.pool.adopt(carried.game, false)
+               || !h.pool.adopt(fresh.game, false)) {
+                detail = "could not take the released descriptor back";
+            } else if (  ::write(carried.client, "again\n", 6) != 6
+                      || ::write(fresh.client, "new\n", 4) != 4) {
+                detail = "client write failed";
+            } else if (!pump(h.pool, h.sessions, [&] {
+                           return h.sessions.received_[carried.game] == "again\n"
+                               && h.sessions.received_[fresh.game] == "new\n";
+                       })) {
+                detail = "input after restart did not reach the game";
+            }
+        }
+        h.pool.stop();
+        h.pool.runCompletions(h.sessions);
+        ::close(fresh.client);
+    }
+    ::close(carried.client);
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass("stop, start, release, start");
+}
+
+Result scenarioPartialStart(NetworkEngineType type) {
+    // Find the lowest free descriptor, and allow only two more: enough for
+    // the first shard and not the second.  select keeps no descriptor of
+    // its own; the others need one more per shard.
+    //
+    const int lowest = ::open("/dev/null", O_RDONLY);
+    if (lowest < 0) {
+        return fail("could not open /dev/null");
+    }
+    ::close(lowest);
+    for (int fd = lowest + 1; fd < lowest + 16; fd++) {
+        if (isOpen(fd)) {
+            return skip("descriptors above the lowest free one are in use");
+        }
+    }
+    const rlim_t perShard = (NetworkEngineType::Select == type) ? 2 : 3;
+
+    rlimit saved;
+    if (getrlimit(RLIMIT_NOFILE, &saved) != 0) {
+        return fail("getrlimit failed");
+    }
+    rlimit tight = saved;
+    tight.rlim_cur = static_cast<rlim_t>(lowest) + perShard;
+
+    RawProtocol protocol;
+    GameSessions sessions;
+    int started;
+    {
+        IoShardPool pool(type, nullptr, protocol, nullptr);
+        if (setrlimit(RLIMIT_NOFILE, &tight) != 0) {
+            return fail("setrlimit failed");
+        }
+        started = pool.start(2);
+        setrlimit(RLIMIT_NOFILE, &saved);
+        if (started == 0 && pool.shardCount() != 0) {
+            return fail("start() returned 0 with shards left running");
+        }
+    }
+
+    std::string detail;
+    if (started != 0) {
+        detail = "start() returned " + std::to_string(started) + " of 2 shards";
+    }
+    for (int fd = lowest; fd < lowest + 16 && detail.empty(); fd++) {
+        if (isOpen(fd)) {
+            detail = "descriptor " + std::to_string(fd) + " leaked by the failed start";
+        }
+    }
+    if (!detail.empty()) {
+        return fail(detail);
+    }
+    return pass("first shard stopped when the second failed");
+}
+
+// ---------------------------------------------------------------------------
+// Runner
+// ---------------------------------------------------------------------------
+
+struct Scenario {
+    const char* name;
+    Result (*run)(NetworkEngineType);
+};
+
+const Scenario kScenarios[] = {
+    {"adopt",            scenarioAdopt},
+    {"cross-shard-send", scenarioCrossShardSend},
+    {"close",            scenarioClose},
+    {"release-all",      scenarioReleaseAll},
+    {"stop-restart",     scenarioStopRestart},
+    {"partial-start",    scenarioPartialStart},
+};
+
+struct EngineUnderTest {
+    const char* name;
+    NetworkEngineType type;
+};
+
+} // namespace
+
+int main() {
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<EngineUnderTest> engines;
+#if defined(__linux__)
+    engines.push_back({"epoll", NetworkEngineType::Epoll});
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+    engines.push_back({"kqueue", NetworkEngineType::Kqueue});
+#endif
+    engines.push_back({"select", NetworkEngineType::Select});
+
+    int n = 0;
+    int failed = 0;
+    int skipped = 0;
+    int passed = 0;
+
+    printf("# GANL IoShardPool harness\n");
+    for (const auto& e : engines) {
+        for (const auto& s : kScenarios) {
+            ++n;
+            const std::string label = std::string(e.name) + " " + s.name;
+            Result r = s.run(e.type);
+            if (r.outcome == Outcome::Pass) {
+                ++passed;
+                printf("ok %d - %s", n, label.c_str());
+                if (!r.detail.empty()) {
+                    printf("  # %s", r.detail.c_str());
+                }
+                printf("\n");
+            } else if (r.outcome == Outcome::Skip) {
+                ++skipped;
+                printf("ok %d - %s  # SKIP %s\n", n, label.c_str(), r.detail.c_str());
+            } else {
+                ++failed;
+                printf("not ok %d - %s  # %s\n", n, label.c_str(), r.detail.c_str());
+            }
+            fflush(stdout);
+        }
+    }
+    printf("1..%d\n", n);
+    printf("# %d passed, %d failed, %d skipped\n", passed, failed, skipped);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,642 @@
+// GANL TLS handshake-burst benchmark.
+//
+// Opens a burst of TLS connections at once against a server loop built the
+// way the game's is -- a real engine, OpenSSLTransport and ConnectionBase
+// objects, one thread polling and dispatching -- and measures how long each
+// pass of that loop holds the thread.  Every client sends "ping" once its
+// handshake is done and waits for "pong"; the run ends when all have it.
+//
+// The burst is run with TLS inline (tls_workers 0), with a TlsWorkerPool,
+// and with the connections on an IoShardPool (io_threads), and the pass
+// times are reported side by side.  A pass is the dispatch of one
+// processEvents() batch plus runCompletions(); the time spent waiting in the
+// poll is not counted.  Each client also times its ping to its pong, which
+// is what the extra hop to and from a worker or shard costs a player.
+//
+// Build/run: `make -C mux/ganl/tests bench` (POSIX, needs OpenSSL).
+//   ganl_tls_bench [connections [workers [client-threads [shards]]]]
+// Defaults: 2000 connections, 2 workers, 4 client threads, 2 shards.  The
+// process needs about twice as many descriptors as connections.
+
+#include <connection.h>
+#include <io_shard_pool.h>
+#include <network_engine.h>
+#include <openssl_transport.h>
+#include <protocol_handler.h>
+#include <session_manager.h>
+#include <tls_worker_pool.h>
+#if defined(__linux__)
+#include <epoll_network_engine.h>
+#else
+#include <kqueue_network_engine.h>
+#endif
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ganl;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long long microsSince(Clock::time_point t0) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count();
+}
+
+// ---------------------------------------------------------------------------
+// Self-signed certificate, written to a temporary directory.
+// ---------------------------------------------------------------------------
+
+bool makeCertificate(const std::string& certFile, const std::string& keyFile) {
+    EVP_PKEY* pkey = nullptr;
+    EVP_PKEY_CTX* kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+    if (  !kctx
+       || EVP_PKEY_keygen_init(kctx) <= 0
+       || EVP_PKEY_CTX_set_rsa_keygen_bits(kctx, 2048) <= 0
+       || EVP_PKEY_keygen(kctx, &pkey) <= 0) {
+        EVP_PKEY_CTX_free(kctx);
+        return false;
+    }
+    EVP_PKEY_CTX_free(kctx);
+
+    X509* x509 = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509), 24 * 60 * 60);
+    X509_set_pubkey(x509, pkey);
+    X509_NAME* name = X509_get_subject_name(x509);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(x509, name);
+    bool ok = X509_sign(x509, pkey, EVP_sha256()) > 0;
+
+    FILE* f = ok ? fopen(certFile.c_str(), "w") : nullptr;
+    ok = f && PEM_write_X509(f, x509);
+    if (f) {
+        fclose(f);
+    }
+    f = ok ? fopen(keyFile.c_str(), "w") : nullptr;
+    ok = f && PEM_write_PrivateKey(f, pkey, nullptr, nullptr, 0, nullptr, nullptr);
+    if (f) {
+        fclose(f);
+    }
+
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Server side: passthrough protocol and a session manager that answers
+// "ping" with "pong" from the task phase, as the game answers a command.
+// ---------------------------------------------------------------------------
+
+class RawProtocol : public ProtocolHandler {
+public:
+    bool createProtocolContext(ConnectionHandle) override { return true; }
+    void destroyProtocolContext(ConnectionHandle) override {}
+    void startNegotiation(ConnectionHandle, IoBuffer&) override {}
+    bool processInput(ConnectionHandle, IoBuffer& in, IoBuffer& app,
+                      IoBuffer&, bool consumeInput) override {
+        app.append(in.readPtr(), in.readableBytes());
+        if (consumeInput) {
+            in.consumeRead(in.readableBytes());
+        }
+        return true;
+    }
+    bool formatOutput(ConnectionHandle, IoBuffer& app, IoBuffer& out,
+                      bool consumeInput) override {
+        out.append(app.readPtr(), app.readableBytes());
+        if (consumeInput) {
+            app.consumeRead(app.readableBytes());
+        }
+        return true;
+    }
+    bool passesOutputThrough() const override { return true; }
+    NegotiationStatus getNegotiationStatus(ConnectionHandle) override {
+        return NegotiationStatus::Completed;
+    }
+    bool consumeStateChanges(ConnectionHandle, ProtocolState&,
+                             ProtocolStateChangeFlags&) override {
+        return false;
+    }
+    bool setEncoding(ConnectionHandle, EncodingType) override { return true; }
+    EncodingType getEncoding(ConnectionHandle) override { return EncodingType::Utf8; }
+    ProtocolState getProtocolState(ConnectionHandle) override { return ProtocolState{}; }
+    void updateWidth(ConnectionHandle, uint16_t) override {}
+    void updateHeight(ConnectionHandle, uint16_t) override {}
+    std::string getLastProtocolErrorString(ConnectionHandle) override { return {}; }
+};
+
+class PongSession : public SessionManager {
+public:
+    bool initialize() override { return true; }
+    void shutdown() override {}
+    SessionId onConnectionOpen(ConnectionHandle h, const std::string&) override {
+        const SessionId id = nextId_++;
+        handles_[id] = h;
+        return id;
+    }
+    void onDataReceived(SessionId id, const std::string& data) override {
+        if (data.find("ping") != std::string::npos) {
+            replies_.push_back(handles_[id]);
+        }
+    }
+    void onConnectionClose(SessionId id, DisconnectReason) override {
+        handles_.erase(id);
+    }
+
+    // A connection on a shard is known by its handle; the pool does not
+    // open it here.
+    void track(ConnectionHandle h) {
+        handles_[static_cast<SessionId>(h)] = h;
+    }
+    bool sendToSession(SessionId, const std::string&) override { return true; }
+    bool broadcastMessage(const std::string&, SessionId) override { return true; }
+    bool disconnectSession(SessionId, DisconnectReason) override { return true; }
+    bool authenticateSession(SessionId, ConnectionHandle, const std::string&,
+                             const std::string&) override {
+        return false;
+    }
+    void onAuthenticationSuccess(SessionId, int) override {}
+    int getPlayerId(SessionId) override { return -1; }
+    SessionState getSessionState(SessionId) override { return SessionState::Connected; }
+    SessionStats getSessionStats(SessionId) override { return SessionStats{}; }
+    ConnectionHandle getConnectionHandle(SessionId) override { return InvalidConnectionHandle; }
+    bool isAddressAllowed(const std::string&) override { return true; }
+    bool isAddressRegistered(const std::string&) override { return false; }
+    bool isAddressForbidden(const std::string&) override { return false; }
+    bool isAddressSuspect(const std::string&) override { return false; }
+    std::string getLastSessionErrorString(SessionId) override { return {}; }
+
+    std::vector<ConnectionHandle> replies_;
+
+private:
+    SessionId nextId_{1};
+    std::map<SessionId, ConnectionHandle> handles_;
+};
+
+// ---------------------------------------------------------------------------
+// Client side: each thread drives its share of the connections with
+// non-blocking sockets and one poll().
+// ---------------------------------------------------------------------------
+
+struct Client {
+    int fd{-1};
+    SSL* ssl{nullptr};
+    enum { Connecting, Handshaking, Sending, Reading, Done, Failed } state{Connecting};
+    short events{POLLOUT};
+    std::string got;
+    Clock::time_point pinged;
+    long long rttUs{0};
+};
+
+void runClients(SSL_CTX* ctx, uint16_t port, int count,
+                std::atomic<int>& done, std::atomic<int>& failed,
+                const std::atomic<bool>& release, std::vector<long long>& rttUs) {
+    std::vector<Client> clients(count);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (auto& c : clients) {
+        c.fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (c.fd < 0) {
+            c.state = Client::Failed;
+            failed++;
+            continue;
+        }
+        fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+        if (connect(c.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 && EINPROGRESS != errno) {
+            c.state = Client::Failed;
+            failed++;
+        }
+    }
+
+    auto step = [](Client& c) {
+        for (;;) {
+            int rc;
+            switch (c.state) {
+            case Client::Connecting:
+                c.state = Client::Handshaking;
+                continue;
+            case Client::Handshaking:
+                rc = SSL_do_handshake(c.ssl);
+                if (1 == rc) {
+                    c.state = Client::Sending;
+                    continue;
+                }
+                break;
+            case Client::Sending:
+                rc = SSL_write(c.ssl, "ping\n", 5);
+                if (0 < rc) {
+                    c.pinged = Clock::now();
+                    c.state = Client::Reading;
+                    continue;
+                }
+                break;
+            case Client::Reading: {
+                char buf[256];
+                rc = SSL_read(c.ssl, buf, sizeof(buf));
+                if (0 < rc) {
+                    c.got.append(buf, rc);
+                    if (c.got.find("pong") != std::string::npos) {
+                        c.rttUs = microsSince(c.pinged);
+                        c.state = Client::Done;
+                        return true;
+                    }
+                    continue;
+                }
+                break;
+            }
+            default:
+                return true;
+            }
+            const int err = SSL_get_error(c.ssl, rc);
+            if (SSL_ERROR_WANT_READ == err) {
+                c.events = POLLIN;
+            } else if (SSL_ERROR_WANT_WRITE == err) {
+                c.events = POLLOUT;
+            } else {
+                c.state = Client::Failed;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    for (auto& c : clients) {
+        if (Client::Failed != c.state) {
+            c.ssl = SSL_new(ctx);
+            SSL_set_fd(c.ssl, c.fd);
+            SSL_set_connect_state(c.ssl);
+        }
+    }
+
+    const auto deadline = Clock::now() + std::chrono::seconds(120);
+    std::vector<pollfd> pfds;
+    std::vector<Client*> live;
+    for (;;) {
+        pfds.clear();
+        live.clear();
+        for (auto& c : clients) {
+            if (Client::Done != c.state && Client::Failed != c.state) {
+                pfds.push_back({c.fd, c.events, 0});
+                live.push_back(&c);
+            }
+        }
+        if (live.empty() || deadline < Clock::now()) {
+            break;
+        }
+        if (poll(pfds.data(), pfds.size(), 100) < 0 && EINTR != errno) {
+            break;
+        }
+        for (size_t i = 0; i < live.size(); i++) {
+            if (0 == pfds[i].revents) {
+                continue;
+            }
+            Client& c = *live[i];
+            if (step(c)) {
+                if (Client::Done == c.state) {
+                    done++;
+                } else {
+                    failed++;
+                }
+            }
+        }
+    }
+    for (auto& c : clients) {
+        if (Client::Done != c.state && Client::Failed != c.state) {
+            failed++;
+        }
+    }
+
+    // Hold every connection open until the whole burst is through, so no
+    // thread's early finish thins the load on the others.
+    while (!release) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (auto& c : clients) {
+        if (Client::Done == c.state) {
+            rttUs.push_back(c.rttUs);
+        }
+        if (c.ssl) {
+            SSL_free(c.ssl);
+        }
+        if (0 <= c.fd) {
+            close(c.fd);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// One run
+// ---------------------------------------------------------------------------
+
+struct RunResult {
+    int done{0};
+    int failed{0};
+    long long wallMs{0};
+    long long busyMs{0};
+    long long maxPassUs{0};
+    long long p99PassUs{0};
+    long long p50PassUs{0};
+    size_t passes{0};
+    long long p50RttUs{0};
+    long long p99RttUs{0};
+};
+
+bool drainWake(int fd) {
+    char buf[256];
+    while (0 < read(fd, buf, sizeof(buf))) {
+    }
+    return true;
+}
+
+RunResult runBurst(const std::string& certFile, const std::string& keyFile,
+                   int connections, int workers, int clientThreads, int shards) {
+    RunResult rr;
+
+#if defined(__linux__)
+    EpollNetworkEngine engine;
+#else
+    KqueueNetworkEngine engine;
+#endif
+    OpenSSLTransport tls;
+    RawProtocol proto;
+    PongSession sess;
+
+    TlsConfig config;
+    config.certificateFile = certFile;
+    config.keyFile = keyFile;
+    if (!engine.initialize() || !tls.initialize(config)) {
+        fprintf(stderr, "engine or TLS initialization failed\n");
+        rr.failed = connections;
+        return rr;
+    }
+
+    ErrorCode error = 0;
+    ListenerHandle listener = engine.createListener("127.0.0.1", 0, error);
+    int lctx = 0;
+    if (InvalidListenerHandle == listener || !engine.startListening(listener, &lctx, error)) {
+        fprintf(stderr, "listener failed: %s\n", engine.getErrorString(error).c_str());
+        rr.failed = connections;
+        return rr;
+    }
+    sockaddr_in bound{};
+    socklen_t len = sizeof(bound);
+    getsockname(static_cast<int>(listener), reinterpret_cast<sockaddr*>(&bound), &len);
+    const uint16_t port = ntohs(bound.sin_port);
+
+    // The game's wake channel, reproduced.
+    int wake[2] = {-1, -1};
+    std::unique_ptr<TlsWorkerPool> pool;
+    std::unique_ptr<IoShardPool> shardPool;
+    ConnectionHandle wakeHandle = InvalidConnectionHandle;
+    if ((0 < workers || 0 < shards) && 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, wake)) {
+        fcntl(wake[1], F_SETFL, fcntl(wake[1], F_GETFL, 0) | O_NONBLOCK);
+        wakeHandle = engine.adoptConnection(wake[0], &wakeHandle, error);
+        const int wakeFd = wake[1];
+        auto ring = [wakeFd]() {
+            const char ch = 0;
+            (void)!write(wakeFd, &ch, 1);
+        };
+        if (0 < workers) {
+            pool = std::make_unique<TlsWorkerPool>(tls, ring);
+            if (InvalidConnectionHandle == wakeHandle || !pool->start(workers)) {
+                fprintf(stderr, "could not start %d TLS workers\n", workers);
+                rr.failed = connections;
+                return rr;
+            }
+        } else {
+#if defined(__linux__)
+            const NetworkEngineType type = NetworkEngineType::Epoll;
+#else
+            const NetworkEngineType type = NetworkEngineType::Kqueue;
+#endif
+            shardPool = std::make_unique<IoShardPool>(type, &tls, proto, ring);
+            if (InvalidConnectionHandle == wakeHandle || shardPool->start(shards) != shards) {
+                fprintf(stderr, "could not start %d I/O shards\n", shards);
+                rr.failed = connections;
+                return rr;
+            }
+        }
+    }
+    const OutputSegment pong = std::make_shared<const std::string>("pong\n");
+
+    SSL_CTX* cctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_verify(cctx, SSL_VERIFY_NONE, nullptr);
+
+    std::map<ConnectionHandle, std::shared_ptr<ConnectionBase>> conns;
+    std::atomic<int> done{0};
+    std::atomic<int> failed{0};
+    std::atomic<bool> release{false};
+    std::vector<std::thread> threads;
+    std::vector<std::vector<long long>> rtts(clientThreads);
+    const auto t0 = Clock::now();
+    for (int i = 0; i < clientThreads; i++) {
+        const int share = connections / clientThreads + (i < connections % clientThreads ? 1 : 0);
+        threads.emplace_back(runClients, cctx, port, share, std::ref(done), std::ref(failed),
+            std::cref(release), std::ref(rtts[i]));
+    }
+
+    std::vector<long long> passUs;
+    long long busyUs = 0;
+    constexpr int MAX_EVENTS = 64;
+    IoEvent events[MAX_EVENTS];
+    while (done + failed < connections && microsSince(t0) < 150LL * 1000 * 1000) {
+        const int n = engine.processEvents(10, events, MAX_EVENTS);
+        const auto p0 = Clock::now();
+        for (int i = 0; i < n; i++) {
+            const IoEvent& ev = events[i];
+            if (InvalidConnectionHandle != wakeHandle && ev.connection == wakeHandle) {
+                drainWake(wake[0]);
+                continue;
+            }
+            if (IoEventType::Accept == ev.type && shardPool) {
+                if (shardPool->adopt(ev.connection, true)) {
+                    sess.track(ev.connection);
+                    engine.detachConnection(ev.connection);
+                } else {
+                    engine.closeConnection(ev.connection);
+                }
+                continue;
+            }
+            if (IoEventType::Accept == ev.type) {
+                auto conn = ConnectionFactory::createConnection(ev.connection, engine, &tls, proto, sess);
+                conn->setTlsWorkerPool(pool.get());
+                conns[ev.connection] = conn;
+                if (!conn->initialize(true)) {
+                    conns.erase(ev.connection);
+                }
+                continue;
+            }
+            auto it = conns.find(ev.connection);
+            if (it != conns.end()) {
+                it->second->handleNetworkEvent(ev);
+            }
+        }
+        if (pool) {
+            pool->runCompletions();
+        }
+        if (shardPool) {
+            shardPool->runCompletions(sess);
+        }
+        for (ConnectionHandle h : sess.replies_) {
+            auto it = conns.find(h);
+            if (it != conns.end()) {
+                it->second->sendDataToClient(pong);
+            } else if (shardPool) {
+                shardPool->send(h, pong);
+            }
+        }
+        sess.replies_.clear();
+        if (0 < n || pool || shardPool) {
+            const long long us = microsSince(p0);
+            busyUs += us;
+            if (0 < n) {
+                passUs.push_back(us);
+            }
+        }
+    }
+    rr.wallMs = microsSince(t0) / 1000;
+
+    release = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    rr.done = done;
+    rr.failed = connections - done;
+
+    for (auto& pair : conns) {
+        pair.second->close(DisconnectReason::ServerShutdown);
+    }
+    if (pool) {
+        pool->waitIdle();
+        pool->runCompletions();
+        pool->stop();
+    }
+    if (shardPool) {
+        shardPool->stop();
+        shardPool->runCompletions(sess);
+        shardPool.reset();
+    }
+    conns.clear();
+    if (InvalidConnectionHandle != wakeHandle) {
+        engine.closeConnection(wakeHandle);
+        close(wake[1]);
+    }
+    engine.closeListener(listener);
+    SSL_CTX_free(cctx);
+    pool.reset();
+    tls.shutdown();
+    engine.shutdown();
+
+    std::sort(passUs.begin(), passUs.end());
+    rr.passes = passUs.size();
+    rr.busyMs = busyUs / 1000;
+    if (!passUs.empty()) {
+        rr.maxPassUs = passUs.back();
+        rr.p99PassUs = passUs[(passUs.size() * 99) / 100];
+        rr.p50PassUs = passUs[passUs.size() / 2];
+    }
+
+    std::vector<long long> rttUs;
+    for (const auto& v : rtts) {
+        rttUs.insert(rttUs.end(), v.begin(), v.end());
+    }
+    std::sort(rttUs.begin(), rttUs.end());
+    if (!rttUs.empty()) {
+        rr.p99RttUs = rttUs[(rttUs.size() * 99) / 100];
+        rr.p50RttUs = rttUs[rttUs.size() / 2];
+    }
+    return rr;
+}
+
+void report(const char* label, const RunResult& r) {
+    printf("%-10s %6d/%-6d %8lld %8lld %8zu %8lld %8lld %9lld %8lld %8lld\n",
+        label, r.done, r.done + r.failed, r.wallMs, r.busyMs, r.passes,
+        r.p50PassUs, r.p99PassUs, r.maxPassUs, r.p50RttUs, r.p99RttUs);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int connections = (1 < argc) ? atoi(argv[1]) : 2000;
+    const int workers = (2 < argc) ? atoi(argv[2]) : 2;
+    const int clientThreads = (3 < argc) ? std::max(1, atoi(argv[3])) : 4;
+    const int shards = (4 < argc) ? std::max(1, atoi(argv[4])) : 2;
+
+    rlimit rl;
+    if (0 == getrlimit(RLIMIT_NOFILE, &rl)) {
+        const rlim_t need = static_cast<rlim_t>(connections) * 2 + 64;
+        if (rl.rlim_cur < need && need <= rl.rlim_max) {
+            rl.rlim_cur = need;
+            setrlimit(RLIMIT_NOFILE, &rl);
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    char dir[] = "/tmp/ganl_tls_bench.XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    const std::string certFile = std::string(dir) + "/cert.pem";
+    const std::string keyFile = std::string(dir) + "/key.pem";
+    if (!makeCertificate(certFile, keyFile)) {
+        fprintf(stderr, "could not create a certificate\n");
+        return 1;
+    }
+
+    printf("# %d TLS connections at once, %d client threads, RSA-2048\n",
+        connections, clientThreads);
+    printf("# pass = dispatch of one poll batch + completions, in microseconds\n");
+    printf("# rtt = a client's ping to its pong, in microseconds\n");
+    printf("%-10s %13s %8s %8s %8s %8s %8s %9s %8s %8s\n",
+        "mode", "ok/total", "wall-ms", "busy-ms", "passes", "p50", "p99", "max",
+        "rtt-p50", "rtt-p99");
+
+    const RunResult inlineRun = runBurst(certFile, keyFile, connections, 0, clientThreads, 0);
+    report("inline", inlineRun);
+    char label[32];
+    snprintf(label, sizeof(label), "workers=%d", workers);
+    const RunResult pooled = runBurst(certFile, keyFile, connections, workers, clientThreads, 0);
+    report(label, pooled);
+    snprintf(label, sizeof(label), "shards=%d", shards);
+    const RunResult sharded = runBurst(certFile, keyFile, connections, 0, clientThreads, shards);
+    report(label, sharded);
+
+    unlink(certFile.c_str());
+    unlink(keyFile.c_str());
+    rmdir(dir);
+    return (inlineRun.failed || pooled.failed || sharded.failed) ? 1 : 0;
+}
@@ -24,6 +24,9 @@
 #include <vector>
 #include <memory>
 
+typedef struct tagFun FUN;
+typedef struct ufun UFUN;
+
 // ---------------------------------------------------------------
 // AST node types
 // ---------------------------------------------------------------
@@ -55,19 +58,79 @@ enum ASTNoevalKind {
     ASTNOEVAL_ULAMBDA
 };
 
+struct ASTNode;
+class ASTArena;
+
+// Text held by a parsed tree.  A view into the tree's arena, always followed
+// by a '\0', so c_str() is valid.  Converts to std::string on request.
+//
+class ASTText : public std::string_view
+{
+public:
+    ASTText() : std::string_view("", 0) {}
+    ASTText(const char *p, size_t n) : std::string_view(p, n) {}
+
+    // s must outlive the view.
+    //
+    explicit ASTText(const std::string &s) : std::string_view(s) {}
+
+    const char *c_str() const { return data(); }
+    operator std::string() const { return std::string(data(), size()); }
+};
+
+// A run of T in a tree's arena.  Read-only once the parser has filled it.
+//
+template <typename T>
+class ASTSpan
+{
+public:
+    size_t size() const  { return m_n; }
+    bool   empty() const { return 0 == m_n; }
+
+    const T &operator[](size_t i) const { return m_p[i]; }
+    const T &front() const { return m_p[0]; }
+    const T &back() const  { return m_p[m_n - 1]; }
+    const T *begin() const { return m_p; }
+    const T *end() const   { return m_p + m_n; }
+
+    void assign(T *p, size_t n)
+    {
+        m_p = p;
+        m_n = static_cast<uint32_t>(n);
+    }
+    T *data() { return m_p; }
+
+private:
+    T       *m_p = nullptr;
+    uint32_t m_n = 0;
+};
+
+// A child link.  Reads like the std::unique_ptr it replaced -- .get(), ->,
+// and a test for null -- but owns nothing; the arena does.
+//
+struct ASTNodeRef {
+    ASTNode *p;
+
+    ASTNode *get() const        { return p; }
+    ASTNode *operator->() const { return p; }
+    ASTNode &operator*() const  { return *p; }
+    explicit operator bool() const { return nullptr != p; }
+};
+
 struct ASTDeferredArg {
-    std::string raw_text;
+    ASTText raw_text;
     bool is_deferred;
-
-    ASTDeferredArg(std::string_view raw = "", bool deferred = false)
-        : raw_text(raw), is_deferred(deferred) {}
 };
 
+// Nodes, child lists, and text all live in the ASTArena of the parse that
+// produced them, and nothing in a node needs destroying, so a whole tree is
+// freed by releasing the arena's few blocks.
+//
 struct ASTNode {
+    ASTText text;
+    ASTSpan<ASTNodeRef> children;
+    ASTSpan<ASTDeferredArg> deferred_args; // FUNCCALL arg metadata
     ASTNodeType type;
-    std::string text;
-    std::vector<std::unique_ptr<ASTNode>> children;
-    std::vector<ASTDeferredArg> deferred_args; // FUNCCALL arg metadata
     ASTNoevalKind noeval_kind;
     bool parser_known_noeval;
     bool has_close_paren;   // FUNCCALL: true if ')' was found
@@ -91,16 +154,67 @@ struct ASTNode {
     mutable uint32_t jit_gate_stamp;
     mutable bool     jit_gate_verdict;
 
-    ASTNode(ASTNodeType t, std::string_view s = "")
-        : type(t), text(s), noeval_kind(ASTNOEVAL_NONE),
+    // FUNCCALL: what the name resolved to, builtin or @function, the last
+    // time this node was evaluated.  Valid while fn_epoch matches the
+    // function-table epoch that jit_gate_note_function_table_change()
+    // bumps; 0 means "not resolved".  Both null is a cached "not found".
+    //
+    mutable uint32_t fn_epoch;
+    mutable FUN     *fn_builtin;
+    mutable UFUN    *fn_ufun;
+
+    ASTNode(ASTNodeType t, ASTText s)
+        : text(s), type(t), noeval_kind(ASTNOEVAL_NONE),
           parser_known_noeval(false), has_close_paren(true),
           has_close_bracket(true), has_close_brace(true),
-          jit_gate_stamp(0), jit_gate_verdict(false) {}
+          jit_gate_stamp(0), jit_gate_verdict(false),
+          fn_epoch(0), fn_builtin(nullptr), fn_ufun(nullptr) {}
+};
 
-    void addChild(std::unique_ptr<ASTNode> child) {
-        children.push_back(std::move(child));
+// Bump allocator behind one parsed tree.  The first block is sized from the
+// input, so a typical expression is one block; a larger one chains more.
+//
+class ASTArena
+{
+public:
+    explicit ASTArena(size_t nHint);
+    ~ASTArena();
+
+    ASTArena(const ASTArena &) = delete;
+    ASTArena &operator=(const ASTArena &) = delete;
+
+    ASTNode *new_node(ASTNodeType t, std::string_view text = std::string_view());
+    ASTText  intern(std::string_view text);
+
+    template <typename T>
+    T *new_array(size_t n)
+    {
+        return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
     }
+
+    size_t nodes() const { return m_nNodes; }
+    size_t bytes() const { return m_nReserved; }
+    size_t used() const  { return m_nUsed; }
+
+private:
+    void *allocate(size_t n, size_t align);
+
+    struct Block;
+    Block *m_pBlocks = nullptr;
+    char  *m_pFree = nullptr;
+    char  *m_pLimit = nullptr;
+    size_t m_nNodes = 0;
+    size_t m_nReserved = 0;
+    size_t m_nUsed = 0;
+};
+
+// Owner of a parsed tree: the root node, which frees its arena when dropped.
+//
+struct ASTArenaDelete {
+    ASTArena *arena = nullptr;
+    void operator()(ASTNode *) const;
 };
+typedef std::unique_ptr<ASTNode, ASTArenaDelete> ASTTree;
 
 // ---------------------------------------------------------------
 // Source regions and lexer modes
@@ -166,18 +280,17 @@ std::vector<ASTToken> ast_tokenize_mode(const UTF8 *input, size_t nLen,
 
 // Parse a token stream into an AST.
 //
-std::unique_ptr<ASTNode> ast_parse(const std::vector<ASTToken> &tokens);
+ASTTree ast_parse(const std::vector<ASTToken> &tokens);
 
 // Parse a MUX expression string directly into an AST.
 // Convenience wrapper: tokenize + parse.
 //
-std::unique_ptr<ASTNode> ast_parse_string(const UTF8 *input, size_t nLen);
+ASTTree ast_parse_string(const UTF8 *input, size_t nLen);
 
 // Parse a source region directly into an AST under an explicit lexer
 // mode. This is the entrypoint intended for deferred-region reparsing.
 //
-std::unique_ptr<ASTNode> ast_parse_region(ASTSourceSpan span,
-                                          ASTLexMode mode);
+ASTTree ast_parse_region(ASTSourceSpan span, ASTLexMode mode);
 
 // Reconstruct the raw source text from an AST subtree.
 //
@@ -187,6 +300,47 @@ std::string ast_raw_text(const ASTNode *node);
 //
 void ast_dump(const ASTNode *node, int indent = 0);
 
+// ---------------------------------------------------------------
+// Attribute-sourced expressions
+// ---------------------------------------------------------------
+
+// Marks a buffer as holding the unmodified text of one attribute, so that
+// mux_exec() on it finds the cached parse by (object, attribute, mod count)
+// instead of hashing the whole text -- for a large u() body run once per
+// list element, that hash was most of the lookup.
+//
+// Bound by parse_and_get_attrib() or bind(), and in effect until release()
+// or destruction.  The buffer must not be written while bound, and must be
+// released before it is freed.
+//
+class ASTAttrSource
+{
+public:
+    ASTAttrSource() = default;
+    ~ASTAttrSource() { release(); }
+
+    ASTAttrSource(const ASTAttrSource &) = delete;
+    ASTAttrSource &operator=(const ASTAttrSource &) = delete;
+
+    void bind(const UTF8 *pText, dbref obj, int attrnum);
+    void release();
+
+    // The bound source whose buffer is pText, if any.
+    //
+    static const ASTAttrSource *find(const UTF8 *pText);
+
+    size_t   length() const    { return m_nLen; }
+    uint64_t key() const       { return m_key; }
+    uint32_t mod_count() const { return m_mod_count; }
+
+private:
+    const UTF8    *m_pText = nullptr;
+    size_t         m_nLen = 0;
+    uint64_t       m_key = 0;
+    uint32_t       m_mod_count = 0;
+    ASTAttrSource *m_pNext = nullptr;
+};
+
 // ---------------------------------------------------------------
 // mux_exec — drop-in replacement for mux_exec
 // ---------------------------------------------------------------
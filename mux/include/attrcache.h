@@ -25,6 +25,8 @@ void cache_close(void);
 void cache_tick(void);
 bool cache_sync(void);
 bool cache_flush_writes(void);
+void cache_before_fork(void);
+void cache_after_fork_parent(void);
 void cache_discard_writes(void);
 // Drop pending OP_CODE_CACHE_PUT ops only (keep attribute put/del).
 // Used by jitstats(flush) so a subsequent DELETE FROM code_cache is not
@@ -59,7 +61,16 @@ void cache_preload_obj(dbref obj, bool bAll);
 void cache_preload_nearby(dbref obj, int depth);
 void cache_preload_deferred_bfs(dbref room, int depth);
 int cache_count(dbref obj);
+
+// Parent-chain prefetch for atr_pget and friends.  Reads attrnum for every
+// object in chain that the cache cannot already answer, in one storage
+// round trip, and sets absent[i] for each chain[i] now known not to have
+// it.  The caller may skip those levels instead of asking cache_get.
+//
+void cache_prefetch_chain(const dbref *chain, int nChain, int attrnum,
+    bool *absent);
 void list_cache_stats(dbref player);
+void list_cache_objects(dbref player);
 
 struct CacheStats
 {
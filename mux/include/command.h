@@ -45,6 +45,7 @@ CMD_ONE_ARG(do_apply_marked);   /* Apply command to marked objects */
 CMD_TWO_ARG(do_admin);          /* Change config parameters */
 CMD_TWO_ARG(do_alias);          /* Change the alias of something */
 CMD_TWO_ARG(do_attribute);      /* Manage user-named attributes */
+CMD_ONE_ARG(do_backup);         // Copy the database while the game runs.
 CMD_ONE_ARG(do_boot);           /* Force-disconnect a player */
 CMD_TWO_ARG(do_chown);          /* Change object or attribute owner */
 CMD_TWO_ARG(do_chownall);       /* Give away all of someone's objs */
@@ -12,6 +12,7 @@
 #undef STARTLOG
 #undef ENDLOG
 #undef LOG_SIMPLE
+#undef LOG_EVENT
 
 // g_pILog->start_log() checks mudconf.log_options internally, so the driver
 // doesn't need to reference mudconf at all.
@@ -30,4 +31,11 @@
         g_pILog->log_text(m); \
     ENDLOG
 
+// As with start_log(), the engine checks key against event_log.
+//
+#define LOG_EVENT(key,type,sock,player,other,s1,s2) \
+    if (g_pILog) { \
+        g_pILog->log_event((key), (type), static_cast<uint32_t>(sock), \
+            (player), (other), (s1), (s2)); }
+
 #endif // DRIVER_LOG_H
@@ -0,0 +1,85 @@
+/*! \file eventlog.h
+ * \brief On-disk format of the binary event log.
+ *
+ * The event log is an optional, compact record of the high-volume log
+ * categories (see the event_log config parameter).  The engine appends to it
+ * through a memory-mapped window; muxevents reads it back.  This header is
+ * shared by both, so it depends on nothing but <cstdint>.
+ *
+ * A file is a 64-byte header followed by 32-byte slots.  Each slot is one
+ * EVLOG_RECORD, except that an EVLOG_STRING record is followed by as many
+ * slots as it takes to hold its bytes.  Strings are interned per file: the
+ * first record that mentions a string is preceded by its EVLOG_STRING
+ * definition, and later records refer to it by id.  Id 0 means no string.
+ * Every file is therefore readable on its own.
+ *
+ * The file is extended in zero-filled steps ahead of the writer, so a slot
+ * whose type is EVLOG_NONE marks the end of the data.  A file that was
+ * closed cleanly is truncated to its last record.
+ */
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <cstdint>
+
+#define EVLOG_MAGIC         "MUXEVLOG"
+#define EVLOG_VERSION       1
+#define EVLOG_RECORD_SIZE   32
+#define EVLOG_HEADER_SIZE   64
+
+// A string is at most EVLOG_MAX_STRING bytes, and string ids stay below
+// EVLOG_MAX_STRINGS; the writer starts a new file before running out.  A
+// reader can take anything past either as a corrupt file.
+//
+#define EVLOG_MAX_STRING    255
+#define EVLOG_MAX_STRINGS   65536
+
+typedef struct
+{
+    char     magic[8];          // EVLOG_MAGIC, not terminated.
+    uint32_t version;
+    uint32_t record_size;
+    int64_t  created_usec;      // Microseconds since 1970-01-01 UTC.
+    uint8_t  reserved[40];
+} EVLOG_HEADER;
+
+typedef struct
+{
+    int64_t  usec;              // Microseconds since 1970-01-01 UTC.
+    uint16_t type;              // EVLOG_*
+    uint16_t reserved;
+    uint32_t socket;
+    int32_t  player;            // The subject, or NOTHING.
+    int32_t  other;             // Per type; see below.
+    uint32_t str1;              // Per type; see below.
+    uint32_t str2;
+} EVLOG_RECORD;
+
+static_assert(sizeof(EVLOG_HEADER) == EVLOG_HEADER_SIZE, "EVLOG_HEADER size");
+static_assert(sizeof(EVLOG_RECORD) == EVLOG_RECORD_SIZE, "EVLOG_RECORD size");
+
+// Record types.  Values are part of the file format; only add to the end of
+// a group.
+//
+//                                socket  player   other     str1     str2
+#define EVLOG_NONE            0   // End of data.
+#define EVLOG_STRING          1   //       length   slots     id
+#define EVLOG_NET_CONNECT    10   // yes   -        port      address
+#define EVLOG_NET_DISCONNECT 11   // yes   player   -         address  reason
+#define EVLOG_NET_REFUSED    12   // yes   -        -         address  why
+#define EVLOG_LOGIN          20   // yes   player   location  address
+#define EVLOG_LOGIN_FAILED   21   // yes   -        -         address  name
+#define EVLOG_LOGIN_REFUSED  22   // yes   player   -         address  why
+#define EVLOG_CREATE         23   // yes   player   -         address
+#define EVLOG_CREATE_FAILED  24   // yes   -        -         address  name
+#define EVLOG_COMMAND        30   //       player   location  verb
+#define EVLOG_COMMAND_SUSPECT 31  //       player   location  verb
+#define EVLOG_COMMAND_BAD    32   //       player   location  verb
+#define EVLOG_RENAME         40   //       thing    -         new name
+//
+// LOGIN_FAILED's str2 is the name tried, or for a line that was neither a
+// connect nor a create, the line itself (cut to 150 bytes), as the text log
+// records it.
+
+#endif // EVENTLOG_H
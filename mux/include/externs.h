@@ -198,6 +198,7 @@ constexpr int DS_WEBSOCKET    = 0x0008;      // WebSocket connection (RFC 6455).
 constexpr int DS_WEBSOCKET_HS = 0x0010;      // WebSocket handshake in progress.
 constexpr int DS_NEED_PROTO   = 0x0020;      // Awaiting protocol detection (telnet vs WS).
 constexpr int DS_TLS          = 0x0040;      // Connection uses TLS (GANL transport layer).
+constexpr int DS_LOGIN_PENDING = 0x0080;     // Password being checked; input held.
 
 // Telnet option helpers (implementations access DESC internals)
 //
@@ -294,6 +295,22 @@ extern void set_doing_all(dbref target, const UTF8 *doing, size_t len);
 extern bool set_doing_least_idle(dbref target, const UTF8 *doing, size_t len);
 extern void update_all_desc_quotas(int nExtra, int nMax);
 extern void broadcast_and_flush(int inflags, const UTF8 *text);
+extern void begin_broadcast(void);
+extern void end_broadcast(void);
+
+// While one of these is alive, text sent to several players is rendered
+// once per output encoding rather than once per connection.
+//
+class CBroadcastScope
+{
+public:
+    CBroadcastScope(void)  { begin_broadcast(); }
+    ~CBroadcastScope(void) { end_broadcast(); }
+
+    CBroadcastScope(const CBroadcastScope &) = delete;
+    CBroadcastScope &operator=(const CBroadcastScope &) = delete;
+};
+
 extern void for_each_connected_desc(void (*callback)(dbref player, SOCKET sock, void *context), void *context);
 extern const UTF8 *time_format_1(int64_t Seconds, size_t maxWidth);
 extern const UTF8 *time_format_2(int64_t Seconds);
@@ -314,6 +331,7 @@ extern int boot_by_port(SOCKET port, bool bGod, const UTF8 *message);
 extern void find_oldest(dbref target, DESC *dOldest[2]);
 extern void check_idle();
 void Task_ProcessCommand(void *arg_voidptr, int arg_iInteger);
+extern void cancel_pending_login(DESC *d);
 extern dbref  find_connected_name(dbref, const UTF8 *);
 extern void do_command(DESC *, UTF8 *);
 extern void desc_addhash(DESC *);
@@ -328,6 +346,11 @@ extern void handle_prog(DESC *d, UTF8 *message);
 //
 void record_login(dbref, bool, const UTF8 *, const UTF8 *, const UTF8 *, const UTF8 *);
 extern dbref connect_player(UTF8 *, UTF8 *, UTF8 *, UTF8 *, UTF8 *);
+bool connect_player_begin(const UTF8 *name, const UTF8 *password,
+    const UTF8 *host, const UTF8 *username, const UTF8 *ipaddr,
+    void (*fpDone)(void *, int), void *pContext, int *pTicket, dbref *pPlayer);
+bool connect_player_end(int ticket, dbref *pPlayer);
+void connect_player_cancel(int ticket);
 
 // From bsd.cpp and netaddr.cpp
 //
@@ -338,6 +361,7 @@ extern "C" MUX_RESULT DCL_API pipepump(void);
 #endif // HAVE_WORKING_FORK && STUB_SLAVE
 
 extern NAMETAB sigactions_nametab[];
+extern NAMETAB network_engine_nametab[];
 
 #include "file_c.h"
 #ifdef REALITY_LVLS
@@ -469,6 +493,13 @@ void mux_exec(const UTF8 *pStr, size_t nStr, UTF8 *buff, UTF8 **bufc, dbref exec
 // of one increment in non-JIT builds.
 //
 void jit_gate_note_function_table_change(void);
+void ast_attr_index_invalidate_all(void);
+void list_ast_cache_stats(dbref);
+bool function_memo_replay(const FUN *fp, const UTF8 * const fargs[],
+    int nfargs, UTF8 *buff, UTF8 **bufc);
+void function_memo_store(const UTF8 *buff, const UTF8 *pStart, const UTF8 *pEnd);
+void ast_function_memo_reset(void);
+void list_function_memo_stats(dbref);
 
 inline void RegAddRef(reg_ref *regref)
 {
@@ -561,6 +592,7 @@ bool regexp_match
     UTF8 *args[],
     int nargs
 );
+void list_regex_cache_stats(dbref);
 
 bool list_check
 (
@@ -582,6 +614,7 @@ bool html_escape(const UTF8 *src, UTF8 *dest, UTF8 **destp);
 void dump_database_internal(int);
 void dump_database(void);
 void fork_and_dump(int key);
+void backup_abort(void);
 void process_preload(void);
 
 #define LOAD_GAME_SUCCESS           0
@@ -609,8 +642,10 @@ void log_name_and_loc(dbref);
 void log_type_and_name(dbref);
 
 #define SIZEOF_LOG_BUFFER 1024
+class CLogWriter;
 class CLogFile
 {
+    friend class CLogWriter;
 private:
     CLinearTimeAbsolute m_ltaStarted;
 #if defined(WINDOWS_THREADS)
@@ -629,10 +664,18 @@ private:
     UTF8 *m_pBasename;
     UTF8 m_szPrefix[32];
     UTF8 m_szFilename[SIZEOF_PATHNAME];
+    CLogWriter *m_pWriter;
+    bool m_bWriterFailed;
+    bool m_bForked;
+    uint64_t m_nFailuresReported;
 
     bool CreateLogFile(void);
     void AppendLogFile(void);
     void CloseLogFile(void);
+    bool WriteFileData(const UTF8 *pData, size_t nData);
+    void NextLogFile(void);
+    CLogWriter *Writer(void);
+    void StopWriter(void);
 public:
     CLogFile(void);
     ~CLogFile(void);
@@ -646,10 +689,23 @@ public:
     void StartLogging(void);
     void StopLogging(void);
     void Rotate(void);
+    void Sync(void);
+    void AfterFork(void);
+    void ListStats(dbref player);
+    void MakeFileName(const UTF8 *szExtension, UTF8 *szName, size_t nName);
 };
 
 extern CLogFile Log;
 
+/* From eventlog.cpp */
+void log_event(int iType, uint32_t nSocket, dbref player, dbref other,
+    const UTF8 *pStr1, const UTF8 *pStr2);
+void log_command_event(int key, int iType, dbref executor, const UTF8 *pCommand);
+void eventlog_rotate(void);
+void eventlog_close(void);
+void eventlog_after_fork(void);
+void eventlog_list_stats(dbref player);
+
 /* From look.cpp */
 void look_in(dbref,dbref, int);
 void show_vrml_url(dbref, dbref);
@@ -677,7 +733,7 @@ void  empty_obj(dbref);
 void  link_exit(const dbref, const dbref, const dbref);
 
 /* From player.cpp */
-dbref create_player(const UTF8 *name, const UTF8 *pass, dbref executor, bool isrobot, const UTF8 **pmsg);
+dbref create_player(const UTF8 *name, const UTF8 *pass, dbref executor, bool isrobot, bool bHashLater, const UTF8 **pmsg);
 void AddToPublicChannel(dbref player);
 void AddToPlayerChannels(dbref player);
 bool add_player_name(dbref player, const UTF8 *name, bool bAlias);
@@ -692,6 +748,7 @@ bool badname_check(const UTF8 *);
 void badname_list(dbref, const UTF8 *);
 bool protectname_check(const UTF8 *name, dbref player);
 void ChangePassword(dbref player, const UTF8 *szPassword);
+void password_hash_shutdown(void);
 const UTF8 *mux_crypt(const UTF8 *szPassword, const UTF8 *szSalt, int *piType);
 int  QueueMax(dbref);
 int  a_Queue(dbref, int);
@@ -769,6 +826,9 @@ void SetClearFlags(dbref thing, FLAG aClearFlags[3], FLAG aSetFlags[3]);
 bool eval_boolexp(dbref, dbref, dbref, BOOLEXP *);
 BOOLEXP *parse_boolexp(dbref, const UTF8 *, bool);
 bool eval_boolexp_atr(dbref, dbref, dbref, UTF8 *);
+bool eval_boolexp_lock(dbref, dbref, dbref, int);
+void lock_cache_invalidate_all(void);
+void list_lock_cache_stats(dbref);
 
 /* From functions.cpp */
 bool xlate(const UTF8 *);
@@ -855,6 +915,7 @@ UTF8 *atr_pget_str_LEN(UTF8 *, dbref, int, dbref *, int *, size_t *);
 UTF8 *atr_pget_str(UTF8 *, dbref, int, dbref *, int *);
 bool atr_get_info(dbref, int, dbref *, int *);
 bool atr_pget_info(dbref, int, dbref *, int *);
+dbref atr_pget_source(void);
 void atr_free(dbref);
 bool check_zone_handler(dbref player, dbref thing, bool bPlayerCheck);
 #define check_zone(player, thing) check_zone_handler(player, thing, false)
@@ -869,6 +930,7 @@ extern int anum_alc_top;
 #define ATTRIB_RENAME   2   /* Rename attribute */
 #define ATTRIB_DELETE   4   /* Delete attribute */
 #define ATTRIB_INFO     8   /* Info (number, flags) about attribute */
+#define BACKUP_ABORT    1   // Abandon the backup being copied.
 #define BOOT_QUIET      1   /* Inhibit boot message to victim */
 #define BOOT_PORT       2   /* Boot by port number */
 #define BREAK_INLINE    1   // Evaluate @break action inline
@@ -1282,6 +1344,14 @@ extern NAMETAB method_nametab[];
 #define SA_EXIT         1   /* Exit, and dump core */
 #define SA_DFLT         2   /* Try to restart on a fatal error */
 
+/* Network engine choices (network_engine) */
+
+#define NE_AUTO         0   /* Best available for the platform */
+#define NE_SELECT       1
+#define NE_EPOLL        2
+#define NE_KQUEUE       3
+#define NE_IO_URING     4   /* Linux 6.0+; falls back to NE_AUTO */
+
 #define STARTLOG(key,p,s) \
     if ((((key) & mudconf.log_options) != 0) && start_log(T(p), T(s))) {
 #define ENDLOG \
@@ -1290,6 +1360,9 @@ extern NAMETAB method_nametab[];
     STARTLOG(key,p,s) \
         log_text(m); \
     ENDLOG
+#define LOG_EVENT(key,type,sock,player,other,s1,s2) \
+    if (((key) & mudconf.event_log) != 0) { \
+        log_event((type), static_cast<uint32_t>(sock), (player), (other), (s1), (s2)); }
 
 extern const UTF8 *NOMATCH_MESSAGE;
 extern const UTF8 *AMBIGUOUS_MESSAGE;
@@ -1405,7 +1478,7 @@ void dispatch_CacheTick(void *pUnused, int iUnused);
 //
 typedef void FTASK(void *, int);
 
-typedef struct
+typedef struct task_record
 {
     CLinearTimeAbsolute ltaWhen;
 
@@ -1414,7 +1487,12 @@ typedef struct
     FTASK      *fpTask;
     void       *arg_voidptr;
     int        arg_Integer;
-    int        m_iVisitedMark;
+    dbref      m_dbObject;    // Object whose queue holds this task, or NOTHING.
+    dbref      m_dbWaitOn;    // Semaphore object this task blocks on, or NOTHING.
+    size_t     m_iHeapIndex;  // Position within whichever heap holds this task.
+    int        m_iWheelSlot;  // Timing wheel bucket holding this task, or -1.
+    struct task_record *m_pWheelNext;
+    struct task_record *m_pWheelPrev;
 } TASK_RECORD, *PTASK_RECORD;
 
 #define PRIORITY_SYSTEM  100
@@ -1434,8 +1512,9 @@ typedef int SCHLOOK(PTASK_RECORD);
 #define IU_REMOVE_TASK 2
 #define IU_UPDATE_TASK 3
 
-// Comparator functors for the two scheduler heaps.  std:: heap algorithms
-// implement a max-heap, so "greater" gives us min-heap behaviour.
+// Comparator functors for the two scheduler heaps.  Like the std:: heap
+// algorithms, CTaskHeap is a max-heap, so "greater" gives us min-heap
+// behaviour.
 //
 struct CompareWhenGreater
 {
@@ -1456,25 +1535,66 @@ struct ComparePriorityGreater
     }
 };
 
+// Each task records its own position in the heap, so that a task found
+// through one of the scheduler's indexes can be removed or re-keyed in
+// O(log n) without rebuilding the heap.
+//
 template <typename Compare>
 class CTaskHeap
 {
 private:
     std::vector<PTASK_RECORD> m_Heap;
-    int m_iVisitedMark;
     Compare m_Compare;
 
-public:
-    CTaskHeap() : m_iVisitedMark(0) {}
+    void Place(size_t i, PTASK_RECORD p)
+    {
+        m_Heap[i] = p;
+        p->m_iHeapIndex = i;
+    }
 
-    ~CTaskHeap()
+    void SiftUp(size_t i)
     {
-        for (auto p : m_Heap)
+        PTASK_RECORD p = m_Heap[i];
+        while (0 < i)
         {
-            delete p;
+            const size_t iParent = (i - 1)/2;
+            if (!m_Compare(m_Heap[iParent], p))
+            {
+                break;
+            }
+            Place(i, m_Heap[iParent]);
+            i = iParent;
         }
+        Place(i, p);
     }
 
+    void SiftDown(size_t i)
+    {
+        const size_t n = m_Heap.size();
+        PTASK_RECORD p = m_Heap[i];
+        for (;;)
+        {
+            size_t iChild = 2*i + 1;
+            if (n <= iChild)
+            {
+                break;
+            }
+            if (  iChild + 1 < n
+               && m_Compare(m_Heap[iChild], m_Heap[iChild + 1]))
+            {
+                iChild++;
+            }
+            if (!m_Compare(p, m_Heap[iChild]))
+            {
+                break;
+            }
+            Place(i, m_Heap[iChild]);
+            i = iChild;
+        }
+        Place(i, p);
+    }
+
+public:
     void Shrink(void)
     {
         m_Heap.shrink_to_fit();
@@ -1482,12 +1602,44 @@ public:
 
     bool Insert(PTASK_RECORD pTask)
     {
-        pTask->m_iVisitedMark = m_iVisitedMark - 1;
         m_Heap.push_back(pTask);
-        std::push_heap(m_Heap.begin(), m_Heap.end(), m_Compare);
+        SiftUp(m_Heap.size() - 1);
         return true;
     }
 
+    bool empty(void) const
+    {
+        return m_Heap.empty();
+    }
+
+    bool Contains(PTASK_RECORD pTask) const
+    {
+        return  pTask->m_iHeapIndex < m_Heap.size()
+             && m_Heap[pTask->m_iHeapIndex] == pTask;
+    }
+
+    // Remove a task from anywhere in the heap.
+    //
+    void Remove(PTASK_RECORD pTask)
+    {
+        const size_t i = pTask->m_iHeapIndex;
+        PTASK_RECORD pLast = m_Heap.back();
+        m_Heap.pop_back();
+        if (pLast != pTask)
+        {
+            Place(i, pLast);
+            Update(pLast);
+        }
+    }
+
+    // Restore the heap after a task's ltaWhen or iPriority has changed.
+    //
+    void Update(PTASK_RECORD pTask)
+    {
+        SiftUp(pTask->m_iHeapIndex);
+        SiftDown(pTask->m_iHeapIndex);
+    }
+
     // Count live (non-cancelled) tasks whose priority lies strictly between
     // iLo and iHi.  Used to tell real user work apart from recurring system
     // maintenance and parked semaphore entries.
@@ -1522,107 +1674,172 @@ public:
         {
             return nullptr;
         }
-        std::pop_heap(m_Heap.begin(), m_Heap.end(), m_Compare);
-        PTASK_RECORD p = m_Heap.back();
-        m_Heap.pop_back();
+        PTASK_RECORD p = m_Heap.front();
+        Remove(p);
         return p;
     }
 
-    void CancelTask(FTASK *fpTask, void *arg_voidptr, int arg_Integer)
+    // Append the tasks in heap order, or in the order they will run.
+    //
+    void Snapshot(std::vector<PTASK_RECORD> &v) const
     {
-        for (auto p : m_Heap)
-        {
-            if (  p->fpTask == fpTask
-               && p->arg_voidptr == arg_voidptr
-               && p->arg_Integer == arg_Integer)
-            {
-                p->fpTask = nullptr;
-            }
-        }
+        v.insert(v.end(), m_Heap.begin(), m_Heap.end());
+    }
+
+    void SnapshotOrdered(std::vector<PTASK_RECORD> &v) const
+    {
+        const size_t iFirst = v.size();
+        Snapshot(v);
+        std::sort(v.begin() + iFirst, v.end(),
+            [this](PTASK_RECORD a, PTASK_RECORD b) { return m_Compare(b, a); });
+    }
+};
+
+// Hashed hierarchical timing wheel for tasks ordered by ltaWhen.
+//
+// Time is cut into slots of 2^WHEEL_SHIFT ticks (about 6.5ms).  A task
+// whose slot is after the wheel's current slot hangs from a doubly-linked
+// bucket, at the level of the highest byte in which the two slots differ,
+// so insert and cancel are O(1).  Tasks at or before the current slot sit
+// in a small heap, which keeps the exact CompareWhenGreater order for
+// whatever is due next.  Buckets that fall wholly before the present are
+// expired in one batch without being sorted.
+//
+class CTaskWheel
+{
+private:
+    static const int WHEEL_SHIFT  = 16;
+    static const int WHEEL_BITS   = 8;
+    static const int WHEEL_SIZE   = 1 << WHEEL_BITS;
+    static const int WHEEL_LEVELS = (64 - WHEEL_SHIFT)/WHEEL_BITS;
+
+    CTaskHeap<CompareWhenGreater> m_Due;
+    PTASK_RECORD m_Buckets[WHEEL_LEVELS][WHEEL_SIZE];
+    uint64_t     m_Occupied[WHEEL_LEVELS][WHEEL_SIZE/64];
+    uint64_t     m_slotCurrent;
+    size_t       m_nWheel;
+
+    static uint64_t Slot(const CLinearTimeAbsolute &lta);
+    void Place(PTASK_RECORD pTask);
+    void Unlink(PTASK_RECORD pTask);
+    PTASK_RECORD Detach(int iLevel, int iBucket);
+    bool FindEarliest(int &iLevel, int &iBucket) const;
+    uint64_t BucketStart(int iLevel, int iBucket) const;
+    bool CascadeEarliest(void);
+
+public:
+    CTaskWheel(void);
+
+    void Shrink(void) { m_Due.Shrink(); }
+    bool Insert(PTASK_RECORD pTask);
+    bool Contains(PTASK_RECORD pTask) const;
+    void Remove(PTASK_RECORD pTask);
+    void Update(PTASK_RECORD pTask);
+    int  CountInPriorityRange(int iLo, int iHi) const;
+    PTASK_RECORD PeekAtTopmost(void);
+    PTASK_RECORD RemoveTopmost(void);
+    void Expire(const CLinearTimeAbsolute &ltaNow, std::vector<PTASK_RECORD> &ready);
+    void Snapshot(std::vector<PTASK_RECORD> &v) const;
+    void SnapshotOrdered(std::vector<PTASK_RECORD> &v) const;
+};
+
+// Secondary index from a key to the tasks filed under it.
+//
+template <typename Key, typename Hasher = std::hash<Key>>
+class CTaskIndex
+{
+private:
+    std::unordered_map<Key, std::unordered_set<PTASK_RECORD>, Hasher> m_Index;
+
+public:
+    void Add(const Key &k, PTASK_RECORD p)
+    {
+        m_Index[k].insert(p);
     }
 
-    int TraverseUnordered(SCHLOOK *pfLook)
+    void Remove(const Key &k, PTASK_RECORD p)
     {
-        m_iVisitedMark++;
-        if (m_iVisitedMark == 0)
+        const auto it = m_Index.find(k);
+        if (it != m_Index.end())
         {
-            for (auto p : m_Heap)
+            it->second.erase(p);
+            if (it->second.empty())
             {
-                p->m_iVisitedMark = m_iVisitedMark;
+                m_Index.erase(it);
             }
-            m_iVisitedMark++;
         }
+    }
 
-        bool bUnvisitedRecords;
-        do
+    void Find(const Key &k, std::vector<PTASK_RECORD> &v) const
+    {
+        const auto it = m_Index.find(k);
+        if (it != m_Index.end())
         {
-            bUnvisitedRecords = false;
-            for (size_t i = 0; i < m_Heap.size(); i++)
-            {
-                PTASK_RECORD p = m_Heap[i];
-                if (p->m_iVisitedMark == m_iVisitedMark)
-                {
-                    continue;
-                }
-                bUnvisitedRecords = true;
-                p->m_iVisitedMark = m_iVisitedMark;
-
-                int cmd = pfLook(p);
-                switch (cmd)
-                {
-                case IU_REMOVE_TASK:
-                    m_Heap[i] = m_Heap.back();
-                    m_Heap.pop_back();
-                    std::make_heap(m_Heap.begin(), m_Heap.end(), m_Compare);
-                    break;
-
-                case IU_DONE:
-                    return false;
-
-                case IU_UPDATE_TASK:
-                    std::make_heap(m_Heap.begin(), m_Heap.end(), m_Compare);
-                    break;
-                }
-            }
-        } while (bUnvisitedRecords);
-        return true;
+            v.insert(v.end(), it->second.begin(), it->second.end());
+        }
     }
 
-    int TraverseOrdered(SCHLOOK *pfLook)
+    void Keys(std::vector<Key> &v) const
     {
-        std::sort_heap(m_Heap.begin(), m_Heap.end(), m_Compare);
-
-        for (int i = static_cast<int>(m_Heap.size()) - 1; i >= 0; i--)
+        for (const auto &kv : m_Index)
         {
-            PTASK_RECORD p = m_Heap[i];
-            int cmd = pfLook(p);
-            if (IU_DONE == cmd)
-            {
-                break;
-            }
+            v.push_back(kv.first);
         }
-
-        std::make_heap(m_Heap.begin(), m_Heap.end(), m_Compare);
-        return true;
     }
 };
 
 class CScheduler
 {
 private:
-    CTaskHeap<CompareWhenGreater>     m_WhenHeap;
+    CTaskWheel                        m_WhenWheel;
     CTaskHeap<ComparePriorityGreater> m_PriorityHeap;
     uint64_t m_Ticket;
     int       m_minPriority;
 
+    // TASK_RECORDs are carved from blocks and recycled through a free list
+    // rather than new'd and deleted one at a time.
+    //
+    std::vector<std::unique_ptr<TASK_RECORD[]>> m_TaskBlocks;
+    PTASK_RECORD m_pFreeTasks;
+    std::vector<PTASK_RECORD> m_Ready;
+
+    // Every scheduled task is filed by ticket (the @ps PID) and by its
+    // argument (for CancelTask).  Queue entries are also filed by the
+    // object that runs them and, while blocked, by their semaphore, so
+    // @halt, @notify and @halt/pid visit only the tasks they can affect.
+    //
+    std::unordered_map<uint64_t, PTASK_RECORD> m_TaskByTicket;
+    CTaskIndex<void *>                m_TasksByArg;
+    CTaskIndex<dbref, dbrefHasher>    m_TasksByObject;
+    CTaskIndex<dbref, dbrefHasher>    m_TasksBySemaphore;
+    int       m_nTraversals;
+
+    PTASK_RECORD AllocTask(void);
+    void FreeTask(PTASK_RECORD pTask);
+    bool Schedule(PTASK_RECORD pTask);
+    void Unindex(PTASK_RECORD pTask);
+    void Remove(PTASK_RECORD pTask);
+    void Update(PTASK_RECORD pTask);
+    bool Visit(const std::vector<PTASK_RECORD> &tasks, SCHLOOK *pfLook);
+
 public:
     void TraverseUnordered(SCHLOOK *pfLook);
     void TraverseOrdered(SCHLOOK *pfLook);
-    CScheduler(void) { m_Ticket = 0; m_minPriority = PRIORITY_CF_DEQUEUE_ENABLED; }
+    void TraverseObject(dbref dbObject, SCHLOOK *pfLook);
+    void TraverseSemaphore(dbref dbSem, bool bOrdered, SCHLOOK *pfLook);
+    void TraverseTicket(uint64_t iTicket, SCHLOOK *pfLook);
+    void QueuedObjects(std::vector<dbref> &objects) const;
+    CScheduler(void) { m_Ticket = 0; m_minPriority = PRIORITY_CF_DEQUEUE_ENABLED; m_pFreeTasks = nullptr; m_nTraversals = 0; }
     // #1871: return false if the task cannot be allocated or enqueued so
     // wait_que (and similar) can free the BQUE and refund quota/cost.
-    bool DeferTask(const CLinearTimeAbsolute& ltWhen, int iPriority, FTASK *fpTask, void *arg_voidptr, int arg_Integer);
-    bool DeferImmediateTask(int iPriority, FTASK *fpTask, void *arg_voidptr, int arg_Integer);
+    //
+    // dbObject and dbWaitOn file a queue entry under the object that runs
+    // it and the semaphore it waits on.
+    //
+    bool DeferTask(const CLinearTimeAbsolute& ltWhen, int iPriority, FTASK *fpTask, void *arg_voidptr, int arg_Integer,
+                   dbref dbObject = NOTHING, dbref dbWaitOn = NOTHING);
+    bool DeferImmediateTask(int iPriority, FTASK *fpTask, void *arg_voidptr, int arg_Integer,
+                   dbref dbObject = NOTHING);
     bool WhenNext(CLinearTimeAbsolute *);
     bool HasPendingUserTasks(void);
     int  RunTasks(int iCount);
@@ -1704,7 +1921,9 @@ UTF8 *modSpeech(dbref player, const UTF8 *message, bool bWhich, const UTF8 *comm
 
 // From funceval.cpp
 //
-bool parse_and_get_attrib(dbref, const UTF8 * const [], UTF8 **, dbref *, dbref *, int *, UTF8 *, UTF8 **);
+class ASTAttrSource;
+bool parse_and_get_attrib(dbref, const UTF8 * const [], UTF8 **, dbref *, dbref *, int *, UTF8 *, UTF8 **,
+    ASTAttrSource *pSource = nullptr);
 
 // Engine-side factory classes are internal to engine.so.  Their
 // declarations live in engine_com.cpp and log.cpp respectively.
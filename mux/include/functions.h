@@ -38,6 +38,8 @@ typedef struct ufun {
 #define FN_PRIV     4   // Perform user-def function as holding obj.
 #define FN_PRES     8   // Preseve r-regs before user-def functions.
 #define FN_RESTRICT 32  // Only callable by wizard code (including inherited).
+#define FN_PURE     64  // Output depends only on the arguments, and costs
+                        // more than looking it up (function_memo_max).
 
 #define FN_LIST     1   // Corresponds to /list switch. -not- used in
                         // UFUN structure.
@@ -17,6 +17,8 @@
 #include "session_manager.h"
 #include "connection.h"
 #include "io_buffer.h"
+#include "tls_worker_pool.h"
+#include "io_shard_pool.h"
 
 #include <condition_variable>
 #include <memory>
@@ -68,6 +70,7 @@ public:
 
     // --- TinyMUX Interface ---
     void send_data(DESC* d, const char* data, size_t len);
+    void send_data(DESC* d, const ganl::OutputSegment& segment);
     void close_connection(DESC* d, ganl::DisconnectReason reason);
     std::string get_remote_address(DESC* d);
     int get_socket_descriptor(DESC* d); // For legacy functions needing descriptor num
@@ -107,6 +110,21 @@ public:
     uint64_t connections_closed_   = 0;
     void log_socket_stats(bool force);
 
+    // Each main loop pass drains every ready connection (several
+    // processEvents calls if the first one fills) before any command runs,
+    // up to a budget of client bytes so a flood cannot starve the task
+    // phase.  loop_bytes_in_ counts the current pass.  The histograms time
+    // the I/O and task phases of each pass in log2 microsecond buckets and
+    // are reported beside NET/STAT.
+    //
+    static constexpr int LOOP_HIST_BUCKETS = 16;
+    size_t loop_bytes_in_ = 0;
+    uint64_t loop_budget_stops_ = 0;
+    uint64_t loop_io_hist_[LOOP_HIST_BUCKETS] = {};
+    uint64_t loop_task_hist_[LOOP_HIST_BUCKETS] = {};
+    void dispatch_network_events(ganl::IoEvent* events, int num_events,
+                                 unsigned int avail_descriptors);
+
     // Listener Handles (Port -> ListenerHandle)
     std::map<int, ganl::ListenerHandle> port_listeners_;
     std::map<int, ganl::ListenerHandle> ssl_port_listeners_;
@@ -151,6 +169,40 @@ public:
     void drain_dns_results();
 #endif
 
+    // TLS handshakes and record crypto run on these threads when
+    // tls_workers is non-zero.  Workers write a byte to the wake pipe when
+    // results are waiting, and the main loop hands them to their connections
+    // after each poll.  Windows keeps TLS on the main thread.
+    //
+    std::unique_ptr<ganl::TlsWorkerPool> tlsWorkers_;
+    ganl::ConnectionHandle tlsWakeHandle_{ganl::InvalidConnectionHandle};
+    int tlsWakeWriteFd_{-1};
+
+    void start_tls_workers();
+    void flush_tls_workers();
+    void stop_tls_workers();
+    void drain_tls_wake_pipe();
+
+    // Socket I/O runs on these threads when io_threads is non-zero.  The
+    // main loop still accepts and opens the DESC, then hands the socket to
+    // a shard, which reads, writes and does TLS for it and nothing else.
+    // Bytes a shard receives come back undecoded through the pool's
+    // completion list, so DS_NEED_PROTO detection, the WebSocket handshake
+    // and framing, telnet, and everything else that touches a DESC stays
+    // on this thread.  A handle_to_conn_ entry with no ConnectionBase is a shard's.
+    // Windows keeps all connection I/O on the main thread.
+    //
+    std::unique_ptr<ganl::IoShardPool> ioShards_;
+    ganl::ConnectionHandle ioWakeHandle_{ganl::InvalidConnectionHandle};
+    int ioWakeWriteFd_{-1};
+
+    void start_io_shards(ganl::NetworkEngineType engineType);
+    void flush_io_shards();
+    void stop_io_shards();
+    void drain_io_wake_pipe();
+    void accept_to_shard(ganl::ConnectionHandle handle, const ListenerContext& listenerCtx,
+                         const ganl::NetworkAddress& remoteAddress, bool useTls);
+
     bool start_dns_slave();
     void shutdown_dns_slave();
     void queue_dns_lookup(const UTF8* numericAddress);
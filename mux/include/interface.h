@@ -46,7 +46,7 @@ struct descriptor_data
   size_t output_size;
   size_t output_tot;
   size_t output_lost;
-  std::deque<std::string> output_queue;
+  std::deque<std::shared_ptr<const std::string>> output_queue;
   size_t input_size;
   size_t input_tot;
   size_t input_lost;
@@ -82,6 +82,14 @@ struct descriptor_data
   ws_state *ws;                            // WebSocket state (nullptr if telnet)
   int64_t connlog_id;                      // SQLite connlog row (0 if not logged)
 
+  // While DS_LOGIN_PENDING: what check_connect needs to finish the connect
+  // once the engine has checked the password.
+  //
+  int   login_ticket;
+  bool  login_dark;
+  bool  login_guest;
+  UTF8 *login_user;
+
   // #1800: partial WebSocket "GET " preface across TCP read boundaries.
   // While DS_NEED_PROTO and len < 4 with a matching prefix of "GET ",
   // bytes accumulate here so a split preface is not forced to telnet.
@@ -59,7 +59,8 @@ const MUX_IID IID_ISlaveControl          = UINT64_C(0x0000000250C158E9);
 const MUX_IID IID_IServerEventsControl   = UINT64_C(0x000000026EE5256E);
 const MUX_CID CID_QuerySinkPSFactory      = UINT64_C(0x00000002746B93B9);
 const MUX_CID CID_QueryControlPSFactory   = UINT64_C(0x00000002683E889A);
-const MUX_IID IID_ILog                   = UINT64_C(0x000000028B9DC13B);
+// IID bumped ..C13B -> ..C13C when log_event was added.
+const MUX_IID IID_ILog                   = UINT64_C(0x000000028B9DC13C);
 const MUX_CID CID_QueryServer            = UINT64_C(0x000000028FEA49AD);
 const MUX_CID CID_ServerEventsSource     = UINT64_C(0x00000002A5080812);
 const MUX_IID IID_IQuerySink             = UINT64_C(0x00000002CBBCE24E);
@@ -71,7 +72,8 @@ const MUX_CID CID_LogPSFactory           = UINT64_C(0x00000002BC269C88);
 const MUX_CID CID_SlaveControlPSFactory  = UINT64_C(0x00000002FD75363F);
 const MUX_CID CID_Functions              = UINT64_C(0x00000002FE32BEA1);
 const MUX_CID CID_Notify                 = UINT64_C(0x00000002B880897B);
-const MUX_IID IID_INotify                = UINT64_C(0x00000002621F4385);
+// IID bumped ..4385 -> ..4386 when BeginBroadcast/EndBroadcast were added.
+const MUX_IID IID_INotify                = UINT64_C(0x00000002621F4386);
 const MUX_CID CID_ObjectInfo             = UINT64_C(0x00000002251565F1);
 // IID bumped ..6C49 -> ..6C4A when PayFor/GiveTo were added (#1194).
 // IID bumped ..6C4A -> ..6C4B when UnparseObject was added (#1640).
@@ -109,6 +111,11 @@ public:
     virtual MUX_RESULT SetBasename(const UTF8 *pBasename) = 0;
     virtual MUX_RESULT StartLogging(void) = 0;
     virtual MUX_RESULT Flush(void) = 0;
+
+    // Append a record to the binary event log (eventlog.h) if one of key's
+    // categories is enabled by event_log.
+    //
+    virtual MUX_RESULT log_event(int key, int iType, uint32_t nSocket, dbref player, dbref other, const UTF8 *pStr1, const UTF8 *pStr2) = 0;
 };
 
 interface mux_IServerEventsSink : public mux_IUnknown
@@ -266,6 +273,12 @@ public:
     virtual MUX_RESULT RawNotify(dbref target, const UTF8 *msg) = 0;
     virtual MUX_RESULT NotifyCheck(dbref target, dbref sender,
         const UTF8 *msg, int key) = 0;
+
+    // Bracket a message sent to many players (see
+    // mux_IConnectionManager::BeginBroadcast).
+    //
+    virtual MUX_RESULT BeginBroadcast(void) = 0;
+    virtual MUX_RESULT EndBroadcast(void) = 0;
 };
 
 // Object property queries.
@@ -878,6 +891,9 @@ struct DRIVER_CONFIG
     // Behavior flags and limits.
     //
     int     sig_action;
+    int     network_engine;
+    int     tls_workers;
+    int     io_threads;
     bool    fork_dump;
     bool    name_spaces;
     bool    idle_wiz_dark;
@@ -923,7 +939,7 @@ const MUX_CID CID_GameEngine           = UINT64_C(0x00000002D4E5F6A7);
 // the ENGINE sees it into storage the DRIVER sized, so a size disagreement
 // here is an out-of-bounds write, not a wrong answer.  Any change to
 // DRIVER_CONFIG's layout must bump this for the same reason.
-const MUX_IID IID_IGameEngine          = UINT64_C(0x0000000247B8C9D4);
+const MUX_IID IID_IGameEngine          = UINT64_C(0x0000000247B8C9D6);
 
 interface mux_IGameEngine : public mux_IUnknown
 {
@@ -1062,7 +1078,10 @@ public:
 // state changes.
 //
 const MUX_CID CID_PlayerSession        = UINT64_C(0x00000002F1A2B3C4);
-const MUX_IID IID_IPlayerSession       = UINT64_C(0x00000002F2B3C4D5);
+// IID bumped from ...F2B3C4D5 when the BeginConnectPlayer family was added;
+// a stale driver must fail QueryInterface rather than call through a shifted
+// slot.
+const MUX_IID IID_IPlayerSession       = UINT64_C(0x00000002F2B3C4D6);
 
 interface mux_IPlayerSession : public mux_IUnknown
 {
@@ -1125,6 +1144,26 @@ public:
     //
     virtual MUX_RESULT CreateGuest(DESC *d, const UTF8 **ppName) = 0;
     virtual MUX_RESULT CheckGuest(dbref player, bool *pResult) = 0;
+
+    // ConnectPlayer without waiting for the password hash, which runs on an
+    // engine worker thread.  Returns MUX_S_OK with the answer in *pPlayer
+    // when it is known at once, or MUX_S_FALSE with a ticket in *pTicket.
+    // In that case the engine later schedules fpDone(pContext, ticket), and
+    // the driver collects the answer with EndConnectPlayer.
+    //
+    virtual MUX_RESULT BeginConnectPlayer(const UTF8 *name,
+        const UTF8 *password, const UTF8 *host, const UTF8 *username,
+        const UTF8 *ipaddr, void (*fpDone)(void *, int), void *pContext,
+        int *pTicket, dbref *pPlayer) = 0;
+
+    // The answer for a ticket whose fpDone has run.  MUX_E_NOTFOUND if the
+    // ticket is unknown or not done.
+    //
+    virtual MUX_RESULT EndConnectPlayer(int ticket, dbref *pPlayer) = 0;
+
+    // The connection went away.  Its fpDone is not called.
+    //
+    virtual MUX_RESULT CancelConnectPlayer(int ticket) = 0;
 };
 
 // Driver control — the interface the engine uses for non-connection
@@ -1233,7 +1272,10 @@ public:
 // functions (find_desc_by_socket, send_text_to_player, etc.).
 //
 const MUX_CID CID_ConnectionManager    = UINT64_C(0x00000002E3F4A5B6);
-const MUX_IID IID_IConnectionManager   = UINT64_C(0x00000002F1D2C3E5);
+// IID bumped ..C3E5 -> ..C3E6 when BeginBroadcast/EndBroadcast were added
+// mid-vtable: a stale module must fail QueryInterface rather than call
+// through a shifted slot.
+const MUX_IID IID_IConnectionManager   = UINT64_C(0x00000002F1D2C3E6);
 
 interface mux_IConnectionManager : public mux_IUnknown
 {
@@ -1252,6 +1294,13 @@ public:
     //
     virtual MUX_RESULT BroadcastAndFlush(int inflags, const UTF8 *text) = 0;
 
+    // Bracket a message sent to many players.  In between, text is rendered
+    // once for each output encoding and shared by the connections that use
+    // it.  Calls nest.
+    //
+    virtual MUX_RESULT BeginBroadcast(void) = 0;
+    virtual MUX_RESULT EndBroadcast(void) = 0;
+
     // Send @program prompt to all of a player's descriptors.
     //
     virtual MUX_RESULT SendProgPrompt(dbref target) = 0;
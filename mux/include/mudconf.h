@@ -68,6 +68,14 @@ struct confdata
                                 // the old one-program behaviour (the A/B
                                 // lever).  Read per run — runtime @admin
                                 // takes effect immediately.
+    int     ast_cache_max;      // parsed-expression LRU capacity for
+                                // mux_exec().  Clamped to [16, 1048576]
+                                // at use; read at insert time, so runtime
+                                // @admin applies on the next miss.
+    int     function_memo_max;  // per-command memo of FN_PURE builtin
+                                // results, keyed by evaluated arguments.
+                                // 0 disables.  Past this many entries the
+                                // memo is flushed wholesale.
     int     jit_compile_cache_max; // in-memory compiled-program LRU
                                 // capacity (#2130).  Clamped to
                                 // [8, 65536] at use; read at insert time
@@ -155,6 +163,7 @@ struct confdata
     int     idle_interval;      /* when to check for idle users */
     int     idle_timeout;       /* Boot off players idle this long in secs */
     int     init_size;          // initial db size.
+    int     io_threads;         // Threads doing socket I/O and TLS (0 = inline).
     int     keepalive_interval; /* when to send keep alive */
     int     killguarantee;      /* cost of kill cmd that guarantees success */
     int     killmax;            /* max cost of kill command */
@@ -163,6 +172,7 @@ struct confdata
     int     lock_nest_lim;      /* Max nesting of lock evals */
     int     log_info;           /* Info that goes into log entries */
     int     log_options;        /* What gets logged */
+    int     event_log;          /* What goes to the binary event log */
     int     machinecost;        /* One in mc+1 cmds costs 1 penny (POW2-1) */
     int     lua_instruction_limit; // Max Lua VM instructions per call.
     int     lua_memory_limit;   // Max Lua memory per execution (bytes).
@@ -283,10 +293,12 @@ struct confdata
     int     room_quota;         /* quota needed to make a room */
     int     sacadjust;          /* sacrifice earns (obj_cost/sfactor) + sadj */
     int     sacfactor;          /* ... */
+    int     network_engine;     // Which GANL network engine to run (NE_*).
     int     searchcost;         /* cost of commands that search the whole DB */
     int     sig_action;         // What to do with fatal signals.
     int     start_quota;        /* Quota for new players */
     int     thing_quota;        /* quota needed to make a thing */
+    int     tls_workers;        // Threads doing TLS work (0 = inline).
     int     trace_limit;        /* Max lines of trace output if top-down */
     int     vattr_flags;        /* Attr flags for all user-defined attrs */
     int     vattr_per_hour;     // Maximum allowed vattrs per hour per object.
@@ -300,6 +312,14 @@ struct confdata
 
     int64_t         max_cache_size; // Max size of attribute cache (-1 = unlimited).
     int             cache_preload_depth; // Preload depth (0=obj, 1=+adjacent, 2=two rooms).
+    int             cache_prefetch_misses; // Misses on an object before cache_get loads all of it (0=never).
+    int64_t         cache_prefetch_max_size; // Largest object (bytes) cache_get will prefetch (-1 = no cap).
+    bool            cache_write_thread; // Commit queued attribute writes on a background thread.
+    int64_t         cache_write_batch_size; // Queued bytes that send a write batch at once (-1 = no limit).
+    CLinearTimeDelta cache_write_delay; // Longest a queued write waits before its batch is sent.
+    int             wal_checkpoint_pages; // WAL growth (pages) that triggers a background checkpoint step (0=off).
+    CLinearTimeDelta backup_slice; // Longest @backup holds the game thread per step.
+    CLinearTimeDelta wal_checkpoint_idle; // Quiet time before the WAL is checkpointed in full and truncated.
     unsigned int    site_chars; // where to truncate site name.
 
     std::vector<int> ports;     // user ports.
@@ -620,6 +640,8 @@ struct statedata
     int     pipe_nest_lev;      // Number of piped commands.
     int     pcreates_this_hour; // Player creations possible this hour.
     int     ntfy_nest_lev;      // Current nesting of notifys.
+    uint64_t notify_direct;     // Deliveries that skipped notify_check's buffers.
+    uint64_t notify_full;       // Deliveries that needed them.
     int     include_nest_lev;   // Current nesting of @include/@dolist/now inline lists.
     int     train_nest_lev;     // Current nesting of train.
     int     record_players;     // The maximum # of player logged on.
@@ -677,20 +699,97 @@ struct statedata
     CLinearTimeAbsolute restart_time;   /* When was MUX restarted */
     CLinearTimeAbsolute tThrottleExpired; // How much time is left in this hour of throttling.
 
+    // Attribute cache, two levels: dbref, then attrnum.  Per-object work
+    // (pending overlay, attribute-number lists, preload bookkeeping, flush)
+    // touches only that object's record, never the whole cache.
+    //
+    // Entries are threaded onto one of two intrusive lists.  Clean entries
+    // live on the LRU list and may be evicted; dirty entries (pending write
+    // or tombstone) live on the pinned list and may not.  unordered_map
+    // never moves its nodes, so the links stay valid across rehashes.
+    //
     struct AttrCacheEntry
     {
         std::vector<UTF8> data;
-        std::list<Aname>::iterator lru_it;
+        AttrCacheEntry *lru_prev;
+        AttrCacheEntry *lru_next;
+        unsigned int object;
+        unsigned int attrnum;
         dbref attr_owner;
         int   attr_flags;
         bool  dirty;        // Pending write in queue; pinned against eviction.
         bool  tombstone;    // Deleted but not yet flushed to SQLite.
+        bool  prefetched;   // Loaded by a cache_get prefetch and not yet read.
+        uint64_t write_seq; // Write batch carrying the latest pending write.
+    };
+    struct AttrCacheList
+    {
+        AttrCacheEntry *head = nullptr;  // Oldest.
+        AttrCacheEntry *tail = nullptr;  // Newest.
+        size_t count = 0;
+
+        void push_back(AttrCacheEntry *pEntry)
+        {
+            pEntry->lru_prev = tail;
+            pEntry->lru_next = nullptr;
+            if (nullptr != tail)
+            {
+                tail->lru_next = pEntry;
+            }
+            else
+            {
+                head = pEntry;
+            }
+            tail = pEntry;
+            count++;
+        }
+        void remove(AttrCacheEntry *pEntry)
+        {
+            if (nullptr != pEntry->lru_prev)
+            {
+                pEntry->lru_prev->lru_next = pEntry->lru_next;
+            }
+            else
+            {
+                head = pEntry->lru_next;
+            }
+            if (nullptr != pEntry->lru_next)
+            {
+                pEntry->lru_next->lru_prev = pEntry->lru_prev;
+            }
+            else
+            {
+                tail = pEntry->lru_prev;
+            }
+            pEntry->lru_prev = nullptr;
+            pEntry->lru_next = nullptr;
+            count--;
+        }
+        void touch(AttrCacheEntry *pEntry)
+        {
+            if (tail != pEntry)
+            {
+                remove(pEntry);
+                push_back(pEntry);
+            }
+        }
+    };
+    struct AttrCacheObject
+    {
+        std::unordered_map<unsigned int, AttrCacheEntry> attrs;
+        std::unordered_set<unsigned int> dirty;  // attrnums pinned on this object.
+        std::vector<int> attrnum_list;           // SQLite's view, see #2077.
+        size_t   size = 0;                       // Bytes cached for this object.
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        bool     preloaded_builtin = false;
+        bool     preloaded_all = false;
+        bool     attrnum_list_valid = false;
+        bool     prefetch_oversize = false;      // Over cache_prefetch_max_size.
     };
-    std::list<Aname> attribute_lru_cache_list;   // Evictable (clean) entries.
-    std::list<Aname> attribute_pinned_list;       // Dirty entries; not evictable.
-    std::unordered_map<Aname, AttrCacheEntry, AnameHasher> attribute_lru_cache_map;
-    std::unordered_set<dbref, dbrefHasher> attribute_preloaded_builtin_objects;
-    std::unordered_set<dbref, dbrefHasher> attribute_preloaded_all_objects;
+    AttrCacheList attribute_lru_cache_list;   // Evictable (clean) entries.
+    AttrCacheList attribute_pinned_list;      // Dirty entries; not evictable.
+    std::unordered_map<dbref, AttrCacheObject, dbrefHasher> attribute_cache_objects;
     std::unordered_map<std::vector<UTF8>, ATTR*, VectorHasher> builtin_attribute_names; /* Attribute names hashtable */
     std::map<std::vector<UTF8>, struct channel*> channel_names; /* Channels hashtable */
     StringPtrMap command_htab;  /* Commands hashtable */
@@ -0,0 +1,57 @@
+/*! \file regexcache.h
+ * \brief Shared cache of compiled regular expressions.
+ *
+ * REGEXP $-commands and ^-listens, regexp @filter/@infilter attributes, and
+ * the regex functions, used to compile their pattern on every match attempt.
+ * Compiled patterns are kept here in an LRU keyed by the pattern text and its
+ * compile options, along with spare match data blocks.  A pattern is
+ * JIT-compiled the second time it is used, or at once for callers that are
+ * about to match it many times.
+ */
+
+#ifndef REGEXCACHE_H
+#define REGEXCACHE_H
+
+#ifndef PCRE2_CODE_UNIT_WIDTH
+#define PCRE2_CODE_UNIT_WIDTH 8
+#endif // PCRE2_CODE_UNIT_WIDTH
+#include <pcre2.h>
+#include <memory>
+
+struct regex_cache_entry;
+
+// One use of a cached pattern.  The lease keeps the compiled code alive
+// even if the entry is evicted meanwhile, and owns its match data block
+// until it is destroyed, so nested or repeated uses of the same pattern
+// never share one.
+//
+class RegexLease
+{
+public:
+    RegexLease(const UTF8 *pattern, uint32_t options, bool bJit = false);
+    ~RegexLease();
+
+    RegexLease(const RegexLease &) = delete;
+    RegexLease &operator=(const RegexLease &) = delete;
+
+    // code() is nullptr if the pattern did not compile, and error() is then
+    // the PCRE2 error code.  match_data() is nullptr if that failed, or if
+    // no match data block could be allocated.
+    //
+    pcre2_code *code(void) const;
+    pcre2_match_data *match_data(void) const { return m_md; }
+    int error(void) const { return m_errcode; }
+
+    // Match context to pass to pcre2_match().  It gives JIT code a larger
+    // stack than PCRE2's 32K default, so a pattern the interpreter can match
+    // does not start failing once it is JIT-compiled.
+    //
+    pcre2_match_context *context(void) const;
+
+private:
+    std::shared_ptr<regex_cache_entry> m_entry;
+    pcre2_match_data *m_md;
+    int m_errcode;
+};
+
+#endif // REGEXCACHE_H
@@ -32,6 +32,8 @@ public:
     bool DelAll(unsigned int object) override;
     bool GetAll(unsigned int object, AttrCallback cb) override;
     bool GetBuiltin(unsigned int object, AttrCallback cb) override;
+    bool GetMulti(const unsigned int *objects, size_t nObjects,
+                  unsigned int attrnum, ObjAttrCallback cb) override;
 
     int Count(unsigned int object) override;
     uint32_t GetModCount(unsigned int object, unsigned int attrnum) override;
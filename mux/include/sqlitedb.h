@@ -12,9 +12,13 @@
 #define SQLITEDB_H
 
 #include "sqlite3.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <mutex>
 #include <string>
 
 // When building the standalone test harness, define TINYMUX_TYPES_DEFINED
@@ -29,6 +33,42 @@ typedef unsigned char UTF8;
 constexpr dbref NOTHING = -1;
 #endif
 
+// Arbitrates the database write lock between the game thread's connection
+// and a background writer on a second connection.  The writer brackets each
+// transaction with Enter() and Leave() and, between statements, commits and
+// leaves as soon as YieldRequested() says the game thread is waiting.  The
+// game thread's side is its connection's busy handler (see
+// CSQLiteDB::SetWriteGate), so every write it makes, whatever the table, is
+// held up by at most one of the writer's statements rather than by a whole
+// batch.  There is one thread on each side.
+//
+class CSQLiteWriteGate
+{
+public:
+    // Writer side.  Enter() gives a waiting foreground write its turn first.
+    //
+    void Enter();
+    void Leave();
+    bool YieldRequested() const { return m_bClaim.load(std::memory_order_acquire); }
+
+    // Foreground side.  Returns false at once if the writer is not in a
+    // transaction, so whatever holds the lock is not ours to hurry.
+    // Otherwise asks it to yield and waits up to tMax for it to leave.
+    //
+    bool WaitForWriter(std::chrono::milliseconds tMax);
+
+    // The foreground write has committed.
+    //
+    void Done();
+
+private:
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    bool                    m_bHeld = false;
+    std::atomic<bool>       m_bClaim{false};
+    std::chrono::steady_clock::time_point m_tClaim;
+};
+
 class CSQLiteDB
 {
 public:
@@ -101,6 +141,11 @@ public:
                       size_t *pLen, dbref *owner, int *flags);
     bool PutAttribute(dbref obj, int attrnum, const UTF8 *value, size_t len,
                       dbref owner, int flags);
+    // As above with the new mod_count supplied by the caller, for a
+    // connection that must not read the engine's in-memory counters.
+    //
+    bool PutAttribute(dbref obj, int attrnum, const UTF8 *value, size_t len,
+                      dbref owner, int flags, uint32_t mod_count);
     bool DelAttribute(dbref obj, int attrnum);
     uint32_t GetAttrModCount(dbref obj, int attrnum);
     void GetAllAttrModCounts(dbref obj, std::function<void(int attrnum, uint32_t mc)> cb);
@@ -118,6 +163,16 @@ public:
     bool GetAllAttributes(dbref obj, AttrCallback cb);
     bool GetBuiltinAttributes(dbref obj, AttrCallback cb);
 
+    // One attribute from each of several objects.  Objects are queried
+    // ATTR_GET_MULTI_MAX at a time through a single prepared statement, so
+    // a parent chain costs one round trip instead of one per level.
+    //
+    static const size_t ATTR_GET_MULTI_MAX = 16;
+    typedef std::function<void(dbref obj, const UTF8 *value, size_t len,
+                               dbref owner, int flags)> ObjAttrCallback;
+    bool GetAttributeMulti(const dbref *objs, size_t nObjs, int attrnum,
+                           ObjAttrCallback cb);
+
     // Attribute name registry.
     // These correspond to vattr_define_LEN / vattr_alloc_LEN.
     //
@@ -142,9 +197,15 @@ public:
 
     // Transaction support for batching related writes.
     //
+    // Begin takes the write lock up front (BEGIN IMMEDIATE): the attribute
+    // cache's writer thread has its own connection, and a deferred
+    // transaction that read before it wrote would fail outright with
+    // SQLITE_BUSY_SNAPSHOT instead of waiting out busy_timeout.
+    //
     bool Begin();
     bool Commit();
     bool Rollback();
+    bool InTransaction() const;
 
     // Comsys operations (bulk sync + write-through).
     //
@@ -279,11 +340,37 @@ public:
     bool CodeCacheFlush();
     void CodeCacheReset();
 
-    // Maintenance
+    // Maintenance.  Checkpoint() copies the whole WAL back and resets it,
+    // except while a CSQLiteBackup of this file holds the WAL in place;
+    // then it copies what it can and leaves the reset for later.
     //
     bool Checkpoint();
     bool Optimize();
 
+    // One checkpoint attempt in the given SQLITE_CHECKPOINT_* mode, without
+    // retrying.  Returns the SQLite result code; *pnLog and *pnCkpt receive
+    // the frames in the WAL and the frames now copied into the database.
+    // A mode that waits on readers and writers gives up as soon as
+    // *pbCancel becomes true, and is not tried at all while a CSQLiteBackup
+    // of this file is in progress.
+    //
+    int CheckpointStep(int eMode, int *pnLog, int *pnCkpt,
+                       const std::atomic<bool> *pbCancel = nullptr);
+
+    // WAL size as of this connection's most recent commit, and how many
+    // commits it has made.  Both are updated from the WAL hook and may be
+    // read from any thread.
+    //
+    int WalFrames() const { return m_walFrames.load(std::memory_order_relaxed); }
+    uint32_t WalCommits() const { return m_walCommits.load(std::memory_order_relaxed); }
+    int PageSize() const { return m_pageSize; }
+
+    // Route this connection's lock waits through pGate, so that a writer
+    // holding the lock on another connection steps aside for it.  nullptr
+    // restores the plain busy_timeout.
+    //
+    void SetWriteGate(CSQLiteWriteGate *pGate);
+
     // Statistics
     //
     struct Stats
@@ -296,6 +383,7 @@ public:
         uint64_t    attr_puts;
         uint64_t    attr_dels;
         uint64_t    attr_bulk_loads;
+        uint64_t    attr_multi_gets;
     };
     Stats GetStats() const { return m_stats; }
     void ResetStats() { m_stats = {}; }
@@ -307,6 +395,19 @@ private:
     //
     std::string m_path;
 
+    // Maintained by WalHook().
+    //
+    std::atomic<int>      m_walFrames;
+    std::atomic<uint32_t> m_walCommits;
+    int                   m_pageSize;
+
+    // See SetWriteGate() and CheckpointStep().  m_tBusyStart is when the statement now waiting
+    // on the lock first found it held.
+    //
+    CSQLiteWriteGate     *m_pGate;
+    const std::atomic<bool> *m_pbCancel;
+    std::chrono::steady_clock::time_point m_tBusyStart;
+
     // Object metadata statements.
     //
     sqlite3_stmt *m_stmtObjInsert;
@@ -334,6 +435,7 @@ private:
     sqlite3_stmt *m_stmtAttrDelObj;
     sqlite3_stmt *m_stmtAttrGetObj;
     sqlite3_stmt *m_stmtAttrGetBuiltin;
+    sqlite3_stmt *m_stmtAttrGetMulti;
     sqlite3_stmt *m_stmtAttrCount;
 
     // Attribute name registry statements.
@@ -394,10 +496,56 @@ private:
     bool PrepareStatements();
     void FinalizeStatements();
     bool ConfigurePragmas();
+    static int WalHook(void *pArg, sqlite3 *db, const char *zDb, int nFrames);
+    static int BusyHandler(void *pArg, int nCalls);
 
     // Helper: execute a single-field UPDATE on the objects table.
     //
     bool UpdateSingleField(sqlite3_stmt *stmt, dbref obj, int val);
 };
 
+// Online, point-in-time copy of a database file, made a few pages at a time
+// with SQLite's backup API.  Begin() holds a read transaction on a private
+// connection to the source, so commits made meanwhile by other connections
+// neither appear in the copy nor force it to start over.  That transaction
+// keeps the source's WAL from being reset until Finish(), so CSQLiteDB
+// checkpoints of the same file do not wait for it (see Checkpoint()).
+//
+class CSQLiteBackup
+{
+public:
+    CSQLiteBackup();
+    ~CSQLiteBackup();
+
+    bool Begin(const char *pSource, const char *pDest);
+
+    // Copy up to nPages more.  Returns SQLITE_OK while there is more to do,
+    // SQLITE_DONE when the copy is complete, or an error code.
+    //
+    int Step(int nPages);
+    int Remaining() const;
+    int PageCount() const;
+
+    // Release both connections.  The copy is complete and closed only if
+    // Step() returned SQLITE_DONE; otherwise it is abandoned as is.
+    //
+    bool Finish();
+
+    const char *ErrorMessage() const { return m_error.c_str(); }
+
+    // Open a finished copy on its own and check it.  Returns an empty string
+    // if it is sound, or what is wrong.  Uses no shared state, so it may run
+    // on any thread.  Stops early, as a failure, once *pbCancel is true.
+    //
+    static std::string Verify(const char *pPath,
+                              const std::atomic<bool> *pbCancel = nullptr);
+
+private:
+    sqlite3        *m_src;
+    sqlite3        *m_dest;
+    sqlite3_backup *m_backup;
+    std::string     m_source;   // Set while the source is registered live.
+    std::string     m_error;
+};
+
 #endif // !SQLITEDB_H
@@ -68,6 +68,17 @@ public:
     virtual bool GetAll(unsigned int object, AttrCallback cb) = 0;
     virtual bool GetBuiltin(unsigned int object, AttrCallback cb) = 0;
 
+    // GetMulti: fetches one attribute from each of several objects in a
+    //           single round trip.  The callback receives each (object,
+    //           value, len, owner, flags) tuple found; objects without the
+    //           attribute are not reported.  Used to prefetch the parent
+    //           chain of an inherited attribute lookup.
+    //
+    typedef std::function<void(unsigned int object, const UTF8 *value, size_t len,
+                               int owner, int flags)> ObjAttrCallback;
+    virtual bool GetMulti(const unsigned int *objects, size_t nObjects,
+                          unsigned int attrnum, ObjAttrCallback cb) = 0;
+
     // Attribute count and mod_count access.
     //
     // Count: returns the number of attributes stored on an object.
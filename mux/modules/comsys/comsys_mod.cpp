@@ -1355,6 +1355,10 @@ void CComsysMod::SendChannelMessage(dbref executor, struct channel *ch,
         effMsgNoComtitle = ('\0' != mogMsg[0]) ? mogMsg : msgNoComtitle;
     }
 
+    // Listeners that see the same line through the same kind of client
+    // share one rendering of it.
+    //
+    m_pINotify->BeginBroadcast();
     for (auto &kv : ch->users)
     {
         comuser &user = kv.second;
@@ -1419,6 +1423,7 @@ void CComsysMod::SendChannelMessage(dbref executor, struct channel *ch,
             }
         }
     }
+    m_pINotify->EndBroadcast();
 
     // Engine only evaluates MOGRIFY`* for non-join/leave traffic
     // (comsys.cpp:1701).  Pass that through so join/leave history is not
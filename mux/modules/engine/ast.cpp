@@ -8,6 +8,7 @@
 #include "autoconf.h"
 #include "config.h"
 #include "externs.h"
+#include "engine_api.h"
 
 #include "ast.h"
 #include "functions.h"
@@ -16,6 +17,9 @@
 #include <cstring>
 #include <algorithm>
 #include <list>
+#include <new>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 
 #include "jit_tier1_stamp.h"
@@ -160,7 +164,7 @@ static bool ast_call_arg_is_deferred(const ASTNode *call, int argIndex)
     return ast_noeval_arg_is_deferred(call->noeval_kind, argIndex, nfargs);
 }
 
-static const std::string *ast_call_raw_arg(const ASTNode *call, int argIndex)
+static const ASTText *ast_call_raw_arg(const ASTNode *call, int argIndex)
 {
     if (!call || argIndex < 0)
     {
@@ -202,18 +206,36 @@ namespace
     };
 }
 
+// Children and deferred-argument records are collected on these stacks while
+// their node is being parsed, then copied into the arena as one run.  A node's
+// entries sit above any its ancestors left, and nested nodes pop theirs before
+// returning, so one pair of stacks serves the whole parse -- including the
+// structural re-parse of NOEVAL arguments, which shares the arena too.
+//
+struct ASTParseScratch {
+    std::vector<ASTNodeRef> children;
+    std::vector<ASTDeferredArg> deferred;
+    std::string raw;
+};
+
+static thread_local ASTParseScratch s_parse_scratch;
+
 class ASTParser {
 public:
-    ASTParser(const std::vector<ASTToken> &tokens)
-        : m_tokens(tokens), m_pos(0), m_bracketDepth(0), m_braceDepth(0) {}
+    ASTParser(const std::vector<ASTToken> &tokens, ASTArena &arena,
+              ASTParseScratch &scratch)
+        : m_tokens(tokens), m_arena(arena), m_scratch(scratch),
+          m_pos(0), m_bracketDepth(0), m_braceDepth(0) {}
 
-    std::unique_ptr<ASTNode> parse()
+    ASTNode *parse()
     {
         return parseSequence(false, false, false, false);
     }
 
 private:
     const std::vector<ASTToken> &m_tokens;
+    ASTArena &m_arena;
+    ASTParseScratch &m_scratch;
     size_t m_pos;
     int m_bracketDepth;
     int m_braceDepth;
@@ -227,6 +249,21 @@ private:
             || m_tokens[m_pos].type == ASTTOK_EOF;
     }
 
+    // Move everything stacked above base into the arena as node's children.
+    //
+    void commitChildren(ASTNode *node, size_t base)
+    {
+        const size_t n = m_scratch.children.size() - base;
+        if (0 < n)
+        {
+            ASTNodeRef *p = m_arena.new_array<ASTNodeRef>(n);
+            std::copy(m_scratch.children.begin() + base,
+                      m_scratch.children.end(), p);
+            node->children.assign(p, n);
+            m_scratch.children.resize(base);
+        }
+    }
+
     static bool parser_lookup_builtin_noeval(std::string_view funcName)
     {
         LBuf TempFun = LBuf_Src("lookup_noeval");
@@ -264,62 +301,74 @@ private:
         {
             return;
         }
-        call->deferred_args.emplace_back(rawTextFromTokens(start, end), false);
+        m_scratch.deferred.push_back({rawTextFromTokens(start, end), false});
     }
 
-    void parser_apply_structural_arg_policy(ASTNode *call)
+    void parser_apply_structural_arg_policy(ASTNode *call, size_t base)
     {
         if (!call || !call->parser_known_noeval)
         {
+            m_scratch.deferred.resize(base);
             return;
         }
 
-        call->deferred_args.resize(call->children.size());
-        for (int i = 0; i < static_cast<int>(call->children.size()); i++)
+        const size_t nArgs = call->children.size();
+        m_scratch.deferred.resize(base + nArgs, {ASTText(), false});
+        if (0 < nArgs)
+        {
+            ASTDeferredArg *p = m_arena.new_array<ASTDeferredArg>(nArgs);
+            std::copy(m_scratch.deferred.begin() + base,
+                      m_scratch.deferred.end(), p);
+            call->deferred_args.assign(p, nArgs);
+        }
+        m_scratch.deferred.resize(base);
+
+        for (int i = 0; i < static_cast<int>(nArgs); i++)
         {
             if (!parser_should_structuralize_arg(call, i))
             {
                 continue;
             }
 
-            call->deferred_args[i].is_deferred = true;
-            const std::string *raw = ast_call_raw_arg(call, i);
+            call->deferred_args.data()[i].is_deferred = true;
+            const ASTText *raw = ast_call_raw_arg(call, i);
             if (!raw)
             {
                 continue;
             }
 
-            auto structural = ast_parse_region(
-                ASTSourceSpan(reinterpret_cast<const UTF8 *>(raw->c_str()),
-                              raw->size()),
+            auto tokens = ast_tokenize_mode(
+                reinterpret_cast<const UTF8 *>(raw->c_str()), raw->size(),
                 ASTLEX_STRUCTURAL);
-            if (structural)
+            ASTParser structural(tokens, m_arena, m_scratch);
+            ASTNode *node = structural.parse();
+            if (node)
             {
-                call->children[i] = std::move(structural);
+                call->children.data()[i].p = node;
             }
         }
     }
 
-    std::string rawTextFromTokens(size_t start, size_t end) const
+    ASTText rawTextFromTokens(size_t start, size_t end)
     {
-        std::string raw;
+        std::string &raw = m_scratch.raw;
+        raw.clear();
         for (size_t i = start; i < end && i < m_tokens.size(); i++)
         {
             raw.append(m_tokens[i].text.data(), m_tokens[i].text.size());
         }
-        return raw;
+        return m_arena.intern(raw);
     }
 
-    std::unique_ptr<ASTNode> parseSequence(
+    ASTNode *parseSequence(
         bool stopRP, bool stopRB, bool stopRC, bool stopCM)
     {
         // Bound parser recursion: every []/{}/() nesting level re-enters here.
         //
         AstParseDepthGuard depth_guard;
-        auto seq = std::make_unique<ASTNode>(AST_SEQUENCE);
         if (depth_guard.overflow())
         {
-            return seq;
+            return m_arena.new_node(AST_SEQUENCE);
         }
         // Depth of bare parentheses opened inside this sequence (#1219).
         //
@@ -337,6 +386,7 @@ private:
         // `Meet me (Tue5pm downtown)`.
         //
         int parenDepth = 0;
+        const size_t base = m_scratch.children.size();
 
         while (!atEnd())
         {
@@ -355,41 +405,45 @@ private:
                 parenDepth--;
             }
 
-            auto node = parseOne();
+            ASTNode *node = parseOne();
             if (node)
             {
-                seq->addChild(std::move(node));
+                m_scratch.children.push_back({node});
             }
         }
-        if (seq->children.size() == 1)
+        if (m_scratch.children.size() == base + 1)
         {
-            return std::move(seq->children[0]);
+            ASTNode *only = m_scratch.children.back().p;
+            m_scratch.children.pop_back();
+            return only;
         }
+        ASTNode *seq = m_arena.new_node(AST_SEQUENCE);
+        commitChildren(seq, base);
         return seq;
     }
 
-    std::unique_ptr<ASTNode> parseOne()
+    ASTNode *parseOne()
     {
         const ASTToken &tok = peek();
         switch (tok.type)
         {
         case ASTTOK_LIT:
             {
-                auto n = std::make_unique<ASTNode>(AST_LITERAL, tok.text);
+                ASTNode *n = m_arena.new_node(AST_LITERAL, tok.text);
                 advance();
                 return n;
             }
 
         case ASTTOK_SPACE:
             {
-                auto n = std::make_unique<ASTNode>(AST_SPACE, tok.text);
+                ASTNode *n = m_arena.new_node(AST_SPACE, tok.text);
                 advance();
                 return n;
             }
 
         case ASTTOK_PCT:
             {
-                auto n = std::make_unique<ASTNode>(AST_SUBST, tok.text);
+                ASTNode *n = m_arena.new_node(AST_SUBST, tok.text);
                 advance();
                 // No DynCall support — if ( follows a substitution,
                 // the ( is just a literal parenthesis.
@@ -398,14 +452,14 @@ private:
 
         case ASTTOK_ESC:
             {
-                auto n = std::make_unique<ASTNode>(AST_ESCAPE, tok.text);
+                ASTNode *n = m_arena.new_node(AST_ESCAPE, tok.text);
                 advance();
                 return n;
             }
 
         case ASTTOK_SEMI:
             {
-                auto n = std::make_unique<ASTNode>(AST_SEMICOLON, tok.text);
+                ASTNode *n = m_arena.new_node(AST_SEMICOLON, tok.text);
                 advance();
                 return n;
             }
@@ -425,7 +479,7 @@ private:
         case ASTTOK_COMMA:
         case ASTTOK_LPAREN:
             {
-                auto n = std::make_unique<ASTNode>(AST_LITERAL, tok.text);
+                ASTNode *n = m_arena.new_node(AST_LITERAL, tok.text);
                 advance();
                 return n;
             }
@@ -436,10 +490,10 @@ private:
         return nullptr;
     }
 
-    std::unique_ptr<ASTNode> parseFuncCall()
+    ASTNode *parseFuncCall()
     {
         ASTToken funcTok = advance();
-        auto call = std::make_unique<ASTNode>(AST_FUNCCALL, funcTok.text);
+        ASTNode *call = m_arena.new_node(AST_FUNCCALL, funcTok.text);
         call->noeval_kind = ast_noeval_kind(funcTok.text);
         call->parser_known_noeval = parser_lookup_builtin_noeval(funcTok.text);
 
@@ -450,7 +504,7 @@ private:
         }
         advance(); // consume LPAREN
 
-        parseArgList(call.get());
+        parseArgList(call);
         return call;
     }
 
@@ -474,10 +528,12 @@ private:
         //
         bool inBracket = (m_bracketDepth > 0);
         bool inBrace = (m_braceDepth > 0);
+        const size_t base = m_scratch.children.size();
+        const size_t deferredBase = m_scratch.deferred.size();
         size_t argStart = m_pos;
-        auto arg = parseSequence(true, inBracket, inBrace, true);
+        ASTNode *arg = parseSequence(true, inBracket, inBrace, true);
         parser_capture_raw_arg(call, argStart, m_pos);
-        call->addChild(std::move(arg));
+        m_scratch.children.push_back({arg});
 
         while (!atEnd() && peek().type == ASTTOK_COMMA)
         {
@@ -485,7 +541,7 @@ private:
             argStart = m_pos;
             arg = parseSequence(true, inBracket, inBrace, true);
             parser_capture_raw_arg(call, argStart, m_pos);
-            call->addChild(std::move(arg));
+            m_scratch.children.push_back({arg});
         }
 
         if (!atEnd() && peek().type == ASTTOK_RPAREN)
@@ -494,17 +550,19 @@ private:
             call->has_close_paren = true;
         }
 
-        parser_apply_structural_arg_policy(call);
+        commitChildren(call, base);
+        parser_apply_structural_arg_policy(call, deferredBase);
     }
 
-    std::unique_ptr<ASTNode> parseEvalBracket()
+    ASTNode *parseEvalBracket()
     {
         advance(); // consume LBRACK
         m_bracketDepth++;
 
-        auto bracket = std::make_unique<ASTNode>(AST_EVALBRACKET);
-        auto contents = parseSequence(false, true, false, false);
-        bracket->addChild(std::move(contents));
+        ASTNode *bracket = m_arena.new_node(AST_EVALBRACKET);
+        const size_t base = m_scratch.children.size();
+        m_scratch.children.push_back({parseSequence(false, true, false, false)});
+        commitChildren(bracket, base);
 
         if (!atEnd() && peek().type == ASTTOK_RBRACK)
         {
@@ -518,14 +576,15 @@ private:
         return bracket;
     }
 
-    std::unique_ptr<ASTNode> parseBraceGroup()
+    ASTNode *parseBraceGroup()
     {
         advance(); // consume LBRACE
         m_braceDepth++;
 
-        auto group = std::make_unique<ASTNode>(AST_BRACEGROUP);
-        auto contents = parseSequence(false, false, true, false);
-        group->addChild(std::move(contents));
+        ASTNode *group = m_arena.new_node(AST_BRACEGROUP);
+        const size_t base = m_scratch.children.size();
+        m_scratch.children.push_back({parseSequence(false, false, true, false)});
+        commitChildren(group, base);
 
         if (!atEnd() && peek().type == ASTTOK_RBRACE)
         {
@@ -540,24 +599,143 @@ private:
     }
 };
 
+// ---------------------------------------------------------------
+// Arena
+// ---------------------------------------------------------------
+
+static_assert(std::is_trivially_destructible<ASTNode>::value,
+    "ASTArena frees nodes without running destructors");
+
+struct ASTArena::Block {
+    Block *pNext;
+    size_t nSize;
+};
+
+static const size_t AST_ARENA_MIN_BLOCK = 256;
+
+ASTArena::ASTArena(size_t nHint)
+{
+    // The hint is the whole first block, so a tree whose size was guessed
+    // right is contiguous.
+    //
+    const size_t nSize = (nHint < AST_ARENA_MIN_BLOCK) ? AST_ARENA_MIN_BLOCK : nHint;
+    Block *pBlock = static_cast<Block *>(::operator new(sizeof(Block) + nSize));
+    pBlock->pNext = nullptr;
+    pBlock->nSize = nSize;
+    m_pBlocks = pBlock;
+    m_pFree = reinterpret_cast<char *>(pBlock + 1);
+    m_pLimit = m_pFree + nSize;
+    m_nReserved = nSize;
+}
+
+ASTArena::~ASTArena()
+{
+    while (nullptr != m_pBlocks)
+    {
+        Block *pNext = m_pBlocks->pNext;
+        ::operator delete(m_pBlocks);
+        m_pBlocks = pNext;
+    }
+}
+
+void *ASTArena::allocate(size_t n, size_t align)
+{
+    uintptr_t p = (reinterpret_cast<uintptr_t>(m_pFree) + align - 1) & ~(align - 1);
+    if (p + n > reinterpret_cast<uintptr_t>(m_pLimit))
+    {
+        // Chain a block half the size of the last, so a low guess costs a
+        // few blocks rather than one per node, and does not double the tree.
+        //
+        size_t nSize = m_pBlocks->nSize/2;
+        if (nSize < AST_ARENA_MIN_BLOCK)
+        {
+            nSize = AST_ARENA_MIN_BLOCK;
+        }
+        if (nSize < n + align)
+        {
+            nSize = n + align;
+        }
+        Block *pBlock = static_cast<Block *>(::operator new(sizeof(Block) + nSize));
+        pBlock->pNext = m_pBlocks;
+        pBlock->nSize = nSize;
+        m_pBlocks = pBlock;
+        m_pFree = reinterpret_cast<char *>(pBlock + 1);
+        m_pLimit = m_pFree + nSize;
+        m_nReserved += nSize;
+        p = (reinterpret_cast<uintptr_t>(m_pFree) + align - 1) & ~(align - 1);
+    }
+    m_nUsed += (p + n) - reinterpret_cast<uintptr_t>(m_pFree);
+    m_pFree = reinterpret_cast<char *>(p + n);
+    return reinterpret_cast<void *>(p);
+}
+
+ASTText ASTArena::intern(std::string_view text)
+{
+    char *p = static_cast<char *>(allocate(text.size() + 1, 1));
+    memcpy(p, text.data(), text.size());
+    p[text.size()] = '\0';
+    return ASTText(p, text.size());
+}
+
+ASTNode *ASTArena::new_node(ASTNodeType t, std::string_view text)
+{
+    void *p = allocate(sizeof(ASTNode), alignof(ASTNode));
+    m_nNodes++;
+    return new (p) ASTNode(t, text.empty() ? ASTText() : intern(text));
+}
+
+void ASTArenaDelete::operator()(ASTNode *) const
+{
+    delete arena;
+}
+
 // ---------------------------------------------------------------
 // Public parse API
 // ---------------------------------------------------------------
 
-std::unique_ptr<ASTNode> ast_parse(const std::vector<ASTToken> &tokens)
+ASTTree ast_parse(const std::vector<ASTToken> &tokens)
 {
-    ASTParser parser(tokens);
-    return parser.parse();
+    // A node, a child link, and the text for each token that opens or is a
+    // node.  Commas and closers make none, but a multi-part argument adds a
+    // sequence node, so they are allowed a link and half a node.
+    //
+    size_t nHint = 0;
+    for (const auto &tok : tokens)
+    {
+        switch (tok.type)
+        {
+        case ASTTOK_LPAREN:
+        case ASTTOK_EOF:
+            break;
+
+        case ASTTOK_COMMA:
+        case ASTTOK_RPAREN:
+        case ASTTOK_RBRACK:
+        case ASTTOK_RBRACE:
+            nHint += sizeof(ASTNodeRef) + sizeof(ASTNode)/2;
+            break;
+
+        default:
+            nHint += sizeof(ASTNode) + sizeof(ASTNodeRef) + tok.text.size() + 1;
+            break;
+        }
+    }
+
+    std::unique_ptr<ASTArena> arena(new ASTArena(nHint));
+    s_parse_scratch.children.clear();
+    s_parse_scratch.deferred.clear();
+    ASTParser parser(tokens, *arena, s_parse_scratch);
+    ASTNode *root = parser.parse();
+    return ASTTree(root, ASTArenaDelete{arena.release()});
 }
 
-std::unique_ptr<ASTNode> ast_parse_region(ASTSourceSpan span,
-                                          ASTLexMode mode)
+ASTTree ast_parse_region(ASTSourceSpan span, ASTLexMode mode)
 {
     auto tokens = ast_tokenize_mode(span.input, span.nLen, mode);
     return ast_parse(tokens);
 }
 
-std::unique_ptr<ASTNode> ast_parse_string(const UTF8 *input, size_t nLen)
+ASTTree ast_parse_string(const UTF8 *input, size_t nLen)
 {
     return ast_parse_region(ASTSourceSpan(input, nLen), ASTLEX_EVAL);
 }
@@ -586,7 +764,8 @@ std::string ast_raw_text(const ASTNode *n)
 
     case AST_FUNCCALL:
         {
-            std::string r = n->text + "(";
+            std::string r(n->text);
+            r += "(";
             for (size_t i = 0; i < n->children.size(); i++)
             {
                 if (i > 0) r += ",";
@@ -739,7 +918,7 @@ static void ast_eval_node(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
 //   Pass 2: eval -- re-tokenize the result and evaluate it
 //
 static void ast_eval_deferred_region(const ASTNode *node,
-    const ASTNode *noevalNode, const std::string *rawText, UTF8 *buff,
+    const ASTNode *noevalNode, const ASTText *rawText, UTF8 *buff,
     UTF8 **bufc, dbref executor, dbref caller, dbref enactor,
     int eval, const UTF8 *cargs[], int ncargs)
 {
@@ -1491,8 +1670,9 @@ static void ast_eval_branch(const ASTNode *callNode, int childIndex,
     int eval, const UTF8 *cargs[], int ncargs)
 {
     const ASTNode *noevalNode = nullptr;
-    const std::string *rawText = nullptr;
+    const ASTText *rawText = nullptr;
     std::string fallbackRaw;
+    ASTText fallbackText;
     if (ast_call_arg_is_deferred(callNode, childIndex))
     {
         noevalNode = child;
@@ -1501,7 +1681,8 @@ static void ast_eval_branch(const ASTNode *callNode, int childIndex,
     else if (child)
     {
         fallbackRaw = ast_raw_text(child);
-        rawText = &fallbackRaw;
+        fallbackText = ASTText(fallbackRaw);
+        rawText = &fallbackText;
     }
 
     ast_eval_deferred_region(child, noevalNode, rawText, buff, bufc,
@@ -1848,6 +2029,261 @@ static void ast_noeval_iter(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
     }
 }
 
+// Argument buffers for function calls.
+//
+// Every argument of every call used to take a whole LBUF from the pool and
+// hold it until the call returned, so nested u() or a wide switch() pinned
+// depth x arity LBUFs for arguments that are mostly a few bytes.  They are
+// now carved, in stack order, from one arena per thread.
+//
+// An argument being evaluated gets a window of LBUF_SIZE bytes at the top,
+// so the safe_*() limits, which are measured from the start of the buffer,
+// mean what they always did.  Anything its evaluation allocates goes above
+// the window and is released before the evaluation returns.  The window then
+// shrinks to what was written, so only the argument in progress at each
+// nesting level holds a full LBUF's worth.  A call gives back everything it
+// took when it returns (ASTArgScope), and once nothing is live the arena
+// frees all but its first block.
+//
+class ASTArgArena
+{
+public:
+    struct Mark
+    {
+        size_t iBlock;
+        size_t nTop;
+    };
+
+    ~ASTArgArena()
+    {
+        for (auto p : m_blocks)
+        {
+            MEMFREE(p);
+        }
+    }
+
+    Mark mark() const { return {m_iBlock, m_nTop}; }
+
+    void release(const Mark &m)
+    {
+        m_iBlock = m.iBlock;
+        m_nTop = m.nTop;
+        if (  0 == m_iBlock
+           && 0 == m_nTop)
+        {
+            while (1 < m_blocks.size())
+            {
+                MEMFREE(m_blocks.back());
+                m_blocks.pop_back();
+            }
+        }
+    }
+
+    // An LBUF_SIZE window to evaluate into.  Nothing else may be taken from
+    // the arena until close() unless it is released first.
+    //
+    UTF8 *open()
+    {
+        return reserve(LBUF_SIZE);
+    }
+
+    // Keep [p, pEnd) of the window open() returned, and return the rest.
+    //
+    void close(const UTF8 *p, const UTF8 *pEnd)
+    {
+        mux_assert(p + LBUF_SIZE == m_blocks[m_iBlock] + m_nTop);
+        m_nTop = static_cast<size_t>(pEnd - m_blocks[m_iBlock]);
+    }
+
+    // A copy of pText[0..nLen) with a '\0' after it.
+    //
+    UTF8 *copy(const UTF8 *pText, size_t nLen)
+    {
+        UTF8 *p = reserve(nLen + 1);
+        memcpy(p, pText, nLen);
+        p[nLen] = '\0';
+        return p;
+    }
+
+private:
+    static const size_t BLOCK_SIZE = 8 * LBUF_SIZE;
+
+    UTF8 *reserve(size_t n)
+    {
+        if (  m_blocks.empty()
+           || BLOCK_SIZE - m_nTop < n)
+        {
+            if (!m_blocks.empty())
+            {
+                m_iBlock++;
+            }
+            m_nTop = 0;
+            if (m_blocks.size() <= m_iBlock)
+            {
+                UTF8 *pBlock = static_cast<UTF8 *>(MEMALLOC(BLOCK_SIZE));
+                if (nullptr == pBlock)
+                {
+                    OutOfMemory(reinterpret_cast<const UTF8 *>(__FILE__), __LINE__);
+                }
+                m_blocks.push_back(pBlock);
+            }
+        }
+        UTF8 *p = m_blocks[m_iBlock] + m_nTop;
+        m_nTop += n;
+        return p;
+    }
+
+    std::vector<UTF8 *> m_blocks;
+    size_t m_iBlock = 0;
+    size_t m_nTop = 0;
+};
+
+static thread_local ASTArgArena s_argArena;
+
+class ASTArgScope
+{
+public:
+    ASTArgScope() : m_mark(s_argArena.mark()) {}
+    ~ASTArgScope() { s_argArena.release(m_mark); }
+
+    ASTArgScope(const ASTArgScope &) = delete;
+    ASTArgScope &operator=(const ASTArgScope &) = delete;
+
+private:
+    ASTArgArena::Mark m_mark;
+};
+
+// Per-command memo of FN_PURE builtins (function_memo_max).
+//
+// A pure builtin's output depends only on its evaluated arguments, so
+// within one command a repeat of the same call -- the lnum() or extract()
+// on an invariant list inside an iter() body -- can replay the earlier
+// result instead of recomputing it.  Both dispatchers use it: the AST
+// evaluator below and the compiled route's ecall_invoke_fun().  The key is
+// the FUN pointer followed by each argument and its terminating NUL.  The
+// memo is emptied at the start of each command and flushed wholesale when
+// it fills.
+//
+// A result is kept only if it stopped short of the end of the output
+// buffer, and replayed only where it fits, so a replay writes exactly what
+// the call would have.  Both dispatchers charge the invocation and
+// recursion limits before they get here, so a hit counts against them like
+// any other call.
+//
+static std::unordered_map<std::string, std::string> s_funcMemo;
+static std::string s_funcMemoKey;
+static bool     s_funcMemoPending = false;
+static size_t   s_funcMemoBytes   = 0;
+static uint64_t s_funcMemoHits    = 0;
+static uint64_t s_funcMemoMisses  = 0;
+static uint64_t s_funcMemoFlushes = 0;
+
+static size_t function_memo_max(void)
+{
+    if (mudconf.function_memo_max <= 0)
+    {
+        return 0;
+    }
+    return static_cast<size_t>(std::min(mudconf.function_memo_max, 65536));
+}
+
+// Write the remembered result of fp(fargs) at *bufc and return true, or
+// return false and leave the key for function_memo_store().  Nothing can
+// rebuild the key in between: an FN_PURE builtin evaluates no softcode.
+//
+bool function_memo_replay(const FUN *fp, const UTF8 * const fargs[],
+    int nfargs, UTF8 *buff, UTF8 **bufc)
+{
+    s_funcMemoPending = false;
+    if (  0 == (fp->flags & FN_PURE)
+       || 0 == function_memo_max()
+       || alarm_clock.alarmed)
+    {
+        return false;
+    }
+
+    s_funcMemoKey.assign(reinterpret_cast<const char *>(&fp), sizeof(fp));
+    for (int i = 0; i < nfargs; i++)
+    {
+        s_funcMemoKey.append(reinterpret_cast<const char *>(fargs[i]),
+            strlen(reinterpret_cast<const char *>(fargs[i])) + 1);
+    }
+
+    const auto it = s_funcMemo.find(s_funcMemoKey);
+    if (  it != s_funcMemo.end()
+       && it->second.size() <= static_cast<size_t>(buff + LBUF_SIZE - 1 - *bufc))
+    {
+        s_funcMemoHits++;
+        memcpy(*bufc, it->second.data(), it->second.size());
+        *bufc += it->second.size();
+        **bufc = '\0';
+        return true;
+    }
+    s_funcMemoMisses++;
+    s_funcMemoPending = true;
+    return false;
+}
+
+// Remember what the call function_memo_replay() just declined wrote
+// between pStart and pEnd.
+//
+void function_memo_store(const UTF8 *buff, const UTF8 *pStart, const UTF8 *pEnd)
+{
+    if (!s_funcMemoPending)
+    {
+        return;
+    }
+    s_funcMemoPending = false;
+    if (  buff + LBUF_SIZE - 1 <= pEnd
+       || alarm_clock.alarmed)
+    {
+        return;
+    }
+
+    const size_t nResult = static_cast<size_t>(pEnd - pStart);
+    const size_t nMax = function_memo_max();
+    if (  nMax <= s_funcMemo.size()
+       || nMax * 1024 < s_funcMemoBytes + s_funcMemoKey.size() + nResult)
+    {
+        s_funcMemo.clear();
+        s_funcMemoBytes = 0;
+        s_funcMemoFlushes++;
+    }
+    if (s_funcMemo.emplace(s_funcMemoKey,
+            std::string(reinterpret_cast<const char *>(pStart), nResult)).second)
+    {
+        s_funcMemoBytes += s_funcMemoKey.size() + nResult;
+    }
+}
+
+void ast_function_memo_reset(void)
+{
+    if (!s_funcMemo.empty())
+    {
+        s_funcMemo.clear();
+        s_funcMemoBytes = 0;
+    }
+}
+
+void list_function_memo_stats(dbref player)
+{
+    const uint64_t total = s_funcMemoHits + s_funcMemoMisses;
+    UTF8 szHitPct[64];
+    mux_sprintf(szHitPct, sizeof(szHitPct), T("%.1f"),
+        (0 < total) ? (100.0 * s_funcMemoHits / total) : 0.0);
+
+    notify(player, M_("--- Pure Function Memo ---"));
+    notify(player, tprintf(T("Entries: %lu   Max: %lu   Hits: %llu   Misses: %llu   Hit rate: %s%%"),
+        static_cast<unsigned long>(s_funcMemo.size()),
+        static_cast<unsigned long>(function_memo_max()),
+        static_cast<unsigned long long>(s_funcMemoHits),
+        static_cast<unsigned long long>(s_funcMemoMisses),
+        szHitPct));
+    notify(player, tprintf(T("Bytes: %lu   Flushes: %llu"),
+        static_cast<unsigned long>(s_funcMemoBytes),
+        static_cast<unsigned long long>(s_funcMemoFlushes)));
+}
+
 // ulambda(body, arg0, arg1, ...): anonymous function evaluation.
 //
 // The first argument (body) is received UNEVALUATED — the parser's
@@ -1877,10 +2313,11 @@ static void ast_noeval_ulambda(const ASTNode *node,
     // EV_STRIP_CURLY|EV_EVAL but WITHOUT EV_FCHECK so inner function
     // names like mul(...) are emitted as literal text, not dispatched.
     //
-    LBuf raw_arg0 = LBuf_Src("ulambda.arg0");
+    ASTArgScope args;
+    UTF8 *raw_arg0 = s_argArena.open();
     UTF8 *rp = raw_arg0;
 
-    const std::string *rawText = ast_call_raw_arg(node, 0);
+    const ASTText *rawText = ast_call_raw_arg(node, 0);
     if (rawText && !rawText->empty()) {
         UTF8 *rawCopy = alloc_lbuf("ulambda.raw");
         size_t rawLen = rawText->size();
@@ -1895,6 +2332,7 @@ static void ast_noeval_ulambda(const ASTNode *node,
         free_lbuf(rawCopy);
     }
     *rp = '\0';
+    s_argArena.close(raw_arg0, rp + 1);
 
     // Evaluate the remaining arguments (these are NOT deferred).
     //
@@ -1904,12 +2342,13 @@ static void ast_noeval_ulambda(const ASTNode *node,
     int real_nfargs = nfargs;
     if (real_nfargs > MAX_ARG) real_nfargs = MAX_ARG;
     for (int i = 1; i < real_nfargs; i++) {
-        fargs[i] = alloc_lbuf("ulambda.arg");
+        fargs[i] = s_argArena.open();
         UTF8 *bp = fargs[i];
         ast_eval_node(node->children[i].get(), fargs[i], &bp,
             executor, executor, enactor,
             eval | EV_FCHECK | EV_EVAL, cargs, ncargs);
         *bp = '\0';
+        s_argArena.close(fargs[i], bp + 1);
     }
 
     // Use parse_and_get_attrib to handle #lambda/, #apply/, obj/attr.
@@ -1918,10 +2357,10 @@ static void ast_noeval_ulambda(const ASTNode *node,
     dbref thing;
     dbref aowner;
     int aflags;
+    ASTAttrSource source;
     if (!parse_and_get_attrib(executor, fargs, &atext, &thing,
-                               &aowner, &aflags, buff, bufc))
+                               &aowner, &aflags, buff, bufc, &source))
     {
-        for (int i = 1; i < real_nfargs; i++) free_lbuf(fargs[i]);
         return;
     }
 
@@ -1950,8 +2389,8 @@ static void ast_noeval_ulambda(const ASTNode *node,
             AttrTrace(aflags, EV_FCHECK | EV_EVAL),
             const_cast<const UTF8 **>(&fargs[1]), real_nfargs - 1);
     }
+    source.release();
     free_lbuf(atext);
-    for (int i = 1; i < real_nfargs; i++) free_lbuf(fargs[i]);
 }
 
 // Dispatch table for native NOEVAL handling. Returns true if the
@@ -2025,7 +2464,7 @@ static std::string ast_raw_arg_text(const ASTNode *callNode, int argIndex)
     {
         return "";
     }
-    if (const std::string *raw = ast_call_raw_arg(callNode, argIndex))
+    if (const ASTText *raw = ast_call_raw_arg(callNode, argIndex))
     {
         return *raw;
     }
@@ -2060,6 +2499,8 @@ static void ast_emit_literal_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bu
     safe_chr(')', buff, bufc);
 }
 
+static inline uint32_t function_table_epoch(void);
+
 // Evaluate a function call node (AST_FUNCCALL).
 //
 static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
@@ -2097,8 +2538,6 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
         return;
     }
 
-    // Uppercase the function name for lookup.
-    //
     size_t nName = node->text.size();
     if (nName == 0 || nName > MAX_UFUN_NAME_LEN)
     {
@@ -2107,41 +2546,46 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
         return;
     }
 
-    LBuf TempFun = LBuf_Src("ast_eval_funccall");
-    memcpy(TempFun, node->text.c_str(), nName);
-    TempFun[nName] = '\0';
-    size_t nUpper;
-    UTF8 *pUpper = mux_strupr(TempFun, nUpper);
-    if (nUpper >= LBUF_SIZE)
-    {
-        nUpper = LBUF_SIZE - 1;
-    }
-    memcpy(TempFun, pUpper, nUpper);
-    TempFun[nUpper] = '\0';
-
-    std::vector<UTF8> name_key(TempFun.get(), TempFun.get() + nUpper);
-    FUN *fp = nullptr;
-    UFUN *ufp = nullptr;
-
-    const auto it = mudstate.builtin_functions.find(name_key);
-    if (it != mudstate.builtin_functions.end())
+    // The name is fixed and the tree is cached, so resolve it once and
+    // keep the answer on the node until the function tables change.
+    //
+    const uint32_t epoch = function_table_epoch();
+    if (node->fn_epoch != epoch)
     {
-        fp = it->second;
-    }
+        size_t nUpper;
+        UTF8 *pUpper = mux_strupr(
+            reinterpret_cast<const UTF8 *>(node->text.c_str()), nUpper);
+        std::vector<UTF8> name_key(pUpper, pUpper + nUpper);
 
-    if (!fp)
-    {
-        auto it_ufunc = mudstate.ufunc_htab.find(name_key);
-        ufp = (it_ufunc != mudstate.ufunc_htab.end())
-            ? static_cast<UFUN*>(it_ufunc->second) : nullptr;
+        node->fn_builtin = nullptr;
+        node->fn_ufun = nullptr;
+        const auto it = mudstate.builtin_functions.find(name_key);
+        if (it != mudstate.builtin_functions.end())
+        {
+            node->fn_builtin = it->second;
+        }
+        else
+        {
+            auto it_ufunc = mudstate.ufunc_htab.find(name_key);
+            if (it_ufunc != mudstate.ufunc_htab.end())
+            {
+                node->fn_ufun = static_cast<UFUN*>(it_ufunc->second);
+            }
+        }
+        node->fn_epoch = epoch;
     }
+    FUN *fp = node->fn_builtin;
+    UFUN *ufp = node->fn_ufun;
 
     if (!fp && !ufp)
     {
         if (eval & EV_FMAND)
         {
+            size_t nUpper;
+            UTF8 *pUpper = mux_strupr(
+                reinterpret_cast<const UTF8 *>(node->text.c_str()), nUpper);
             safe_str(S_("#-1 FUNCTION ("), buff, bufc);
-            safe_str(TempFun, buff, bufc);
+            safe_copy_buf(pUpper, nUpper, buff, bufc);
             safe_str(T(") NOT FOUND"), buff, bufc);
             s_fmand_abort = true;
         }
@@ -2192,6 +2636,8 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
         int aflags;
         UTF8 *tbuf = atr_get("ast_eval.ufun", ufp->obj, ufp->atr,
             &aowner, &aflags);
+        ASTAttrSource source;
+        source.bind(tbuf, ufp->obj, ufp->atr);
 
         dbref obj = (ufp->flags & FN_PRIV) ? ufp->obj : executor;
 
@@ -2203,16 +2649,18 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
 
         // Evaluate arguments for UFUN.
         //
+        ASTArgScope args;
         UTF8 *fargs[MAX_ARG];
         memset(fargs, 0, sizeof(fargs));
         for (int i = 0; i < nfargs; i++)
         {
-            fargs[i] = alloc_lbuf("ast_eval.ufun.arg");
+            fargs[i] = s_argArena.open();
             UTF8 *bp = fargs[i];
             ast_eval_node(node->children[i].get(), fargs[i], &bp,
                 executor, caller, enactor,
                 eval | EV_FCHECK | EV_EVAL, cargs, ncargs);
             *bp = '\0';
+            s_argArena.close(fargs[i], bp + 1);
         }
 
         if ((aflags & AF_NOEVAL) || NoEval(ufp->obj))
@@ -2241,10 +2689,7 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
             }
         }
 
-        for (int i = 0; i < nfargs; i++)
-        {
-            free_lbuf(fargs[i]);
-        }
+        source.release();
         free_lbuf(tbuf);
     }
     else
@@ -2281,6 +2726,7 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
                 return;
             }
 
+            ASTArgScope args;
             UTF8 *fargs[MAX_ARG];
             memset(fargs, 0, sizeof(fargs));
             int feval;
@@ -2294,20 +2740,19 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
                 feval = eval & ~(EV_EVAL | EV_TOP | EV_FMAND | EV_STRIP_CURLY);
                 for (int i = 0; i < nfargs; i++)
                 {
-                    fargs[i] = alloc_lbuf("ast_eval.noeval");
-
                     if (i < nfargs - 1 || nParsed <= nfargs)
                     {
                         std::string raw = ast_raw_arg_text(node, i);
                         size_t len = raw.size();
                         if (len >= LBUF_SIZE) len = LBUF_SIZE - 1;
-                        memcpy(fargs[i], raw.c_str(), len);
-                        fargs[i][len] = '\0';
+                        fargs[i] = s_argArena.copy(
+                            reinterpret_cast<const UTF8 *>(raw.c_str()), len);
                     }
                     else
                     {
                         // Catenate remaining children with commas.
                         //
+                        fargs[i] = s_argArena.open();
                         UTF8 *bp = fargs[i];
                         for (int j = i; j < nParsed; j++)
                         {
@@ -2317,6 +2762,7 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
                                 fargs[i], &bp);
                         }
                         *bp = '\0';
+                        s_argArena.close(fargs[i], bp + 1);
                     }
                 }
             }
@@ -2327,7 +2773,7 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
                 feval = eval & ~(EV_TOP | EV_FMAND);
                 for (int i = 0; i < nfargs; i++)
                 {
-                    fargs[i] = alloc_lbuf("ast_eval.arg");
+                    fargs[i] = s_argArena.open();
                     UTF8 *bp = fargs[i];
 
                     if (i < nfargs - 1 || nParsed <= nfargs)
@@ -2349,17 +2795,22 @@ static void ast_eval_funccall(const ASTNode *node, UTF8 *buff, UTF8 **bufc,
                         }
                     }
                     *bp = '\0';
+                    s_argArena.close(fargs[i], bp + 1);
                 }
             }
 
+            if (function_memo_replay(fp, fargs, nfargs, buff, &oldp))
+            {
+                *bufc = oldp;
+                mudstate.func_nest_lev--;
+                return;
+            }
+
+            UTF8 *pStart = oldp;
             fp->fun(fp, buff, &oldp, executor, caller, enactor,
                 feval & EV_TRACE, fargs, nfargs, cargs, ncargs);
+            function_memo_store(buff, pStart, oldp);
             *bufc = oldp;
-
-            for (int i = 0; i < nfargs; i++)
-            {
-                free_lbuf(fargs[i]);
-            }
         }
         else
         {
@@ -2693,18 +3144,203 @@ void ast_exec(const UTF8 *pStr, size_t nStr,
 // Parsing is pure (no side effects), so cached ASTs are safe
 // to share across evaluations with different contexts.
 //
+// The map is keyed by a hash of the text, and the entry holds the one copy
+// of the text, so a lookup hashes the caller's buffer in place and compares
+// it against the entry -- no key string is built per call.  Two texts with
+// the same hash share a slot; the later one evicts the earlier.
+//
+// Text that came straight from an attribute (ASTAttrSource) is also indexed
+// by (object, attribute) and stamped with that attribute's mod count, which
+// atr_add_raw_LEN, atr_clr, and object destruction all bump.  A matching
+// stamp names the cached entry without reading the text at all.  The index
+// is bounded by clearing it wholesale; a lost entry costs one hash.
+//
+// Capacity is ast_cache_max, read at insert time.
+//
 
 struct ASTCacheEntry
 {
+    std::string text;
     std::shared_ptr<ASTNode> ast;
-    std::list<std::string>::iterator lru_it;
+    std::list<uint64_t>::iterator lru_it;
+};
+
+struct ASTAttrCacheEntry
+{
+    uint64_t hash;
+    size_t   nLen;
+    uint32_t mod_count;
 };
 
-static std::unordered_map<std::string, ASTCacheEntry> s_astCache;
-static std::list<std::string> s_astLru;
-static const size_t AST_CACHE_MAX = 1024;
+static std::unordered_map<uint64_t, ASTCacheEntry> s_astCache;
+static std::list<uint64_t> s_astLru;
+static std::unordered_map<uint64_t, ASTAttrCacheEntry> s_astAttrIndex;
 static const size_t AST_CACHE_MIN_LEN = 16;
 
+static uint64_t s_ast_hits = 0;
+static uint64_t s_ast_attr_hits = 0;
+static uint64_t s_ast_misses = 0;
+
+static size_t ast_cache_max(void)
+{
+    int n = mudconf.ast_cache_max;
+    if (n < 16)
+    {
+        n = 16;
+    }
+    else if (n > 1048576)
+    {
+        n = 1048576;
+    }
+    return static_cast<size_t>(n);
+}
+
+static ASTAttrSource *s_attrSources = nullptr;
+
+void ASTAttrSource::bind(const UTF8 *pText, dbref obj, int attrnum)
+{
+    release();
+    m_pText = pText;
+    m_nLen = strlen(reinterpret_cast<const char *>(pText));
+    m_key = (static_cast<uint64_t>(static_cast<uint32_t>(obj)) << 32)
+          | static_cast<uint32_t>(attrnum);
+    m_mod_count = attr_mod_count_get(obj, attrnum);
+    m_pNext = s_attrSources;
+    s_attrSources = this;
+}
+
+void ASTAttrSource::release()
+{
+    if (nullptr == m_pText)
+    {
+        return;
+    }
+    for (ASTAttrSource **pp = &s_attrSources; nullptr != *pp; pp = &(*pp)->m_pNext)
+    {
+        if (*pp == this)
+        {
+            *pp = m_pNext;
+            break;
+        }
+    }
+    m_pText = nullptr;
+    m_pNext = nullptr;
+}
+
+const ASTAttrSource *ASTAttrSource::find(const UTF8 *pText)
+{
+    for (const ASTAttrSource *p = s_attrSources; nullptr != p; p = p->m_pNext)
+    {
+        if (p->m_pText == pText)
+        {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+// Find or parse the tree for pStr[0..nLen).  pSource, when given, is the
+// attribute pStr was fetched from, unmodified and of exactly nLen bytes.
+//
+static std::shared_ptr<ASTNode> ast_cache_lookup(const UTF8 *pStr, size_t nLen,
+    const ASTAttrSource *pSource)
+{
+    if (nullptr != pSource)
+    {
+        const auto itAttr = s_astAttrIndex.find(pSource->key());
+        if (  itAttr != s_astAttrIndex.end()
+           && itAttr->second.mod_count == pSource->mod_count()
+           && itAttr->second.nLen == nLen)
+        {
+            const auto it = s_astCache.find(itAttr->second.hash);
+            if (  it != s_astCache.end()
+               && it->second.text.size() == nLen)
+            {
+                s_ast_attr_hits++;
+                s_astLru.splice(s_astLru.begin(), s_astLru, it->second.lru_it);
+                return it->second.ast;
+            }
+        }
+    }
+
+    const std::string_view text(reinterpret_cast<const char *>(pStr), nLen);
+    const uint64_t hash = std::hash<std::string_view>{}(text);
+    std::shared_ptr<ASTNode> ast;
+
+    auto it = s_astCache.find(hash);
+    if (  it != s_astCache.end()
+       && it->second.text == text)
+    {
+        // Cache hit — move to front of LRU.
+        //
+        s_ast_hits++;
+        s_astLru.splice(s_astLru.begin(), s_astLru, it->second.lru_it);
+        ast = it->second.ast;
+    }
+    else
+    {
+        // Cache miss — parse and insert.
+        //
+        s_ast_misses++;
+        ast = std::shared_ptr<ASTNode>(ast_parse_string(pStr, nLen));
+        if (it != s_astCache.end())
+        {
+            s_astLru.erase(it->second.lru_it);
+            s_astCache.erase(it);
+        }
+
+        // Evict LRU entries if cache is full.
+        //
+        const size_t nMax = ast_cache_max();
+        while (s_astCache.size() >= nMax)
+        {
+            s_astCache.erase(s_astLru.back());
+            s_astLru.pop_back();
+        }
+
+        s_astLru.push_front(hash);
+        s_astCache[hash] = {std::string(text), ast, s_astLru.begin()};
+    }
+
+    if (nullptr != pSource)
+    {
+        if (s_astAttrIndex.size() >= 2 * ast_cache_max())
+        {
+            s_astAttrIndex.clear();
+        }
+        s_astAttrIndex[pSource->key()] = {hash, nLen, pSource->mod_count()};
+    }
+    return ast;
+}
+
+// Counters restart from 0 when attr_mod_count_invalidate_all() clears them,
+// so an index entry could match a rewritten attribute at a reused count.
+//
+void ast_attr_index_invalidate_all(void)
+{
+    s_astAttrIndex.clear();
+}
+
+void list_ast_cache_stats(dbref player)
+{
+    const uint64_t hits = s_ast_hits + s_ast_attr_hits;
+    const uint64_t total = hits + s_ast_misses;
+    UTF8 szHitPct[64];
+    mux_sprintf(szHitPct, sizeof(szHitPct), T("%.1f"),
+        (0 < total) ? (100.0 * hits / total) : 0.0);
+
+    notify(player, M_("--- Parse Cache ---"));
+    notify(player, tprintf(T("Entries: %lu   Max: %lu   Hits: %llu   Misses: %llu   Hit rate: %s%%"),
+        static_cast<unsigned long>(s_astCache.size()),
+        static_cast<unsigned long>(ast_cache_max()),
+        static_cast<unsigned long long>(hits),
+        static_cast<unsigned long long>(s_ast_misses),
+        szHitPct));
+    notify(player, tprintf(T("By attribute: %llu   Attributes indexed: %lu"),
+        static_cast<unsigned long long>(s_ast_attr_hits),
+        static_cast<unsigned long>(s_astAttrIndex.size())));
+}
+
 // ---------------------------------------------------------------
 // Stamp for the memoized jit_can_handle() verdict (#2068).
 //
@@ -2748,6 +3384,14 @@ void jit_gate_note_function_table_change(void)
 #endif
 }
 
+// Also stamps the function-call bindings on FUNCCALL nodes, which do not
+// care about the toggle.
+//
+static inline uint32_t function_table_epoch(void)
+{
+    return s_jit_gate_epoch;
+}
+
 static inline uint32_t jit_gate_stamp_now(void)
 {
     return s_jit_gate_epoch | (mudconf.jit_eval_brackets ? 1u : 0u);
@@ -2781,51 +3425,29 @@ void mux_exec(const UTF8 *pStr, size_t nStr,
     }
 
     // nStr is a buffer-size limit, not the string length.
-    // Use the actual string length for caching and parsing.
+    // Use the actual string length for caching and parsing.  An attribute
+    // source already knows it.
     //
-    size_t nLen = strlen(reinterpret_cast<const char *>(pStr));
+    const ASTAttrSource *pSource = ASTAttrSource::find(pStr);
+    size_t nLen = (nullptr != pSource)
+        ? pSource->length()
+        : strlen(reinterpret_cast<const char *>(pStr));
     if (nLen > nStr)
     {
         nLen = nStr;
+        pSource = nullptr;
     }
 
     // Look up in the parse cache.
     //
     const ASTNode *ast_ptr;
     std::shared_ptr<ASTNode> cache_holder;
-    std::unique_ptr<ASTNode> parse_holder;
+    ASTTree parse_holder;
 
     if (nLen >= AST_CACHE_MIN_LEN)
     {
-        std::string key(reinterpret_cast<const char *>(pStr), nLen);
-        auto it = s_astCache.find(key);
-        if (it != s_astCache.end())
-        {
-            // Cache hit — move to front of LRU.
-            //
-            cache_holder = it->second.ast;
-            s_astLru.splice(s_astLru.begin(), s_astLru, it->second.lru_it);
-            ast_ptr = cache_holder.get();
-        }
-        else
-        {
-            // Cache miss — parse and insert.
-            //
-            cache_holder = std::shared_ptr<ASTNode>(
-                ast_parse_string(pStr, nLen).release());
-            ast_ptr = cache_holder.get();
-
-            // Evict LRU entries if cache is full.
-            //
-            while (s_astCache.size() >= AST_CACHE_MAX)
-            {
-                s_astCache.erase(s_astLru.back());
-                s_astLru.pop_back();
-            }
-
-            s_astLru.push_front(key);
-            s_astCache[key] = {cache_holder, s_astLru.begin()};
-        }
+        cache_holder = ast_cache_lookup(pStr, nLen, pSource);
+        ast_ptr = cache_holder.get();
     }
     else
     {
@@ -3076,8 +3698,10 @@ FUNCTION(fun_asteval)
 // astbench(<expr>, <iterations>)
 //
 // Runs the expression through both the AST evaluator and the JIT,
-// reports microseconds per call for each.  Output format:
-//   ast=X.XXus jit=Y.YYus ratio=Z.Zx result=<value>
+// reports microseconds per call for each, and what parsing it costs: the
+// tree's node count, the bytes its arena reserved, and microseconds per
+// parse.  Output format:
+//   ast=X.XXus nodes=N arena=BB parse=P.PPus jit=Y.YYus ratio=Z.Zx result=<value>
 // ---------------------------------------------------------------
 
 FUNCTION(fun_astbench)
@@ -3138,6 +3762,26 @@ FUNCTION(fun_astbench)
                    + (t1.tv_nsec - t0.tv_nsec) / 1e3) / iterations;
 #endif
 
+    // --- Parse benchmark ---
+#ifdef WIN32
+    QueryPerformanceCounter(&pc0);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+#endif
+    for (int i = 0; i < iterations; i++) {
+        auto reparsed = ast_parse_string(expr, nLen);
+    }
+#ifdef WIN32
+    QueryPerformanceCounter(&pc1);
+    double parse_us = (double)(pc1.QuadPart - pc0.QuadPart) * 1e6
+                    / ((double)freq.QuadPart * iterations);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double parse_us = ((t1.tv_sec - t0.tv_sec) * 1e6
+                     + (t1.tv_nsec - t0.tv_nsec) / 1e3) / iterations;
+#endif
+    const ASTArena *arena = ast.get_deleter().arena;
+
     // --- JIT benchmark ---
 #if defined(TINYMUX_JIT)
     // Warm the compile cache, then discard what the warm-up emitted.
@@ -3219,10 +3863,13 @@ FUNCTION(fun_astbench)
     // this pattern for the same reason.
     //
     char ast_buf[32];
+    char parse_buf[32];
     char jit_buf[32];
     char ratio_buf[32];
     mux_sprintf(reinterpret_cast<UTF8 *>(ast_buf), sizeof(ast_buf),
         T("%.2f"), ast_us);
+    mux_sprintf(reinterpret_cast<UTF8 *>(parse_buf), sizeof(parse_buf),
+        T("%.2f"), parse_us);
     if (bAllHandled) {
         mux_sprintf(reinterpret_cast<UTF8 *>(jit_buf), sizeof(jit_buf),
             T("%.2fus"), jit_us);
@@ -3242,6 +3889,8 @@ FUNCTION(fun_astbench)
     }
 
     safe_tprintf_str(buff, bufc,
-        T("ast=%sus jit=%s ratio=%s result=%s"),
-        ast_buf, jit_buf, ratio_buf, result.get());
+        T("ast=%sus nodes=%u arena=%u parse=%sus jit=%s ratio=%s result=%s"),
+        ast_buf, static_cast<unsigned int>(arena->nodes()),
+        static_cast<unsigned int>(arena->bytes()), parse_buf,
+        jit_buf, ratio_buf, result.get());
 }
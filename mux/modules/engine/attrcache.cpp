@@ -5,9 +5,12 @@
  * disk-based mode. It's not used in memory-based builds. The lower-level
  * storage is either CHashFile (.dir/.pag) or SQLite (.db).
  *
- * The upper-level cache is organized by an unordered_map and a linked list.
- * The former allows random access while the linked list helps find the
- * least-recently-used attribute.
+ * The upper-level cache is organized in two levels -- an unordered_map of
+ * per-object records keyed by dbref, each holding an unordered_map of entries
+ * keyed by attrnum -- plus two intrusive lists threaded through the entries.
+ * The maps allow random access and keep per-object work proportional to the
+ * object, while the lists find the least-recently-used clean attribute and
+ * keep dirty ones pinned.
  */
 
 #include "copyright.h"
@@ -16,8 +19,15 @@
 #include "externs.h"
 using namespace std;
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
 
+#include "engine_api.h"
 #include "sqlite_backend.h"
 
 CSQLiteBackend *g_pSQLiteBackend = nullptr;
@@ -29,13 +39,166 @@ static bool cache_initted = false;
 thread_local UTF8 sqlite_attr_buf[LBUF_SIZE];
 
 static size_t cache_size = 0;
+static size_t cache_entries = 0;
 static uint64_t cache_hits = 0;
 static uint64_t cache_misses = 0;
 
+// Adaptive prefetch counters (see cache_get).  Loaded counts the speculative
+// entries a prefetch brought in beside the one that was asked for; used and
+// wasted split those by whether anything read them before they were evicted
+// or overwritten.
+//
+static uint64_t cache_prefetches = 0;
+static uint64_t cache_prefetch_loaded = 0;
+static uint64_t cache_prefetch_used = 0;
+static uint64_t cache_prefetch_wasted = 0;
+static uint64_t cache_prefetch_oversize = 0;
+static uint64_t cache_single_loads = 0;
+
+// Parent-chain prefetch counters (see cache_prefetch_chain).
+//
+static uint64_t cache_chain_prefetches = 0;
+static uint64_t cache_chain_levels = 0;
+static uint64_t cache_chain_found = 0;
+
+typedef statedata::AttrCacheEntry  AttrCacheEntry;
+typedef statedata::AttrCacheObject AttrCacheObject;
+typedef unordered_map<dbref, AttrCacheObject, dbrefHasher>::iterator AttrCacheObjectIt;
+
+static AttrCacheObject *cache_find_object(dbref obj)
+{
+    const auto it = mudstate.attribute_cache_objects.find(obj);
+    if (it == mudstate.attribute_cache_objects.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+static AttrCacheEntry *cache_find_entry(AttrCacheObject *pObj, unsigned int attrnum)
+{
+    if (nullptr == pObj)
+    {
+        return nullptr;
+    }
+    const auto it = pObj->attrs.find(attrnum);
+    if (it == pObj->attrs.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+// Drop an object's record once nothing in it is worth remembering.  A record
+// with no entries is still kept while it carries a preload mark or a cached
+// attribute-number list, because both answer questions without SQLite, and
+// once it has missed, because the miss count is what cache_get's prefetch
+// decision is made on.  Eviction and cache_sweep_miss_records() clear that
+// count again.
+//
+static bool cache_object_idle(const AttrCacheObject &o)
+{
+    return o.attrs.empty()
+        && 0 == o.misses
+        && !o.preloaded_builtin
+        && !o.preloaded_all
+        && !o.attrnum_list_valid;
+}
+
+static void cache_release_object(dbref obj)
+{
+    const auto it = mudstate.attribute_cache_objects.find(obj);
+    if (  it != mudstate.attribute_cache_objects.end()
+       && cache_object_idle(it->second))
+    {
+        mudstate.attribute_cache_objects.erase(it);
+    }
+}
+
+// A record that has only missed -- the attributes asked for did not exist,
+// or what was read has since been evicted -- holds nothing but its miss
+// count.  Forget those counts wholesale once the map has doubled since the
+// last sweep, so objects touched once do not keep a record for the life of
+// the process.  An object that keeps missing simply earns its prefetch
+// again.
+//
+static size_t s_objects_swept_at = 0;
+
+static void cache_sweep_miss_records(void)
+{
+    if (mudstate.attribute_cache_objects.size() <= 2 * s_objects_swept_at + 1024)
+    {
+        return;
+    }
+    for (auto it = mudstate.attribute_cache_objects.begin();
+         it != mudstate.attribute_cache_objects.end(); )
+    {
+        if (it->second.attrs.empty())
+        {
+            it->second.misses = 0;
+        }
+        if (cache_object_idle(it->second))
+        {
+            it = mudstate.attribute_cache_objects.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    s_objects_swept_at = mudstate.attribute_cache_objects.size();
+}
+
+// Insert an entry for attrnum on pObj and thread it onto list.  The caller
+// fills in the value and flags.
+//
+static AttrCacheEntry *cache_insert_entry(AttrCacheObject *pObj, dbref obj,
+    unsigned int attrnum, statedata::AttrCacheList &list)
+{
+    AttrCacheEntry &entry = pObj->attrs[attrnum];
+    entry.object     = static_cast<unsigned int>(obj);
+    entry.attrnum    = attrnum;
+    entry.attr_owner = NOTHING;
+    entry.attr_flags = 0;
+    entry.dirty      = false;
+    entry.tombstone  = false;
+    entry.prefetched = false;
+    entry.write_seq  = 0;
+    list.push_back(&entry);
+    cache_entries++;
+    return &entry;
+}
+
+// Unthread and erase an entry.  Does not release the object record.
+//
+static void cache_erase_entry(AttrCacheObject *pObj, AttrCacheEntry *pEntry)
+{
+    if (pEntry->prefetched)
+    {
+        cache_prefetch_wasted++;
+    }
+    if (pEntry->dirty)
+    {
+        mudstate.attribute_pinned_list.remove(pEntry);
+        pObj->dirty.erase(pEntry->attrnum);
+    }
+    else
+    {
+        mudstate.attribute_lru_cache_list.remove(pEntry);
+    }
+    cache_size -= pEntry->data.size();
+    pObj->size -= pEntry->data.size();
+    cache_entries--;
+    const unsigned int attrnum = pEntry->attrnum;
+    pObj->attrs.erase(attrnum);
+}
+
 // ---------------------------------------------------------------------------
-// Write queue: batches Put/Del operations and flushes them in a single
-// BEGIN/COMMIT transaction.  Flushed on threshold, on demand-driven
-// deferred task, and before sync/close/tick.
+// Write queue: batches Put/Del operations and commits them in a single
+// BEGIN/COMMIT transaction.  The queue is handed off as a batch on
+// threshold or after cache_write_delay, and normally committed by the
+// writer thread below; cache_flush_writes() waits for everything to land
+// before sync/close.
 // ---------------------------------------------------------------------------
 
 struct CacheWriteOp
@@ -47,6 +210,7 @@ struct CacheWriteOp
     vector<UTF8>    value;      // empty for OP_DEL
     int             owner;
     int             flags;
+    uint32_t        mod_count;  // OP_PUT; filled in when the batch is sent.
 
     // OP_CODE_CACHE_PUT fields.
     //
@@ -72,99 +236,1037 @@ struct CacheWriteOp
     vector<char>    cc_deps;
 };
 
-static vector<CacheWriteOp> s_write_queue;
-static unordered_map<Aname, size_t, AnameHasher> s_attr_write_index;
+static vector<CacheWriteOp> s_write_queue;
+static unordered_map<Aname, size_t, AnameHasher> s_attr_write_index;
+static size_t s_write_queue_bytes = 0;
+
+// Batch sequence number the open queue will be committed under.  Each dirty
+// entry is stamped with it (write_seq), so when an older batch lands, an
+// entry written again since is left pinned for the batch that carries it.
+//
+static uint64_t s_write_seq = 1;
+
+static size_t write_op_bytes(const CacheWriteOp &op)
+{
+    return op.value.size()
+         + op.cc_memory.size()
+         + op.cc_code.size()
+         + op.cc_str.size()
+         + op.cc_fargs.size()
+         + op.cc_deps.size();
+}
+
+// Which attribute numbers an object has, as SQLite sees them (#2077).
+//
+// atr_head/atr_next need this list, and collect_attrnums_from_storage() used
+// to answer with a GetAll() query every time.  For $-command matching that is
+// one database round trip per object in scope on every line a player types --
+// 200 objects in a master room cost ~1.4ms per command, ~67% of it inside
+// SQLite and its file locking.
+//
+// This caches the STORAGE half only.  The pending overlay stays live on every
+// lookup (cache_collect_pending_attrnums), because it changes as the write
+// queue drains and must not be baked in.
+//
+// The list lives on the object's cache record (mudconf.h), so a lookup or an
+// invalidation is the same single probe the value cache already does.
+//
+// Invalidation is narrow: an object's list changes only when an attribute
+// appears or disappears, never when a value changes.  Entries are dropped
+// when a write is queued (which also covers the bStandAlone paths that write
+// through to SQLite directly) AND again when the queue flushes -- the second
+// is not redundant.  A list cached between queue and flush is correct only
+// while the overlay still reports the pending attribute; once the flush
+// clears the dirty flag the overlay goes quiet, and a stale cached list would
+// silently lose the attribute.
+static size_t s_attrnum_lists = 0;
+
+// Crude but predictable bound.  These are small (a vector<int> per object
+// ever enumerated), so this is generous; clearing wholesale on overflow costs
+// one repopulation rather than adding an eviction policy nothing has asked
+// for yet.
+static const size_t ATTRNUM_LIST_CACHE_MAX = 65536;
+
+static void cache_drop_attrnum_list(AttrCacheObject *pObj)
+{
+    if (pObj->attrnum_list_valid)
+    {
+        pObj->attrnum_list_valid = false;
+        vector<int>().swap(pObj->attrnum_list);
+        s_attrnum_lists--;
+    }
+}
+
+void cache_invalidate_attrnum_list(dbref thing)
+{
+    if (0 == s_attrnum_lists)
+    {
+        return;
+    }
+    AttrCacheObject *pObj = cache_find_object(thing);
+    if (  nullptr != pObj
+       && pObj->attrnum_list_valid)
+    {
+        cache_drop_attrnum_list(pObj);
+        cache_release_object(thing);
+    }
+}
+
+bool cache_lookup_attrnum_list(dbref thing, vector<int> &attrnums)
+{
+    const AttrCacheObject *pObj = cache_find_object(thing);
+    if (  nullptr == pObj
+       || !pObj->attrnum_list_valid)
+    {
+        return false;
+    }
+    attrnums = pObj->attrnum_list;
+    return true;
+}
+
+static void cache_clear_attrnum_lists(void)
+{
+    for (auto it = mudstate.attribute_cache_objects.begin();
+         it != mudstate.attribute_cache_objects.end(); )
+    {
+        cache_drop_attrnum_list(&it->second);
+        if (cache_object_idle(it->second))
+        {
+            it = mudstate.attribute_cache_objects.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    s_attrnum_lists = 0;
+}
+
+void cache_store_attrnum_list(dbref thing, const vector<int> &attrnums)
+{
+    if (s_attrnum_lists >= ATTRNUM_LIST_CACHE_MAX)
+    {
+        cache_clear_attrnum_lists();
+    }
+    AttrCacheObject &o = mudstate.attribute_cache_objects[thing];
+    if (!o.attrnum_list_valid)
+    {
+        o.attrnum_list_valid = true;
+        s_attrnum_lists++;
+    }
+    o.attrnum_list = attrnums;
+}
+// OP_CODE_CACHE_PUT is keyed by source_hash, not Aname (#1284 residual).
+static unordered_map<string, size_t> s_code_cache_write_index;
+static bool s_flush_scheduled = false;
+static const size_t WRITE_QUEUE_THRESHOLD = 50;
+
+// Forward declaration.
+//
+bool cache_flush_writes(void);
+static void cache_submit_writes(void);
+static void cache_reap_writes(void);
+static void trim_attribute_cache(void);
+static bool cache_obj_preloaded(dbref obj, bool bAll);
+static bool cache_load_obj(dbref obj, bool bAll, bool bPrefetch,
+    unsigned int attrnumWanted);
+
+// ---------------------------------------------------------------------------
+// Background writer.
+//
+// A flush used to run on the game thread, so a burst of writes stalled every
+// player for the length of an SQLite transaction.  Now the game thread hands
+// the queue off as an immutable batch and goes on; the writer thread commits
+// it on a connection of its own, taking every batch that arrived while it
+// was busy into the same transaction (group commit).
+//
+// The game thread still writes object rows, names, comsys, mail and the
+// like through its own connection, and SQLite has one write lock.  So the
+// writer takes its transactions through a CSQLiteWriteGate: when a game
+// thread write finds the lock held, the writer commits after the statement
+// it is on and lets it in, then carries on in a fresh transaction.
+//
+// Until a batch is acknowledged its entries stay pinned and dirty in the
+// cache, so reads, the attrnum overlay, and eviction see exactly what they
+// saw while the batch sat in the queue.  Acknowledgements are only acted on
+// by the game thread (cache_reap_writes), so nothing else is shared.
+// ---------------------------------------------------------------------------
+
+struct CacheWriteBatch
+{
+    uint64_t             seq;
+    size_t               bytes;
+    vector<CacheWriteOp> ops;
+};
+typedef shared_ptr<const CacheWriteBatch> CacheWriteBatchPtr;
+
+// Apply one op inside a transaction the caller owns.
+//
+static bool apply_write_op(CSQLiteDB &db, const CacheWriteOp &op)
+{
+    if (op.op == CacheWriteOp::OP_PUT)
+    {
+        if (!db.PutAttribute(static_cast<dbref>(op.object),
+            static_cast<int>(op.attrnum), op.value.data(), op.value.size(),
+            static_cast<dbref>(op.owner), op.flags, op.mod_count))
+        {
+            return false;
+        }
+    }
+    else if (op.op == CacheWriteOp::OP_DEL)
+    {
+        if (!db.DelAttribute(static_cast<dbref>(op.object),
+            static_cast<int>(op.attrnum)))
+        {
+            return false;
+        }
+    }
+    else if (op.op == CacheWriteOp::OP_CODE_CACHE_PUT)
+    {
+        if (!db.CodeCachePut(
+            op.cc_source_hash.data(),
+            static_cast<int>(op.cc_source_hash.size()),
+            op.cc_blob_hash.data(),
+            static_cast<int>(op.cc_blob_hash.size()),
+            op.cc_memory.data(),
+            static_cast<int>(op.cc_memory.size()),
+            op.cc_code.data(),
+            static_cast<int>(op.cc_code.size()),
+            op.cc_entry_pc,
+            op.cc_code_size,
+            op.cc_str.data(),
+            static_cast<int>(op.cc_str.size()),
+            op.cc_str_pool_end,
+            op.cc_fargs.data(),
+            static_cast<int>(op.cc_fargs.size()),
+            op.cc_fargs_pool_end,
+            op.cc_out_pool_end,
+            op.cc_out_addr,
+            op.cc_needs_jit,
+            op.cc_folds,
+            op.cc_ecalls,
+            op.cc_tier2_calls,
+            op.cc_native_ops,
+            op.cc_max_func_depth,
+            op.cc_n_func_calls,
+            op.cc_deps.data(),
+            static_cast<int>(op.cc_deps.size())))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool apply_write_ops(CSQLiteDB &db, const vector<CacheWriteOp> &ops)
+{
+    for (const auto &op : ops)
+    {
+        if (!apply_write_op(db, op))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The mod_count a put is written with comes from the engine's in-memory
+// counters, which only the game thread may read.  Taken when the batch
+// leaves the queue -- the moment the synchronous flush used to take it.
+//
+static void stamp_mod_counts(vector<CacheWriteOp> &ops)
+{
+    for (auto &op : ops)
+    {
+        if (op.op == CacheWriteOp::OP_PUT)
+        {
+            op.mod_count = attr_mod_count_get(static_cast<dbref>(op.object),
+                static_cast<int>(op.attrnum)) + 1;
+        }
+    }
+}
+
+// WAL checkpoint scheduling.  Automatic checkpointing is off (see
+// CSQLiteDB::ConfigurePragmas), so left alone the WAL would grow until the
+// next @dump and then be copied back in one long stall.  Instead, the writer
+// thread polls this between batches: once the WAL has grown by
+// wal_checkpoint_pages since the last step, it runs a PASSIVE checkpoint,
+// which copies what it can without waiting on anyone, so each step is about
+// that many pages.  Only after wal_checkpoint_idle with no commits does it
+// run a TRUNCATE checkpoint, the kind that waits for readers and writers,
+// to reset the WAL file.
+//
+// The WAL is fed by two connections, the game thread's and the writer's.
+// Each reports its commits through its WAL hook; only a connection that has
+// committed since the last step says anything current about the WAL size.
+//
+class CWalCheckpointer
+{
+public:
+    struct Stats
+    {
+        uint64_t steps;         // PASSIVE checkpoints run.
+        uint64_t frames;        // Pages those copied into the database.
+        uint64_t truncates;
+        uint64_t busy;          // Attempts that could not finish.
+        uint64_t step_us;
+        uint64_t max_step_us;
+        int      wal_frames;    // WAL size, in pages, as last known.
+        int      lag;           // Pages in the WAL not yet copied back.
+        int64_t  idle_ms;       // Time since either connection committed.
+    };
+
+    // Settings are copied in by the game thread; the writer thread only
+    // ever reads these copies.
+    //
+    void SetPolicy(int nPages, int64_t idle_ms)
+    {
+        m_nPages.store(nPages, std::memory_order_relaxed);
+        m_idle_ms.store(idle_ms, std::memory_order_relaxed);
+    }
+
+    // Run at most one checkpoint on db.  pOther is the second connection
+    // writing the same WAL, if any.
+    //
+    void Poll(CSQLiteDB &db, const CSQLiteDB *pOther)
+    {
+        const int nPages = m_nPages.load(std::memory_order_relaxed);
+        if (nPages <= 0)
+        {
+            return;
+        }
+
+        const auto tNow = std::chrono::steady_clock::now();
+        int eMode;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Observe(&db, pOther, tNow);
+            if (  !m_bKnown
+               || nPages <= m_lag)
+            {
+                eMode = SQLITE_CHECKPOINT_PASSIVE;
+            }
+            else if (  0 < m_nLog
+                    && std::chrono::milliseconds(m_idle_ms.load(std::memory_order_relaxed))
+                       <= tNow - m_tLastCommit)
+            {
+                eMode = SQLITE_CHECKPOINT_TRUNCATE;
+            }
+            else
+            {
+                return;
+            }
+        }
+
+        // The game thread's own full checkpoint goes first (see HoldOff).
+        // m_mutex is not held across SQLite, so GetStats() never waits on
+        // a checkpoint.
+        //
+        std::unique_lock<std::mutex> ckpt(m_ckptMutex, std::try_to_lock);
+        if (!ckpt.owns_lock())
+        {
+            return;
+        }
+        int nLog = 0;
+        int nCkpt = 0;
+        const int rc = db.CheckpointStep(eMode, &nLog, &nCkpt, &m_bHeldOff);
+        const uint64_t us = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - tNow).count());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.step_us += us;
+        if (m_stats.max_step_us < us)
+        {
+            m_stats.max_step_us = us;
+        }
+
+        if (SQLITE_OK == rc)
+        {
+            if (SQLITE_CHECKPOINT_TRUNCATE == eMode)
+            {
+                m_stats.truncates++;
+                nLog = 0;
+                nCkpt = 0;
+            }
+            else
+            {
+                // nCkpt counts from the start of the WAL, which starts over
+                // once it has been completely copied back.
+                //
+                const int nBase = (m_bKnown && m_nCkpt <= nCkpt) ? m_nCkpt : 0;
+                m_stats.steps++;
+                m_stats.frames += static_cast<uint64_t>(nCkpt - nBase);
+            }
+            m_nLog = nLog;
+            m_nCkpt = nCkpt;
+            m_lag = nLog - nCkpt;
+            m_bKnown = true;
+        }
+        else
+        {
+            // Another checkpoint in progress, readers and writers that did
+            // not clear within busy_timeout, or the game thread wanting its
+            // own.  Wait for the next quiet spell rather than retrying at
+            // every poll.
+            //
+            m_stats.busy++;
+            m_tLastCommit = tNow;
+        }
+    }
+
+    // The game thread has just run a full checkpoint of its own.
+    //
+    void Invalidate(void)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bKnown = false;
+    }
+
+    // Bracket the game thread's own full checkpoint so the two do not
+    // contend for the checkpoint lock.  A TRUNCATE step the writer is
+    // waiting in gives up rather than make the game thread wait it out.
+    //
+    void HoldOff(void)
+    {
+        m_bHeldOff.store(true, std::memory_order_release);
+        m_ckptMutex.lock();
+    }
+
+    void Resume(void)
+    {
+        m_ckptMutex.unlock();
+        m_bHeldOff.store(false, std::memory_order_release);
+    }
+
+    Stats GetStats(const CSQLiteDB *pOne, const CSQLiteDB *pOther)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto tNow = std::chrono::steady_clock::now();
+        Observe(pOne, pOther, tNow);
+        Stats st = m_stats;
+        st.wal_frames = m_nLog;
+        st.lag = m_lag;
+        st.idle_ms = static_cast<int64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                tNow - m_tLastCommit).count());
+        return st;
+    }
+
+private:
+    // Fold in what the WAL hooks have seen since we last looked.
+    //
+    void Observe(const CSQLiteDB *pOne, const CSQLiteDB *pOther,
+        std::chrono::steady_clock::time_point tNow)
+    {
+        int nFrames = -1;
+        const CSQLiteDB *aSource[2] = { pOne, pOther };
+        for (int i = 0; i < 2; i++)
+        {
+            if (nullptr == aSource[i])
+            {
+                continue;
+            }
+            const uint32_t nCommits = aSource[i]->WalCommits();
+            if (nCommits != m_nCommits[i])
+            {
+                m_nCommits[i] = nCommits;
+                if (nFrames < aSource[i]->WalFrames())
+                {
+                    nFrames = aSource[i]->WalFrames();
+                }
+            }
+        }
+        if (0 <= nFrames)
+        {
+            m_tLastCommit = tNow;
+            if (m_nLog <= nFrames)
+            {
+                m_lag = nFrames - m_nCkpt;
+            }
+            else
+            {
+                // Smaller than before: the WAL was reset and refilled.
+                //
+                m_nCkpt = 0;
+                m_lag = nFrames;
+            }
+            m_nLog = nFrames;
+        }
+    }
+
+    // m_ckptMutex is held across a checkpoint, by whichever thread runs
+    // it; m_mutex only ever briefly, for the fields below it.  Taken in
+    // that order.
+    //
+    std::mutex               m_ckptMutex;
+    std::atomic<bool>        m_bHeldOff{false};
+    std::mutex               m_mutex;
+    std::atomic<int>         m_nPages{0};
+    std::atomic<int64_t>     m_idle_ms{0};
+    bool                     m_bKnown = false;
+    int                      m_nLog = 0;
+    int                      m_nCkpt = 0;
+    int                      m_lag = 0;
+    uint32_t                 m_nCommits[2] = { 0, 0 };
+    std::chrono::steady_clock::time_point m_tLastCommit = std::chrono::steady_clock::now();
+    Stats                    m_stats{};
+};
+
+static CWalCheckpointer s_checkpointer;
+static const std::chrono::milliseconds WAL_POLL_INTERVAL(100);
+
+class CCacheWriter
+{
+public:
+    struct Stats
+    {
+        uint64_t batches;       // Batches committed.
+        uint64_t commits;       // Transactions; fewer than batches when grouped.
+        uint64_t yields;        // Transactions cut short for the game thread.
+        uint64_t ops;
+        uint64_t bytes;
+        uint64_t failures;      // Transactions rolled back and retried.
+        uint64_t commit_us;     // Total time inside transactions.
+        uint64_t max_commit_us;
+    };
+
+    ~CCacheWriter()
+    {
+        Stop();
+    }
+
+    // pMain is the game thread's connection, whose commits the checkpoint
+    // scheduler also has to account for, and whose writes go ahead of ours.
+    //
+    bool Start(const char *pPath, CSQLiteDB *pMain)
+    {
+        if (!m_db.Open(pPath))
+        {
+            return false;
+        }
+        m_pMain = pMain;
+        m_pMain->SetWriteGate(&m_gate);
+        try
+        {
+            m_thread = std::thread(&CCacheWriter::Run, this);
+        }
+        catch (const std::system_error &)
+        {
+            m_pMain->SetWriteGate(nullptr);
+            m_pMain = nullptr;
+            m_db.Close();
+            return false;
+        }
+        return true;
+    }
+
+    // Returns once the thread has gone.  A batch that keeps failing is left
+    // behind rather than retried forever; the caller can see it from Acked().
+    //
+    void Stop(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStop = true;
+        }
+        m_cvWork.notify_one();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        if (nullptr != m_pMain)
+        {
+            m_pMain->SetWriteGate(nullptr);
+            m_pMain = nullptr;
+        }
+        m_db.Close();
+    }
+
+    void Submit(const CacheWriteBatchPtr &batch)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.push_back(batch);
+        }
+        m_cvWork.notify_one();
+    }
+
+    uint64_t Acked(void) const
+    {
+        return m_acked.load(std::memory_order_acquire);
+    }
+
+    // Block until batch seq has landed.  Returns false instead if a commit
+    // fails first, so a caller that must have the data durable can say so
+    // rather than hang on a full disk.
+    //
+    bool Wait(uint64_t seq)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const uint64_t failures = m_stats.failures;
+        m_cvDone.wait(lock, [this, seq, failures]
+        {
+            return seq <= Acked()
+                || failures != m_stats.failures;
+        });
+        return seq <= Acked();
+    }
+
+    Stats GetStats(void)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    // Start no new transaction or checkpoint step, and return once the one
+    // in progress, if any, is done.  Batches keep queuing meanwhile.
+    //
+    void Pause(void)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_bPaused = true;
+        m_cvIdle.wait(lock, [this]
+        {
+            return !m_bBusy;
+        });
+    }
+
+    void Resume(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bPaused = false;
+        }
+        m_cvWork.notify_one();
+    }
+
+    const CSQLiteDB &DB(void) const
+    {
+        return m_db;
+    }
+
+private:
+    // Commit the group, in one transaction unless the game thread asks for
+    // the lock part way.  A failure rolls back only the open transaction;
+    // the retry starts the group over, which rewrites the same final values.
+    //
+    bool CommitGroup(const vector<CacheWriteBatchPtr> &group, uint64_t &nCommits)
+    {
+        size_t iBatch = 0;
+        size_t iOp = 0;
+        for (;;)
+        {
+            while (  iBatch < group.size()
+                  && group[iBatch]->ops.size() <= iOp)
+            {
+                iBatch++;
+                iOp = 0;
+            }
+            if (group.size() <= iBatch)
+            {
+                return true;
+            }
+
+            m_gate.Enter();
+            bool bOk = m_db.Begin();
+            if (bOk)
+            {
+                // At least one op per transaction, so a busy game thread
+                // cannot hold us off forever.
+                //
+                do
+                {
+                    bOk = apply_write_op(m_db, group[iBatch]->ops[iOp]);
+                    if (group[iBatch]->ops.size() <= ++iOp)
+                    {
+                        iBatch++;
+                        iOp = 0;
+                    }
+                } while (  bOk
+                        && iBatch < group.size()
+                        && !m_gate.YieldRequested());
+
+                if (bOk)
+                {
+                    bOk = m_db.Commit();
+                }
+                if (!bOk)
+                {
+                    m_db.Rollback();
+                }
+            }
+            m_gate.Leave();
+            if (!bOk)
+            {
+                return false;
+            }
+            nCommits++;
+        }
+    }
+
+    // Called with m_mutex held.
+    //
+    void SetBusy(bool bBusy)
+    {
+        m_bBusy = bBusy;
+        if (!bBusy)
+        {
+            m_cvIdle.notify_one();
+        }
+    }
+
+    void Run(void)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            // Between batches, and every WAL_POLL_INTERVAL when there are
+            // none, see whether the WAL wants a checkpoint step.
+            //
+            if (!m_cvWork.wait_for(lock, WAL_POLL_INTERVAL, [this]
+                {
+                    return m_bStop
+                        || (!m_bPaused && !m_pending.empty());
+                }))
+            {
+                if (!m_bPaused)
+                {
+                    SetBusy(true);
+                    lock.unlock();
+                    s_checkpointer.Poll(m_db, m_pMain);
+                    lock.lock();
+                    SetBusy(false);
+                }
+                continue;
+            }
+            if (m_pending.empty())
+            {
+                break;
+            }
+
+            // Group commit: everything handed off so far.
+            //
+            vector<CacheWriteBatchPtr> group(m_pending.begin(), m_pending.end());
+            SetBusy(true);
+            lock.unlock();
+
+            const auto tStart = std::chrono::steady_clock::now();
+            uint64_t nCommits = 0;
+            const bool bOk = CommitGroup(group, nCommits);
+            const uint64_t us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - tStart).count());
+
+            lock.lock();
+            if (bOk)
+            {
+                m_pending.erase(m_pending.begin(), m_pending.begin() + group.size());
+                for (const auto &batch : group)
+                {
+                    m_stats.ops += batch->ops.size();
+                    m_stats.bytes += batch->bytes;
+                }
+                m_stats.batches += group.size();
+                m_stats.commits += nCommits;
+                if (1 < nCommits)
+                {
+                    m_stats.yields += nCommits - 1;
+                }
+                m_stats.commit_us += us;
+                if (m_stats.max_commit_us < us)
+                {
+                    m_stats.max_commit_us = us;
+                }
+                m_acked.store(group.back()->seq, std::memory_order_release);
+                m_cvDone.notify_one();
+
+                lock.unlock();
+                s_checkpointer.Poll(m_db, m_pMain);
+                lock.lock();
+                SetBusy(false);
+            }
+            else
+            {
+                // Busy past busy_timeout, or a real I/O error.  Keep the
+                // batches and try again shortly; the game thread logs it.
+                //
+                SetBusy(false);
+                m_stats.failures++;
+                m_cvDone.notify_one();
+                m_cvWork.wait_for(lock, std::chrono::seconds(1), [this]
+                {
+                    return m_bStop;
+                });
+                if (m_bStop)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    CSQLiteDB                  m_db;
+    CSQLiteDB                 *m_pMain = nullptr;
+    CSQLiteWriteGate           m_gate;
+    std::thread                m_thread;
+    std::mutex                 m_mutex;
+    std::condition_variable    m_cvWork;
+    std::condition_variable    m_cvDone;
+    std::condition_variable    m_cvIdle;
+    deque<CacheWriteBatchPtr>  m_pending;
+    std::atomic<uint64_t>      m_acked{0};
+    bool                       m_bStop = false;
+    bool                       m_bPaused = false;  // Held for a fork().
+    bool                       m_bBusy = false;    // In SQLite, off m_mutex.
+    Stats                      m_stats{};
+};
+
+static CCacheWriter *s_pWriter = nullptr;
+static bool s_writer_failed = false;
+static string s_cache_path;
 
-// Which attribute numbers an object has, as SQLite sees them (#2077).
-//
-// atr_head/atr_next need this list, and collect_attrnums_from_storage() used
-// to answer with a GetAll() query every time.  For $-command matching that is
-// one database round trip per object in scope on every line a player types --
-// 200 objects in a master room cost ~1.4ms per command, ~67% of it inside
-// SQLite and its file locking.
-//
-// This caches the STORAGE half only.  The pending overlay stays live on every
-// lookup (cache_collect_pending_attrnums), because it changes as the write
-// queue drains and must not be baked in.
+// Batches handed to the writer and not yet reaped, oldest first.
 //
-// Invalidation is narrow: an object's list changes only when an attribute
-// appears or disappears, never when a value changes.  Entries are dropped
-// when a write is queued (which also covers the bStandAlone paths that write
-// through to SQLite directly) AND again when the queue flushes -- the second
-// is not redundant.  A list cached between queue and flush is correct only
-// while the overlay still reports the pending attribute; once the flush
-// clears the dirty flag the overlay goes quiet, and a stale cached list would
-// silently lose the attribute.
-static unordered_map<dbref, vector<int>> s_attrnum_list_cache;
+static deque<CacheWriteBatchPtr> s_inflight;
+static uint64_t s_writer_failures_logged = 0;
 
-// Crude but predictable bound.  These are small (a vector<int> per object
-// ever enumerated), so this is generous; clearing wholesale on overflow costs
-// one repopulation rather than adding an eviction policy nothing has asked
-// for yet.
-static const size_t ATTRNUM_LIST_CACHE_MAX = 65536;
+static void cache_writer_policy(void)
+{
+    s_checkpointer.SetPolicy(mudconf.wal_checkpoint_pages,
+        mudconf.wal_checkpoint_idle.ReturnMilliseconds());
+}
 
-void cache_invalidate_attrnum_list(dbref thing)
+// The writer thread, if there can be one.  It commits write batches when
+// cache_write_thread is on and schedules WAL checkpoints regardless.
+//
+static CCacheWriter *cache_writer(void)
 {
-    if (!s_attrnum_list_cache.empty())
+    if (  mudstate.bStandAlone
+       || mudstate.bSQLiteLoading
+       || s_writer_failed)
+    {
+        return nullptr;
+    }
+#if defined(HAVE_WORKING_FORK)
+    if (mudstate.write_protect)
+    {
+        return nullptr;
+    }
+#endif // HAVE_WORKING_FORK
+
+    // Started on first use rather than in cache_init, so no thread exists
+    // across anything startup might fork.  A private in-memory database
+    // cannot be shared with a second connection at all.
+    //
+    if (nullptr == s_pWriter)
     {
-        s_attrnum_list_cache.erase(thing);
+        if (  s_cache_path.empty()
+           || s_cache_path == ":memory:"
+           || nullptr == g_pSQLiteBackend)
+        {
+            s_writer_failed = true;
+            return nullptr;
+        }
+        cache_writer_policy();
+        s_pWriter = new CCacheWriter;
+        if (!s_pWriter->Start(s_cache_path.c_str(), &g_pSQLiteBackend->GetDB()))
+        {
+            delete s_pWriter;
+            s_pWriter = nullptr;
+            s_writer_failed = true;
+            Log.tinyprintf(T("cache_writer: could not start; committing writes on the game thread." ENDLINE));
+            return nullptr;
+        }
     }
+    return s_pWriter;
 }
 
-bool cache_lookup_attrnum_list(dbref thing, vector<int> &attrnums)
+static bool cache_writer_usable(void)
+{
+    return mudconf.cache_write_thread
+        && nullptr != cache_writer();
+}
+
+// A batch has landed in SQLite: unpin what it wrote.  Tombstones are
+// removed from cache entirely; dirty puts are cleared and moved from the
+// pinned list to the LRU list -- unless the entry has been written again
+// since, in which case a later batch owns it.
+//
+static void cache_retire_writes(const vector<CacheWriteOp> &ops, uint64_t seq)
 {
-    const auto it = s_attrnum_list_cache.find(thing);
-    if (it == s_attrnum_list_cache.end())
+    if (!mudstate.bStandAlone)
     {
-        return false;
+        for (const auto &op : ops)
+        {
+            if (op.op == CacheWriteOp::OP_PUT || op.op == CacheWriteOp::OP_DEL)
+            {
+                const dbref obj = static_cast<dbref>(op.object);
+                AttrCacheObject *pObj = cache_find_object(obj);
+                AttrCacheEntry *pEntry = cache_find_entry(pObj, op.attrnum);
+                if (  nullptr != pEntry
+                   && pEntry->write_seq <= seq)
+                {
+                    if (pEntry->tombstone)
+                    {
+                        cache_erase_entry(pObj, pEntry);
+                        cache_release_object(obj);
+                    }
+                    else if (pEntry->dirty)
+                    {
+                        // Move from pinned to LRU (evictable).
+                        //
+                        pEntry->dirty = false;
+                        pObj->dirty.erase(pEntry->attrnum);
+                        mudstate.attribute_pinned_list.remove(pEntry);
+                        mudstate.attribute_lru_cache_list.push_back(pEntry);
+                    }
+                }
+            }
+        }
+        trim_attribute_cache();
+    }
+
+    // The writes have landed in SQLite, so any cached attribute-number list
+    // for a touched object is now stale (#2077).  Unconditional: the writes
+    // happen in bStandAlone too, unlike the unpin loop.
+    //
+    if (0 != s_attrnum_lists)
+    {
+        for (const auto &op : ops)
+        {
+            if (op.op == CacheWriteOp::OP_PUT || op.op == CacheWriteOp::OP_DEL)
+            {
+                cache_invalidate_attrnum_list(static_cast<dbref>(op.object));
+            }
+        }
     }
-    attrnums = it->second;
-    return true;
 }
 
-void cache_store_attrnum_list(dbref thing, const vector<int> &attrnums)
+// Act on whatever the writer has acknowledged.
+//
+static void cache_reap_writes(void)
 {
-    if (s_attrnum_list_cache.size() >= ATTRNUM_LIST_CACHE_MAX)
+    if (nullptr == s_pWriter)
+    {
+        return;
+    }
+
+    const uint64_t acked = s_pWriter->Acked();
+    while (  !s_inflight.empty()
+          && s_inflight.front()->seq <= acked)
+    {
+        cache_retire_writes(s_inflight.front()->ops, s_inflight.front()->seq);
+        s_inflight.pop_front();
+    }
+
+    const uint64_t failures = s_pWriter->GetStats().failures;
+    if (s_writer_failures_logged != failures)
     {
-        s_attrnum_list_cache.clear();
+        s_writer_failures_logged = failures;
+        Log.tinyprintf(T("cache_writer: SQLite write failed; %u batches waiting to retry" ENDLINE),
+            static_cast<unsigned int>(s_inflight.size()));
     }
-    s_attrnum_list_cache[thing] = attrnums;
 }
-// OP_CODE_CACHE_PUT is keyed by source_hash, not Aname (#1284 residual).
-static unordered_map<string, size_t> s_code_cache_write_index;
-static bool s_flush_scheduled = false;
-static const size_t WRITE_QUEUE_THRESHOLD = 50;
 
-// Forward declaration.
+// Block until every batch handed to the writer has landed.
 //
-bool cache_flush_writes(void);
-static void trim_attribute_cache(void);
-static bool cache_obj_preloaded(dbref obj, bool bAll);
-
-static void Task_WriteQueueFlush(void *pUnused, int iUnused)
+static bool cache_wait_writes(void)
 {
-    UNUSED_PARAMETER(pUnused);
-    UNUSED_PARAMETER(iUnused);
-
-    s_flush_scheduled = false;
-    cache_flush_writes();
+    if (s_inflight.empty())
+    {
+        return true;
+    }
+    const bool bOk = s_pWriter->Wait(s_inflight.back()->seq);
+    cache_reap_writes();
+    return bOk && s_inflight.empty();
 }
 
+static void Task_WriteQueueFlush(void *pUnused, int iUnused);
+
 static void schedule_flush(void)
 {
     if (!s_flush_scheduled && !mudstate.bStandAlone)
     {
         CLinearTimeAbsolute ltaNow;
         ltaNow.GetUTC();
-        scheduler.DeferTask(ltaNow + time_250ms, PRIORITY_SYSTEM,
+        scheduler.DeferTask(ltaNow + mudconf.cache_write_delay, PRIORITY_SYSTEM,
             Task_WriteQueueFlush, nullptr, 0);
         s_flush_scheduled = true;
     }
 }
 
+static void Task_WriteQueueFlush(void *pUnused, int iUnused)
+{
+    UNUSED_PARAMETER(pUnused);
+    UNUSED_PARAMETER(iUnused);
+
+    s_flush_scheduled = false;
+    cache_submit_writes();
+
+    // Come back for the acknowledgement so the entries are unpinned even
+    // if nothing else is written for a while.
+    //
+    if (!s_inflight.empty())
+    {
+        schedule_flush();
+    }
+}
+
+// Hand the open queue to the writer without waiting for it, or commit it
+// here when there is no writer to hand it to.
+//
+static void cache_submit_writes(void)
+{
+    cache_reap_writes();
+    if (  s_write_queue.empty()
+       || !g_pSQLiteBackend)
+    {
+        return;
+    }
+    if (!cache_writer_usable())
+    {
+        cache_flush_writes();
+        return;
+    }
+
+    auto batch = make_shared<CacheWriteBatch>();
+    batch->seq = s_write_seq++;
+    batch->bytes = s_write_queue_bytes;
+    batch->ops.swap(s_write_queue);
+    stamp_mod_counts(batch->ops);
+    s_attr_write_index.clear();
+    s_code_cache_write_index.clear();
+    s_write_queue_bytes = 0;
+
+    s_inflight.push_back(batch);
+    s_pWriter->Submit(batch);
+    schedule_flush();
+}
+
+// Called after every queued write: send the batch once it is big enough,
+// else make sure it goes within cache_write_delay.
+//
+static void write_queue_check(void)
+{
+    if (  s_write_queue.size() >= WRITE_QUEUE_THRESHOLD
+       || (  0 <= mudconf.cache_write_batch_size
+          && static_cast<uint64_t>(mudconf.cache_write_batch_size) <= s_write_queue_bytes))
+    {
+        cache_submit_writes();
+    }
+    else
+    {
+        schedule_flush();
+    }
+}
+
+// Make every queued write durable before returning: the contract sync,
+// close, and flatfile import rely on.
+//
 bool cache_flush_writes(void)
 {
-    if (s_write_queue.empty() || !g_pSQLiteBackend)
+    if (!g_pSQLiteBackend)
     {
         return true;
     }
@@ -178,12 +1280,46 @@ bool cache_flush_writes(void)
     }
 #endif
 
+    CSQLiteDB &db = g_pSQLiteBackend->GetDB();
+    if (!s_inflight.empty())
+    {
+        // Waiting on the writer while this connection holds a transaction
+        // would deadlock: the writer is waiting for that same lock.
+        //
+        if (db.InTransaction())
+        {
+            return false;
+        }
+        if (cache_writer_usable())
+        {
+            cache_submit_writes();
+            return cache_wait_writes();
+        }
+
+        // No writer for the queue, but older batches must land before it.
+        //
+        if (!cache_wait_writes())
+        {
+            return false;
+        }
+    }
+    else if (  !s_write_queue.empty()
+            && !db.InTransaction()
+            && cache_writer_usable())
+    {
+        cache_submit_writes();
+        return cache_wait_writes();
+    }
+
+    if (s_write_queue.empty())
+    {
+        return true;
+    }
+
     // If we're inside a caller-managed transaction (e.g., flatfile import),
     // skip the Begin/Commit wrapper — the caller owns the transaction.
     //
     bool bOwnTransaction = !mudstate.bSQLiteLoading;
-    CSQLiteDB &db = g_pSQLiteBackend->GetDB();
-
     if (bOwnTransaction)
     {
         if (!db.Begin())
@@ -193,61 +1329,8 @@ bool cache_flush_writes(void)
         }
     }
 
-    bool bOk = true;
-    for (const auto &op : s_write_queue)
-    {
-        if (op.op == CacheWriteOp::OP_PUT)
-        {
-            if (!g_pSQLiteBackend->Put(op.object, op.attrnum,
-                op.value.data(), op.value.size(), op.owner, op.flags))
-            {
-                bOk = false;
-                break;
-            }
-        }
-        else if (op.op == CacheWriteOp::OP_DEL)
-        {
-            if (!g_pSQLiteBackend->Del(op.object, op.attrnum))
-            {
-                bOk = false;
-                break;
-            }
-        }
-        else if (op.op == CacheWriteOp::OP_CODE_CACHE_PUT)
-        {
-            if (!db.CodeCachePut(
-                op.cc_source_hash.data(),
-                static_cast<int>(op.cc_source_hash.size()),
-                op.cc_blob_hash.data(),
-                static_cast<int>(op.cc_blob_hash.size()),
-                op.cc_memory.data(),
-                static_cast<int>(op.cc_memory.size()),
-                op.cc_code.data(),
-                static_cast<int>(op.cc_code.size()),
-                op.cc_entry_pc,
-                op.cc_code_size,
-                op.cc_str.data(),
-                static_cast<int>(op.cc_str.size()),
-                op.cc_str_pool_end,
-                op.cc_fargs.data(),
-                static_cast<int>(op.cc_fargs.size()),
-                op.cc_fargs_pool_end,
-                op.cc_out_pool_end,
-                op.cc_out_addr,
-                op.cc_needs_jit,
-                op.cc_folds, op.cc_ecalls,
-                op.cc_tier2_calls, op.cc_native_ops,
-                op.cc_max_func_depth,
-                op.cc_n_func_calls,
-                op.cc_deps.data(),
-                static_cast<int>(op.cc_deps.size())))
-            {
-                bOk = false;
-                break;
-            }
-        }
-    }
-
+    stamp_mod_counts(s_write_queue);
+    bool bOk = apply_write_ops(db, s_write_queue);
     if (bOk && bOwnTransaction)
     {
         if (!db.Commit())
@@ -269,60 +1352,12 @@ bool cache_flush_writes(void)
         return false;
     }
 
-    // Unpin flushed entries: tombstones are removed from cache entirely;
-    // dirty puts are cleared and moved from pinned list to LRU list.
-    //
-    if (!mudstate.bStandAlone)
-    {
-        for (const auto &op : s_write_queue)
-        {
-            if (op.op == CacheWriteOp::OP_PUT || op.op == CacheWriteOp::OP_DEL)
-            {
-                Aname nam;
-                nam.object  = op.object;
-                nam.attrnum = op.attrnum;
-                auto it = mudstate.attribute_lru_cache_map.find(nam);
-                if (it != mudstate.attribute_lru_cache_map.end())
-                {
-                    if (it->second.tombstone)
-                    {
-                        cache_size -= it->second.data.size();
-                        mudstate.attribute_pinned_list.erase(it->second.lru_it);
-                        mudstate.attribute_lru_cache_map.erase(it);
-                    }
-                    else if (it->second.dirty)
-                    {
-                        it->second.dirty = false;
-                        // Move from pinned to LRU (evictable).
-                        mudstate.attribute_lru_cache_list.splice(
-                            mudstate.attribute_lru_cache_list.end(),
-                            mudstate.attribute_pinned_list,
-                            it->second.lru_it);
-                    }
-                }
-            }
-        }
-        trim_attribute_cache();
-    }
-
-    // The queue has landed in SQLite, so any cached attribute-number list for
-    // a touched object is now stale (#2077).  Unconditional: the writes above
-    // happen in bStandAlone too, unlike the unpin loop.
-    //
-    if (!s_attrnum_list_cache.empty())
-    {
-        for (const auto &op : s_write_queue)
-        {
-            if (op.op == CacheWriteOp::OP_PUT || op.op == CacheWriteOp::OP_DEL)
-            {
-                s_attrnum_list_cache.erase(static_cast<dbref>(op.object));
-            }
-        }
-    }
+    cache_retire_writes(s_write_queue, s_write_seq++);
 
     s_write_queue.clear();
     s_attr_write_index.clear();
     s_code_cache_write_index.clear();
+    s_write_queue_bytes = 0;
     return true;
 }
 
@@ -334,6 +1369,7 @@ void cache_discard_writes(void)
     s_write_queue.clear();
     s_attr_write_index.clear();
     s_code_cache_write_index.clear();
+    s_write_queue_bytes = 0;
 }
 
 // Drop only OP_CODE_CACHE_PUT ops, preserving attribute put/del.  Rebuilds
@@ -341,6 +1377,10 @@ void cache_discard_writes(void)
 //
 void cache_discard_code_cache_writes(void)
 {
+    // Puts already handed to the writer must land before the caller's
+    // DELETE, not after it.
+    //
+    cache_wait_writes();
     if (s_code_cache_write_index.empty())
     {
         return;
@@ -358,6 +1398,12 @@ void cache_discard_code_cache_writes(void)
     s_write_queue = std::move(kept);
     s_code_cache_write_index.clear();
 
+    s_write_queue_bytes = 0;
+    for (const auto &op : s_write_queue)
+    {
+        s_write_queue_bytes += write_op_bytes(op);
+    }
+
     s_attr_write_index.clear();
     for (size_t i = 0; i < s_write_queue.size(); ++i)
     {
@@ -378,42 +1424,46 @@ void cache_discard_code_cache_writes(void)
 //
 void cache_collect_pending_attrnums(dbref thing, vector<int> &attrnums)
 {
+    AttrCacheObject *pObj = cache_find_object(thing);
+    if (  (  nullptr == pObj
+          || pObj->dirty.empty())
+       && s_write_queue.empty())
+    {
+        return;
+    }
+
     unordered_set<int> present(attrnums.begin(), attrnums.end());
 
     // Only dirty and tombstoned entries can contribute, and those are exactly
-    // the ones on the pinned list -- attribute_lru_cache_list holds the clean,
-    // evictable entries (mudconf.h).  Walking the whole cache map instead made
-    // this O(total cached attributes) per call, and collect_attrnums_from_storage
-    // calls it once per object whose attribute list is needed -- which for
-    // $-command matching is once per object in scope, on every typed command.
-    // That was the entire superlinear term in $-dispatch: 3.4ms per command
-    // with 200 global commands in the master room, and worsening per object as
-    // the cache grew (#2046).
+    // the ones in the object's dirty set.  Walking the whole cache map made
+    // this O(total cached attributes) per call (#2046), and walking the global
+    // pinned list still made it O(pending writes game-wide).
+    // collect_attrnums_from_storage calls it once per object whose attribute
+    // list is needed -- which for $-command matching is once per object in
+    // scope, on every typed command.
     //
-    for (const Aname &nam : mudstate.attribute_pinned_list)
+    if (nullptr != pObj)
     {
-        if (nam.object != static_cast<unsigned int>(thing))
-        {
-            continue;
-        }
-        const unsigned int an = nam.attrnum;
-        if (  an == 0U
-           || an == static_cast<unsigned int>(A_LIST))
-        {
-            continue;
-        }
-        const auto it = mudstate.attribute_lru_cache_map.find(nam);
-        if (it == mudstate.attribute_lru_cache_map.end())
-        {
-            continue;
-        }
-        if (it->second.tombstone)
+        for (const unsigned int an : pObj->dirty)
         {
-            present.erase(static_cast<int>(an));
-        }
-        else if (it->second.dirty)
-        {
-            present.insert(static_cast<int>(an));
+            if (  an == 0U
+               || an == static_cast<unsigned int>(A_LIST))
+            {
+                continue;
+            }
+            const AttrCacheEntry *pEntry = cache_find_entry(pObj, an);
+            if (nullptr == pEntry)
+            {
+                continue;
+            }
+            if (pEntry->tombstone)
+            {
+                present.erase(static_cast<int>(an));
+            }
+            else if (pEntry->dirty)
+            {
+                present.insert(static_cast<int>(an));
+            }
         }
     }
 
@@ -452,6 +1502,8 @@ static void queue_attr_write(const CacheWriteOp &new_op)
     if (it != s_attr_write_index.end())
     {
         CacheWriteOp &existing = s_write_queue[it->second];
+        s_write_queue_bytes -= existing.value.size();
+        s_write_queue_bytes += new_op.value.size();
         existing.op = new_op.op;
         existing.object = new_op.object;
         existing.attrnum = new_op.attrnum;
@@ -462,6 +1514,7 @@ static void queue_attr_write(const CacheWriteOp &new_op)
     }
 
     s_write_queue.push_back(new_op);
+    s_write_queue_bytes += new_op.value.size();
     s_attr_write_index.insert(make_pair(nam, s_write_queue.size() - 1));
 }
 
@@ -529,26 +1582,21 @@ void cache_queue_code_cache_put(
     // residual / Pass E2 #1284).  Keep the newest put at the same index.
     //
     {
+        s_write_queue_bytes += write_op_bytes(op);
         const auto it = s_code_cache_write_index.find(op.cc_source_hash);
         if (it != s_code_cache_write_index.end())
         {
+            s_write_queue_bytes -= write_op_bytes(s_write_queue[it->second]);
             s_write_queue[it->second] = std::move(op);
         }
         else
         {
             s_code_cache_write_index[op.cc_source_hash] = s_write_queue.size();
-            s_write_queue.push_back(std::move(op));
-        }
-    }
-
-    if (s_write_queue.size() >= WRITE_QUEUE_THRESHOLD)
-    {
-        cache_flush_writes();
-    }
-    else
-    {
-        schedule_flush();
+            s_write_queue.push_back(std::move(op));
+        }
     }
+
+    write_queue_check();
 }
 
 int cache_init(const UTF8 *indb)
@@ -594,9 +1642,14 @@ int cache_init(const UTF8 *indb)
         return HF_OPEN_STATUS_ERROR;
     }
 
+    s_cache_path.assign(szPath);
     cache_initted = true;
-    mudstate.attribute_preloaded_builtin_objects.clear();
-    mudstate.attribute_preloaded_all_objects.clear();
+    for (auto &kv : mudstate.attribute_cache_objects)
+    {
+        kv.second.preloaded_builtin = false;
+        kv.second.preloaded_all = false;
+        kv.second.prefetch_oversize = false;
+    }
 
     return bNewDatabase ? HF_OPEN_STATUS_NEW : HF_OPEN_STATUS_OLD;
 }
@@ -604,21 +1657,72 @@ int cache_init(const UTF8 *indb)
 void cache_close(void)
 {
     cache_flush_writes();
+    if (nullptr != s_pWriter)
+    {
+        s_pWriter->Stop();
+        cache_reap_writes();
+
+        // Whatever the writer could not commit gets one last try here
+        // rather than vanishing with the thread.
+        //
+        if (  !s_inflight.empty()
+           && nullptr != g_pSQLiteBackend)
+        {
+            CSQLiteDB &db = g_pSQLiteBackend->GetDB();
+            bool bOk = db.Begin();
+            for (const auto &batch : s_inflight)
+            {
+                bOk = bOk && apply_write_ops(db, batch->ops);
+            }
+            if (bOk && db.Commit())
+            {
+                for (const auto &batch : s_inflight)
+                {
+                    cache_retire_writes(batch->ops, batch->seq);
+                }
+            }
+            else
+            {
+                db.Rollback();
+                Log.tinyprintf(T("cache_close: %u write batches could not be committed" ENDLINE),
+                    static_cast<unsigned int>(s_inflight.size()));
+            }
+        }
+        s_inflight.clear();
+        delete s_pWriter;
+        s_pWriter = nullptr;
+    }
+    s_checkpointer.Invalidate();
+    s_writer_failed = false;
+    s_writer_failures_logged = 0;
+    s_cache_path.clear();
     if (g_pSQLiteBackend)
     {
         g_pSQLiteBackend->Close();
         delete g_pSQLiteBackend;
         g_pSQLiteBackend = nullptr;
     }
-    mudstate.attribute_preloaded_builtin_objects.clear();
-    mudstate.attribute_preloaded_all_objects.clear();
-    s_attrnum_list_cache.clear();
+    for (auto &kv : mudstate.attribute_cache_objects)
+    {
+        kv.second.preloaded_builtin = false;
+        kv.second.preloaded_all = false;
+        kv.second.prefetch_oversize = false;
+    }
+    cache_clear_attrnum_lists();
     cache_initted = false;
 }
 
 void cache_tick(void)
 {
-    cache_flush_writes();
+    cache_submit_writes();
+
+    // Checkpoints need the thread even when nothing has been written.
+    //
+    if (0 < mudconf.wal_checkpoint_pages)
+    {
+        cache_writer();
+    }
+    cache_writer_policy();
     if (g_pSQLiteBackend)
     {
         g_pSQLiteBackend->Tick();
@@ -636,49 +1740,40 @@ static void trim_attribute_cache(void)
 
     // Check to see if the cache needs to be trimmed.
     //
-    unordered_set<dbref> evicted_objects;
     while (cache_size > static_cast<size_t>(mudconf.max_cache_size))
     {
-        if (mudstate.attribute_lru_cache_list.empty())
+        AttrCacheEntry *pOldest = mudstate.attribute_lru_cache_list.head;
+        if (nullptr == pOldest)
         {
             // All remaining bytes are pinned (dirty).  Stop evicting.
             //
             break;
         }
 
-        // Blow the oldest thing away.
+        // Blow the oldest thing away.  The object no longer holds every
+        // attribute, so its preload marks go with it, and it earns its
+        // next prefetch from scratch -- which also lets the record go once
+        // its last entry does.
         //
-        const Aname nam = mudstate.attribute_lru_cache_list.front();
-        const auto it = mudstate.attribute_lru_cache_map.find(nam);
-        cache_size -= it->second.data.size();
-        evicted_objects.insert(static_cast<dbref>(nam.object));
-        mudstate.attribute_lru_cache_map.erase(it);
-        mudstate.attribute_lru_cache_list.pop_front();
-    }
-
-    for (dbref obj : evicted_objects)
-    {
-        mudstate.attribute_preloaded_builtin_objects.erase(obj);
-        mudstate.attribute_preloaded_all_objects.erase(obj);
+        const dbref obj = static_cast<dbref>(pOldest->object);
+        AttrCacheObject *pObj = cache_find_object(obj);
+        pObj->preloaded_builtin = false;
+        pObj->preloaded_all = false;
+        pObj->misses = 0;
+        cache_erase_entry(pObj, pOldest);
+        cache_release_object(obj);
     }
 }
 
 static bool cache_obj_preloaded(dbref obj, bool bAll)
 {
-    if (mudstate.attribute_preloaded_all_objects.find(obj)
-        != mudstate.attribute_preloaded_all_objects.end())
-    {
-        return true;
-    }
-
-    if (!bAll
-        && mudstate.attribute_preloaded_builtin_objects.find(obj)
-            != mudstate.attribute_preloaded_builtin_objects.end())
+    const AttrCacheObject *pObj = cache_find_object(obj);
+    if (nullptr == pObj)
     {
-        return true;
+        return false;
     }
-
-    return false;
+    return pObj->preloaded_all
+        || (!bAll && pObj->preloaded_builtin);
 }
 
 const UTF8 *cache_get(Aname *nam, size_t *pLen, dbref *owner, int *flags)
@@ -692,100 +1787,133 @@ const UTF8 *cache_get(Aname *nam, size_t *pLen, dbref *owner, int *flags)
         return nullptr;
     }
 
+    const dbref obj = static_cast<dbref>(nam->object);
     if (!mudstate.bStandAlone)
     {
         // Check the cache, first.
         //
-        const auto it = mudstate.attribute_lru_cache_map.find(*nam);
-        if (it != mudstate.attribute_lru_cache_map.end())
+        AttrCacheObject *pObj = cache_find_object(obj);
+        AttrCacheEntry *pEntry = cache_find_entry(pObj, nam->attrnum);
+        if (nullptr != pEntry)
         {
+            cache_hits++;
+            pObj->hits++;
+
             // Tombstone: attribute was deleted but not yet flushed.
             //
-            if (it->second.tombstone)
+            if (pEntry->tombstone)
             {
-                cache_hits++;
                 *pLen = 0;
                 *owner = NOTHING;
                 *flags = 0;
                 return nullptr;
             }
 
+            if (pEntry->prefetched)
+            {
+                pEntry->prefetched = false;
+                cache_prefetch_used++;
+            }
+
             // Cache hit — move to newest position in whichever list
             // the entry lives in (LRU for clean, pinned for dirty).
             //
-            cache_hits++;
-            auto &target_list = it->second.dirty
-                ? mudstate.attribute_pinned_list
-                : mudstate.attribute_lru_cache_list;
-            target_list.splice(
-                target_list.end(),
-                target_list,
-                it->second.lru_it
-            );
-        	*pLen = it->second.data.size();
-            *owner = it->second.attr_owner;
-            *flags = it->second.attr_flags;
-            return it->second.data.data();
+            if (pEntry->dirty)
+            {
+                mudstate.attribute_pinned_list.touch(pEntry);
+            }
+            else
+            {
+                mudstate.attribute_lru_cache_list.touch(pEntry);
+            }
+            *pLen = pEntry->data.size();
+            *owner = pEntry->attr_owner;
+            *flags = pEntry->attr_flags;
+            return pEntry->data.data();
         }
         cache_misses++;
     }
 
-    // Object-affinity prefetch: instead of loading one attribute,
-    // bulk-load the entire object.  GetAll (~5.5 us) is cheaper than
-    // 2 individual Gets (~3.6 us each), and most code that touches
-    // one attribute on an object will touch more.
+    // Object-affinity prefetch (docs/design-speculative-prefetch.md, stage
+    // 1): once an object has missed cache_prefetch_misses times, bulk-load
+    // the entire object.  GetAll (~5.5 us) is cheaper than 2 individual Gets
+    // (~3.6 us each), and code that keeps coming back to an object will
+    // touch more of it.  An object read once and never again stays a single
+    // Get, and one bigger than cache_prefetch_max_size is left to single
+    // Gets rather than flooding the cache.
     //
     if (!mudstate.bStandAlone)
     {
-        const dbref obj = static_cast<dbref>(nam->object);
-        if (!cache_obj_preloaded(obj, true))
+        cache_sweep_miss_records();
+        AttrCacheObject *pObj = &mudstate.attribute_cache_objects[obj];
+        pObj->misses++;
+        if (  !pObj->preloaded_all
+           && !pObj->prefetch_oversize
+           && 0 < mudconf.cache_prefetch_misses
+           && static_cast<uint64_t>(mudconf.cache_prefetch_misses) <= pObj->misses)
         {
-            cache_preload_obj(obj, true);
+            cache_load_obj(obj, true, true, nam->attrnum);
+
+            // The trim after the load may have evicted every entry it
+            // brought in, which releases the record.
+            //
+            pObj = cache_find_object(obj);
         }
 
-        // After a successful full preload the map is authoritative: a
-        // miss means the attr does not exist.  Re-hitting SQLite for
-        // every known-missing attr was the residual (#1284).  If
-        // preload failed, the object is still not marked preloaded and
-        // we fall through to a single Get below.
+        // Look again even when the object did not end up marked preloaded:
+        // an oversize prefetch keeps what it read before giving up, and the
+        // trim after a bulk load can evict siblings (dropping the mark)
+        // while leaving this attribute resident.
         //
-        if (cache_obj_preloaded(obj, true))
+        AttrCacheEntry *pEntry = cache_find_entry(pObj, nam->attrnum);
+        if (nullptr != pEntry)
         {
-            const auto it2 = mudstate.attribute_lru_cache_map.find(*nam);
-            if (it2 != mudstate.attribute_lru_cache_map.end())
+            if (pEntry->tombstone)
             {
-                if (it2->second.tombstone)
-                {
-                    *pLen = 0;
-                    *owner = NOTHING;
-                    *flags = 0;
-                    return nullptr;
-                }
-
-                // Don't count as a hit — the miss already counted.
-                //
-                auto &list2 = it2->second.dirty
-                    ? mudstate.attribute_pinned_list
-                    : mudstate.attribute_lru_cache_list;
-                list2.splice(list2.end(), list2, it2->second.lru_it);
-                *pLen = it2->second.data.size();
-                *owner = it2->second.attr_owner;
-                *flags = it2->second.attr_flags;
-                return it2->second.data.data();
+                *pLen = 0;
+                *owner = NOTHING;
+                *flags = 0;
+                return nullptr;
             }
 
-            // Definitive miss after successful preload.
+            // Don't count as a hit — the miss already counted.
             //
+            if (pEntry->prefetched)
+            {
+                pEntry->prefetched = false;
+                cache_prefetch_used++;
+            }
+            if (pEntry->dirty)
+            {
+                mudstate.attribute_pinned_list.touch(pEntry);
+            }
+            else
+            {
+                mudstate.attribute_lru_cache_list.touch(pEntry);
+            }
+            *pLen = pEntry->data.size();
+            *owner = pEntry->attr_owner;
+            *flags = pEntry->attr_flags;
+            return pEntry->data.data();
+        }
+
+        // After a successful full preload the map is authoritative: a miss
+        // means the attr does not exist.  Re-hitting SQLite for every
+        // known-missing attr was the residual (#1284).
+        //
+        if (  nullptr != pObj
+           && pObj->preloaded_all)
+        {
             *pLen = 0;
             *owner = NOTHING;
             *flags = 0;
             return nullptr;
         }
-        // else: preload failed — single Get as recovery.
+        // else: not yet worth a prefetch, too big, or the bulk load failed.
     }
 
-    // Standalone mode, or online recovery after a failed bulk preload:
-    // single-attribute load.
+    // Standalone mode, or an object cache_get has not (or could not)
+    // preload: single-attribute load.
     //
     size_t nLength = 0;
     int db_owner = NOTHING;
@@ -794,6 +1922,23 @@ const UTF8 *cache_get(Aname *nam, size_t *pLen, dbref *owner, int *flags)
                               sqlite_attr_buf, sizeof(sqlite_attr_buf), &nLength,
                               &db_owner, &db_flags))
     {
+        if (!mudstate.bStandAlone)
+        {
+            // Keep it, so the next read of this attribute is a hit.  The
+            // caller gets sqlite_attr_buf rather than the entry, which the
+            // trim below may already have evicted.
+            //
+            cache_single_loads++;
+            AttrCacheObject *pObj = &mudstate.attribute_cache_objects[obj];
+            AttrCacheEntry *pEntry = cache_insert_entry(pObj, obj,
+                nam->attrnum, mudstate.attribute_lru_cache_list);
+            pEntry->data.assign(sqlite_attr_buf, sqlite_attr_buf + nLength);
+            pEntry->attr_owner = static_cast<dbref>(db_owner);
+            pEntry->attr_flags = db_flags;
+            cache_size += nLength;
+            pObj->size += nLength;
+            trim_attribute_cache();
+        }
         *pLen = nLength;
         *owner = static_cast<dbref>(db_owner);
         *flags = db_flags;
@@ -856,34 +2001,42 @@ bool cache_put(Aname *nam, const UTF8 *value, size_t len, dbref owner, int flags
     // must see the pinned entry so it can unpin it after committing.
     //
     {
-        statedata::AttrCacheEntry entry;
-        entry.data.assign(value, value + len);
-        entry.lru_it = mudstate.attribute_pinned_list.insert(
-            mudstate.attribute_pinned_list.end(), *nam);
-        entry.attr_owner = owner;
-        entry.attr_flags = flags;
-        entry.dirty     = true;
-        entry.tombstone = false;
-
-        const auto it = mudstate.attribute_lru_cache_map.find(*nam);
-        if (it != mudstate.attribute_lru_cache_map.end())
+        const dbref obj = static_cast<dbref>(nam->object);
+        AttrCacheObject &o = mudstate.attribute_cache_objects[obj];
+        AttrCacheEntry *pEntry = cache_find_entry(&o, nam->attrnum);
+        if (nullptr == pEntry)
+        {
+            pEntry = cache_insert_entry(&o, obj, nam->attrnum,
+                mudstate.attribute_pinned_list);
+        }
+        else
         {
-            cache_size += entry.data.size() - it->second.data.size();
-            if (it->second.dirty)
+            if (pEntry->prefetched)
+            {
+                pEntry->prefetched = false;
+                cache_prefetch_wasted++;
+            }
+            if (pEntry->dirty)
             {
-                mudstate.attribute_pinned_list.erase(it->second.lru_it);
+                mudstate.attribute_pinned_list.remove(pEntry);
             }
             else
             {
-                mudstate.attribute_lru_cache_list.erase(it->second.lru_it);
+                mudstate.attribute_lru_cache_list.remove(pEntry);
             }
-            it->second = std::move(entry);
-        }
-        else
-        {
-            cache_size += entry.data.size();
-            mudstate.attribute_lru_cache_map.insert(make_pair(*nam, std::move(entry)));
+            mudstate.attribute_pinned_list.push_back(pEntry);
+            cache_size -= pEntry->data.size();
+            o.size -= pEntry->data.size();
         }
+        pEntry->data.assign(value, value + len);
+        pEntry->attr_owner = owner;
+        pEntry->attr_flags = flags;
+        pEntry->dirty     = true;
+        pEntry->tombstone = false;
+        pEntry->write_seq = s_write_seq;
+        o.dirty.insert(nam->attrnum);
+        cache_size += len;
+        o.size += len;
         trim_attribute_cache();
     }
 
@@ -898,19 +2051,33 @@ bool cache_put(Aname *nam, const UTF8 *value, size_t len, dbref owner, int flags
         op.owner   = static_cast<int>(owner);
         op.flags   = flags;
         queue_attr_write(op);
-
-        if (s_write_queue.size() >= WRITE_QUEUE_THRESHOLD)
-        {
-            cache_flush_writes();
-        }
-        else
-        {
-            schedule_flush();
-        }
+        write_queue_check();
     }
     return true;
 }
 
+// A fork()ed child inherits SQLite's internal mutexes as they stand, so no
+// other thread may be inside SQLite at the moment of the fork.  Hold the
+// writer thread and the checkpoint scheduler between these two calls.
+//
+void cache_before_fork(void)
+{
+    if (nullptr != s_pWriter)
+    {
+        s_pWriter->Pause();
+    }
+    s_checkpointer.HoldOff();
+}
+
+void cache_after_fork_parent(void)
+{
+    s_checkpointer.Resume();
+    if (nullptr != s_pWriter)
+    {
+        s_pWriter->Resume();
+    }
+}
+
 bool cache_sync(void)
 {
     if (!cache_flush_writes())
@@ -919,7 +2086,10 @@ bool cache_sync(void)
     }
     if (g_pSQLiteBackend)
     {
+        s_checkpointer.HoldOff();
         g_pSQLiteBackend->Sync();
+        s_checkpointer.Resume();
+        s_checkpointer.Invalidate();
     }
     return true;
 }
@@ -961,30 +2131,28 @@ bool cache_del(Aname *nam)
     // rationale as cache_put (flush must see the pinned entry).
     //
     {
-        const auto it = mudstate.attribute_lru_cache_map.find(*nam);
-        if (it != mudstate.attribute_lru_cache_map.end())
+        const dbref obj = static_cast<dbref>(nam->object);
+        AttrCacheObject &o = mudstate.attribute_cache_objects[obj];
+        AttrCacheEntry *pEntry = cache_find_entry(&o, nam->attrnum);
+        if (nullptr == pEntry)
         {
-            it->second.tombstone = true;
-            if (!it->second.dirty)
-            {
-                it->second.dirty = true;
-                mudstate.attribute_pinned_list.splice(
-                    mudstate.attribute_pinned_list.end(),
-                    mudstate.attribute_lru_cache_list,
-                    it->second.lru_it);
-            }
+            pEntry = cache_insert_entry(&o, obj, nam->attrnum,
+                mudstate.attribute_pinned_list);
         }
-        else
+        else if (!pEntry->dirty)
+        {
+            mudstate.attribute_lru_cache_list.remove(pEntry);
+            mudstate.attribute_pinned_list.push_back(pEntry);
+        }
+        if (pEntry->prefetched)
         {
-            statedata::AttrCacheEntry entry;
-            entry.lru_it = mudstate.attribute_pinned_list.insert(
-                mudstate.attribute_pinned_list.end(), *nam);
-            entry.attr_owner = NOTHING;
-            entry.attr_flags = 0;
-            entry.dirty     = true;
-            entry.tombstone = true;
-            mudstate.attribute_lru_cache_map.insert(make_pair(*nam, std::move(entry)));
+            pEntry->prefetched = false;
+            cache_prefetch_wasted++;
         }
+        pEntry->dirty     = true;
+        pEntry->tombstone = true;
+        pEntry->write_seq = s_write_seq;
+        o.dirty.insert(nam->attrnum);
     }
 
     // Queue the delete and check threshold.
@@ -998,15 +2166,7 @@ bool cache_del(Aname *nam)
         op.flags   = 0;
         op.value.clear();
         queue_attr_write(op);
-
-        if (s_write_queue.size() >= WRITE_QUEUE_THRESHOLD)
-        {
-            cache_flush_writes();
-        }
-        else
-        {
-            schedule_flush();
-        }
+        write_queue_check();
     }
     return true;
 }
@@ -1025,45 +2185,57 @@ int cache_count(dbref obj)
     return g_pSQLiteBackend->Count(static_cast<unsigned int>(obj));
 }
 
-void cache_preload_obj(dbref obj, bool bAll)
+// Bulk-load an object's attributes into the cache: all of them when bAll,
+// else only builtins (attrnum < 256).  A prefetch from cache_get also marks
+// what it brings in (other than attrnumWanted, which was asked for) so
+// @list cache can say whether prefetching pays, and gives up on an object
+// larger than cache_prefetch_max_size -- the entries already read stay
+// cached, but the object is not marked preloaded and will not be tried
+// again.
+//
+static bool cache_load_obj(dbref obj, bool bAll, bool bPrefetch,
+    unsigned int attrnumWanted)
 {
-    if (  !cache_initted
-       || mudstate.bStandAlone)
-    {
-        return;
-    }
-
-    if (cache_obj_preloaded(obj, bAll))
-    {
-        return;
-    }
-
-    auto loader = [obj](unsigned int attrnum, const UTF8 *value, size_t len,
-                        int db_owner, int db_flags)
-    {
-        Aname nam;
-        nam.object = static_cast<unsigned int>(obj);
-        nam.attrnum = attrnum;
+    AttrCacheObject *pObj = &mudstate.attribute_cache_objects[obj];
+    const int64_t cap = bPrefetch ? mudconf.cache_prefetch_max_size : -1;
+    size_t nBytes = 0;
+    bool bOversize = false;
+    auto loader = [obj, pObj, bPrefetch, attrnumWanted, cap, &nBytes, &bOversize](
+        unsigned int attrnum, const UTF8 *value, size_t len,
+        int db_owner, int db_flags)
+    {
+        if (bOversize)
+        {
+            return;
+        }
+        nBytes += len;
+        if (  0 <= cap
+           && static_cast<uint64_t>(cap) < nBytes)
+        {
+            bOversize = true;
+            return;
+        }
 
         // Skip if already in cache.
         //
-        if (mudstate.attribute_lru_cache_map.find(nam)
-            != mudstate.attribute_lru_cache_map.end())
+        if (pObj->attrs.find(attrnum) != pObj->attrs.end())
         {
             return;
         }
 
-        statedata::AttrCacheEntry entry;
-        entry.data.assign(value, value + len);
-        entry.lru_it = mudstate.attribute_lru_cache_list.insert(
-            mudstate.attribute_lru_cache_list.end(), nam);
-        entry.attr_owner = static_cast<dbref>(db_owner);
-        entry.attr_flags = db_flags;
-        entry.dirty     = false;
-        entry.tombstone = false;
-        cache_size += entry.data.size();
-        mudstate.attribute_lru_cache_map.insert(
-            std::make_pair(nam, std::move(entry)));
+        AttrCacheEntry *pEntry = cache_insert_entry(pObj, obj, attrnum,
+            mudstate.attribute_lru_cache_list);
+        pEntry->data.assign(value, value + len);
+        pEntry->attr_owner = static_cast<dbref>(db_owner);
+        pEntry->attr_flags = db_flags;
+        if (  bPrefetch
+           && attrnum != attrnumWanted)
+        {
+            pEntry->prefetched = true;
+            cache_prefetch_loaded++;
+        }
+        cache_size += len;
+        pObj->size += len;
     };
 
     bool ok;
@@ -1075,23 +2247,183 @@ void cache_preload_obj(dbref obj, bool bAll)
     {
         ok = g_pSQLiteBackend->GetBuiltin(static_cast<unsigned int>(obj), loader);
     }
+    if (bPrefetch)
+    {
+        cache_prefetches++;
+    }
 
     if (!ok)
     {
         Log.tinyprintf(T("cache_preload: failed bulk preload for #%d" ENDLINE), obj);
-        return;
+        cache_release_object(obj);
+        return false;
     }
 
-    if (bAll)
+    if (bOversize)
     {
-        mudstate.attribute_preloaded_all_objects.insert(obj);
-        mudstate.attribute_preloaded_builtin_objects.insert(obj);
+        pObj->prefetch_oversize = true;
+        cache_prefetch_oversize++;
     }
     else
     {
-        mudstate.attribute_preloaded_builtin_objects.insert(obj);
+        pObj->preloaded_builtin = true;
+        if (bAll)
+        {
+            pObj->preloaded_all = true;
+        }
+    }
+
+    trim_attribute_cache();
+    return !bOversize;
+}
+
+void cache_preload_obj(dbref obj, bool bAll)
+{
+    if (  !cache_initted
+       || mudstate.bStandAlone)
+    {
+        return;
+    }
+
+    if (cache_obj_preloaded(obj, bAll))
+    {
+        return;
+    }
+
+    cache_load_obj(obj, bAll, false, 0);
+}
+
+// Resolve an inherited lookup's parent chain in one query
+// (docs/design-speculative-prefetch.md, stage 4).  Without this, a cold
+// atr_pget that finds its attribute N levels up pays N+1 single Gets, and
+// most of those come back empty.
+//
+// A level is left alone when the cache can already answer it: the entry is
+// resident, the object is fully preloaded, or the object has missed often
+// enough that cache_get is about to bulk-load it anyway.  The rest are read
+// together.  What is found is cached like any other clean entry; what is not
+// found is reported through absent[] and counted as a miss on that object,
+// just as cache_get would have.  That answer is only good until the caller
+// next lets softcode run, so it is not kept.
+//
+void cache_prefetch_chain(const dbref *chain, int nChain, int attrnum,
+    bool *absent)
+{
+    for (int i = 0; i < nChain; i++)
+    {
+        absent[i] = false;
+    }
+    if (  !cache_initted
+       || mudstate.bStandAlone
+       || nChain < 2)
+    {
+        return;
+    }
+
+    const unsigned int an = static_cast<unsigned int>(attrnum);
+    unsigned int wanted[CSQLiteDB::ATTR_GET_MULTI_MAX];
+    bool found[CSQLiteDB::ATTR_GET_MULTI_MAX];
+    size_t nWanted = 0;
+    for (int i = 0; i < nChain && nWanted < CSQLiteDB::ATTR_GET_MULTI_MAX; i++)
+    {
+        const AttrCacheObject *pObj = cache_find_object(chain[i]);
+        if (nullptr != pObj)
+        {
+            if (  pObj->preloaded_all
+               || pObj->attrs.find(an) != pObj->attrs.end())
+            {
+                continue;
+            }
+            if (  !pObj->prefetch_oversize
+               && 0 < mudconf.cache_prefetch_misses
+               && static_cast<uint64_t>(mudconf.cache_prefetch_misses) <= pObj->misses + 1)
+            {
+                continue;
+            }
+        }
+
+        // A parent loop repeats objects.
+        //
+        const unsigned int obj = static_cast<unsigned int>(chain[i]);
+        bool bDup = false;
+        for (size_t j = 0; j < nWanted; j++)
+        {
+            if (wanted[j] == obj)
+            {
+                bDup = true;
+                break;
+            }
+        }
+        if (!bDup)
+        {
+            found[nWanted] = false;
+            wanted[nWanted++] = obj;
+        }
+    }
+
+    // One level is no better than the Get cache_get would do.
+    //
+    if (nWanted < 2)
+    {
+        return;
+    }
+
+    auto loader = [an, &wanted, &found, nWanted](unsigned int object,
+        const UTF8 *value, size_t len, int db_owner, int db_flags)
+    {
+        for (size_t j = 0; j < nWanted; j++)
+        {
+            if (wanted[j] == object)
+            {
+                found[j] = true;
+                break;
+            }
+        }
+
+        const dbref obj = static_cast<dbref>(object);
+        AttrCacheObject *pObj = &mudstate.attribute_cache_objects[obj];
+        if (pObj->attrs.find(an) != pObj->attrs.end())
+        {
+            return;
+        }
+        AttrCacheEntry *pEntry = cache_insert_entry(pObj, obj, an,
+            mudstate.attribute_lru_cache_list);
+        pEntry->data.assign(value, value + len);
+        pEntry->attr_owner = static_cast<dbref>(db_owner);
+        pEntry->attr_flags = db_flags;
+        pEntry->prefetched = true;
+        cache_prefetch_loaded++;
+        cache_chain_found++;
+        cache_size += len;
+        pObj->size += len;
+    };
+
+    cache_chain_prefetches++;
+    cache_chain_levels += nWanted;
+    if (!g_pSQLiteBackend->GetMulti(wanted, nWanted, an, loader))
+    {
+        // Nothing is known about the levels that were not reported.
+        //
+        trim_attribute_cache();
+        return;
     }
 
+    for (size_t j = 0; j < nWanted; j++)
+    {
+        if (found[j])
+        {
+            continue;
+        }
+        cache_misses++;
+        mudstate.attribute_cache_objects[static_cast<dbref>(wanted[j])].misses++;
+        for (int i = 0; i < nChain; i++)
+        {
+            if (static_cast<unsigned int>(chain[i]) == wanted[j])
+            {
+                absent[i] = true;
+            }
+        }
+    }
     trim_attribute_cache();
 }
 
@@ -1254,13 +2586,13 @@ void cache_get_stats(CacheStats *pStats)
 {
     pStats->hits = cache_hits;
     pStats->misses = cache_misses;
-    pStats->entries = mudstate.attribute_lru_cache_map.size();
+    pStats->entries = cache_entries;
     pStats->size = cache_size;
 }
 
 void list_cache_stats(dbref player)
 {
-    size_t nEntries = mudstate.attribute_lru_cache_map.size();
+    size_t nEntries = cache_entries;
     uint64_t total = cache_hits + cache_misses;
     double hit_pct = (total > 0) ? (100.0 * cache_hits / total) : 0.0;
 
@@ -1281,16 +2613,177 @@ void list_cache_stats(dbref player)
         static_cast<unsigned long long>(cache_misses),
         szHitPct));
 
+    UTF8 szPrefetchMax[64];
+    format_size(szPrefetchMax, sizeof(szPrefetchMax), mudconf.cache_prefetch_max_size);
+    if (0 < mudconf.cache_prefetch_misses)
+    {
+        notify(player, tprintf(T("Prefetch: after %d misses, up to %s   Prefetches: %llu   Oversize: %llu"),
+            mudconf.cache_prefetch_misses,
+            szPrefetchMax,
+            static_cast<unsigned long long>(cache_prefetches),
+            static_cast<unsigned long long>(cache_prefetch_oversize)));
+    }
+    else
+    {
+        notify(player, tprintf(T("Prefetch: disabled   Prefetches: %llu   Oversize: %llu"),
+            static_cast<unsigned long long>(cache_prefetches),
+            static_cast<unsigned long long>(cache_prefetch_oversize)));
+    }
+    notify(player, tprintf(T("Prefetched: %llu   Used: %llu   Wasted: %llu   Single loads: %llu"),
+        static_cast<unsigned long long>(cache_prefetch_loaded),
+        static_cast<unsigned long long>(cache_prefetch_used),
+        static_cast<unsigned long long>(cache_prefetch_wasted),
+        static_cast<unsigned long long>(cache_single_loads)));
+    notify(player, tprintf(T("Chain prefetches: %llu   Levels: %llu   Found: %llu"),
+        static_cast<unsigned long long>(cache_chain_prefetches),
+        static_cast<unsigned long long>(cache_chain_levels),
+        static_cast<unsigned long long>(cache_chain_found)));
+
     CSQLiteDB::Stats st = g_pSQLiteBackend->GetDB().GetStats();
 
     notify(player, M_("--- SQLite Storage ---"));
-    notify(player, tprintf(T("Attr gets: %llu   puts: %llu   dels: %llu   bulk loads: %llu"),
+    notify(player, tprintf(T("Attr gets: %llu   puts: %llu   dels: %llu   bulk loads: %llu   multi gets: %llu"),
         static_cast<unsigned long long>(st.attr_gets),
         static_cast<unsigned long long>(st.attr_puts),
         static_cast<unsigned long long>(st.attr_dels),
-        static_cast<unsigned long long>(st.attr_bulk_loads)));
+        static_cast<unsigned long long>(st.attr_bulk_loads),
+        static_cast<unsigned long long>(st.attr_multi_gets)));
     notify(player, tprintf(T("Obj inserts: %llu   updates: %llu   loads: %llu"),
         static_cast<unsigned long long>(st.obj_inserts),
         static_cast<unsigned long long>(st.obj_updates),
         static_cast<unsigned long long>(st.obj_loads)));
+
+    // The writer thread's puts and dels are made on its own connection, so
+    // they are counted here rather than above.
+    //
+    UTF8 szQueued[64];
+    format_size(szQueued, sizeof(szQueued), static_cast<int64_t>(s_write_queue_bytes));
+    if (  nullptr != s_pWriter
+       && mudconf.cache_write_thread)
+    {
+        const CCacheWriter::Stats ws = s_pWriter->GetStats();
+        UTF8 szBytes[64];
+        format_size(szBytes, sizeof(szBytes), static_cast<int64_t>(ws.bytes));
+        notify(player, tprintf(T("Writer: thread   Batches: %llu   Commits: %llu   Yields: %llu   Ops: %llu   Bytes: %s   Failures: %llu"),
+            static_cast<unsigned long long>(ws.batches),
+            static_cast<unsigned long long>(ws.commits),
+            static_cast<unsigned long long>(ws.yields),
+            static_cast<unsigned long long>(ws.ops),
+            szBytes,
+            static_cast<unsigned long long>(ws.failures)));
+        notify(player, tprintf(T("Queued: %lu ops (%s)   In flight: %lu batches   Avg commit: %llu us   Max commit: %llu us"),
+            static_cast<unsigned long>(s_write_queue.size()),
+            szQueued,
+            static_cast<unsigned long>(s_inflight.size()),
+            static_cast<unsigned long long>((0 < ws.commits) ? ws.commit_us / ws.commits : 0),
+            static_cast<unsigned long long>(ws.max_commit_us)));
+    }
+    else
+    {
+        notify(player, tprintf(T("Writer: game thread   Queued: %lu ops (%s)"),
+            static_cast<unsigned long>(s_write_queue.size()),
+            szQueued));
+    }
+
+    // Checkpoints run on the writer thread; without it, only @dump and
+    // shutdown checkpoint.
+    //
+    const CSQLiteDB &db = g_pSQLiteBackend->GetDB();
+    if (  nullptr != s_pWriter
+       && 0 < mudconf.wal_checkpoint_pages)
+    {
+        const CWalCheckpointer::Stats cs = s_checkpointer.GetStats(&s_pWriter->DB(), &db);
+        const uint64_t nAttempts = cs.steps + cs.truncates + cs.busy;
+        UTF8 szWal[64];
+        UTF8 szLag[64];
+        format_size(szWal, sizeof(szWal), static_cast<int64_t>(cs.wal_frames) * db.PageSize());
+        format_size(szLag, sizeof(szLag), static_cast<int64_t>(cs.lag) * db.PageSize());
+        notify(player, tprintf(T("WAL: %d pages (%s)   Lag: %d pages (%s)   Idle: %lld ms"),
+            cs.wal_frames, szWal, cs.lag, szLag,
+            static_cast<long long>(cs.idle_ms)));
+        notify(player, tprintf(T("Checkpoints: every %d pages   Steps: %llu (%llu pages)   Truncates: %llu   Busy: %llu   Avg: %llu us   Max: %llu us"),
+            mudconf.wal_checkpoint_pages,
+            static_cast<unsigned long long>(cs.steps),
+            static_cast<unsigned long long>(cs.frames),
+            static_cast<unsigned long long>(cs.truncates),
+            static_cast<unsigned long long>(cs.busy),
+            static_cast<unsigned long long>((0 < nAttempts) ? cs.step_us / nAttempts : 0),
+            static_cast<unsigned long long>(cs.max_step_us)));
+    }
+    else
+    {
+        notify(player, tprintf(T("WAL: %d pages   Checkpoints: at @dump and shutdown only"),
+            db.WalFrames()));
+    }
+
+    list_lock_cache_stats(player);
+    list_ast_cache_stats(player);
+    list_regex_cache_stats(player);
+}
+
+// Per-object view of the attribute cache for @list cache: how many objects
+// are resident, and the busiest ones with their entry counts, bytes, pinned
+// entries, and hit rates.
+//
+static const size_t CACHE_LIST_TOP_OBJECTS = 20;
+
+void list_cache_objects(dbref player)
+{
+    size_t nObjects = mudstate.attribute_cache_objects.size();
+    size_t nPreloaded = 0;
+    vector<pair<uint64_t, dbref>> busiest;
+    busiest.reserve(nObjects);
+    for (const auto &kv : mudstate.attribute_cache_objects)
+    {
+        if (kv.second.preloaded_all)
+        {
+            nPreloaded++;
+        }
+        const uint64_t accesses = kv.second.hits + kv.second.misses;
+        if (0 < accesses)
+        {
+            busiest.push_back(make_pair(accesses, kv.first));
+        }
+    }
+
+    const size_t nShow = busiest.size() < CACHE_LIST_TOP_OBJECTS
+        ? busiest.size() : CACHE_LIST_TOP_OBJECTS;
+    partial_sort(busiest.begin(), busiest.begin() + nShow, busiest.end(),
+        [](const pair<uint64_t, dbref> &a, const pair<uint64_t, dbref> &b)
+        {
+            return a.first > b.first
+                || (a.first == b.first && a.second < b.second);
+        });
+
+    notify(player, M_("--- Attribute Cache Objects ---"));
+    notify(player, tprintf(T("Objects: %lu   Fully preloaded: %lu   Clean entries: %lu   Pinned entries: %lu"),
+        static_cast<unsigned long>(nObjects),
+        static_cast<unsigned long>(nPreloaded),
+        static_cast<unsigned long>(mudstate.attribute_lru_cache_list.count),
+        static_cast<unsigned long>(mudstate.attribute_pinned_list.count)));
+    if (0 == nShow)
+    {
+        return;
+    }
+    notify(player, T("Object       Entries  Pinned       Size        Hits      Misses  Hit rate"));
+    for (size_t i = 0; i < nShow; i++)
+    {
+        const dbref obj = busiest[i].second;
+        const AttrCacheObject *pObj = cache_find_object(obj);
+        UTF8 szSize[64];
+        format_size(szSize, sizeof(szSize), static_cast<int64_t>(pObj->size));
+        UTF8 szHitPct[64];
+        mux_sprintf(szHitPct, sizeof(szHitPct), T("%.1f%%"),
+            100.0 * pObj->hits / busiest[i].first);
+        UTF8 szObj[32];
+        mux_sprintf(szObj, sizeof(szObj), T("#%d"), obj);
+        notify(player, tprintf(T("%-10s %9lu %7lu %10s %11llu %11llu %9s"),
+            szObj,
+            static_cast<unsigned long>(pObj->attrs.size()),
+            static_cast<unsigned long>(pObj->dirty.size()),
+            szSize,
+            static_cast<unsigned long long>(pObj->hits),
+            static_cast<unsigned long long>(pObj->misses),
+            szHitPct));
+    }
 }
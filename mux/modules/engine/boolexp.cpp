@@ -11,6 +11,10 @@
 #include "autoconf.h"
 #include "config.h"
 #include "externs.h"
+#include "engine_api.h"
+#include <list>
+#include <memory>
+#include <unordered_map>
 
 static bool parsing_internal = false;
 
@@ -146,10 +150,7 @@ bool eval_boolexp(dbref player, dbref thing, dbref from, BOOLEXP *b)
             mudstate.lock_nest_lev--;
             return false;
         }
-        {
-            LBuf lkey = LBuf_Adopt(atr_get("boolexp.130", b->sub1->thing, b->thing, &aowner, &aflags));
-            c = eval_boolexp_atr(player, b->sub1->thing, from, lkey);
-        }
+        c = eval_boolexp_lock(player, b->sub1->thing, from, b->thing);
         mudstate.lock_nest_lev--;
         return c;
 
@@ -308,6 +309,139 @@ bool eval_boolexp_atr(dbref player, dbref thing, dbref from, UTF8 *key)
     return ret_value;
 }
 
+// ---------------------------------------------------------------------------
+// Lock cache.
+//
+// could_doit() runs for every object in scope on every typed command (the
+// A_LUSE check in atr_match1), and each call used to re-read and re-parse the
+// lock text.  Parsed trees are kept here keyed by (object, lock attribute)
+// and stamped with that attribute's mod count, which atr_add_raw_LEN,
+// atr_clr, and object destruction all bump.  A matching stamp means the text
+// has not changed, so a hit skips both the atr_get and the parse.
+//
+// Stored locks are parsed in internal mode, which depends on only three
+// things besides the text: attribute names (atr_str), the God-only numeric
+// attribute form, and Good_dbref.  @attribute/rename and /delete flush the
+// cache, God bypasses it, and a non-empty lock that fails to parse is never
+// cached, so a later-defined name or a grown database is still picked up.
+// An empty lock is cached as a null tree -- that is the common case.
+//
+// Trees are shared_ptr-held because evaluation re-enters: an eval lock can
+// rewrite its own lock attribute, and an indirect lock can evict the entry
+// that is being evaluated.
+//
+struct LockCacheEntry
+{
+    std::shared_ptr<BOOLEXP> key;
+    uint32_t mod_count;
+    std::list<uint64_t>::iterator lru_it;
+};
+
+static std::unordered_map<uint64_t, LockCacheEntry> s_lockCache;
+static std::list<uint64_t> s_lockLru;
+static const size_t LOCK_CACHE_MAX = 4096;
+
+static uint64_t s_lock_hits = 0;
+static uint64_t s_lock_misses = 0;
+static uint64_t s_lock_stale = 0;
+static uint64_t s_lock_uncached = 0;
+static uint64_t s_lock_flushes = 0;
+
+void lock_cache_invalidate_all(void)
+{
+    if (!s_lockCache.empty())
+    {
+        s_lock_flushes++;
+    }
+    s_lockCache.clear();
+    s_lockLru.clear();
+}
+
+bool eval_boolexp_lock(dbref player, dbref thing, dbref from, int locknum)
+{
+    dbref aowner;
+    int   aflags;
+
+    if (God(player))
+    {
+        // Only God's parse accepts numeric attribute references.
+        //
+        s_lock_uncached++;
+        LBuf key = LBuf_Adopt(atr_get("eval_boolexp_lock.god", thing, locknum, &aowner, &aflags));
+        return eval_boolexp_atr(player, thing, from, key);
+    }
+
+    const uint64_t k = (static_cast<uint64_t>(static_cast<uint32_t>(thing)) << 32)
+                     | static_cast<uint32_t>(locknum);
+    const uint32_t mc = attr_mod_count_get(thing, locknum);
+
+    std::shared_ptr<BOOLEXP> b;
+    auto it = s_lockCache.find(k);
+    if (  it != s_lockCache.end()
+       && it->second.mod_count == mc)
+    {
+        s_lock_hits++;
+        s_lockLru.splice(s_lockLru.begin(), s_lockLru, it->second.lru_it);
+        b = it->second.key;
+    }
+    else
+    {
+        if (it != s_lockCache.end())
+        {
+            s_lock_stale++;
+            s_lockLru.erase(it->second.lru_it);
+            s_lockCache.erase(it);
+        }
+        s_lock_misses++;
+
+        LBuf key = LBuf_Adopt(atr_get("eval_boolexp_lock", thing, locknum, &aowner, &aflags));
+        BOOLEXP *p = parse_boolexp(player, key, true);
+        if (  TRUE_BOOLEXP == p
+           && '\0' != key[0])
+        {
+            // Unparseable.  It evaluates as unlocked, as it always has.
+            //
+            s_lock_uncached++;
+            return true;
+        }
+        b = std::shared_ptr<BOOLEXP>(p, free_boolexp);
+
+        while (s_lockCache.size() >= LOCK_CACHE_MAX)
+        {
+            s_lockCache.erase(s_lockLru.back());
+            s_lockLru.pop_back();
+        }
+        s_lockLru.push_front(k);
+        s_lockCache[k] = {b, mc, s_lockLru.begin()};
+    }
+
+    if (TRUE_BOOLEXP == b.get())
+    {
+        return true;
+    }
+    return eval_boolexp(player, thing, from, b.get());
+}
+
+void list_lock_cache_stats(dbref player)
+{
+    const uint64_t total = s_lock_hits + s_lock_misses;
+    UTF8 szHitPct[64];
+    mux_sprintf(szHitPct, sizeof(szHitPct), T("%.1f"),
+        (0 < total) ? (100.0 * s_lock_hits / total) : 0.0);
+
+    notify(player, M_("--- Lock Cache ---"));
+    notify(player, tprintf(T("Entries: %lu   Max: %lu   Hits: %llu   Misses: %llu   Hit rate: %s%%"),
+        static_cast<unsigned long>(s_lockCache.size()),
+        static_cast<unsigned long>(LOCK_CACHE_MAX),
+        static_cast<unsigned long long>(s_lock_hits),
+        static_cast<unsigned long long>(s_lock_misses),
+        szHitPct));
+    notify(player, tprintf(T("Stale: %llu   Uncached: %llu   Flushes: %llu"),
+        static_cast<unsigned long long>(s_lock_stale),
+        static_cast<unsigned long long>(s_lock_uncached),
+        static_cast<unsigned long long>(s_lock_flushes)));
+}
+
 // If the parser returns TRUE_BOOLEXP, you lose
 // TRUE_BOOLEXP cannot be typed in by the user; use @unlock instead
 //
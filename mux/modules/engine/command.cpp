@@ -11,6 +11,7 @@
 #include "autoconf.h"
 #include "config.h"
 #include "externs.h"
+#include "eventlog.h"
 #include "ganl_stub.h"
 #include "walk.h"
 #include "mux_table.h"
@@ -28,6 +29,12 @@ static NAMETAB attrib_sw[] =
     {static_cast<UTF8*>(nullptr),     0,       0,     0}
 };
 
+static NAMETAB backup_sw[] =
+{
+    {T("abort"),           1,  CA_GOD,     BACKUP_ABORT},
+    {static_cast<UTF8*>(nullptr),     0,          0,  0}
+};
+
 static NAMETAB boot_sw[] =
 {
     {T("port"),            1,  CA_WIZARD,  BOOT_PORT|SW_MULTIPLE},
@@ -762,6 +769,7 @@ static CMDENT_NO_ARG command_table_no_arg[] =
 static CMDENT_ONE_ARG command_table_one_arg[] =
 {
     {T("@apply_marked"), nullptr,    CA_WIZARD|CA_GBL_INTERP,    0,  CS_ONE_ARG|CS_CMDARG|CS_NOINTERP|CS_STRIP_AROUND,   0, do_apply_marked},
+    {T("@backup"),       backup_sw,  CA_GOD,                     0,  CS_ONE_ARG|CS_INTERP, 0, do_backup},
     {T("@boot"),         boot_sw,    CA_NO_GUEST|CA_NO_SLAVE,    0,  CS_ONE_ARG|CS_INTERP, 0, do_boot},
     {T("@ccreate"),      nullptr,    CA_NO_SLAVE|CA_NO_GUEST,    0,  CS_ONE_ARG,           0, do_createchannel},
     {T("@cdestroy"),     nullptr,    CA_NO_SLAVE|CA_NO_GUEST,    0,  CS_ONE_ARG,           0, do_destroychannel},
@@ -2063,6 +2071,18 @@ UTF8 *process_command
         ENDLOG;
     }
 
+    if (  Suspect(executor)
+       && (mudconf.event_log & LOG_SUSPECTCMDS))
+    {
+        log_command_event(LOG_SUSPECTCMDS, EVLOG_COMMAND_SUSPECT, executor,
+            pOriginalCommand);
+    }
+    else
+    {
+        log_command_event(LOG_ALLCOMMANDS, EVLOG_COMMAND, executor,
+            pOriginalCommand);
+    }
+
     // Reset recursion limits.
     //
     // Note: include_nest_lev is intentionally not reset here — it tracks
@@ -2072,6 +2092,7 @@ UTF8 *process_command
     mudstate.func_nest_lev = 0;
     mudstate.func_invk_ctr = 0;
     mudstate.ntfy_nest_lev = 0;
+    ast_function_memo_reset();
     mudstate.lock_nest_lev = 0;
 
     if (Verbose(executor))
@@ -2988,6 +3009,8 @@ UTF8 *process_command
             log_text(T(" entered: "));
             log_text(pCommand);
             ENDLOG;
+            log_command_event(LOG_BADCOMMANDS, EVLOG_COMMAND_BAD, executor,
+                pCommand);
         }
     }
     g_debug_cmd = cmdsave;
@@ -4048,7 +4071,8 @@ static void list_hashstats(const dbref player)
     list_hashstat_abbreviated(player, T("Excl. $-cmds"), static_cast<int>(mudstate.parent_htab.size()));
     list_hashstat_abbreviated(player, T("Mail Messages"), static_cast<int>(mudstate.mail_htab.size()));
     list_hashstat_abbreviated(player, T("Channel Names"), static_cast<int>(mudstate.channel_names.size()));;
-    list_hashstat_abbreviated(player, T("Attr. Cache"), static_cast<int>(mudstate.attribute_lru_cache_list.size()));
+    list_hashstat_abbreviated(player, T("Attr. Cache"), static_cast<int>(mudstate.attribute_lru_cache_list.count
+        + mudstate.attribute_pinned_list.count));
     for (int i = 0; i < mudstate.nHelpDesc; i++)
     {
         list_hashstat_abbreviated(player, mudstate.aHelpDesc[i].pBaseFilename,
@@ -4347,6 +4371,9 @@ void do_list(dbref executor, dbref caller, dbref enactor, int eval, const int ke
     {
     case LIST_ALLOCATOR:
         list_bufstats(executor);
+        notify(executor, tprintf(T("Notify deliveries: %llu direct, %llu with work buffers"),
+            static_cast<unsigned long long>(mudstate.notify_direct),
+            static_cast<unsigned long long>(mudstate.notify_full)));
         break;
     case LIST_BUFTRACE:
         list_buftrace(executor);
@@ -4406,6 +4433,8 @@ void do_list(dbref executor, dbref caller, dbref enactor, int eval, const int ke
                    T("Events Logged:"), T("enabled"), T("disabled"));
         interp_nametab(executor, logdata_nametab, mudconf.log_info,
                    T("Information Logged:"), T("yes"), T("no"));
+        Log.ListStats(executor);
+        eventlog_list_stats(executor);
         break;
     case LIST_DB_STATS:
         list_cache_stats(executor);
@@ -4424,6 +4453,7 @@ void do_list(dbref executor, dbref caller, dbref enactor, int eval, const int ke
         break;
     case LIST_CACHE:
         list_cache_stats(executor);
+        list_cache_objects(executor);
         break;
     case LIST_LUA:
         if (nullptr != mudstate.pILuaControl)
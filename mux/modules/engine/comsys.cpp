@@ -1885,6 +1885,7 @@ void SendChannelMessage
     const UTF8 *effMsgNormal = (mogMsg && *mogMsg) ? mogMsg : msgNormal;
     const UTF8 *effMsgNoComtitle = (mogMsg && *mogMsg) ? mogMsg : msgNoComtitle;
 
+    CBroadcastScope broadcast;
     for (auto &kv : ch->users)
     {
         comuser &user = kv.second;
@@ -55,6 +55,14 @@ void cf_init(void)
     mudconf.status_file = StringClone(T("shutdown.status"));
     mudconf.max_cache_size = 256LL*1024*1024;
     mudconf.cache_preload_depth = 1;
+    mudconf.cache_prefetch_misses = 2;
+    mudconf.cache_prefetch_max_size = 1024LL*1024;
+    mudconf.cache_write_thread = true;
+    mudconf.cache_write_batch_size = 64LL*1024;
+    mudconf.cache_write_delay = time_250ms;
+    mudconf.wal_checkpoint_pages = 1000;
+    mudconf.wal_checkpoint_idle.SetSeconds(10);
+    mudconf.backup_slice = time_5ms;
 
     mudconf.ip_address = nullptr;
     mudconf.ports.push_back(2860);
@@ -127,6 +135,9 @@ void cf_init(void)
     mudconf.have_zones = true;
     mudconf.paranoid_alloc = false;
     mudconf.sig_action = SA_DFLT;
+    mudconf.network_engine = NE_AUTO;
+    mudconf.tls_workers = 2;
+    mudconf.io_threads = 0;
     mudconf.max_name_protect = 5;
     mudconf.max_players = -1;
     mudconf.dump_interval = 3600;
@@ -238,6 +249,8 @@ void cf_init(void)
     mudconf.float_precision = -1;
 
     mudconf.autozone        = true;
+    mudconf.ast_cache_max   = 8192;
+    mudconf.function_memo_max = 1024;
     mudconf.jit_code_slots  = 7;    // all slots (#2129); 1 = old behaviour
     mudconf.jit_compile_cache_max = 2048;  // #2130: cover the measured
                                            // ~1500-program live working set
@@ -332,6 +345,7 @@ void cf_init(void)
         LOG_SHOUTS | LOG_STARTUP | LOG_WIZARD | LOG_SUSPECTCMDS |
         LOG_PROBLEMS | LOG_PCREATES | LOG_TIMEUSE;
     mudconf.log_info = LOGOPT_TIMESTAMP | LOGOPT_LOC;
+    mudconf.event_log = 0;
     mudconf.markdata[0] = 0x01;
     mudconf.markdata[1] = 0x02;
     mudconf.markdata[2] = 0x04;
@@ -443,6 +457,8 @@ void cf_init(void)
     mudstate.func_invk_ctr = 0;
     mudstate.wild_invk_ctr = 0;
     mudstate.ntfy_nest_lev = 0;
+    mudstate.notify_direct = 0;
+    mudstate.notify_full = 0;
     mudstate.include_nest_lev = 0;
     mudstate.train_nest_lev = 0;
     mudstate.lock_nest_lev = 0;
@@ -2061,17 +2077,24 @@ static CONFPARM conftable[] =
 {
     {T("access"),                    cf_access,      CA_GOD,    CA_DISABLED, nullptr,                         access_nametab,     0},
     {T("alias"),                     cf_cmd_alias,   CA_GOD,    CA_DISABLED, reinterpret_cast<int *>(&mudstate.command_htab),   0,                  0},
+    {T("ast_cache_max"),             cf_int,         CA_GOD,    CA_WIZARD,   &mudconf.ast_cache_max,          nullptr,            0},
     {T("attr_access"),               cf_attr_access, CA_GOD,    CA_DISABLED, reinterpret_cast<int *>(&mudstate.attrperm_list),  attraccess_nametab, 0},
     {T("attr_alias"),                cf_attr_name_alias,CA_GOD, CA_DISABLED, nullptr,                         nullptr,            0},
     {T("attr_cmd_access"),           cf_acmd_access, CA_GOD,    CA_DISABLED, nullptr,                         access_nametab,     0},
     {T("attr_name_charset"),         cf_modify_bits, CA_GOD,    CA_PUBLIC,   &mudconf.attr_name_charset,      allow_charset_nametab, 0},
     {T("autozone"),                  cf_bool,        CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(&mudconf.autozone),        nullptr,            0},
+    {T("backup_slice"),              cf_seconds,     CA_GOD,    CA_GOD,      reinterpret_cast<int *>(&mudconf.backup_slice), nullptr,               0},
     {T("bad_name"),                  cf_badname,     CA_GOD,    CA_DISABLED, nullptr,                         nullptr,            0},
     {T("badsite_file"),              cf_string_dyn,  CA_STATIC, CA_GOD,      reinterpret_cast<int *>(&mudconf.site_file),       nullptr, SIZEOF_PATHNAME},
     {T("cache_names"),               cf_bool,        CA_STATIC, CA_GOD,      reinterpret_cast<int *>(&mudconf.cache_names),     nullptr,            0},
     {T("cache_tick_period"),         cf_seconds,     CA_GOD,    CA_WIZARD,   reinterpret_cast<int *>(&mudconf.cache_tick_period), nullptr,          0},
     {T("cache_max_size"),            cf_size,        CA_GOD,    CA_GOD,      reinterpret_cast<int *>(&mudconf.max_cache_size),  nullptr,            0},
+    {T("cache_prefetch_max_size"),   cf_size,        CA_GOD,    CA_GOD,      reinterpret_cast<int *>(&mudconf.cache_prefetch_max_size), nullptr,    0},
+    {T("cache_prefetch_misses"),     cf_int,         CA_GOD,    CA_GOD,      &mudconf.cache_prefetch_misses,  nullptr,            0},
     {T("cache_preload_depth"),       cf_int,         CA_GOD,    CA_GOD,      &mudconf.cache_preload_depth,    nullptr,            0},
+    {T("cache_write_batch_size"),    cf_size,        CA_GOD,    CA_GOD,      reinterpret_cast<int *>(&mudconf.cache_write_batch_size), nullptr,     0},
+    {T("cache_write_delay"),         cf_seconds,     CA_GOD,    CA_GOD,      reinterpret_cast<int *>(&mudconf.cache_write_delay), nullptr,          0},
+    {T("cache_write_thread"),        cf_bool,        CA_GOD,    CA_GOD,      reinterpret_cast<int *>(&mudconf.cache_write_thread), nullptr,         0},
     {T("check_interval"),            cf_int,         CA_GOD,    CA_WIZARD,   &mudconf.check_interval,         nullptr,            0},
     {T("check_offset"),              cf_int,         CA_GOD,    CA_WIZARD,   &mudconf.check_offset,           nullptr,            0},
     {T("clone_copies_cost"),         cf_bool,        CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(&mudconf.clone_copy_cost), nullptr,            0},
@@ -2099,6 +2122,7 @@ static CONFPARM conftable[] =
     {T("dump_message"),              cf_string,      CA_GOD,    CA_WIZARD,   reinterpret_cast<int *>(mudconf.dump_msg),         nullptr,          256},
     {T("dump_offset"),               cf_int,         CA_GOD,    CA_WIZARD,   &mudconf.dump_offset,            nullptr,            0},
     {T("earn_limit"),                cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.paylimit,               nullptr,            0},
+    {T("event_log"),                 cf_modify_bits, CA_GOD,    CA_DISABLED, &mudconf.event_log,              logoptions_nametab, 0},
     {T("eval_comtitle"),             cf_bool,        CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(&mudconf.eval_comtitle),   nullptr,            0},
     {T("events_daily_hour"),         cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.events_daily_hour,      nullptr,            0},
     {T("examine_flags"),             cf_bool,        CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(&mudconf.ex_flags),        nullptr,            0},
@@ -2124,6 +2148,7 @@ static CONFPARM conftable[] =
     {T("function_access"),           cf_func_access, CA_GOD,    CA_DISABLED, nullptr,                         access_nametab,     0},
     {T("function_alias"),            cf_function_alias,CA_GOD,  CA_DISABLED, nullptr,                         nullptr,            0},
     {T("function_invocation_limit"), cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.func_invk_lim,          nullptr,            0},
+    {T("function_memo_max"),         cf_int,         CA_GOD,    CA_WIZARD,   &mudconf.function_memo_max,      nullptr,            0},
     {T("function_name"),             cf_function_name, CA_GOD,  CA_DISABLED, nullptr,                         nullptr,            0},
     {T("function_recursion_limit"),  cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.func_nest_lim,          nullptr,            0},
     {T("global_error_obj"),          cf_dbref,       CA_GOD,    CA_GOD,      &mudconf.global_error_obj,       nullptr,            0},
@@ -2148,6 +2173,7 @@ static CONFPARM conftable[] =
     {T("indent_desc"),               cf_bool,        CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(&mudconf.indent_desc),     nullptr,            0},
     {T("initial_size"),              cf_int,         CA_STATIC, CA_WIZARD,   &mudconf.init_size,              nullptr,            0},
     {T("input_database"),            cf_string_dyn,  CA_STATIC, CA_GOD,      reinterpret_cast<int *>(&mudconf.indb),            nullptr, SIZEOF_PATHNAME},
+    {T("io_threads"),                cf_int,         CA_STATIC, CA_GOD,      &mudconf.io_threads,             nullptr,            0},
     {T("ip_address"),                cf_string_dyn,  CA_STATIC, CA_GOD,      reinterpret_cast<int *>(&mudconf.ip_address),      nullptr,    LBUF_SIZE},
     {T("jit_code_slots"),            cf_int,         CA_GOD,    CA_WIZARD,   &mudconf.jit_code_slots,         nullptr,            0},
     {T("jit_compile_cache_max"),     cf_int,         CA_GOD,    CA_WIZARD,   &mudconf.jit_compile_cache_max,  nullptr,            0},
@@ -2188,6 +2214,7 @@ static CONFPARM conftable[] =
     {T("module"),                    cf_module,      CA_GOD,    CA_WIZARD,   nullptr,                  nullptr,            0},
     {T("mud_name"),                  cf_string,      CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(mudconf.mud_name),         nullptr,           32},
     {T("language"),                  cf_string,      CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(mudconf.language),         nullptr,           32},
+    {T("network_engine"),            cf_option,      CA_STATIC, CA_GOD,      &mudconf.network_engine,         network_engine_nametab, 0},
     {T("newuser_file"),              cf_string_dyn,  CA_STATIC, CA_GOD,      reinterpret_cast<int *>(&mudconf.crea_file),       nullptr, SIZEOF_PATHNAME},
     {T("no_flash"),                  cf_bool,        CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(&g_no_flash),             nullptr,            0},
     {T("noguest_site"),              cf_site,        CA_GOD,    CA_DISABLED, nullptr,    nullptr,   HC_NOGUEST},
@@ -2295,6 +2322,7 @@ static CONFPARM conftable[] =
     {T("thing_parent"),              cf_dbref,       CA_GOD,    CA_PUBLIC,   &mudconf.thing_parent,           nullptr,            0},
     {T("thing_quota"),               cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.thing_quota,            nullptr,            0},
     {T("timeslice"),                 cf_seconds,     CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(&mudconf.timeslice),       nullptr,            0},
+    {T("tls_workers"),               cf_int,         CA_STATIC, CA_GOD,      &mudconf.tls_workers,            nullptr,            0},
     {T("toad_recipient"),            cf_dbref,       CA_GOD,    CA_WIZARD,   &mudconf.toad_recipient,         nullptr,            0},
     {T("trace_output_limit"),        cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.trace_limit,            nullptr,            0},
     {T("trace_topdown"),             cf_bool,        CA_GOD,    CA_PUBLIC,   reinterpret_cast<int *>(&mudconf.trace_topdown),   nullptr,            0},
@@ -2304,6 +2332,8 @@ static CONFPARM conftable[] =
     {T("user_attr_per_hour"),        cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.vattr_per_hour,         nullptr,            0},
     {T("vlimit"),                    cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.vlimit,                 nullptr,            0},
     {T("wait_cost"),                 cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.waitcost,               nullptr,            0},
+    {T("wal_checkpoint_idle"),       cf_seconds,     CA_GOD,    CA_GOD,      reinterpret_cast<int *>(&mudconf.wal_checkpoint_idle), nullptr,        0},
+    {T("wal_checkpoint_pages"),      cf_int,         CA_GOD,    CA_GOD,      &mudconf.wal_checkpoint_pages,   nullptr,            0},
     {T("wizard_motd_file"),          cf_string_dyn,  CA_STATIC, CA_GOD,      reinterpret_cast<int *>(&mudconf.wizmotd_file),    nullptr, SIZEOF_PATHNAME},
     {T("wizard_motd_message"),       cf_string,      CA_GOD,    CA_WIZARD,   reinterpret_cast<int *>(mudconf.wizmotd_msg),      nullptr,    GBUF_SIZE},
     {T("zone_recursion_limit"),      cf_int,         CA_GOD,    CA_PUBLIC,   &mudconf.zone_nest_lim,          nullptr,            0},
@@ -178,6 +178,16 @@ void broadcast_and_flush(int inflags, const UTF8 *text)
     if (g_pConnMgr) g_pConnMgr->BroadcastAndFlush(inflags, text);
 }
 
+void begin_broadcast(void)
+{
+    if (g_pConnMgr) g_pConnMgr->BeginBroadcast();
+}
+
+void end_broadcast(void)
+{
+    if (g_pConnMgr) g_pConnMgr->EndBroadcast();
+}
+
 void send_prog_prompt(dbref target)
 {
     if (g_pConnMgr) g_pConnMgr->SendProgPrompt(target);
@@ -707,6 +717,16 @@ NAMETAB sigactions_nametab[] =
     {static_cast<UTF8 *>(nullptr), 0,  0,  0}
 };
 
+NAMETAB network_engine_nametab[] =
+{
+    {T("auto"),        1,  0,  NE_AUTO},
+    {T("epoll"),       1,  0,  NE_EPOLL},
+    {T("io_uring"),    1,  0,  NE_IO_URING},
+    {T("kqueue"),      1,  0,  NE_KQUEUE},
+    {T("select"),      1,  0,  NE_SELECT},
+    {static_cast<UTF8 *>(nullptr), 0,  0,  0}
+};
+
 NAMETAB logout_cmdtable[] =
 {
     {T("DOING"),         5,  CA_PUBLIC,  CMD_DOING},
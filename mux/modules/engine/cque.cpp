@@ -620,9 +620,30 @@ int halt_que(const dbref executor, const dbref object)
     Halt_Player_Run    = NOTHING;
     Halt_Entries_Run   = 0;
 
-    // Process @wait, timed semaphores, and untimed semaphores.
+    // Process @wait, timed semaphores, and untimed semaphores.  A halt aimed
+    // at an object or an owner only needs the entries filed under the
+    // objects involved.
     //
-    scheduler.TraverseUnordered(CallBack_HaltQueue);
+    if (NOTHING != object)
+    {
+        scheduler.TraverseObject(object, CallBack_HaltQueue);
+    }
+    else if (NOTHING != executor)
+    {
+        std::vector<dbref> objects;
+        scheduler.QueuedObjects(objects);
+        for (const auto obj : objects)
+        {
+            if (Owner(obj) == executor)
+            {
+                scheduler.TraverseObject(obj, CallBack_HaltQueue);
+            }
+        }
+    }
+    else
+    {
+        scheduler.TraverseUnordered(CallBack_HaltQueue);
+    }
 
     if (Halt_Player_Run != NOTHING)
     {
@@ -719,7 +740,7 @@ static int halt_que_pid(const dbref executor, const uint64_t pid)
     Halt_Pid_Player_Run  = NOTHING;
     Halt_Pid_Entries_Run = 0;
 
-    scheduler.TraverseUnordered(CallBack_HaltQueueByPid);
+    scheduler.TraverseTicket(pid, CallBack_HaltQueueByPid);
 
     if (Halt_Pid_Player_Run != NOTHING)
     {
@@ -1020,11 +1041,11 @@ int nfy_que(dbref sem, int attr, int key, int count)
         Notify_Num_Max = count;
         if (NFY_NFY == (key & NFY_MASK))
         {
-            scheduler.TraverseOrdered(CallBack_NotifySemaphoreFirst);
+            scheduler.TraverseSemaphore(sem, true, CallBack_NotifySemaphoreFirst);
         }
         else
         {
-            scheduler.TraverseUnordered(CallBack_NotifySemaphoreDrainOrAll);
+            scheduler.TraverseSemaphore(sem, false, CallBack_NotifySemaphoreDrainOrAll);
         }
     }
 
@@ -1409,12 +1430,12 @@ bool wait_que
         if (tmp->IsTimed)
         {
             bDeferred = scheduler.DeferTask(tmp->waittime, iPriority,
-                Task_RunQueueEntry, tmp, 0);
+                Task_RunQueueEntry, tmp, 0, tmp->executor);
         }
         else
         {
             bDeferred = scheduler.DeferImmediateTask(iPriority,
-                Task_RunQueueEntry, tmp, 0);
+                Task_RunQueueEntry, tmp, 0, tmp->executor);
         }
     }
     else
@@ -1428,7 +1449,7 @@ bool wait_que
             iPriority = PRIORITY_SUSPEND;
         }
         bDeferred = scheduler.DeferTask(tmp->waittime, iPriority,
-            Task_SemaphoreTimeout, tmp, 0);
+            Task_SemaphoreTimeout, tmp, 0, tmp->executor, sem);
     }
 
     // #1871: if the scheduler could not hold a TASK_RECORD, the command is
@@ -1589,7 +1610,7 @@ void sql_que
     // but must be initialized before DeferTask.
     //
     tmp->waittime.GetUTC();
-    if (!scheduler.DeferTask(tmp->waittime, PRIORITY_SUSPEND, Task_SQLTimeout, tmp, 0))
+    if (!scheduler.DeferTask(tmp->waittime, PRIORITY_SUSPEND, Task_SQLTimeout, tmp, 0, tmp->executor))
     {
         // #1871: same rollback as wait_que / Query-reject path.
         //
@@ -1028,7 +1028,7 @@ void do_pcreate
 
     const UTF8 *pmsg;
     const bool isrobot = (key == PCRE_ROBOT);
-    const dbref newplayer = create_player(name, pass, executor, isrobot, &pmsg);
+    const dbref newplayer = create_player(name, pass, executor, isrobot, true, &pmsg);
     if (newplayer == NOTHING)
     {
         notify_quiet(executor, tprintf(M_("Failure creating ‘%s’.  %s"), name, pmsg));
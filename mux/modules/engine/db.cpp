@@ -17,6 +17,7 @@
 #include "autoconf.h"
 #include "config.h"
 #include "externs.h"
+#include "eventlog.h"
 
 #include "routing.h"
 #include "sqlite_backend.h"
@@ -132,6 +133,8 @@ void attr_mod_count_invalidate_all()
     // restart from 0 on next access, which is correct because the
     // JIT code cache is also cleared on database reload.
     s_attr_mod_counts.clear();
+    lock_cache_invalidate_all();
+    ast_attr_index_invalidate_all();
 }
 
 uint32_t attr_mod_count_get(dbref obj, int attrnum)
@@ -1174,6 +1177,7 @@ void do_fixdb
             log_text(T(" renamed to "));
             log_text(pValidName);
             ENDLOG;
+            LOG_EVENT(LOG_SECURITY, EVLOG_RENAME, 0, thing, NOTHING, pValidName, nullptr);
 
             if (Suspect(executor))
             {
@@ -2449,15 +2453,55 @@ bool atr_get_info(dbref thing, int atr, dbref *owner, int *flags)
     return true;
 }
 
+// Once thing itself has come up empty, read atr from all of its parents at
+// once rather than one cache miss per level.  absent[lev-1] is set for each
+// level now known not to have it.  Returns the number of levels covered.
+//
+#define PGET_CHAIN_MAX 16
+
+static int atr_pget_prefetch(dbref thing, int atr, bool *absent)
+{
+    dbref chain[PGET_CHAIN_MAX];
+    int nChain = 0;
+    dbref parent = Parent(thing);
+    for (int lev = 1;
+            Good_obj(parent)
+         && lev < mudconf.parent_nest_lim
+         && nChain < PGET_CHAIN_MAX;
+         parent = Parent(parent), lev++)
+    {
+        chain[nChain++] = parent;
+    }
+    cache_prefetch_chain(chain, nChain, atr, absent);
+    return nChain;
+}
+
+// Which object in the parent chain the last atr_pget*() took its text from.
+//
+static dbref s_pget_source = NOTHING;
+
+dbref atr_pget_source(void)
+{
+    return s_pget_source;
+}
+
 UTF8 *atr_pget_str_LEN(UTF8 *s, dbref thing, int atr, dbref *owner, int *flags, size_t *pLen)
 {
     dbref parent;
     int lev;
     ATTR *ap;
     const UTF8 *buff;
+    bool absent[PGET_CHAIN_MAX];
+    int nChain = 0;
 
     ITER_PARENTS(thing, parent, lev)
     {
+        if (  0 < lev
+           && lev <= nChain
+           && absent[lev - 1])
+        {
+            continue;
+        }
         buff = atr_get_raw_LEN(parent, atr, pLen);
         if (buff && *buff)
         {
@@ -2467,6 +2511,7 @@ UTF8 *atr_pget_str_LEN(UTF8 *s, dbref thing, int atr, dbref *owner, int *flags,
             if (  lev == 0
                || !(*flags & AF_PRIVATE))
             {
+                s_pget_source = parent;
                 return s;
             }
         }
@@ -2478,8 +2523,10 @@ UTF8 *atr_pget_str_LEN(UTF8 *s, dbref thing, int atr, dbref *owner, int *flags,
             {
                 break;
             }
+            nChain = atr_pget_prefetch(thing, atr, absent);
         }
     }
+    s_pget_source = NOTHING;
     *owner = Owner(thing);
     *flags = 0;
     *s = '\0';
@@ -2513,8 +2560,17 @@ bool atr_pget_info(dbref thing, int atr, dbref *owner, int *flags)
     int lev;
     ATTR *ap;
 
+    bool absent[PGET_CHAIN_MAX];
+    int nChain = 0;
+
     ITER_PARENTS(thing, parent, lev)
     {
+        if (  0 < lev
+           && lev <= nChain
+           && absent[lev - 1])
+        {
+            continue;
+        }
         size_t nLen;
         const UTF8 *buff = atr_get_raw_LEN(parent, atr, &nLen);
         if (buff && *buff)
@@ -2531,6 +2587,7 @@ bool atr_pget_info(dbref thing, int atr, dbref *owner, int *flags)
             ap = atr_num(atr);
             if (!ap || ap->flags & AF_PRIVATE)
                 break;
+            nChain = atr_pget_prefetch(thing, atr, absent);
         }
     }
     *owner = Owner(thing);
@@ -2952,6 +3009,7 @@ void db_free(void)
     mudstate.db_top = 0;
     mudstate.db_size = 0;
     mudstate.freelist = NOTHING;
+    lock_cache_invalidate_all();
 }
 
 bool db_make_minimal(void)
@@ -3075,7 +3133,7 @@ bool db_make_minimal(void)
     //
     load_player_names();
     const UTF8 *pmsg;
-    dbref obj = create_player(T("Wizard"), T("potrzebie"), NOTHING, false, &pmsg);
+    dbref obj = create_player(T("Wizard"), T("potrzebie"), NOTHING, false, false, &pmsg);
     if (obj == NOTHING)
     {
         Log.WriteString(T("db_make_minimal: failed to create Wizard player.\n"));
@@ -13,9 +13,11 @@
 #include "externs.h"
 #include "color_ops.h"
 #include "sqlite_backend.h"
+#include "regexcache.h"
 
-#define PCRE2_CODE_UNIT_WIDTH 8
-#include <pcre2.h>
+#include <future>
+#include <memory>
+#include <thread>
 
 void do_dump(dbref executor, dbref caller, dbref enactor, int eval, int key)
 {
@@ -58,6 +60,186 @@ void report(void)
     }
 }
 
+/* ----------------------------------------------------------------------
+ * Regex cache: compiled patterns shared by REGEXP $-commands, ^-listens,
+ * regexp @filter/@infilter attributes, and the regex functions.
+ *
+ * Compilation depends only on the pattern and its options, which together
+ * form the key, so an entry never goes stale and the cache is only bounded,
+ * never invalidated.  A pattern that fails to compile is not cached.
+ *
+ * JIT compilation costs several times an ordinary compile, so it waits until
+ * a pattern is used a second time -- or is requested up front by a caller
+ * about to match one pattern against many subjects.  pcre2_match() uses the
+ * JIT code whenever it is present, and the interpreter otherwise, including
+ * when PCRE2 was built without JIT support.
+ */
+
+struct regex_cache_entry
+{
+    pcre2_code *re = nullptr;
+    bool jit_tried = false;
+    std::vector<pcre2_match_data *> spare;
+
+    ~regex_cache_entry()
+    {
+        for (auto md : spare)
+        {
+            pcre2_match_data_free(md);
+        }
+        pcre2_code_free(re);
+    }
+};
+
+struct RegexCacheSlot
+{
+    std::shared_ptr<regex_cache_entry> entry;
+    std::list<std::string>::iterator lru_it;
+};
+
+static std::unordered_map<std::string, RegexCacheSlot> s_regexCache;
+static std::list<std::string> s_regexLru;
+static const size_t REGEX_CACHE_MAX = 512;
+static const size_t REGEX_SPARE_MAX = 2;
+static const size_t REGEX_JIT_STACK_MIN = 32*1024;
+static const size_t REGEX_JIT_STACK_MAX = 1024*1024;
+
+static uint64_t s_regex_hits = 0;
+static uint64_t s_regex_misses = 0;
+static uint64_t s_regex_errors = 0;
+static uint64_t s_regex_jit = 0;
+static uint64_t s_regex_jit_failed = 0;
+static uint64_t s_regex_md_created = 0;
+
+static void regex_jit(regex_cache_entry *pEntry)
+{
+    pEntry->jit_tried = true;
+    if (0 == pcre2_jit_compile(pEntry->re, PCRE2_JIT_COMPLETE))
+    {
+        s_regex_jit++;
+    }
+    else
+    {
+        s_regex_jit_failed++;
+    }
+}
+
+RegexLease::RegexLease(const UTF8 *pattern, uint32_t options, bool bJit)
+    : m_md(nullptr), m_errcode(0)
+{
+    const size_t n = strlen(reinterpret_cast<const char *>(pattern));
+    std::string key;
+    key.reserve(sizeof(options) + n);
+    key.append(reinterpret_cast<const char *>(&options), sizeof(options));
+    key.append(reinterpret_cast<const char *>(pattern), n);
+
+    auto it = s_regexCache.find(key);
+    if (it != s_regexCache.end())
+    {
+        s_regex_hits++;
+        s_regexLru.splice(s_regexLru.begin(), s_regexLru, it->second.lru_it);
+        m_entry = it->second.entry;
+        bJit = true;
+    }
+    else
+    {
+        s_regex_misses++;
+        PCRE2_SIZE erroffset;
+        pcre2_code *re = pcre2_compile_8(pattern, n, options, &m_errcode,
+            &erroffset, nullptr);
+        if (nullptr == re)
+        {
+            s_regex_errors++;
+            return;
+        }
+        m_entry = std::make_shared<regex_cache_entry>();
+        m_entry->re = re;
+
+        while (s_regexCache.size() >= REGEX_CACHE_MAX)
+        {
+            s_regexCache.erase(s_regexLru.back());
+            s_regexLru.pop_back();
+        }
+        s_regexLru.push_front(key);
+        s_regexCache[key] = {m_entry, s_regexLru.begin()};
+    }
+
+    if (  bJit
+       && !m_entry->jit_tried)
+    {
+        regex_jit(m_entry.get());
+    }
+
+    if (!m_entry->spare.empty())
+    {
+        m_md = m_entry->spare.back();
+        m_entry->spare.pop_back();
+    }
+    else
+    {
+        m_md = pcre2_match_data_create_from_pattern(m_entry->re, nullptr);
+        s_regex_md_created++;
+    }
+}
+
+RegexLease::~RegexLease()
+{
+    if (nullptr != m_md)
+    {
+        if (m_entry->spare.size() < REGEX_SPARE_MAX)
+        {
+            m_entry->spare.push_back(m_md);
+        }
+        else
+        {
+            pcre2_match_data_free(m_md);
+        }
+    }
+}
+
+pcre2_code *RegexLease::code(void) const
+{
+    return m_entry ? m_entry->re : nullptr;
+}
+
+pcre2_match_context *RegexLease::context(void) const
+{
+    static pcre2_match_context *s_pContext = nullptr;
+    if (nullptr == s_pContext)
+    {
+        s_pContext = pcre2_match_context_create(nullptr);
+        pcre2_jit_stack *pStack = pcre2_jit_stack_create(REGEX_JIT_STACK_MIN,
+            REGEX_JIT_STACK_MAX, nullptr);
+        if (  nullptr != s_pContext
+           && nullptr != pStack)
+        {
+            pcre2_jit_stack_assign(s_pContext, nullptr, pStack);
+        }
+    }
+    return s_pContext;
+}
+
+void list_regex_cache_stats(dbref player)
+{
+    const uint64_t total = s_regex_hits + s_regex_misses;
+    UTF8 szHitPct[64];
+    mux_sprintf(szHitPct, sizeof(szHitPct), T("%.1f"),
+        (0 < total) ? (100.0 * s_regex_hits / total) : 0.0);
+
+    notify(player, M_("--- Regex Cache ---"));
+    notify(player, tprintf(T("Entries: %lu   Max: %lu   Hits: %llu   Misses: %llu   Hit rate: %s%%"),
+        static_cast<unsigned long>(s_regexCache.size()),
+        static_cast<unsigned long>(REGEX_CACHE_MAX),
+        static_cast<unsigned long long>(s_regex_hits),
+        static_cast<unsigned long long>(s_regex_misses),
+        szHitPct));
+    notify(player, tprintf(T("Compile errors: %llu   JIT: %llu   JIT failed: %llu   Match data created: %llu"),
+        static_cast<unsigned long long>(s_regex_errors),
+        static_cast<unsigned long long>(s_regex_jit),
+        static_cast<unsigned long long>(s_regex_jit_failed),
+        static_cast<unsigned long long>(s_regex_md_created)));
+}
+
 /* ----------------------------------------------------------------------
  * regexp_match: Load a regular expression match and insert it into
  * registers.
@@ -74,36 +256,19 @@ bool regexp_match
 {
     int matches;
     int i;
-    PCRE2_SIZE erroffset;
-    int errcode;
 
-    /*
-     * Load the regexp pattern. This allocates memory which must be
-     * later freed. PCRE2 code objects must be explicitly freed with pcre2_code_free().
-     */
-    pcre2_code *re;
     if (alarm_clock.alarmed)
     {
         return false;
     }
 
-    re = pcre2_compile_8(pattern, PCRE2_ZERO_TERMINATED, PCRE2_UTF|case_opt,
-                         &errcode, &erroffset, nullptr);
-    if (re == nullptr)
-    {
-        /*
-         * This is a matching error. We have an error message in
-         * regexp_errbuf that we can ignore, since we're doing
-         * command-matching.
-         */
-        return false;
-    }
-
-    // Create match data block for storing results
-    pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, nullptr);
-    if (match_data == nullptr)
+    // A pattern that does not compile simply does not match; we're doing
+    // command-matching, so there is no one to tell.
+    //
+    RegexLease rx(pattern, PCRE2_UTF|case_opt);
+    pcre2_match_data *match_data = rx.match_data();
+    if (nullptr == match_data)
     {
-        pcre2_code_free(re);
         return false;
     }
 
@@ -111,12 +276,10 @@ bool regexp_match
      * Now we try to match the pattern. The relevant fields will
      * automatically be filled in by this.
      */
-    matches = pcre2_match(re, str, PCRE2_ZERO_TERMINATED, 0, 0, match_data, nullptr);
-
+    matches = pcre2_match(rx.code(), str, PCRE2_ZERO_TERMINATED, 0, 0,
+        match_data, rx.context());
     if (matches < 0)
     {
-        pcre2_match_data_free(match_data);
-        pcre2_code_free(re);
         return false;
     }
 
@@ -165,9 +328,6 @@ bool regexp_match
     {
         args[i] = nullptr;
     }
-
-    pcre2_match_data_free(match_data);
-    pcre2_code_free(re);
     return true;
 }
 
@@ -531,32 +691,15 @@ static bool check_filter(dbref object, dbref player, int filter, const UTF8 *msg
         int case_opt = (aflags & AF_CASE) ? PCRE2_CASELESS : 0;
         do
         {
-            PCRE2_SIZE erroffset;
-            int errcode;
             UTF8 *cp = parse_to(&dp, ',', EV_STRIP_CURLY);
-            pcre2_code *re;
             if (!alarm_clock.alarmed)
             {
-                re = pcre2_compile_8(cp, PCRE2_ZERO_TERMINATED, PCRE2_UTF|case_opt,
-                                   &errcode, &erroffset, nullptr);
-                if (re != nullptr)
+                RegexLease rx(cp, PCRE2_UTF|case_opt);
+                if (  nullptr != rx.match_data()
+                   && 0 <= pcre2_match(rx.code(), msg, PCRE2_ZERO_TERMINATED,
+                              0, 0, rx.match_data(), rx.context()))
                 {
-                    // Create match data block for storing results
-                    pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, nullptr);
-                    if (match_data != nullptr)
-                    {
-                        int matches = pcre2_match(re, msg, PCRE2_ZERO_TERMINATED, 0, 0,
-                                               match_data, nullptr);
-
-                        if (0 <= matches)
-                        {
-                            pcre2_match_data_free(match_data);
-                            pcre2_code_free(re);
-                            return false;
-                        }
-                        pcre2_match_data_free(match_data);
-                    }
-                    pcre2_code_free(re);
+                    return false;
                 }
             }
         } while (dp != nullptr);
@@ -683,6 +826,67 @@ bool html_escape(const UTF8 *src, UTF8 *dest, UTF8 **destp)
     return ret;
 }
 
+// Most deliveries are to a player in a room, or to an object with nothing
+// listening on it.  When no NOSPOOF prefix, HTML escaping, puppet, listen,
+// or forwarding can apply, the message is delivered as given and
+// notify_check() needs none of its work buffers.
+//
+static bool notify_is_direct(dbref target, dbref sender, int key)
+{
+    if (key & (MSG_INV | MSG_INV_EXITS | MSG_NBR | MSG_NBR_EXITS | MSG_LOC))
+    {
+        return false;
+    }
+
+    if (  (key & (MSG_FWDLIST | MSG_NBR_A | MSG_NBR_EXITS_A | MSG_LOC_A))
+       && Audible(target))
+    {
+        return false;
+    }
+
+    if (  mudstate.inpipe
+       && !isPlayer(target))
+    {
+        return false;
+    }
+
+    if (key & MSG_ME)
+    {
+        if (  Nospoof(target)
+           && target != sender
+           && target != mudstate.curr_enactor
+           && target != mudstate.curr_executor)
+        {
+            return false;
+        }
+
+        if (  isPlayer(target)
+           && !(key & MSG_HTML)
+           && Html(target))
+        {
+            return false;
+        }
+
+        if (  Puppet(target)
+           && target != Owner(target))
+        {
+            return false;
+        }
+    }
+
+    // A listen or ^-pattern needs the plain text and may match.
+    //
+    if (  !Halted(target)
+       && (  !isPlayer(target)
+          || mudconf.player_listen)
+       && (  H_Listen(target)
+          || Monitor(target)))
+    {
+        return false;
+    }
+    return true;
+}
+
 void notify_check(dbref target, dbref sender, const UTF8 *msg, int key)
 {
     // If speaker is invalid or message is empty, just exit.
@@ -723,6 +927,26 @@ void notify_check(dbref target, dbref sender, const UTF8 *msg, int key)
         return;
     }
 
+    if (notify_is_direct(target, sender, key))
+    {
+        mudstate.notify_direct++;
+        if (  (key & MSG_ME)
+           && isPlayer(target))
+        {
+            if (key & MSG_HTML)
+            {
+                raw_notify_html(target, msg);
+            }
+            else
+            {
+                raw_notify(target, msg);
+            }
+        }
+        mudstate.ntfy_nest_lev--;
+        return;
+    }
+    mudstate.notify_full++;
+
     // msg_ns: NOSPOOF prefix + msg.  All strings are PUA-encoded UTF-8.
     //
     LBuf msg_ns = LBuf_Src("notify_check.msg_ns");
@@ -1103,6 +1327,7 @@ void notify_check(dbref target, dbref sender, const UTF8 *msg, int key)
                 mux_strncpy(msgFinal, msg, LBUF_SIZE - 1);
             }
 
+            CBroadcastScope broadcast;
             DOLIST(obj, Contents(target))
             {
                 if (  obj != target
@@ -1136,6 +1361,7 @@ void notify_check(dbref target, dbref sender, const UTF8 *msg, int key)
                 mux_strncpy(msgFinal, msg, LBUF_SIZE - 1);
             }
 
+            CBroadcastScope broadcast;
             DOLIST(obj, Contents(targetloc))
             {
                 if (  obj != target
@@ -1180,6 +1406,7 @@ void notify_check(dbref target, dbref sender, const UTF8 *msg, int key)
 void notify_except(dbref loc, dbref player, dbref exception, const UTF8 *msg, int key)
 {
     dbref first;
+    CBroadcastScope broadcast;
 
     if (loc != exception)
     {
@@ -1198,6 +1425,7 @@ void notify_except(dbref loc, dbref player, dbref exception, const UTF8 *msg, in
 void notify_except2(dbref loc, dbref player, dbref exc1, dbref exc2, const UTF8 *msg)
 {
     dbref first;
+    CBroadcastScope broadcast;
 
     if (  loc != exc1
        && loc != exc2)
@@ -1218,6 +1446,7 @@ void notify_except2(dbref loc, dbref player, dbref exc1, dbref exc2, const UTF8
 void notify_except_N(dbref loc, dbref player, dbref aExclude[], int nExclude, const UTF8 *msg, int key)
 {
     dbref first;
+    CBroadcastScope broadcast;
 
     // Notify loc itself unless it's in the exclude list.
     //
@@ -1434,6 +1663,7 @@ void do_shutdown
         //
         emergency_shutdown();
 
+        backup_abort();
         local_presync_database();
         ServerEventsSinkNode *p = g_pServerEventsSinkListHead;
         while (nullptr != p)
@@ -1456,6 +1686,11 @@ void do_shutdown
         log_text(T("Panic dump: "));
         log_text(mudconf.crashdb);
         ENDLOG;
+
+        // The panic dump may not survive to StopLogging; get the log onto
+        // disk first.
+        //
+        Log.Sync();
         dump_database_internal(DUMP_I_PANIC);
         STARTLOG(LOG_ALWAYS, "DMP", "DONE");
         log_text(T("Panic dump complete: "));
@@ -1647,6 +1882,7 @@ void dump_database(void)
     log_text(buff);
     ENDLOG;
 
+    password_hash_shutdown();
     local_presync_database();
     ServerEventsSinkNode *p = g_pServerEventsSinkListHead;
     while (nullptr != p)
@@ -1682,6 +1918,8 @@ void dump_database(void)
     }
 }
 
+static bool backup_verifying(void);
+
 void fork_and_dump(int key)
 {
 #if defined(HAVE_WORKING_FORK)
@@ -1775,6 +2013,13 @@ void fork_and_dump(int key)
         bAttemptFork = false;
     }
 #endif // !HAVE_PREAD !HAVE_PWRITE
+    if (backup_verifying())
+    {
+        // The @backup check is inside SQLite on a thread of its own, which
+        // the child could not count on having left SQLite's locks free.
+        //
+        bAttemptFork = false;
+    }
 #endif // HAVE_WORKING_FORK
 
     if (key & (DUMP_STRUCT|DUMP_FLATFILE))
@@ -1782,7 +2027,16 @@ void fork_and_dump(int key)
 #if defined(HAVE_WORKING_FORK)
         if (bAttemptFork)
         {
+            // What is logged so far reaches the file ahead of anything the
+            // child writes there itself.
+            //
+            Log.Sync();
+            cache_before_fork();
             child = fork();
+            if (0 != child)
+            {
+                cache_after_fork_parent();
+            }
         }
         if (child == 0)
         {
@@ -1792,6 +2046,12 @@ void fork_and_dump(int key)
             // alarm_clock.clear() — it locks a std::mutex that may have been
             // inherited locked across fork(), deadlocking the dump child.
             alarm_clock.alarmed.store(false);
+
+            // Likewise the log writer thread.  The child writes its log
+            // entries itself, and leaves the event log to the parent.
+            //
+            Log.AfterFork();
+            eventlog_after_fork();
 #endif // HAVE_WORKING_FORK
 
             if (key & DUMP_STRUCT)
@@ -1866,6 +2126,383 @@ void fork_and_dump(int key)
     }
 }
 
+// ---------------------------------------------------------------------------
+// @backup: a consistent copy of the SQLite database, made while the game
+// runs.  The copy is taken from one read snapshot and advanced a slice at a
+// time from a scheduler task, so the game thread never spends more than
+// backup_slice on it at once.  It is written beside the destination, checked
+// on a thread of its own, and only then renamed into place.
+// ---------------------------------------------------------------------------
+
+struct BACKUP_STATE
+{
+    std::unique_ptr<CSQLiteBackup> pBackup;
+    std::future<std::string> verify;    // From a promise; never blocks.
+    std::thread verifier;               // Joined by backup_end.
+    std::atomic<bool> bCancelVerify{false};
+    dbref   executor;
+    UTF8    szDest[SIZEOF_PATHNAME];
+    UTF8    szTemp[SIZEOF_PATHNAME + 16];
+    int     nPages;         // Pages per sqlite3_backup_step() call.
+    int     nLastTenth;     // Last progress report, in tenths.
+    CLinearTimeAbsolute ltaStart;
+};
+
+static BACKUP_STATE *s_pBackupState = nullptr;
+
+// The verify thread is inside SQLite until its result is in.
+//
+static bool backup_verifying(void)
+{
+    return nullptr != s_pBackupState
+        && s_pBackupState->verifier.joinable()
+        && std::future_status::ready
+           != s_pBackupState->verify.wait_for(std::chrono::seconds(0));
+}
+
+static void Task_BackupStep(void *arg_voidptr, int arg_Integer);
+static void Task_BackupVerify(void *arg_voidptr, int arg_Integer);
+
+static void backup_notify(const UTF8 *msg)
+{
+    if (Good_obj(s_pBackupState->executor))
+    {
+        notify(s_pBackupState->executor, msg);
+    }
+}
+
+static void backup_end(bool bSuccess, const UTF8 *pReason)
+{
+    BACKUP_STATE *bs = s_pBackupState;
+
+    // A check still running has the copy open.  Stop it before the copy
+    // can be removed, and before its flag goes away with bs.
+    //
+    if (bs->verifier.joinable())
+    {
+        bs->bCancelVerify.store(true, std::memory_order_release);
+        bs->verifier.join();
+    }
+    if (!bSuccess)
+    {
+        RemoveFile(bs->szTemp);
+    }
+
+    CLinearTimeAbsolute ltaNow;
+    ltaNow.GetUTC();
+    CLinearTimeDelta ltd = ltaNow - bs->ltaStart;
+
+    STARTLOG(LOG_DBSAVES, "DMP", "BKUP");
+    log_printf(T("Backup to %s %s"), bs->szDest,
+        bSuccess ? T("complete") : T("failed: "));
+    if (!bSuccess)
+    {
+        log_text(pReason);
+    }
+    ENDLOG;
+
+    if (bSuccess)
+    {
+        backup_notify(tprintf(T("Backup: %s written and verified in %s seconds."),
+            bs->szDest, ltd.ReturnSecondsString(1)));
+    }
+    else
+    {
+        backup_notify(tprintf(T("Backup: failed, %s."), pReason));
+    }
+    delete bs;
+    s_pBackupState = nullptr;
+}
+
+static void backup_progress(void)
+{
+    BACKUP_STATE *bs = s_pBackupState;
+    const int nTotal = bs->pBackup->PageCount();
+    if (0 < nTotal)
+    {
+        const int nDone = nTotal - bs->pBackup->Remaining();
+        const int nTenth = static_cast<int>((10LL * nDone) / nTotal);
+        if (bs->nLastTenth < nTenth && nTenth < 10)
+        {
+            bs->nLastTenth = nTenth;
+            backup_notify(tprintf(T("Backup: %d%% (%d of %d pages)."),
+                10 * nTenth, nDone, nTotal));
+        }
+    }
+}
+
+static void Task_BackupStep(void *arg_voidptr, int arg_Integer)
+{
+    UNUSED_PARAMETER(arg_voidptr);
+    UNUSED_PARAMETER(arg_Integer);
+
+    BACKUP_STATE *bs = s_pBackupState;
+    if (nullptr == bs)
+    {
+        return;
+    }
+
+    // Keep stepping until the slice is used up.  The step size is tuned
+    // so a single step is a small part of the slice.
+    //
+    CLinearTimeAbsolute ltaStart;
+    ltaStart.GetUTC();
+    CLinearTimeAbsolute ltaNow = ltaStart;
+    int rc = SQLITE_OK;
+    while (  SQLITE_OK == rc
+          && ltaNow - ltaStart < mudconf.backup_slice)
+    {
+        CLinearTimeAbsolute ltaStep = ltaNow;
+        rc = bs->pBackup->Step(bs->nPages);
+        ltaNow.GetUTC();
+        const CLinearTimeDelta ltdStep = ltaNow - ltaStep;
+        if (ltdStep * 8 < mudconf.backup_slice)
+        {
+            if (bs->nPages < 65536)
+            {
+                bs->nPages *= 2;
+            }
+        }
+        else if (  mudconf.backup_slice < ltdStep * 4
+                && 1 < bs->nPages)
+        {
+            bs->nPages /= 2;
+        }
+    }
+
+    if (SQLITE_OK == rc)
+    {
+        backup_progress();
+        scheduler.DeferTask(ltaNow + mudconf.backup_slice, PRIORITY_SYSTEM,
+            Task_BackupStep, nullptr, 0);
+        return;
+    }
+
+    const bool bCopied = (SQLITE_DONE == rc);
+    LBuf szReason = LBuf_Src("Task_BackupStep");
+    mux_strncpy(szReason, reinterpret_cast<const UTF8 *>(bs->pBackup->ErrorMessage()),
+        LBUF_SIZE - 1);
+    if (!bs->pBackup->Finish() && bCopied)
+    {
+        mux_strncpy(szReason, reinterpret_cast<const UTF8 *>(bs->pBackup->ErrorMessage()),
+            LBUF_SIZE - 1);
+        backup_end(false, szReason);
+        return;
+    }
+    if (!bCopied)
+    {
+        backup_end(false, szReason);
+        return;
+    }
+
+    backup_notify(T("Backup: copied, verifying."));
+
+    // The check runs on a thread of its own, polled from Task_BackupVerify.
+    // A backup abandoned meanwhile cancels it and joins it in backup_end,
+    // which takes no longer than SQLite's next progress callback.
+    //
+    const std::string temp(reinterpret_cast<const char *>(bs->szTemp));
+    auto done = std::make_shared<std::promise<std::string>>();
+    const std::atomic<bool> *pbCancel = &bs->bCancelVerify;
+    bs->verify = done->get_future();
+    try
+    {
+        bs->verifier = std::thread([temp, done, pbCancel]
+        {
+            done->set_value(CSQLiteBackup::Verify(temp.c_str(), pbCancel));
+        });
+    }
+    catch (const std::system_error &)
+    {
+        // No thread to spare; check it here instead.
+        //
+        done->set_value(CSQLiteBackup::Verify(temp.c_str()));
+    }
+    scheduler.DeferTask(ltaNow + time_250ms, PRIORITY_SYSTEM,
+        Task_BackupVerify, nullptr, 0);
+}
+
+static void Task_BackupVerify(void *arg_voidptr, int arg_Integer)
+{
+    UNUSED_PARAMETER(arg_voidptr);
+    UNUSED_PARAMETER(arg_Integer);
+
+    BACKUP_STATE *bs = s_pBackupState;
+    if (nullptr == bs)
+    {
+        return;
+    }
+
+    if (std::future_status::ready != bs->verify.wait_for(std::chrono::seconds(0)))
+    {
+        CLinearTimeAbsolute ltaNow;
+        ltaNow.GetUTC();
+        scheduler.DeferTask(ltaNow + time_250ms, PRIORITY_SYSTEM,
+            Task_BackupVerify, nullptr, 0);
+        return;
+    }
+
+    const std::string problem = bs->verify.get();
+    if (!problem.empty())
+    {
+        LBuf szReason = LBuf_Src("Task_BackupVerify");
+        mux_sprintf(szReason, LBUF_SIZE, T("verify: %s"), problem.c_str());
+        backup_end(false, szReason);
+    }
+    else if (0 != ReplaceFile(bs->szTemp, bs->szDest))
+    {
+        backup_end(false, T("could not rename the finished copy into place"));
+    }
+    else
+    {
+        backup_end(true, nullptr);
+    }
+}
+
+// Stop the backup in progress, if any, and remove its unfinished copy.  A
+// check still running is cancelled first.
+//
+static void backup_cancel(const UTF8 *pReason)
+{
+    scheduler.CancelTask(Task_BackupStep, nullptr, 0);
+    scheduler.CancelTask(Task_BackupVerify, nullptr, 0);
+    s_pBackupState->pBackup->Finish();
+    backup_end(false, pReason);
+}
+
+// Called as the game goes down for @shutdown or @restart.
+//
+void backup_abort(void)
+{
+    if (nullptr != s_pBackupState)
+    {
+        backup_cancel(T("the game is going down"));
+    }
+}
+
+// True if pDest names the file pSource is, under another spelling or through
+// a link, so renaming a copy onto it would replace the live database.
+//
+static bool backup_same_file(const char *pSource, const char *pDest)
+{
+#if defined(WINDOWS_FILES)
+    char szSource[_MAX_PATH];
+    char szDest[_MAX_PATH];
+    return nullptr != _fullpath(szSource, pSource, sizeof(szSource))
+        && nullptr != _fullpath(szDest, pDest, sizeof(szDest))
+        && 0 == _stricmp(szSource, szDest);
+#else
+    struct stat sbSource;
+    struct stat sbDest;
+    return 0 == stat(pSource, &sbSource)
+        && 0 == stat(pDest, &sbDest)
+        && sbSource.st_dev == sbDest.st_dev
+        && sbSource.st_ino == sbDest.st_ino;
+#endif // WINDOWS_FILES
+}
+
+void do_backup(dbref executor, dbref caller, dbref enactor, int eval, int key,
+               UTF8 *arg1, const UTF8 *cargs[], int ncargs)
+{
+    UNUSED_PARAMETER(caller);
+    UNUSED_PARAMETER(enactor);
+    UNUSED_PARAMETER(eval);
+    UNUSED_PARAMETER(cargs);
+    UNUSED_PARAMETER(ncargs);
+
+    BACKUP_STATE *bs = s_pBackupState;
+    if (key & BACKUP_ABORT)
+    {
+        if (nullptr == bs)
+        {
+            notify(executor, M_("No backup in progress."));
+            return;
+        }
+        bs->executor = executor;
+        backup_cancel(T("aborted"));
+        return;
+    }
+
+    if (  nullptr == arg1
+       || '\0' == *arg1)
+    {
+        if (nullptr == bs)
+        {
+            notify(executor, M_("No backup in progress."));
+        }
+        else if (bs->verify.valid())
+        {
+            notify(executor, tprintf(T("Backup to %s: verifying."), bs->szDest));
+        }
+        else if (0 == bs->pBackup->PageCount())
+        {
+            notify(executor, tprintf(T("Backup to %s: starting."), bs->szDest));
+        }
+        else
+        {
+            const int nTotal = bs->pBackup->PageCount();
+            notify(executor, tprintf(T("Backup to %s: %d of %d pages copied."),
+                bs->szDest, nTotal - bs->pBackup->Remaining(), nTotal));
+        }
+        return;
+    }
+
+    if (nullptr != bs)
+    {
+        notify(executor, M_("A backup is already in progress."));
+        return;
+    }
+    if (nullptr == g_pSQLiteBackend)
+    {
+        notify(executor, M_("There is no database to back up."));
+        return;
+    }
+
+    const UTF8 *pSource = reinterpret_cast<const UTF8 *>(g_pSQLiteBackend->GetDB().GetPath());
+    if (  strlen(reinterpret_cast<char *>(arg1)) >= SIZEOF_PATHNAME
+       || 0 == strcmp(reinterpret_cast<const char *>(pSource), reinterpret_cast<char *>(arg1))
+       || backup_same_file(reinterpret_cast<const char *>(pSource), reinterpret_cast<char *>(arg1)))
+    {
+        notify(executor, M_("Invalid backup path."));
+        return;
+    }
+
+    // Everything queued so far belongs in the copy.
+    //
+    if (!cache_flush_writes())
+    {
+        notify(executor, M_("Backup: could not flush pending writes; try again."));
+        return;
+    }
+
+    bs = new BACKUP_STATE;
+    bs->executor = executor;
+    mux_strncpy(bs->szDest, arg1, sizeof(bs->szDest) - 1);
+    mux_sprintf(bs->szTemp, sizeof(bs->szTemp), T("%s.#backup#"), bs->szDest);
+    bs->nPages = 64;
+    bs->nLastTenth = 0;
+    bs->ltaStart.GetUTC();
+    s_pBackupState = bs;
+
+    RemoveFile(bs->szTemp);
+    bs->pBackup.reset(new CSQLiteBackup);
+    if (!bs->pBackup->Begin(reinterpret_cast<const char *>(pSource),
+                            reinterpret_cast<const char *>(bs->szTemp)))
+    {
+        LBuf szReason = LBuf_Src("do_backup");
+        mux_strncpy(szReason, reinterpret_cast<const UTF8 *>(bs->pBackup->ErrorMessage()),
+            LBUF_SIZE - 1);
+        backup_end(false, szReason);
+        return;
+    }
+
+    STARTLOG(LOG_DBSAVES, "DMP", "BKUP");
+    log_printf(T("Backup to %s started by #%d"), bs->szDest, executor);
+    ENDLOG;
+    notify(executor, tprintf(T("Backup: copying to %s."), bs->szDest));
+    scheduler.DeferImmediateTask(PRIORITY_SYSTEM, Task_BackupStep, nullptr, 0);
+}
+
 #define LOAD_GAME_SUCCESS           0
 #define LOAD_GAME_NO_INPUT_DB     (-1)
 #define LOAD_GAME_CANNOT_OPEN     (-2)
@@ -712,6 +712,8 @@ public:
     virtual MUX_RESULT RawNotify(dbref target, const UTF8 *msg);
     virtual MUX_RESULT NotifyCheck(dbref target, dbref sender,
         const UTF8 *msg, int key);
+    virtual MUX_RESULT BeginBroadcast(void);
+    virtual MUX_RESULT EndBroadcast(void);
 
     CNotify(void);
     virtual ~CNotify();
@@ -795,6 +797,18 @@ MUX_RESULT CNotify::NotifyCheck(dbref target, dbref sender,
     return MUX_S_OK;
 }
 
+MUX_RESULT CNotify::BeginBroadcast(void)
+{
+    begin_broadcast();
+    return MUX_S_OK;
+}
+
+MUX_RESULT CNotify::EndBroadcast(void)
+{
+    end_broadcast();
+    return MUX_S_OK;
+}
+
 CNotifyFactory::CNotifyFactory(void) : m_cRef(1)
 {
 }
@@ -3671,6 +3685,7 @@ MUX_RESULT CGameEngine::Shutdown(void)
 #if defined(TINYMUX_JIT)
     dbt_compile_cleanup();
 #endif
+    backup_abort();
     walk_shutdown();
     route_shutdown();
     conn_bridge_final();
@@ -3787,6 +3802,9 @@ MUX_RESULT CGameEngine::GetConfig(DRIVER_CONFIG *pConfig)
     // Behavior flags and limits.
     //
     pConfig->sig_action         = mudconf.sig_action;
+    pConfig->network_engine     = mudconf.network_engine;
+    pConfig->tls_workers        = mudconf.tls_workers;
+    pConfig->io_threads         = mudconf.io_threads;
     pConfig->fork_dump          = mudconf.fork_dump;
     pConfig->name_spaces        = mudconf.name_spaces;
     pConfig->idle_wiz_dark      = mudconf.idle_wiz_dark;
@@ -4650,6 +4668,12 @@ public:
     virtual MUX_RESULT FcacheRawSend(SOCKET fd, int num);
     virtual MUX_RESULT CreateGuest(DESC *d, const UTF8 **ppName);
     virtual MUX_RESULT CheckGuest(dbref player, bool *pResult);
+    virtual MUX_RESULT BeginConnectPlayer(const UTF8 *name,
+        const UTF8 *password, const UTF8 *host, const UTF8 *username,
+        const UTF8 *ipaddr, void (*fpDone)(void *, int), void *pContext,
+        int *pTicket, dbref *pPlayer);
+    virtual MUX_RESULT EndConnectPlayer(int ticket, dbref *pPlayer);
+    virtual MUX_RESULT CancelConnectPlayer(int ticket);
 
     CPlayerSession(void);
     virtual ~CPlayerSession();
@@ -4716,6 +4740,40 @@ MUX_RESULT CPlayerSession::ConnectPlayer(const UTF8 *name,
     return (*pPlayer == NOTHING) ? MUX_E_NOTFOUND : MUX_S_OK;
 }
 
+MUX_RESULT CPlayerSession::BeginConnectPlayer(const UTF8 *name,
+    const UTF8 *password, const UTF8 *host, const UTF8 *username,
+    const UTF8 *ipaddr, void (*fpDone)(void *, int), void *pContext,
+    int *pTicket, dbref *pPlayer)
+{
+    if (  nullptr == fpDone
+       || nullptr == pTicket
+       || nullptr == pPlayer)
+    {
+        return MUX_E_INVALIDARG;
+    }
+    if (connect_player_begin(name, password, host, username, ipaddr,
+            fpDone, pContext, pTicket, pPlayer))
+    {
+        return MUX_S_FALSE;
+    }
+    return MUX_S_OK;
+}
+
+MUX_RESULT CPlayerSession::EndConnectPlayer(int ticket, dbref *pPlayer)
+{
+    if (nullptr == pPlayer)
+    {
+        return MUX_E_INVALIDARG;
+    }
+    return connect_player_end(ticket, pPlayer) ? MUX_S_OK : MUX_E_NOTFOUND;
+}
+
+MUX_RESULT CPlayerSession::CancelConnectPlayer(int ticket)
+{
+    connect_player_cancel(ticket);
+    return MUX_S_OK;
+}
+
 MUX_RESULT CPlayerSession::CreatePlayer(const UTF8 *name,
     const UTF8 *password, dbref creator, bool isRobot,
     dbref *pPlayer, const UTF8 **ppMsg)
@@ -4724,7 +4782,7 @@ MUX_RESULT CPlayerSession::CreatePlayer(const UTF8 *name,
     {
         return MUX_E_INVALIDARG;
     }
-    *pPlayer = create_player(name, password, creator, isRobot, ppMsg);
+    *pPlayer = create_player(name, password, creator, isRobot, true, ppMsg);
     return (*pPlayer == NOTHING) ? MUX_E_FAIL : MUX_S_OK;
 }
 
@@ -0,0 +1,472 @@
+/*! \file eventlog.cpp
+ * \brief Binary event log.
+ *
+ * Connections, logins, commands, and renames are the bulk of a busy game's
+ * text log.  The event_log parameter sends the same categories here as
+ * fixed-size records instead (see eventlog.h), where they cost a memcpy
+ * into a mapped window rather than a formatted line, and where muxevents
+ * can filter them without parsing text.
+ *
+ * The text log is unaffected; log_options and event_log are independent.
+ */
+
+#include "copyright.h"
+#include "autoconf.h"
+#include "config.h"
+#include "externs.h"
+#include "eventlog.h"
+
+#include <string>
+#include <unordered_map>
+
+#define EVLOG_MAX_VERB      32
+
+#if defined(UNIX_FILES)
+#include <sys/mman.h>
+
+// The file is mapped a window at a time.  A new window is written out as
+// zeros before it is mapped, so running out of disk shows up as a failed
+// write() instead of a SIGBUS on a later store.
+//
+#define EVLOG_WINDOW_SIZE   (1024*1024)
+#define EVLOG_MAX_FILE_SIZE (64*1024*1024)
+#define EVLOG_MAX_SEQUENCE  999
+
+static_assert(EVLOG_WINDOW_SIZE % EVLOG_RECORD_SIZE == 0, "Records must not straddle windows.");
+static_assert(EVLOG_HEADER_SIZE % EVLOG_RECORD_SIZE == 0, "Records must not straddle windows.");
+
+class CEventLog
+{
+public:
+    CEventLog(void);
+    ~CEventLog();
+
+    void Append(int iType, uint32_t nSocket, dbref player, dbref other,
+        const UTF8 *pStr1, const UTF8 *pStr2);
+    void Rotate(void);
+    void Close(void);
+    void AfterFork(void);
+    void ListStats(dbref player);
+
+private:
+    bool Open(void);
+    bool MapNextWindow(void);
+    bool PutSlot(const void *pSlot);
+    uint32_t Intern(const UTF8 *pStr);
+    void Fail(const UTF8 *szWhat);
+
+    int      m_fh;
+    uint8_t *m_pWindow;
+    uint64_t m_offWindow;       // File offset of m_pWindow
+    size_t   m_nUsed;           // Bytes used in m_pWindow
+    bool     m_bFailed;         // Stay closed until the next rotation
+    bool     m_bForked;
+    UTF8     m_szName[SIZEOF_PATHNAME];
+
+    std::unordered_map<std::string, uint32_t> m_Strings;
+
+    uint64_t m_nRecords;
+    uint64_t m_nStrings;
+    uint64_t m_nFiles;
+};
+
+static CEventLog EventLog;
+
+CEventLog::CEventLog(void) :
+    m_fh(MUX_OPEN_INVALID_HANDLE_VALUE),
+    m_pWindow(nullptr),
+    m_offWindow(0),
+    m_nUsed(0),
+    m_bFailed(false),
+    m_bForked(false),
+    m_nRecords(0),
+    m_nStrings(0),
+    m_nFiles(0)
+{
+    m_szName[0] = '\0';
+}
+
+CEventLog::~CEventLog()
+{
+    Close();
+}
+
+static int64_t event_time(void)
+{
+    CLinearTimeAbsolute ltaNow;
+    ltaNow.GetUTC();
+    return (ltaNow.Return100ns() - EPOCH_OFFSET) / FACTOR_100NS_PER_MICROSECOND;
+}
+
+void CEventLog::Fail(const UTF8 *szWhat)
+{
+    int iError = errno;
+    Close();
+    m_bFailed = true;
+
+    STARTLOG(LOG_ALWAYS, "EVT", "FAIL");
+    log_printf(T("Event log %s: %s failed (%s).  Event logging is off until @logrotate."),
+        m_szName, szWhat, mux_strerror(iError));
+    ENDLOG;
+}
+
+// Write out EVLOG_WINDOW_SIZE zeros at the end of the file and map them.
+// The header occupies the front of the first window.
+//
+bool CEventLog::MapNextWindow(void)
+{
+    static const uint8_t aZeros[64*1024] = { 0 };
+
+    uint64_t offNext = 0;
+    if (nullptr != m_pWindow)
+    {
+        offNext = m_offWindow + EVLOG_WINDOW_SIZE;
+        munmap(m_pWindow, EVLOG_WINDOW_SIZE);
+        m_pWindow = nullptr;
+    }
+
+    if (static_cast<off_t>(offNext) != mux_lseek(m_fh, static_cast<off_t>(offNext), SEEK_SET))
+    {
+        Fail(T("lseek"));
+        return false;
+    }
+    for (size_t i = 0; i < EVLOG_WINDOW_SIZE; i += sizeof(aZeros))
+    {
+        if (sizeof(aZeros) != static_cast<size_t>(mux_write(m_fh, aZeros, sizeof(aZeros))))
+        {
+            Fail(T("write"));
+            return false;
+        }
+    }
+
+    void *p = mmap(nullptr, EVLOG_WINDOW_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED,
+        m_fh, static_cast<off_t>(offNext));
+    if (MAP_FAILED == p)
+    {
+        Fail(T("mmap"));
+        return false;
+    }
+    m_pWindow = static_cast<uint8_t *>(p);
+    m_offWindow = offNext;
+    m_nUsed = 0;
+    return true;
+}
+
+bool CEventLog::Open(void)
+{
+    // Names have one-second resolution, and a busy game can fill a file or
+    // be rotated more often than that.  Never reuse a name; add a sequence
+    // number instead.
+    //
+    Log.MakeFileName(T("evlog"), m_szName, sizeof(m_szName));
+    for (int iSeq = 1; !mux_open(&m_fh, m_szName, O_RDWR|O_CREAT|O_EXCL|O_BINARY); iSeq++)
+    {
+        m_fh = MUX_OPEN_INVALID_HANDLE_VALUE;
+        if (  EEXIST != errno
+           || EVLOG_MAX_SEQUENCE < iSeq)
+        {
+            Fail(T("open"));
+            return false;
+        }
+        UTF8 szExtension[32];
+        mux_sprintf(szExtension, sizeof(szExtension), T("%d.evlog"), iSeq);
+        Log.MakeFileName(szExtension, m_szName, sizeof(m_szName));
+    }
+    if (!MapNextWindow())
+    {
+        return false;
+    }
+
+    EVLOG_HEADER hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, EVLOG_MAGIC, sizeof(hdr.magic));
+    hdr.version = EVLOG_VERSION;
+    hdr.record_size = EVLOG_RECORD_SIZE;
+    hdr.created_usec = event_time();
+    memcpy(m_pWindow, &hdr, sizeof(hdr));
+    m_nUsed = sizeof(hdr);
+
+    m_Strings.clear();
+    m_nFiles++;
+    return true;
+}
+
+// Unmap, and trim the zeros that were written ahead of the last record.
+//
+void CEventLog::Close(void)
+{
+    if (nullptr != m_pWindow)
+    {
+        munmap(m_pWindow, EVLOG_WINDOW_SIZE);
+        m_pWindow = nullptr;
+        if (ftruncate(m_fh, static_cast<off_t>(m_offWindow + m_nUsed)) < 0)
+        {
+            ; // Nothing.  The reader stops at the zeros.
+        }
+    }
+    if (MUX_OPEN_INVALID_HANDLE_VALUE != m_fh)
+    {
+        mux_close(m_fh);
+        m_fh = MUX_OPEN_INVALID_HANDLE_VALUE;
+    }
+    m_Strings.clear();
+}
+
+bool CEventLog::PutSlot(const void *pSlot)
+{
+    if (nullptr == m_pWindow)
+    {
+        return false;
+    }
+    if (  EVLOG_WINDOW_SIZE == m_nUsed
+       && !MapNextWindow())
+    {
+        return false;
+    }
+    memcpy(m_pWindow + m_nUsed, pSlot, EVLOG_RECORD_SIZE);
+    m_nUsed += EVLOG_RECORD_SIZE;
+    return true;
+}
+
+// Return the id of pStr in this file, defining it first if necessary.
+// Strings are cut to EVLOG_MAX_STRING bytes on a character boundary.
+// Returns 0 for an empty string, and on failure.
+//
+uint32_t CEventLog::Intern(const UTF8 *pStr)
+{
+    if (  nullptr == pStr
+       || '\0' == pStr[0])
+    {
+        return 0;
+    }
+
+    size_t n = strlen(reinterpret_cast<const char *>(pStr));
+    if (EVLOG_MAX_STRING < n)
+    {
+        n = EVLOG_MAX_STRING;
+        while (  0 < n
+              && 0x80 == (pStr[n] & 0xC0))
+        {
+            n--;
+        }
+    }
+
+    std::string key(reinterpret_cast<const char *>(pStr), n);
+    auto it = m_Strings.find(key);
+    if (m_Strings.end() != it)
+    {
+        return it->second;
+    }
+
+    const uint32_t id = static_cast<uint32_t>(m_Strings.size() + 1);
+    const size_t nSlots = (n + EVLOG_RECORD_SIZE - 1) / EVLOG_RECORD_SIZE;
+
+    EVLOG_RECORD rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.usec = event_time();
+    rec.type = EVLOG_STRING;
+    rec.player = static_cast<int32_t>(n);
+    rec.other = static_cast<int32_t>(nSlots);
+    rec.str1 = id;
+    if (!PutSlot(&rec))
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < nSlots; i++)
+    {
+        uint8_t aSlot[EVLOG_RECORD_SIZE] = { 0 };
+        size_t nChunk = n - i * EVLOG_RECORD_SIZE;
+        if (EVLOG_RECORD_SIZE < nChunk)
+        {
+            nChunk = EVLOG_RECORD_SIZE;
+        }
+        memcpy(aSlot, key.data() + i * EVLOG_RECORD_SIZE, nChunk);
+        if (!PutSlot(aSlot))
+        {
+            return 0;
+        }
+    }
+
+    m_Strings.emplace(std::move(key), id);
+    m_nStrings++;
+    return id;
+}
+
+void CEventLog::Append(int iType, uint32_t nSocket, dbref player,
+    dbref other, const UTF8 *pStr1, const UTF8 *pStr2)
+{
+    if (  m_bFailed
+       || m_bForked)
+    {
+        return;
+    }
+
+    // Start a new file when this one is big enough, or when its string table
+    // could fill up during this record.
+    //
+    if (  nullptr != m_pWindow
+       && (  EVLOG_MAX_FILE_SIZE <= m_offWindow + m_nUsed
+          || EVLOG_MAX_STRINGS - 2 <= m_Strings.size()))
+    {
+        Close();
+    }
+    if (  nullptr == m_pWindow
+       && !Open())
+    {
+        return;
+    }
+
+    EVLOG_RECORD rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.str1 = Intern(pStr1);
+    rec.str2 = Intern(pStr2);
+    rec.usec = event_time();
+    rec.type = static_cast<uint16_t>(iType);
+    rec.socket = nSocket;
+    rec.player = player;
+    rec.other = other;
+    if (PutSlot(&rec))
+    {
+        m_nRecords++;
+    }
+}
+
+void CEventLog::Rotate(void)
+{
+    Close();
+    m_bFailed = false;
+}
+
+// In a fork()ed child, the mapping is shared with the parent.  Leave it to
+// the parent.
+//
+void CEventLog::AfterFork(void)
+{
+    m_bForked = true;
+}
+
+void CEventLog::ListStats(dbref player)
+{
+    if (nullptr == m_pWindow)
+    {
+        notify(player, tprintf(T("Event log: %s"),
+            m_bFailed ? T("failed; off until @logrotate")
+                      : (0 == mudconf.event_log) ? T("off") : T("no events yet")));
+    }
+    else
+    {
+        notify(player, tprintf(T("Event log: %s   Size: %llu bytes   Strings in file: %lu"),
+            m_szName,
+            static_cast<unsigned long long>(m_offWindow + m_nUsed),
+            static_cast<unsigned long>(m_Strings.size())));
+    }
+    notify(player, tprintf(T("Events: %llu   Strings: %llu   Files: %llu"),
+        static_cast<unsigned long long>(m_nRecords),
+        static_cast<unsigned long long>(m_nStrings),
+        static_cast<unsigned long long>(m_nFiles)));
+}
+
+void log_event(int iType, uint32_t nSocket, dbref player, dbref other,
+    const UTF8 *pStr1, const UTF8 *pStr2)
+{
+    EventLog.Append(iType, nSocket, player, other, pStr1, pStr2);
+}
+
+void eventlog_rotate(void)
+{
+    EventLog.Rotate();
+}
+
+void eventlog_close(void)
+{
+    EventLog.Close();
+}
+
+void eventlog_after_fork(void)
+{
+    EventLog.AfterFork();
+}
+
+void eventlog_list_stats(dbref player)
+{
+    EventLog.ListStats(player);
+}
+
+#else // UNIX_FILES
+
+void log_event(int iType, uint32_t nSocket, dbref player, dbref other,
+    const UTF8 *pStr1, const UTF8 *pStr2)
+{
+    UNUSED_PARAMETER(iType);
+    UNUSED_PARAMETER(nSocket);
+    UNUSED_PARAMETER(player);
+    UNUSED_PARAMETER(other);
+    UNUSED_PARAMETER(pStr1);
+    UNUSED_PARAMETER(pStr2);
+}
+
+void eventlog_rotate(void)
+{
+}
+
+void eventlog_close(void)
+{
+}
+
+void eventlog_after_fork(void)
+{
+}
+
+void eventlog_list_stats(dbref player)
+{
+    notify(player, T("Event log: not supported on this platform."));
+}
+
+#endif // UNIX_FILES
+
+// Record a command by its verb only: the leading punctuation for the
+// single-character commands ("say, :pose, &attr), or otherwise the first
+// word up to a space, '=' or '/', lowercased.  Arguments are left out; the
+// text log has them if all_commands is on there too.
+//
+void log_command_event(int key, int iType, dbref executor, const UTF8 *pCommand)
+{
+    if ((key & mudconf.event_log) == 0)
+    {
+        return;
+    }
+
+    UTF8 aVerb[EVLOG_MAX_VERB + 1];
+    size_t n = 0;
+    if (nullptr != pCommand)
+    {
+        while (mux_isspace(*pCommand))
+        {
+            pCommand++;
+        }
+        if (  '\0' != pCommand[0]
+           && !mux_isalnum(pCommand[0])
+           && '@' != pCommand[0]
+           && '+' != pCommand[0])
+        {
+            aVerb[n++] = pCommand[0];
+        }
+        else
+        {
+            while (  '\0' != pCommand[n]
+                  && !mux_isspace(pCommand[n])
+                  && '=' != pCommand[n]
+                  && '/' != pCommand[n]
+                  && n < EVLOG_MAX_VERB)
+            {
+                aVerb[n] = mux_tolower_ascii(pCommand[n]);
+                n++;
+            }
+        }
+    }
+    aVerb[n] = '\0';
+
+    log_event(iType, 0, executor, Good_obj(executor) ? Location(executor) : NOTHING,
+        aVerb, nullptr);
+}
@@ -37,7 +37,8 @@ bool parse_and_get_attrib
     dbref  *paowner,
     dbref  *paflags,
     UTF8   *buff,
-    UTF8  **bufc
+    UTF8  **bufc,
+    ASTAttrSource *pSource
 )
 {
     // Check for #lambda/body -- inline anonymous softcode.
@@ -126,6 +127,10 @@ bool parse_and_get_attrib
         free_lbuf(*atext);
         return false;
     }
+    if (nullptr != pSource)
+    {
+        pSource->bind(*atext, atr_pget_source(), ap->number);
+    }
     return true;
 }
 
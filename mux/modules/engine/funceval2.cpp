@@ -22,8 +22,7 @@ extern "C" {
 #include "color_ops.h"
 }
 
-#define PCRE2_CODE_UNIT_WIDTH 8
-#include <pcre2.h>
+#include "regexcache.h"
 
 /* ---------------------------------------------------------------------------
  * fun_grab: a combination of extract() and match(), sortof. We grab the
@@ -870,7 +869,8 @@ FUNCTION(fun_mix)
     UTF8 *atext;
     dbref aowner;
     int   aflags;
-    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc))
+    ASTAttrSource source;
+    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -920,6 +920,7 @@ FUNCTION(fun_mix)
             AttrTrace(aflags, EV_STRIP_CURLY|EV_FCHECK|EV_EVAL),
             os, lastn);
     }
+    source.release();
     free_lbuf(atext);
 }
 
@@ -959,7 +960,8 @@ FUNCTION(fun_step)
     dbref thing;
     dbref aowner;
     int   aflags;
-    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc))
+    ASTAttrSource source;
+    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -993,6 +995,7 @@ FUNCTION(fun_step)
         mux_exec(atext, LBUF_SIZE-1, buff, bufc, thing, executor, enactor,
              AttrTrace(aflags, EV_STRIP_CURLY|EV_FCHECK|EV_EVAL), os, i);
     }
+    source.release();
     free_lbuf(atext);
 }
 
@@ -1021,7 +1024,8 @@ FUNCTION(fun_foreach)
     dbref thing;
     dbref aowner;
     int   aflags;
-    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc))
+    ASTAttrSource source;
+    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -1115,6 +1119,7 @@ FUNCTION(fun_foreach)
             i += nBytes;
         }
     }
+    source.release();
     free_lbuf(atext);
 }
 
@@ -1154,7 +1159,8 @@ FUNCTION(fun_munge)
     dbref thing;
     dbref aowner;
     int   aflags;
-    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc))
+    ASTAttrSource source;
+    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -1165,6 +1171,7 @@ FUNCTION(fun_munge)
     int nWords = countwords(fargs[1], sep);
     if (0 == nWords)
     {
+        source.release();
         free_lbuf(atext);
         return;
     }
@@ -1212,6 +1219,7 @@ FUNCTION(fun_munge)
        || nullptr != pValue)
     {
         safe_str(S_("#-1 LISTS MUST BE OF EQUAL SIZE"), buff, bufc);
+        source.release();
         free_lbuf(atext);
         return;
     }
@@ -1231,6 +1239,7 @@ FUNCTION(fun_munge)
     mux_exec(atext, LBUF_SIZE-1, rlist, &bp, executor, caller, enactor,
              AttrTrace(aflags, EV_STRIP_CURLY|EV_FCHECK|EV_EVAL), uargs, 2);
     *bp = '\0';
+    source.release();
     free_lbuf(atext);
 
     // Now that we have our result, put it back into array form.
@@ -1870,14 +1879,13 @@ static UTF8 *regrep_util(dbref player, dbref thing, const UTF8 *pattern,
     olist_push();
     find_wild_attrs(player, thing, pattern, false, false, false);
 
-    // Compile the regex.
+    // Compile the regex.  It is matched against every attribute, so JIT it
+    // now.
     //
-    int errcode;
-    PCRE2_SIZE erroffset;
     uint32_t options = PCRE2_UTF;
     if (insensitive) options |= PCRE2_CASELESS;
-    pcre2_code *re = pcre2_compile_8(lookfor, PCRE2_ZERO_TERMINATED,
-        options, &errcode, &erroffset, nullptr);
+    RegexLease rx(lookfor, options, true);
+    pcre2_code *re = rx.code();
     if (!re)
     {
         olist_pop();
@@ -1885,13 +1893,11 @@ static UTF8 *regrep_util(dbref player, dbref thing, const UTF8 *pattern,
         mux_strncpy(tbuf1, S_("#-1 REGEXP ERROR"), LBUF_SIZE-1);
         return tbuf1;
     }
-    pcre2_match_data *match_data =
-        pcre2_match_data_create_from_pattern(re, nullptr);
+    pcre2_match_data *match_data = rx.match_data();
     // #1113: null-check match_data like regmatch/regrab/regedit.
     //
     if (!match_data)
     {
-        pcre2_code_free(re);
         olist_pop();
         UTF8 *tbuf1 = alloc_lbuf("regrep_util");
         mux_strncpy(tbuf1, S_("#-1 REGEXP MATCH DATA ERROR"), LBUF_SIZE-1);
@@ -1909,7 +1915,7 @@ static UTF8 *regrep_util(dbref player, dbref thing, const UTF8 *pattern,
         size_t nText;
         UTF8 *attrib = atr_get_LEN(thing, ca, &aowner, &aflags, &nText);
         int matches = pcre2_match(re, attrib, nText, 0, 0,
-            match_data, nullptr);
+            match_data, rx.context());
         if (matches >= 0)
         {
             if (bp != tbuf1) safe_chr(' ', tbuf1, &bp);
@@ -1925,8 +1931,6 @@ static UTF8 *regrep_util(dbref player, dbref thing, const UTF8 *pattern,
     }
     *bp = '\0';
 
-    pcre2_match_data_free(match_data);
-    pcre2_code_free(re);
     olist_pop();
     return tbuf1;
 }
@@ -2230,35 +2234,24 @@ static void real_regmatch(const UTF8 *search, const UTF8 *pattern,
         return;
     }
 
-    PCRE2_SIZE erroffset;
-    int errcode;
-
-    // Compile the pattern
-    pcre2_code *re = pcre2_compile_8(
-        pattern,                      // pattern string
-        PCRE2_ZERO_TERMINATED,        // pattern is zero-terminated
-        PCRE2_UTF|(cis ? PCRE2_CASELESS : 0),  // options
-        &errcode,                     // for error code
-        &erroffset,                   // for error offset
-        nullptr                       // use default compile context
-    );
-
+    // Get the compiled pattern
+    RegexLease rx(pattern, PCRE2_UTF|(cis ? PCRE2_CASELESS : 0));
+    pcre2_code *re = rx.code();
     if (!re)
     {
         // Matching error - get the error message
         PCRE2_UCHAR errbuf[256];
-        pcre2_get_error_message(errcode, errbuf, sizeof(errbuf));
+        pcre2_get_error_message(rx.error(), errbuf, sizeof(errbuf));
 
         safe_str(S_("#-1 REGEXP ERROR "), buff, bufc);
         safe_str(reinterpret_cast<UTF8 *>(errbuf), buff, bufc);
         return;
     }
 
-    // Create match data block for storing results
-    pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, nullptr);
+    // Match data block for storing results
+    pcre2_match_data *match_data = rx.match_data();
     if (!match_data)
     {
-        pcre2_code_free(re);
         safe_str(S_("#-1 REGEXP MATCH DATA ERROR"), buff, bufc);
         return;
     }
@@ -2271,7 +2264,7 @@ static void real_regmatch(const UTF8 *search, const UTF8 *pattern,
         0,                          // start offset in subject
         0,                          // options
         match_data,                 // block for storing the result
-        nullptr                     // use default match context
+        rx.context()                // match context
     );
 
     safe_bool(matches > 0, buff, bufc);
@@ -2279,8 +2272,6 @@ static void real_regmatch(const UTF8 *search, const UTF8 *pattern,
     // If we don't have a third argument, we're done.
     if (nfargs != 3 || matches <= 0)
     {
-        pcre2_match_data_free(match_data);
-        pcre2_code_free(re);
         return;
     }
 
@@ -2377,9 +2368,6 @@ static void real_regmatch(const UTF8 *search, const UTF8 *pattern,
             }
         }
     }
-
-    pcre2_match_data_free(match_data);
-    pcre2_code_free(re);
 }
 
 FUNCTION(fun_regmatch)
@@ -2422,45 +2410,29 @@ static void real_regrab(const UTF8 *search, const UTF8 *pattern, const SEP &sep,
         return;
     }
 
-    PCRE2_SIZE erroffset;
-    int errcode;
-
-    // Compile the pattern
-    pcre2_code *re = pcre2_compile_8(
-        pattern,                      // pattern string
-        PCRE2_ZERO_TERMINATED,        // pattern is zero-terminated
-        PCRE2_UTF|(cis ? PCRE2_CASELESS : 0),  // options
-        &errcode,                     // for error code
-        &erroffset,                   // for error offset
-        nullptr                       // use default compile context
-    );
-
+    // Get the compiled pattern, JIT compiled now if we're going to use it
+    // multiple times
+    RegexLease rx(pattern, PCRE2_UTF|(cis ? PCRE2_CASELESS : 0), all);
+    pcre2_code *re = rx.code();
     if (!re)
     {
         // Matching error - get the error message
         PCRE2_UCHAR errbuf[256];
-        pcre2_get_error_message(errcode, errbuf, sizeof(errbuf));
+        pcre2_get_error_message(rx.error(), errbuf, sizeof(errbuf));
 
         safe_str(S_("#-1 REGEXP ERROR "), buff, bufc);
         safe_str(reinterpret_cast<UTF8 *>(errbuf), buff, bufc);
         return;
     }
 
-    // Create match data block for storing results
-    pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, nullptr);
+    // Match data block for storing results
+    pcre2_match_data *match_data = rx.match_data();
     if (!match_data)
     {
-        pcre2_code_free(re);
         safe_str(S_("#-1 REGEXP MATCH DATA ERROR"), buff, bufc);
         return;
     }
 
-    // JIT compile if we're going to use the pattern multiple times
-    if (all)
-    {
-        pcre2_jit_compile(re, PCRE2_JIT_COMPLETE);
-    }
-
     bool first = true;
     LBuf scList = LBuf_Src("real_regrab.list");
     UTF8 *s = trim_space_sep(list_copy_for_split(scList, search), sep);
@@ -2476,7 +2448,7 @@ static void real_regrab(const UTF8 *search, const UTF8 *pattern, const SEP &sep,
                 0,                       // start offset in subject
                 0,                       // options
                 match_data,              // block for storing the result
-                nullptr                  // use default match context
+                rx.context()             // match context
             );
 
             if (rc >= 0)
@@ -2497,9 +2469,6 @@ static void real_regrab(const UTF8 *search, const UTF8 *pattern, const SEP &sep,
             }
         }
     } while (s);
-
-    pcre2_match_data_free(match_data);
-    pcre2_code_free(re);
 }
 
 FUNCTION(fun_regrab)
@@ -2671,22 +2640,12 @@ static void real_regedit(const UTF8 * const fargs[], int nfargs, UTF8 *buff,
             break;
         }
 
-        PCRE2_SIZE erroffset;
-        int errcode;
-
-        pcre2_code *re = pcre2_compile_8(
-            fargs[i],
-            PCRE2_ZERO_TERMINATED,
-            PCRE2_UTF | (cis ? PCRE2_CASELESS : 0),
-            &errcode,
-            &erroffset,
-            nullptr
-        );
-
+        RegexLease rx(fargs[i], PCRE2_UTF | (cis ? PCRE2_CASELESS : 0), all);
+        pcre2_code *re = rx.code();
         if (!re)
         {
             PCRE2_UCHAR errbuf[256];
-            pcre2_get_error_message(errcode, errbuf, sizeof(errbuf));
+            pcre2_get_error_message(rx.error(), errbuf, sizeof(errbuf));
 
             free_lbuf(inbuf);
             free_lbuf(outbuf);
@@ -2695,22 +2654,15 @@ static void real_regedit(const UTF8 * const fargs[], int nfargs, UTF8 *buff,
             return;
         }
 
-        pcre2_match_data *match_data =
-            pcre2_match_data_create_from_pattern(re, nullptr);
+        pcre2_match_data *match_data = rx.match_data();
         if (!match_data)
         {
-            pcre2_code_free(re);
             free_lbuf(inbuf);
             free_lbuf(outbuf);
             safe_str(S_("#-1 REGEXP MATCH DATA ERROR"), buff, bufc);
             return;
         }
 
-        if (all)
-        {
-            pcre2_jit_compile(re, PCRE2_JIT_COMPLETE);
-        }
-
         UTF8 *outp = outbuf;
         PCRE2_SIZE pos = 0;
         PCRE2_SIZE inlen = strlen(reinterpret_cast<char *>(inbuf));
@@ -2730,7 +2682,7 @@ static void real_regedit(const UTF8 * const fargs[], int nfargs, UTF8 *buff,
                 pos,
                 0,
                 match_data,
-                nullptr
+                rx.context()
             );
 
             if (rc < 0)
@@ -2783,9 +2735,6 @@ static void real_regedit(const UTF8 * const fargs[], int nfargs, UTF8 *buff,
 
         *outp = '\0';
 
-        pcre2_match_data_free(match_data);
-        pcre2_code_free(re);
-
         // Swap buffers for next pair.
         //
         UTF8 *tmp = inbuf;
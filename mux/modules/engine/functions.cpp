@@ -54,8 +54,7 @@ private:
     uint32_t m_cRef;
 };
 
-#define PCRE2_CODE_UNIT_WIDTH 8
-#include <pcre2.h>
+#include "regexcache.h"
 
 #if defined(INLINESQL)
 #include <mysql.h>
@@ -2559,7 +2558,8 @@ static void do_ufun(UTF8 *buff, UTF8 **bufc, dbref executor, dbref caller,
     dbref thing;
     dbref aowner;
     int   aflags;
-    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc))
+    ASTAttrSource source;
+    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -2586,6 +2586,7 @@ static void do_ufun(UTF8 *buff, UTF8 **bufc, dbref executor, dbref caller,
             AttrTrace(aflags, EV_FCHECK|EV_EVAL),
             (const UTF8 **)&(fargs[1]), nfargs - 1);
     }
+    source.release();
     free_lbuf(atext);
 
     // If we're evaluating locally, restore the preserved registers.
@@ -7060,35 +7061,28 @@ static void reglattr_handler(UTF8 *buff, UTF8 **bufc, dbref executor,
         return;
     }
 
-    PCRE2_SIZE erroffset;
-    int errcode;
     uint32_t options = PCRE2_UTF;
     if (bCaseInsens)
     {
         options |= PCRE2_CASELESS;
     }
 
-    pcre2_code *re = pcre2_compile_8(
-        fargs[1],
-        PCRE2_ZERO_TERMINATED,
-        options,
-        &errcode,
-        &erroffset,
-        nullptr);
-
+    // Matched against every attribute name, so JIT it now.
+    //
+    RegexLease rx(fargs[1], options, true);
+    pcre2_code *re = rx.code();
     if (!re)
     {
         PCRE2_UCHAR errbuf[256];
-        pcre2_get_error_message(errcode, errbuf, sizeof(errbuf));
+        pcre2_get_error_message(rx.error(), errbuf, sizeof(errbuf));
         safe_str(S_("#-1 REGEXP ERROR "), buff, bufc);
         safe_str(reinterpret_cast<UTF8 *>(errbuf), buff, bufc);
         return;
     }
 
-    pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, nullptr);
+    pcre2_match_data *match_data = rx.match_data();
     if (!match_data)
     {
-        pcre2_code_free(re);
         safe_str(S_("#-1 REGEXP MATCH DATA ERROR"), buff, bufc);
         return;
     }
@@ -7112,7 +7106,7 @@ static void reglattr_handler(UTF8 *buff, UTF8 **bufc, dbref executor,
         }
 
         int rc = pcre2_match(re, pattr->name,
-            PCRE2_ZERO_TERMINATED, 0, 0, match_data, nullptr);
+            PCRE2_ZERO_TERMINATED, 0, 0, match_data, rx.context());
         if (rc >= 0)
         {
             if (bCount)
@@ -7132,9 +7126,6 @@ static void reglattr_handler(UTF8 *buff, UTF8 **bufc, dbref executor,
     }
     atr_pop();
 
-    pcre2_match_data_free(match_data);
-    pcre2_code_free(re);
-
     if (bCount)
     {
         safe_ltoa(count, buff, bufc);
@@ -8010,7 +8001,8 @@ static FUNCTION(fun_fold)
     dbref thing;
     dbref aowner;
     int   aflags;
-    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc))
+    ASTAttrSource source;
+    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -8066,6 +8058,7 @@ static FUNCTION(fun_fold)
     free_lbuf(result);
     safe_str(rstore, buff, bufc);
     free_lbuf(rstore);
+    source.release();
     free_lbuf(atext);
 }
 
@@ -8428,8 +8421,9 @@ FUNCTION(fun_mapsql)
     dbref thing;
     dbref aowner;
     int   aflags;
+    ASTAttrSource source;
     if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner,
-            &aflags, buff, bufc))
+            &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -8440,12 +8434,14 @@ FUNCTION(fun_mapsql)
     UTF8 *cp = trim_space_sep(list_copy_for_split(scQuery, fargs[1]), sepSpace);
     if (!*cp)
     {
+        source.release();
         free_lbuf(atext);
         return;
     }
 
     if (mysql_ping(mush_database))
     {
+        source.release();
         free_lbuf(atext);
         safe_str(S_("#-1 SQL UNAVAILABLE"), buff, bufc);
         return;
@@ -8454,6 +8450,7 @@ FUNCTION(fun_mapsql)
     if (mysql_real_query(mush_database, reinterpret_cast<char *>(cp),
             strlen(reinterpret_cast<char *>(cp))))
     {
+        source.release();
         free_lbuf(atext);
         safe_str(S_("#-1 QUERY ERROR"), buff, bufc);
         return;
@@ -8467,6 +8464,7 @@ FUNCTION(fun_mapsql)
             MYSQL_RES *extra = mysql_store_result(mush_database);
             if (extra) mysql_free_result(extra);
         }
+        source.release();
         free_lbuf(atext);
         return;
     }
@@ -8520,6 +8518,7 @@ FUNCTION(fun_mapsql)
         if (extra) mysql_free_result(extra);
     }
 
+    source.release();
     free_lbuf(atext);
 }
 
@@ -8545,7 +8544,8 @@ static void filter_handler(UTF8 *buff, UTF8 **bufc, dbref executor, dbref enacto
     dbref thing;
     dbref aowner;
     int   aflags;
-    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc))
+    ASTAttrSource source;
+    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -8595,6 +8595,7 @@ static void filter_handler(UTF8 *buff, UTF8 **bufc, dbref executor, dbref enacto
         }
         free_lbuf(result);
     }
+    source.release();
     free_lbuf(atext);
 }
 
@@ -8656,7 +8657,8 @@ static FUNCTION(fun_map)
     dbref thing;
     dbref aowner;
     int   aflags;
-    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc))
+    ASTAttrSource source;
+    if (!parse_and_get_attrib(executor, fargs, &atext, &thing, &aowner, &aflags, buff, bufc, &source))
     {
         return;
     }
@@ -8693,6 +8695,7 @@ static FUNCTION(fun_map)
                 map_args, map_nargs);
         }
     }
+    source.release();
     free_lbuf(atext);
 }
 
@@ -15640,7 +15643,7 @@ static FUN builtin_function_list[] =
     {T("CAT"),         fun_cat,        MAX_ARG, 0, MAX_ARG,         0, CA_PUBLIC},
     {T("CEIL"),        fun_ceil,       MAX_ARG, 1,       1,         0, CA_PUBLIC},
     {T("CEMIT"),       fun_cemit,      MAX_ARG, 2,       2,         0, CA_PUBLIC},
-    {T("CENTER"),      fun_center,     MAX_ARG, 2,       3,         0, CA_PUBLIC},
+    {T("CENTER"),      fun_center,     MAX_ARG, 2,       3,   FN_PURE, CA_PUBLIC},
     {T("CHANFIND"),    fun_chanfind,   MAX_ARG, 1,       1,         0, CA_PUBLIC},
     {T("CHANINFO"),    fun_chaninfo,   MAX_ARG, 2,       2,         0, CA_PUBLIC},
     {T("CHANNELS"),    fun_channels,   MAX_ARG, 0,       4,         0, CA_PUBLIC},
@@ -15709,7 +15712,7 @@ static FUN builtin_function_list[] =
     {T("E"),           fun_e,          MAX_ARG, 0,       0,         0, CA_PUBLIC},
     {T("EDEFAULT"),    fun_edefault,   MAX_ARG, 2,       2, FN_NOEVAL, CA_PUBLIC},
     {T("EDIT"),        fun_edit,       MAX_ARG, 3, MAX_ARG,         0, CA_PUBLIC},
-    {T("ELEMENTS"),    fun_elements,   MAX_ARG, 2,       4,         0, CA_PUBLIC},
+    {T("ELEMENTS"),    fun_elements,   MAX_ARG, 2,       4,   FN_PURE, CA_PUBLIC},
     {T("ELOCK"),       fun_elock,      MAX_ARG, 2,       2,         0, CA_PUBLIC},
     {T("EMIT"),        fun_emit,       MAX_ARG, 1,       1,         0, CA_PUBLIC},
     {T("ENCODE64"),    fun_encode64,   MAX_ARG, 1,       1,         0, CA_PUBLIC},
@@ -15723,7 +15726,7 @@ static FUN builtin_function_list[] =
     {T("EXIT"),        fun_exit,       MAX_ARG, 1,       1,         0, CA_PUBLIC},
     {T("EXP"),         fun_exp,        MAX_ARG, 1,       1,         0, CA_PUBLIC},
     {T("EXPTIME"),     fun_exptime,    MAX_ARG, 1,       1,         0, CA_PUBLIC},
-    {T("EXTRACT"),     fun_extract,    MAX_ARG, 3,       5,         0, CA_PUBLIC},
+    {T("EXTRACT"),     fun_extract,    MAX_ARG, 3,       5,   FN_PURE, CA_PUBLIC},
     {T("FCOUNT"),      fun_fcount,     MAX_ARG, 0,       1, FN_NOEVAL, CA_PUBLIC},
     {T("FDEPTH"),      fun_fdepth,     MAX_ARG, 0,       0,         0, CA_PUBLIC},
     {T("FDIV"),        fun_fdiv,       MAX_ARG, 2,       2,         0, CA_PUBLIC},
@@ -15826,13 +15829,13 @@ static FUN builtin_function_list[] =
     {T("LIST"),        fun_list,       MAX_ARG, 2,       3, FN_NOEVAL, CA_PUBLIC},
     {T("LISTQ"),       fun_listq,      MAX_ARG, 0,       0,         0, CA_PUBLIC},
     {T("LIT"),         fun_lit,              1, 1,       1, FN_NOEVAL, CA_PUBLIC},
-    {T("LJUST"),       fun_ljust,      MAX_ARG, 2,       3,         0, CA_PUBLIC},
+    {T("LJUST"),       fun_ljust,      MAX_ARG, 2,       3,   FN_PURE, CA_PUBLIC},
     {T("LMAX"),        fun_lmax,       MAX_ARG, 0,       2,         0, CA_PUBLIC},
     {T("LMATH"),       fun_lmath,      MAX_ARG, 2,       3,         0, CA_PUBLIC},
     {T("LIMATH"),      fun_limath,     MAX_ARG, 2,       3,         0, CA_PUBLIC},
     {T("LMIN"),        fun_lmin,       MAX_ARG, 0,       2,         0, CA_PUBLIC},
     {T("LN"),          fun_ln,         MAX_ARG, 1,       1,         0, CA_PUBLIC},
-    {T("LNUM"),        fun_lnum,       MAX_ARG, 0,       4,         0, CA_PUBLIC},
+    {T("LNUM"),        fun_lnum,       MAX_ARG, 0,       4,   FN_PURE, CA_PUBLIC},
     {T("LOC"),         fun_loc,        MAX_ARG, 1,       1,         0, CA_PUBLIC},
     {T("LOCALIZE"),    fun_localize,   MAX_ARG, 1,       1, FN_NOEVAL, CA_PUBLIC},
     {T("LOCATE"),      fun_locate,     MAX_ARG, 3,       3,         0, CA_PUBLIC},
@@ -15959,7 +15962,7 @@ static FUN builtin_function_list[] =
     {T("REMAINDER"),   fun_remainder,  MAX_ARG, 2,       2,         0, CA_PUBLIC},
     {T("REMIT"),       fun_remit,      MAX_ARG, 2,       2,         0, CA_PUBLIC},
     {T("REMOVE"),      fun_remove,     MAX_ARG, 2,       4,         0, CA_PUBLIC},
-    {T("REPEAT"),      fun_repeat,     MAX_ARG, 2,       2,         0, CA_PUBLIC},
+    {T("REPEAT"),      fun_repeat,     MAX_ARG, 2,       2,   FN_PURE, CA_PUBLIC},
     {T("REPLACE"),     fun_replace,    MAX_ARG, 3,       5,         0, CA_PUBLIC},
     {T("REST"),        fun_rest,       MAX_ARG, 0,       2,         0, CA_PUBLIC},
     {T("RESTARTS"),    fun_restarts,   MAX_ARG, 0,       0,         0, CA_PUBLIC},
@@ -15968,7 +15971,7 @@ static FUN builtin_function_list[] =
     {T("REVERSE"),     fun_reverse,          1, 1,       1,         0, CA_PUBLIC},
     {T("REVWORDS"),    fun_revwords,   MAX_ARG, 0,       3,         0, CA_PUBLIC},
     {T("RIGHT"),       fun_right,      MAX_ARG, 2,       2,         0, CA_PUBLIC},
-    {T("RJUST"),       fun_rjust,      MAX_ARG, 2,       3,         0, CA_PUBLIC},
+    {T("RJUST"),       fun_rjust,      MAX_ARG, 2,       3,   FN_PURE, CA_PUBLIC},
     {T("RLOC"),        fun_rloc,       MAX_ARG, 2,       2,         0, CA_PUBLIC},
     {T("ROMAN"),       fun_roman,      MAX_ARG, 1,       1,         0, CA_PUBLIC},
     {T("ROOM"),        fun_room,       MAX_ARG, 1,       1,         0, CA_PUBLIC},
@@ -15998,11 +16001,11 @@ static FUN builtin_function_list[] =
     {T("SANDBOX"),     fun_sandbox,    MAX_ARG, 2,       3, FN_NOEVAL, CA_PUBLIC},
     {T("SECURE"),      fun_secure,           1, 1,       1,         0, CA_PUBLIC},
     {T("SET"),         fun_set,        MAX_ARG, 2,       2,         0, CA_PUBLIC},
-    {T("SETDIFF"),     fun_setdiff,    MAX_ARG, 2,       5,         0, CA_PUBLIC},
-    {T("SETINTER"),    fun_setinter,   MAX_ARG, 2,       5,         0, CA_PUBLIC},
+    {T("SETDIFF"),     fun_setdiff,    MAX_ARG, 2,       5,   FN_PURE, CA_PUBLIC},
+    {T("SETINTER"),    fun_setinter,   MAX_ARG, 2,       5,   FN_PURE, CA_PUBLIC},
     {T("SETQ"),        fun_setq,       MAX_ARG, 2,       MAX_ARG,   0, CA_PUBLIC},
     {T("SETR"),        fun_setr,       MAX_ARG, 2,       MAX_ARG,   0, CA_PUBLIC},
-    {T("SETUNION"),    fun_setunion,   MAX_ARG, 2,       5,         0, CA_PUBLIC},
+    {T("SETUNION"),    fun_setunion,   MAX_ARG, 2,       5,   FN_PURE, CA_PUBLIC},
     {T("SHA1"),        fun_sha1,             1, 0,       1,         0, CA_PUBLIC},
     {T("SHL"),         fun_shl,        MAX_ARG, 2,       2,         0, CA_PUBLIC},
     {T("SHR"),         fun_shr,        MAX_ARG, 2,       2,         0, CA_PUBLIC},
@@ -16011,7 +16014,7 @@ static FUN builtin_function_list[] =
     {T("SIN"),         fun_sin,        MAX_ARG, 1,       2,         0, CA_PUBLIC},
     {T("SINGLETIME"),  fun_singletime, MAX_ARG, 1,       1,         0, CA_PUBLIC},
     {T("SITEINFO"),    fun_siteinfo,   MAX_ARG, 1,       1,         0, CA_PUBLIC},
-    {T("SORT"),        fun_sort,       MAX_ARG, 1,       4,         0, CA_PUBLIC},
+    {T("SORT"),        fun_sort,       MAX_ARG, 1,       4,   FN_PURE, CA_PUBLIC},
     {T("SORTBY"),      fun_sortby,     MAX_ARG, 2,       4,         0, CA_PUBLIC},
     {T("SORTKEY"),     fun_sortkey,    MAX_ARG, 2,       5,         0, CA_PUBLIC},
     {T("SOUNDEX"),     fun_soundex,    MAX_ARG, 1,       1,         0, CA_PUBLIC},
@@ -16498,6 +16501,11 @@ void list_functable(dbref player)
     *bp = '\0';
     notify(player, buff);
     free_lbuf(buff);
+
+    if (Wizard(player))
+    {
+        list_function_memo_stats(player);
+    }
 }
 
 
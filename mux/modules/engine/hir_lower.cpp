@@ -2882,7 +2882,7 @@ static int hir_lower_funccall(hir_program &h, rv_compiler &rc,
             size_t nBodyLen = 0;
             UTF8 *body = atr_pget_LEN(thing, pattr->number,
                                        &aowner, &aflags, &nBodyLen);
-            std::unique_ptr<ASTNode> body_ast;
+            ASTTree body_ast;
             if (body && nBodyLen > 0 && !(aflags & AF_TRACE)) {
                 body_ast = ast_parse_string(body, nBodyLen);
             }
@@ -3285,7 +3285,7 @@ static int hir_lower_funccall(hir_program &h, rv_compiler &rc,
             size_t nBodyLen = 0;
             UTF8 *body = atr_pget_LEN(thing, pattr->number,
                                        &aowner, &aflags, &nBodyLen);
-            std::unique_ptr<ASTNode> body_ast;
+            ASTTree body_ast;
             if (body && nBodyLen > 0 && !(aflags & AF_TRACE)) {
                 body_ast = ast_parse_string(body, nBodyLen);
             }
@@ -3707,7 +3707,7 @@ static int hir_lower_funccall(hir_program &h, rv_compiler &rc,
             size_t nBodyLen = 0;
             UTF8 *body = atr_pget_LEN(thing, pattr->number,
                                        &aowner, &aflags, &nBodyLen);
-            std::unique_ptr<ASTNode> body_ast;
+            ASTTree body_ast;
             if (body && nBodyLen > 0 && !(aflags & AF_TRACE)) {
                 body_ast = ast_parse_string(body, nBodyLen);
             }
@@ -4172,7 +4172,7 @@ static int hir_lower_funccall(hir_program &h, rv_compiler &rc,
                 // MAP carries.  Parsing only when the body is eligible
                 // keeps free_lbuf outside the success path so TRACE and
                 // empty bodies free cleanly.
-                std::unique_ptr<ASTNode> body_ast;
+                ASTTree body_ast;
                 if (body && nBodyLen > 0 && !(aflags & AF_TRACE))
                 {
                     body_ast = ast_parse_string(body, nBodyLen);
@@ -6012,7 +6012,7 @@ int hir_lower_node(hir_program &h, rv_compiler &rc,
                 if (node->text.size() >= 4 && node->text[2] == '<') {
                     size_t close = node->text.find('>', 3);
                     if (close != std::string::npos) {
-                        std::string name = node->text.substr(3, close - 3);
+                        std::string name(node->text.substr(3, close - 3));
 
                         if (!name.empty() && name[0] >= '0' && name[0] <= '9') {
                             // Numeric arg reference: %=<0> through %=<N>.
@@ -6077,7 +6077,7 @@ int hir_lower_node(hir_program &h, rv_compiler &rc,
                     // Extract name between < and >.
                     size_t close = node->text.find('>', 3);
                     if (close != std::string::npos) {
-                        std::string regname = node->text.substr(3, close - 3);
+                        std::string regname(node->text.substr(3, close - 3));
                         // Emit ECALL for r("name").
                         uint64_t name_addr = rc.pool_str(regname);
                         int name_val = h.emit_sconst(name_addr, regname);
@@ -4103,8 +4103,11 @@ static int ecall_invoke_fun(FUN *fp, eval_ctx *ec, rv64_ctx_t *ctx,
     // program flags diverged for re-evaluating handlers: fun_eval's
     // inner mux_exec inherited EV_STRIP_CURLY and stripped nested
     // braces the AST route preserves (#991 parser TC010).
-    fp->fun(fp, buff, &bufc, ec->executor, ec->caller, ec->enactor,
-            ec->eval & EV_TRACE, fargs, nfargs, ec->cargs, ec->ncargs);
+    if (!function_memo_replay(fp, fargs, nfargs, buff, &bufc)) {
+        fp->fun(fp, buff, &bufc, ec->executor, ec->caller, ec->enactor,
+                ec->eval & EV_TRACE, fargs, nfargs, ec->cargs, ec->ncargs);
+        function_memo_store(buff, buff, bufc);
+    }
 
     s_current_ecall_ctx = saved_ctx;
 
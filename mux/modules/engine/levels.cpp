@@ -98,6 +98,7 @@ void notify_except_rlevel
     int xflags
 )
 {
+    CBroadcastScope broadcast;
     if (  loc != exception
        && IsReal(loc, player))
     {
@@ -127,6 +128,7 @@ void notify_except2_rlevel
     const UTF8 *msg
 )
 {
+    CBroadcastScope broadcast;
     if (  loc != exc1
        && loc != exc2
        && IsReal(loc, player))
@@ -158,6 +160,7 @@ void notify_except2_rlevel2
     const UTF8 *msg
 )
 {
+    CBroadcastScope broadcast;
     if (  loc != exc1
        && loc != exc2
        && IsReal(loc, player))
@@ -8,6 +8,12 @@
 #include "config.h"
 #include "externs.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 // Factory class declarations — internal to engine.so (no DCL_EXPORT).
 //
 class CLogFactory : public mux_IClassFactory
@@ -386,6 +392,322 @@ void do_log
 }
 
 CLogFile Log;
+// ---------------------------------------------------------------------------
+// Background log writer.
+//
+// Flush() used to write(2) every log entry from the game thread, and rotate
+// the file there too when it grew past FILE_SIZE_TRIGGER.  Now the game
+// thread copies the entry into a ring and goes on, and a writer thread takes
+// whatever has accumulated in as few writes as it can, rotating between
+// them.
+//
+// The ring has one producer and one consumer.  The producer is whoever holds
+// the log -- the game thread, or on Windows whoever holds csLog -- and only it
+// moves m_nHead.  Only the writer moves m_nTail.  Both count bytes from the
+// start, so what is queued is always m_nHead - m_nTail.
+//
+// When the ring is full, the producer waits up to LOG_STALL_LIMIT for room
+// and counts what it queued as delayed.  Past that it drops output rather
+// than hold up the game: the rest of the entry that was cut short goes too,
+// and once there is room again a line saying how much was lost goes in
+// ahead of the next entry.
+//
+#define LOG_RING_SIZE (256*1024UL)
+
+static const std::chrono::milliseconds LOG_STALL_LIMIT(20);
+static const std::chrono::milliseconds LOG_WRITE_PERIOD(50);
+
+class CLogWriter
+{
+public:
+    struct Stats
+    {
+        uint64_t written;       // Bytes that reached the file.
+        uint64_t writes;        // Writes that carried them.
+        uint64_t failures;      // Writes that failed; their bytes are gone.
+        uint64_t delayed;       // Bytes the producer waited for room for.
+        uint64_t dropped;       // Bytes discarded because the ring stayed full.
+        size_t   queued;
+        bool     running;
+    };
+
+    explicit CLogWriter(CLogFile *pLog) : m_pLog(pLog)
+    {
+    }
+
+    ~CLogWriter()
+    {
+        Stop();
+    }
+
+    bool Start(void)
+    {
+        m_bStop = false;
+        try
+        {
+            m_thread = std::thread(&CLogWriter::Run, this);
+        }
+        catch (const std::system_error &)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // Returns once everything queued is written and the thread has gone.
+    // The ring and the counters stay, so Start() can pick up again.
+    //
+    void Stop(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStop = true;
+        }
+        m_cvWork.notify_one();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    bool Running(void) const
+    {
+        return m_thread.joinable();
+    }
+
+    void Put(const UTF8 *pData, size_t nData);
+
+    // Block until everything Put so far has been written.
+    //
+    void Sync(void)
+    {
+        const size_t target = m_nHead.load(std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_bUrgent = true;
+        m_cvWork.notify_one();
+        m_cvRoom.wait(lock, [this, target]
+            { return target <= m_nTail.load(std::memory_order_acquire); });
+    }
+
+    void RequestRotate(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bRotate = true;
+        }
+        m_cvWork.notify_one();
+    }
+
+    uint64_t Failures(void) const
+    {
+        return m_nFailures.load(std::memory_order_relaxed);
+    }
+
+    Stats GetStats(void) const
+    {
+        Stats st;
+        st.written  = m_nWritten.load(std::memory_order_relaxed);
+        st.writes   = m_nWrites.load(std::memory_order_relaxed);
+        st.failures = m_nFailures.load(std::memory_order_relaxed);
+        st.delayed  = m_nDelayed;
+        st.dropped  = m_nDropped;
+        st.queued   = Queued();
+        st.running  = Running();
+        return st;
+    }
+
+private:
+    size_t Queued(void) const
+    {
+        return m_nHead.load(std::memory_order_acquire)
+             - m_nTail.load(std::memory_order_acquire);
+    }
+
+    void Copy(const UTF8 *pData, size_t nData);
+    void Drop(const UTF8 *pData, size_t nData);
+    bool WaitForRoom(size_t nData);
+    void WriteQueued(void);
+    void Run(void);
+
+    CLogFile *m_pLog;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cvWork;
+    std::condition_variable m_cvRoom;   // Signalled after every pass.
+    bool m_bStop{false};                // Guarded by m_mutex.
+    bool m_bUrgent{false};              // Guarded by m_mutex.
+    bool m_bRotate{false};              // Guarded by m_mutex.
+
+    std::atomic<size_t> m_nHead{0};
+    std::atomic<size_t> m_nTail{0};
+    std::atomic<uint64_t> m_nWritten{0};
+    std::atomic<uint64_t> m_nWrites{0};
+    std::atomic<uint64_t> m_nFailures{0};
+
+    // Producer side only.
+    //
+    uint64_t m_nDelayed{0};
+    uint64_t m_nDropped{0};
+    uint64_t m_nDropRun{0};             // Dropped since the last note.
+    bool m_bDropping{false};
+    bool m_bMidEntry{false};            // Last dropped piece ended mid-line.
+    bool m_bLineOpen{false};            // Last queued piece ended mid-line.
+
+    UTF8 m_aRing[LOG_RING_SIZE];
+};
+
+void CLogWriter::Copy(const UTF8 *pData, size_t nData)
+{
+    const size_t head = m_nHead.load(std::memory_order_relaxed);
+    const size_t used = head - m_nTail.load(std::memory_order_acquire);
+    const size_t i = head % LOG_RING_SIZE;
+    size_t nFirst = LOG_RING_SIZE - i;
+    if (nData < nFirst)
+    {
+        nFirst = nData;
+    }
+    memcpy(m_aRing + i, pData, nFirst);
+    memcpy(m_aRing, pData + nFirst, nData - nFirst);
+    m_nHead.store(head + nData, std::memory_order_release);
+    m_bLineOpen = ('\n' != pData[nData-1]);
+
+    // The writer wakes on its own every LOG_WRITE_PERIOD.  Only hurry it
+    // along once the ring is half full.
+    //
+    if (  used < LOG_RING_SIZE/2
+       && LOG_RING_SIZE/2 <= used + nData)
+    {
+        m_cvWork.notify_one();
+    }
+}
+
+void CLogWriter::Drop(const UTF8 *pData, size_t nData)
+{
+    m_bDropping = true;
+    m_nDropped += nData;
+    m_nDropRun += nData;
+    m_bMidEntry = ('\n' != pData[nData-1]);
+}
+
+bool CLogWriter::WaitForRoom(size_t nData)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_bUrgent = true;
+    m_cvWork.notify_one();
+    const bool bRoom = m_cvRoom.wait_for(lock, LOG_STALL_LIMIT, [this, nData]
+        { return nData <= LOG_RING_SIZE - Queued(); });
+    if (bRoom)
+    {
+        m_nDelayed += nData;
+    }
+    return bRoom;
+}
+
+void CLogWriter::Put(const UTF8 *pData, size_t nData)
+{
+    if (0 == nData)
+    {
+        return;
+    }
+
+    if (m_bDropping)
+    {
+        // No waiting while dropping; the writer has shown it is behind.
+        //
+        if (m_bMidEntry)
+        {
+            Drop(pData, nData);
+            return;
+        }
+
+        UTF8 aNote[128];
+        mux_sprintf(aNote, sizeof(aNote),
+            T("%s*** Log writer fell behind; %llu bytes dropped. ***" ENDLINE),
+            m_bLineOpen ? T(ENDLINE) : T(""),
+            static_cast<unsigned long long>(m_nDropRun));
+        const size_t nNote = strlen(reinterpret_cast<char *>(aNote));
+        if (LOG_RING_SIZE - Queued() < nNote + nData)
+        {
+            Drop(pData, nData);
+            return;
+        }
+        Copy(aNote, nNote);
+        m_bDropping = false;
+        m_nDropRun = 0;
+    }
+    else if (  LOG_RING_SIZE - Queued() < nData
+            && !WaitForRoom(nData))
+    {
+        Drop(pData, nData);
+        return;
+    }
+    Copy(pData, nData);
+}
+
+void CLogWriter::WriteQueued(void)
+{
+    const size_t head = m_nHead.load(std::memory_order_acquire);
+    size_t tail = m_nTail.load(std::memory_order_relaxed);
+    while (tail != head)
+    {
+        const size_t i = tail % LOG_RING_SIZE;
+        size_t n = LOG_RING_SIZE - i;
+        if (head - tail < n)
+        {
+            n = head - tail;
+        }
+
+        if (m_pLog->WriteFileData(m_aRing + i, n))
+        {
+            m_nWritten.fetch_add(n, std::memory_order_relaxed);
+        }
+        else
+        {
+            m_nFailures.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_nWrites.fetch_add(1, std::memory_order_relaxed);
+
+        tail += n;
+        m_nTail.store(tail, std::memory_order_release);
+    }
+}
+
+void CLogWriter::Run(void)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_cvWork.wait_for(lock, LOG_WRITE_PERIOD, [this]
+        {
+            return m_bStop
+                || m_bUrgent
+                || m_bRotate
+                || LOG_RING_SIZE/2 <= Queued();
+        });
+        const bool bStop = m_bStop;
+        const bool bRotate = m_bRotate;
+        m_bUrgent = false;
+        m_bRotate = false;
+        lock.unlock();
+
+        WriteQueued();
+        if (bRotate)
+        {
+            m_pLog->NextLogFile();
+        }
+
+        lock.lock();
+        m_cvRoom.notify_one();
+
+        // The producer is the one stopping us, so nothing more is coming.
+        //
+        if (bStop)
+        {
+            return;
+        }
+    }
+}
+
 void CLogFile::WriteInteger(int iNumber)
 {
     UTF8 aTempBuffer[I32BUF_SIZE];
@@ -455,7 +777,8 @@ static void MakeLogName
     const UTF8 *szPrefix,
     CLinearTimeAbsolute lta,
     UTF8 *szLogName,
-    size_t nLogName
+    size_t nLogName,
+    const UTF8 *szExtension = T("log")
 )
 {
     UTF8 szTimeStamp[18];
@@ -463,15 +786,28 @@ static void MakeLogName
     if (  pBasename
        && pBasename[0] != '\0')
     {
-        mux_sprintf(szLogName, nLogName, T("%s/%s-%s.log"),
-            pBasename, szPrefix, szTimeStamp);
+        mux_sprintf(szLogName, nLogName, T("%s/%s-%s.%s"),
+            pBasename, szPrefix, szTimeStamp, szExtension);
     }
     else
     {
-        mux_sprintf(szLogName, nLogName, T("%s-%s.log"), szPrefix, szTimeStamp);
+        mux_sprintf(szLogName, nLogName, T("%s-%s.%s"), szPrefix, szTimeStamp,
+            szExtension);
     }
 }
 
+// Name a companion file for the log, made now, in the same place and with
+// the same prefix as the log files.
+//
+void CLogFile::MakeFileName(const UTF8 *szExtension, UTF8 *szName, size_t nName)
+{
+    CLinearTimeAbsolute ltaNow;
+    ltaNow.GetLocal();
+    MakeLogName(bUseStderr ? nullptr : m_pBasename,
+        ('\0' != m_szPrefix[0]) ? m_szPrefix : T("netmux"), ltaNow,
+        szName, nName, szExtension);
+}
+
 bool CLogFile::CreateLogFile(void)
 {
     CloseLogFile();
@@ -548,6 +884,104 @@ void CLogFile::CloseLogFile(void)
 
 #define FILE_SIZE_TRIGGER (512*1024UL)
 
+void CLogFile::NextLogFile(void)
+{
+    CloseLogFile();
+
+    m_ltaStarted.GetLocal();
+    MakeLogName(m_pBasename, m_szPrefix, m_ltaStarted, m_szFilename,
+        sizeof(m_szFilename));
+
+    CreateLogFile();
+}
+
+// Write to the log file, starting the next one once this one is big enough.
+// Called by the writer thread when there is one, and by the producer
+// otherwise, never both.
+//
+bool CLogFile::WriteFileData(const UTF8 *pData, size_t nData)
+{
+    m_nSize += nData;
+#if defined(WINDOWS_FILES)
+    unsigned long nWritten;
+    bool fSuccess = true;
+    if (!WriteFile(m_hFile, pData, static_cast<DWORD>(nData), &nWritten, nullptr))
+    {
+        fSuccess = false;
+    }
+#elif defined(UNIX_FILES)
+    bool fSuccess = true;
+    while (0 < nData)
+    {
+        ssize_t written = mux_write(m_fdFile, pData, nData);
+        if (written <= 0)
+        {
+            fSuccess = false;
+            break;
+        }
+        pData += written;
+        nData -= static_cast<size_t>(written);
+    }
+#endif // UNIX_FILES
+
+    if (m_nSize > FILE_SIZE_TRIGGER)
+    {
+        NextLogFile();
+    }
+    return fSuccess;
+}
+
+// The writer thread, if there can be one.  stderr is written inline so that
+// it stays in order with everything else going to stderr, and the
+// standalone tools have no game to keep moving.
+//
+CLogWriter *CLogFile::Writer(void)
+{
+    if (  bUseStderr
+       || m_bWriterFailed
+       || m_bForked
+       || mudstate.bStandAlone)
+    {
+        return nullptr;
+    }
+
+    if (nullptr == m_pWriter)
+    {
+        try
+        {
+            m_pWriter = new CLogWriter(this);
+        }
+        catch (...)
+        {
+            ; // Nothing.
+        }
+    }
+
+    if (  nullptr != m_pWriter
+       && !m_pWriter->Running()
+       && !m_pWriter->Start())
+    {
+        delete m_pWriter;
+        m_pWriter = nullptr;
+    }
+
+    if (nullptr == m_pWriter)
+    {
+        m_bWriterFailed = true;
+        const UTF8 *pMsg = T("log_writer: could not start; writing the log on the game thread." ENDLINE);
+        WriteFileData(pMsg, strlen(reinterpret_cast<const char *>(pMsg)));
+    }
+    return m_pWriter;
+}
+
+void CLogFile::StopWriter(void)
+{
+    if (nullptr != m_pWriter)
+    {
+        m_pWriter->Stop();
+    }
+}
+
 void CLogFile::Flush(void)
 {
     if (  m_nBuffer <= 0
@@ -564,37 +998,79 @@ void CLogFile::Flush(void)
     }
     else
     {
-        m_nSize += m_nBuffer;
-#if defined(WINDOWS_FILES)
-        unsigned long nWritten;
+        CLogWriter *pWriter = Writer();
         bool fSuccess = true;
-        if (!WriteFile(m_hFile, m_aBuffer, static_cast<DWORD>(m_nBuffer), &nWritten, nullptr))
+        if (nullptr != pWriter)
         {
-            fSuccess = false;
+            pWriter->Put(m_aBuffer, m_nBuffer);
+
+            const uint64_t nFailures = pWriter->Failures();
+            if (m_nFailuresReported != nFailures)
+            {
+                m_nFailuresReported = nFailures;
+                fSuccess = false;
+            }
+        }
+        else
+        {
+            fSuccess = WriteFileData(m_aBuffer, m_nBuffer);
         }
-#elif defined(UNIX_FILES)
-        ssize_t written = mux_write(m_fdFile, m_aBuffer, m_nBuffer);
-        bool fSuccess = (0 < written && m_nBuffer ==  static_cast<size_t>(written));
-#endif // UNIX_FILES
 
         if (!fSuccess)
         {
             raw_broadcast(WIZARD,
                 M_("GAME: Unable to write to the log.  The disk may be full."));
         }
+    }
+    m_nBuffer = 0;
+}
 
-        if (m_nSize > FILE_SIZE_TRIGGER)
-        {
-            CloseLogFile();
+// Wait for everything logged so far to reach the file.
+//
+void CLogFile::Sync(void)
+{
+    Flush();
+    if (  nullptr != m_pWriter
+       && m_pWriter->Running())
+    {
+        m_pWriter->Sync();
+    }
+}
 
-            m_ltaStarted.GetLocal();
-            MakeLogName(m_pBasename, m_szPrefix, m_ltaStarted, m_szFilename,
-                sizeof(m_szFilename));
+// In a fork()ed child the writer thread does not exist, and its lock may
+// have been copied held.  Leave it alone and write inline from here on.
+//
+void CLogFile::AfterFork(void)
+{
+    m_bForked = true;
+    m_pWriter = nullptr;
+}
 
-            CreateLogFile();
-        }
+void CLogFile::ListStats(dbref player)
+{
+    if (bUseStderr)
+    {
+        notify(player, M_("Log writer: not used; the log goes to stderr."));
+        return;
     }
-    m_nBuffer = 0;
+    if (nullptr == m_pWriter)
+    {
+        notify(player, M_("Log writer: not running; the log is written inline."));
+        return;
+    }
+
+    CLogWriter::Stats st = m_pWriter->GetStats();
+    notify(player, tprintf(T("Log writer: %s   Queued: %lu of %lu bytes"),
+        st.running ? T("running") : T("stopped"),
+        static_cast<unsigned long>(st.queued),
+        static_cast<unsigned long>(LOG_RING_SIZE)));
+    notify(player, tprintf(T("Written: %llu bytes in %llu writes   Failed writes: %llu"),
+        static_cast<unsigned long long>(st.written),
+        static_cast<unsigned long long>(st.writes),
+        static_cast<unsigned long long>(st.failures)));
+    notify(player, tprintf(T("Delayed: %llu bytes   Dropped: %llu bytes"),
+        static_cast<unsigned long long>(st.delayed),
+        static_cast<unsigned long long>(st.dropped)));
 }
 
 void CLogFile::SetPrefix(const UTF8 * szPrefix)
@@ -604,6 +1080,7 @@ void CLogFile::SetPrefix(const UTF8 * szPrefix)
     {
         if (bEnabled)
         {
+            StopWriter();
             CloseLogFile();
         }
 
@@ -626,6 +1103,7 @@ void CLogFile::SetPrefix(const UTF8 * szPrefix)
 
 void CLogFile::SetBasename(const UTF8 * pBasename)
 {
+    StopWriter();
     if (m_pBasename)
     {
         MEMFREE(m_pBasename);
@@ -670,10 +1148,15 @@ CLogFile::CLogFile(void)
     m_pBasename = nullptr;
     m_szPrefix[0] = '\0';
     m_szFilename[0] = '\0';
+    m_pWriter = nullptr;
+    m_bWriterFailed = false;
+    m_bForked = false;
+    m_nFailuresReported = 0;
 }
 
 void CLogFile::StartLogging()
 {
+    StopWriter();
     if (!bUseStderr)
     {
         m_ltaStarted.GetLocal();
@@ -687,6 +1170,7 @@ void CLogFile::StartLogging()
 void CLogFile::StopLogging(void)
 {
     Flush();
+    StopWriter();
     bEnabled = false;
     if (!bUseStderr)
     {
@@ -706,14 +1190,18 @@ void CLogFile::Rotate(void)
     Flush();
     if (!bUseStderr)
     {
-        CloseLogFile();
-
-        m_ltaStarted.GetLocal();
-        MakeLogName(m_pBasename, m_szPrefix, m_ltaStarted, m_szFilename,
-            sizeof(m_szFilename));
-
-        CreateLogFile();
-        m_nSize = 0;
+        // The writer owns the file while it runs, so it does the rotation,
+        // after everything queued ahead of it.
+        //
+        if (  nullptr != m_pWriter
+           && m_pWriter->Running())
+        {
+            m_pWriter->RequestRotate();
+        }
+        else
+        {
+            NextLogFile();
+        }
     }
 
 #if defined(WINDOWS_THREADS)
@@ -734,12 +1222,15 @@ void do_logrotate(dbref executor, dbref caller, dbref enactor, int eval, int key
     ENDLOG;
 
     Log.Rotate();
+    eventlog_rotate();
     notify(executor, M_("Log file rotated."));
 }
 
 CLogFile::~CLogFile(void)
 {
     StopLogging();
+    delete m_pWriter;
+    m_pWriter = nullptr;
 #if defined(WINDOWS_THREADS)
     DeleteCriticalSection(&csLog);
 #endif // WINDOWS_THREADS
@@ -770,6 +1261,7 @@ public:
     virtual MUX_RESULT SetBasename(const UTF8 *pBasename);
     virtual MUX_RESULT StartLogging(void);
     virtual MUX_RESULT Flush(void);
+    virtual MUX_RESULT log_event(int key, int iType, uint32_t nSocket, dbref player, dbref other, const UTF8 *pStr1, const UTF8 *pStr2);
 
     CLog(void);
     virtual ~CLog();
@@ -902,6 +1394,15 @@ MUX_RESULT CLog::Flush(void)
     return MUX_S_OK;
 }
 
+MUX_RESULT CLog::log_event(int key, int iType, uint32_t nSocket, dbref player, dbref other, const UTF8 *pStr1, const UTF8 *pStr2)
+{
+    if ((key & mudconf.event_log) != 0)
+    {
+        ::log_event(iType, nSocket, player, other, pStr1, pStr2);
+    }
+    return MUX_S_OK;
+}
+
 // Factory for CLog component which is not directly accessible.
 //
 CLogFactory::CLogFactory(void) : m_cRef(1)
@@ -995,6 +1496,11 @@ MUX_RESULT CLogFactory::LockServer(bool bLock)
 //  8: log_name_and_loc
 //  9: log_type_and_name
 // 10: end_log
+// 11: WriteString
+// 12: SetBasename
+// 13: StartLogging
+// 14: Flush
+// 15: log_event
 //
 
 
@@ -1028,6 +1534,7 @@ public:
     virtual MUX_RESULT SetBasename(const UTF8 *pBasename);
     virtual MUX_RESULT StartLogging(void);
     virtual MUX_RESULT Flush(void);
+    virtual MUX_RESULT log_event(int key, int iType, uint32_t nSocket, dbref player, dbref other, const UTF8 *pStr1, const UTF8 *pStr2);
 
     CLogProxy(void);
     virtual ~CLogProxy();
@@ -1414,6 +1921,37 @@ MUX_RESULT CLogProxy::Flush(void)
     return mr;
 }
 
+MUX_RESULT CLogProxy::log_event(int key, int iType, uint32_t nSocket, dbref player, dbref other, const UTF8 *pStr1, const UTF8 *pStr2)
+{
+    QUEUE_INFO qiFrame;
+    Pipe_InitializeQueueInfo(&qiFrame);
+
+    Marshal_PutUInt32(&qiFrame, 15);
+    Marshal_PutInt(&qiFrame, key);
+    Marshal_PutInt(&qiFrame, iType);
+    Marshal_PutUInt32(&qiFrame, nSocket);
+    Marshal_PutInt(&qiFrame, player);
+    Marshal_PutInt(&qiFrame, other);
+    Marshal_PutString(&qiFrame, pStr1);
+    Marshal_PutString(&qiFrame, pStr2);
+
+    MUX_RESULT mr = Pipe_SendCallPacketAndWait(m_nChannel, &qiFrame);
+    if (MUX_SUCCEEDED(mr))
+    {
+        MUX_RESULT mrReturn;
+        if (Marshal_GetInt(&qiFrame, &mrReturn))
+        {
+            mr = mrReturn;
+        }
+        else
+        {
+            mr = MUX_E_FAIL;
+        }
+    }
+    Pipe_EmptyQueue(&qiFrame);
+    return mr;
+}
+
 // CLogStub: server-side stub for mux_ILog over a pipe channel.
 //
 class CLogStub : public mux_IRpcStubBuffer
@@ -1723,6 +2261,36 @@ MUX_RESULT CLogStub::Invoke(QUEUE_INFO *pqi)
         }
         break;
 
+    case 15: // log_event
+        {
+            int key;
+            int iType;
+            uint32_t nSocket;
+            dbref player;
+            dbref other;
+            LBuf bufStr1 = LBuf_Src("log_event.str1");
+            LBuf bufStr2 = LBuf_Src("log_event.str2");
+            const UTF8 *pStr1;
+            const UTF8 *pStr2;
+
+            if (  !Marshal_GetInt(pqi, &key)
+               || !Marshal_GetInt(pqi, &iType)
+               || !Marshal_GetUInt32(pqi, &nSocket)
+               || !Marshal_GetInt(pqi, &player)
+               || !Marshal_GetInt(pqi, &other)
+               || !Marshal_GetString(pqi, bufStr1, LBUF_SIZE, &pStr1)
+               || !Marshal_GetString(pqi, bufStr2, LBUF_SIZE, &pStr2))
+            {
+                return MUX_E_INVALIDARG;
+            }
+
+            mr = m_pILog->log_event(key, iType, nSocket, player, other, pStr1, pStr2);
+
+            Pipe_EmptyQueue(pqi);
+            Marshal_PutInt(pqi, mr);
+        }
+        break;
+
     default:
         mr = MUX_E_NOTIMPLEMENTED;
         break;
@@ -310,7 +310,7 @@ dbref CGuests::MakeGuestChar(void)
     // Make the player.
     //
     const UTF8 *pmsg;
-    player = create_player(name, reinterpret_cast<const UTF8 *>(GUEST_PASSWORD), mudconf.guest_nuker, false, &pmsg);
+    player = create_player(name, reinterpret_cast<const UTF8 *>(GUEST_PASSWORD), mudconf.guest_nuker, false, false, &pmsg);
 
     // No Player Created?? Return error.
     //
@@ -42,42 +42,48 @@ static bool sqlite_refresh_cached_attributes_in_sqlite(void)
     // pulling values from SQLite while we are trying to repair SQLite state.
     //
     std::vector<AttrRow> snapshot;
-    snapshot.reserve(mudstate.attribute_lru_cache_map.size());
-    for (const auto& kv : mudstate.attribute_lru_cache_map)
+    snapshot.reserve(mudstate.attribute_lru_cache_list.count
+        + mudstate.attribute_pinned_list.count);
+    for (const auto& okv : mudstate.attribute_cache_objects)
     {
-        const Aname& key = kv.first;
-        const auto& entry = kv.second;
-
-        if (  key.attrnum <= 0
-           || key.attrnum == A_LIST
-           || key.object < 0
-           || key.object >= mudstate.db_top
-           || isGarbage(key.object))
+        for (const auto& kv : okv.second.attrs)
         {
-            continue;
-        }
+            const auto& entry = kv.second;
+            Aname key;
+            key.object = entry.object;
+            key.attrnum = entry.attrnum;
 
-        ATTR *pAttr = atr_num(key.attrnum);
-        if (  nullptr == pAttr
-           || (pAttr->flags & AF_DELETED))
-        {
-            continue;
-        }
+            if (  key.attrnum <= 0
+               || key.attrnum == A_LIST
+               || key.object < 0
+               || key.object >= mudstate.db_top
+               || isGarbage(key.object))
+            {
+                continue;
+            }
 
-        if (entry.data.empty())
-        {
-            Log.tinyprintf(T("sqlite_refresh_cached_attributes_in_sqlite: invalid empty cache entry #%d/%d" ENDLINE),
-                key.object, key.attrnum);
-            return false;
-        }
+            ATTR *pAttr = atr_num(key.attrnum);
+            if (  nullptr == pAttr
+               || (pAttr->flags & AF_DELETED))
+            {
+                continue;
+            }
 
-        AttrRow row;
-        row.obj = key.object;
-        row.attrnum = key.attrnum;
-        row.owner = entry.attr_owner;
-        row.flags = entry.attr_flags;
-        row.value = entry.data;
-        snapshot.push_back(std::move(row));
+            if (entry.data.empty())
+            {
+                Log.tinyprintf(T("sqlite_refresh_cached_attributes_in_sqlite: invalid empty cache entry #%d/%d" ENDLINE),
+                    key.object, key.attrnum);
+                return false;
+            }
+
+            AttrRow row;
+            row.obj = key.object;
+            row.attrnum = key.attrnum;
+            row.owner = entry.attr_owner;
+            row.flags = entry.attr_flags;
+            row.value = entry.data;
+            snapshot.push_back(std::move(row));
+        }
     }
 
     CSQLiteDB &sqldb = g_pSQLiteBackend->GetDB();
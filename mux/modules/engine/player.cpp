@@ -13,6 +13,11 @@
 #include "sha1.h"
 #include "shacrypt.h"
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
 #define NUM_GOOD    4   // # of successful logins to save data for.
 #define NUM_BAD     3   // # of failed logins to save data for.
 
@@ -466,28 +471,422 @@ static const UTF8 *GenerateSalt(int iType)
     return szSalt;
 }
 
-void ChangePassword(dbref player, const UTF8 *szPassword)
+// The settings ChangePassword() tries, best first.  SHA1 always works, so it
+// closes the list whether or not it is configured.
+//
+static std::vector<std::string> password_settings(void)
 {
-    int iTypeOut;
-    const UTF8 *pEncodedPassword = nullptr;
+    std::vector<std::string> settings;
     int methods[] = { CRYPT_SHA512, CRYPT_SHA256, CRYPT_MD5, CRYPT_SHA1, CRYPT_DES };
     for (size_t i = 0; i < sizeof(methods)/sizeof(methods[0]); i++)
     {
-        if (  (mudconf.password_methods & methods[i])
-           && nullptr != (pEncodedPassword = mux_crypt(szPassword, GenerateSalt(methods[i]), &iTypeOut)))
+        if (mudconf.password_methods & methods[i])
         {
-            break;
+            settings.emplace_back(reinterpret_cast<const char *>(GenerateSalt(methods[i])));
+        }
+    }
+    settings.emplace_back(reinterpret_cast<const char *>(GenerateSalt(CRYPT_SHA1)));
+    return settings;
+}
+
+// Hash with the first setting that produces anything.
+//
+static const UTF8 *encode_password(const UTF8 *szPassword,
+    const std::vector<std::string> &settings, int *piType)
+{
+    for (const auto &setting : settings)
+    {
+        const UTF8 *p = mux_crypt(szPassword,
+            reinterpret_cast<const UTF8 *>(setting.c_str()), piType);
+        if (nullptr != p)
+        {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+/* ---------------------------------------------------------------------------
+ * Password hashing off the game thread.
+ *
+ * A sha-crypt hash at the configured rounds costs milliseconds, so a burst of
+ * logins used to stall every player for every password typed.  Connect,
+ * create, and @password hand the hash to a worker thread instead.  The worker
+ * sees only strings: salts are picked, A_PASS is read, and results are
+ * applied on the game thread.  Task_PasswordHashes collects results while
+ * any hash is outstanding.
+ */
+
+struct PASSWORD_JOB
+{
+    int ticket;
+    std::string password;
+    std::vector<std::string> settings;  // Tried in order; see encode_password().
+    std::string result;                 // Empty if no setting worked.
+    int iType;
+    std::function<void(const PASSWORD_JOB &)> done;    // Runs on the game thread.
+};
+
+class CPasswordHasher
+{
+public:
+    ~CPasswordHasher()
+    {
+        Stop();
+    }
+
+    bool Start(void)
+    {
+        try
+        {
+            m_thread = std::thread(&CPasswordHasher::Run, this);
+        }
+        catch (const std::system_error &)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // Returns once everything submitted has been hashed and the thread has
+    // gone.
+    //
+    void Stop(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStop = true;
+        }
+        m_cvWork.notify_one();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
         }
     }
 
-    if (nullptr == pEncodedPassword)
+    void Submit(PASSWORD_JOB &&job)
     {
-        pEncodedPassword = mux_crypt(szPassword, GenerateSalt(CRYPT_SHA1), &iTypeOut);
-        mux_assert(nullptr != pEncodedPassword);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(job));
+        }
+        m_cvWork.notify_one();
     }
+
+    void Reap(std::vector<PASSWORD_JOB> &done)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        done.swap(m_done);
+    }
+
+private:
+    void Run(void)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_cvWork.wait(lock, [this]
+            {
+                return m_bStop || !m_queue.empty();
+            });
+            if (m_queue.empty())
+            {
+                break;
+            }
+            PASSWORD_JOB job = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+
+            job.iType = CRYPT_FAIL;
+            const UTF8 *p = encode_password(
+                reinterpret_cast<const UTF8 *>(job.password.c_str()),
+                job.settings, &job.iType);
+            if (nullptr != p)
+            {
+                job.result = reinterpret_cast<const char *>(p);
+            }
+
+            lock.lock();
+            m_done.push_back(std::move(job));
+        }
+    }
+
+    std::thread             m_thread;
+    std::mutex              m_mutex;
+    std::condition_variable m_cvWork;
+    std::deque<PASSWORD_JOB>     m_queue;
+    std::vector<PASSWORD_JOB>    m_done;
+    bool                    m_bStop = false;
+};
+
+static CPasswordHasher *s_pHasher = nullptr;
+static bool s_hasher_failed = false;
+static bool s_reap_scheduled = false;
+static int  s_hash_ticket = 0;
+static int  s_hashes_outstanding = 0;
+
+// The newest set ticket for each player, taken when the set is asked for.
+// A set that is no longer the newest for its player is dropped.
+//
+static std::unordered_map<dbref, int> s_pending_sets;
+
+// Password work for a player -- a check, or a set -- runs one piece at a
+// time, in the order it was asked for.  A check reads A_PASS only once every
+// set asked for before it has landed, so a reconnect straight after
+// @password, or a second @password right behind the first, sees what it
+// would if hashing were instant.  A player is in the map while a piece runs;
+// the deque holds the pieces waiting behind it.
+//
+static std::unordered_map<dbref, std::deque<std::function<void()>>> s_password_work;
+
+static void Task_PasswordHashes(void *arg_voidptr, int arg_Integer);
+
+// The worker, if there can be one.  Like the cache writer, it starts on
+// first use, so no thread exists across anything startup might fork.
+//
+static CPasswordHasher *password_hasher(void)
+{
+    if (  mudstate.bStandAlone
+       || s_hasher_failed)
+    {
+        return nullptr;
+    }
+
+    if (nullptr == s_pHasher)
+    {
+        s_pHasher = new CPasswordHasher;
+        if (!s_pHasher->Start())
+        {
+            delete s_pHasher;
+            s_pHasher = nullptr;
+            s_hasher_failed = true;
+            Log.tinyprintf(T("password_hasher: could not start; hashing passwords on the game thread." ENDLINE));
+            return nullptr;
+        }
+    }
+    return s_pHasher;
+}
+
+static int next_password_ticket(void)
+{
+    if (INT_MAX == s_hash_ticket)
+    {
+        s_hash_ticket = 0;
+    }
+    return ++s_hash_ticket;
+}
+
+static void password_hash_submit(int ticket, const UTF8 *szPassword,
+    std::vector<std::string> &&settings,
+    std::function<void(const PASSWORD_JOB &)> &&done)
+{
+    PASSWORD_JOB job;
+    job.ticket = ticket;
+    job.password = reinterpret_cast<const char *>(szPassword);
+    job.settings = std::move(settings);
+    job.iType = CRYPT_FAIL;
+    job.done = std::move(done);
+    s_pHasher->Submit(std::move(job));
+    s_hashes_outstanding++;
+
+    if (!s_reap_scheduled)
+    {
+        s_reap_scheduled = true;
+        CLinearTimeAbsolute ltaNow;
+        ltaNow.GetUTC();
+        scheduler.DeferTask(ltaNow + time_5ms, PRIORITY_SYSTEM,
+            Task_PasswordHashes, nullptr, 0);
+    }
+}
+
+// Run fnWork now if nothing else is running for this player, or after
+// everything asked for before it.  fnWork must end with password_work_done().
+//
+static void password_work_start(dbref player, std::function<void()> &&fnWork)
+{
+    const auto it = s_password_work.find(player);
+    if (s_password_work.end() != it)
+    {
+        it->second.push_back(std::move(fnWork));
+        return;
+    }
+    s_password_work[player];
+    fnWork();
+}
+
+static void password_work_done(dbref player)
+{
+    const auto it = s_password_work.find(player);
+    if (s_password_work.end() == it)
+    {
+        return;
+    }
+    if (it->second.empty())
+    {
+        s_password_work.erase(it);
+        return;
+    }
+    std::function<void()> fnNext = std::move(it->second.front());
+    it->second.pop_front();
+    fnNext();
+}
+
+static void password_hash_reap(CPasswordHasher *pHasher)
+{
+    std::vector<PASSWORD_JOB> done;
+    pHasher->Reap(done);
+    s_hashes_outstanding -= static_cast<int>(done.size());
+    for (const auto &job : done)
+    {
+        job.done(job);
+    }
+}
+
+static void Task_PasswordHashes(void *arg_voidptr, int arg_Integer)
+{
+    UNUSED_PARAMETER(arg_voidptr);
+    UNUSED_PARAMETER(arg_Integer);
+
+    s_reap_scheduled = false;
+    if (nullptr == s_pHasher)
+    {
+        return;
+    }
+
+    password_hash_reap(s_pHasher);
+    if (  0 < s_hashes_outstanding
+       && !s_reap_scheduled)
+    {
+        s_reap_scheduled = true;
+        CLinearTimeAbsolute ltaNow;
+        ltaNow.GetUTC();
+        scheduler.DeferTask(ltaNow + time_5ms, PRIORITY_SYSTEM,
+            Task_PasswordHashes, nullptr, 0);
+    }
+}
+
+// Finish every outstanding hash and apply the results, so a password set a
+// moment ago is in the database that is about to be written.  Later sets
+// hash on the game thread, and so does any work still waiting its turn.
+//
+void password_hash_shutdown(void)
+{
+    CPasswordHasher *pHasher = s_pHasher;
+    if (nullptr == pHasher)
+    {
+        return;
+    }
+    s_pHasher = nullptr;
+    s_hasher_failed = true;
+
+    pHasher->Stop();
+    password_hash_reap(pHasher);
+    delete pHasher;
+    scheduler.CancelTask(Task_PasswordHashes, nullptr, 0);
+    s_reap_scheduled = false;
+}
+
+void ChangePassword(dbref player, const UTF8 *szPassword)
+{
+    // A hash still running or waiting for an earlier set must not land on
+    // top of this.
+    //
+    s_pending_sets.erase(player);
+
+    int iTypeOut;
+    const UTF8 *pEncodedPassword = encode_password(szPassword,
+        password_settings(), &iTypeOut);
+    mux_assert(nullptr != pEncodedPassword);
     s_Pass(player, pEncodedPassword);
 }
 
+// Hash strPassword on the worker and store it as set ticket, a piece of
+// password work for player.  fnDone hears whether the set was applied; it is
+// not if a newer set came along meanwhile.
+//
+static void set_password_later(dbref player, int ticket,
+    const std::string &strPassword, std::function<void(bool)> fnDone)
+{
+    const auto it = s_pending_sets.find(player);
+    if (  s_pending_sets.end() == it
+       || it->second != ticket)
+    {
+        fnDone(false);
+        return;
+    }
+
+    if (nullptr == password_hasher())
+    {
+        const bool bApplied = Good_obj(player) && isPlayer(player);
+        if (bApplied)
+        {
+            ChangePassword(player, reinterpret_cast<const UTF8 *>(strPassword.c_str()));
+        }
+        else
+        {
+            s_pending_sets.erase(it);
+        }
+        fnDone(bApplied);
+        return;
+    }
+
+    password_hash_submit(ticket, reinterpret_cast<const UTF8 *>(strPassword.c_str()),
+        password_settings(),
+        [player, fnDone](const PASSWORD_JOB &job)
+        {
+            bool bApplied = false;
+            const auto it2 = s_pending_sets.find(player);
+            if (  s_pending_sets.end() != it2
+               && it2->second == job.ticket)
+            {
+                s_pending_sets.erase(it2);
+                if (  Good_obj(player)
+                   && isPlayer(player)
+                   && !job.result.empty())
+                {
+                    s_Pass(player, reinterpret_cast<const UTF8 *>(job.result.c_str()));
+                    bApplied = true;
+                }
+            }
+            fnDone(bApplied);
+        });
+}
+
+// ChangePassword() with the hash on the worker.  A_PASS keeps its old value
+// until the result lands -- for a new player, that is empty, which no
+// password matches -- but a check asked for after this waits for it.
+// fnDone, if given, hears whether this set was applied.
+//
+static void ChangePasswordLater(dbref player, const UTF8 *szPassword,
+    std::function<void(bool)> fnDone)
+{
+    if (nullptr == password_hasher())
+    {
+        ChangePassword(player, szPassword);
+        if (fnDone)
+        {
+            fnDone(true);
+        }
+        return;
+    }
+
+    const int ticket = next_password_ticket();
+    s_pending_sets[player] = ticket;
+    std::string strPassword(reinterpret_cast<const char *>(szPassword));
+    password_work_start(player, [player, ticket, strPassword, fnDone]()
+    {
+        set_password_later(player, ticket, strPassword,
+            [player, fnDone](bool bApplied)
+            {
+                if (fnDone)
+                {
+                    fnDone(bApplied);
+                }
+                password_work_done(player);
+            });
+    });
+}
+
 #if defined(UNIX_DIGEST) && defined(HAVE_SHA_INIT)
 const UTF8 *p6h_xx_crypt(const UTF8 *szPassword)
 {
@@ -713,7 +1112,21 @@ const UTF8 *mux_crypt(const UTF8 *szPassword, const UTF8 *szSetting, int *piType
 
     case CRYPT_DES:
 #if defined(HAVE_CRYPT)
-        return reinterpret_cast<const UTF8 *>(crypt(reinterpret_cast<const char *>(szPassword), reinterpret_cast<const char *>(szSetting)));
+        {
+            // crypt(3) answers in static storage, and the password hasher
+            // calls this from its own thread.
+            //
+            static std::mutex mtxCrypt;
+            thread_local UTF8 buf[128];
+            std::lock_guard<std::mutex> lock(mtxCrypt);
+            const char *p = crypt(reinterpret_cast<const char *>(szPassword), reinterpret_cast<const char *>(szSetting));
+            if (nullptr == p)
+            {
+                return nullptr;
+            }
+            mux_strncpy(buf, reinterpret_cast<const UTF8 *>(p), sizeof(buf) - 1);
+            return buf;
+        }
 #else
         return szFail;
 #endif
@@ -853,22 +1266,71 @@ static bool check_pass(dbref player, const UTF8 *pPassword)
     return bValidPass;
 }
 
+// check_pass() with the hash on the worker, as a piece of password work for
+// player.  fnDone(bValidPass, bRehash) hears whether the password matched,
+// and if so, whether it should be stored again under the current policy.  It
+// did not match if A_PASS changed while the hash ran: the answer was for a
+// password that is no longer the player's.  Returns false without doing
+// anything if there is no worker.
+//
+static bool check_pass_later(dbref player, const std::string &strPassword,
+    std::function<void(bool, bool)> fnDone)
+{
+    if (nullptr == password_hasher())
+    {
+        return false;
+    }
+    if (  !Good_obj(player)
+       || !isPlayer(player))
+    {
+        fnDone(false, false);
+        return true;
+    }
+
+    int   aflags;
+    dbref aowner;
+    LBuf pTarget = LBuf_Adopt(atr_get("check_pass_later", player, A_PASS, &aowner, &aflags));
+    std::string strSetting(reinterpret_cast<const char *>(pTarget.get()));
+    std::vector<std::string> settings(1, strSetting);
+    password_hash_submit(next_password_ticket(),
+        reinterpret_cast<const UTF8 *>(strPassword.c_str()), std::move(settings),
+        [player, strSetting, fnDone](const PASSWORD_JOB &job)
+        {
+            bool bValidPass = false;
+            if (  !strSetting.empty()
+               && job.result == strSetting
+               && Good_obj(player)
+               && isPlayer(player))
+            {
+                int   aflags2;
+                dbref aowner2;
+                LBuf pNow = LBuf_Adopt(atr_get("check_pass_later.done", player, A_PASS, &aowner2, &aflags2));
+                bValidPass = (strSetting == reinterpret_cast<const char *>(pNow.get()));
+            }
+
+            fnDone(bValidPass,
+                   bValidPass
+                && password_needs_rehash(job.iType,
+                       reinterpret_cast<const UTF8 *>(strSetting.c_str())));
+        });
+    return true;
+}
+
 /* ---------------------------------------------------------------------------
  * connect_player: Try to connect to an existing player.
  */
 
-dbref connect_player(UTF8 *name, UTF8 *password, UTF8 *host, UTF8 *username, UTF8 *ipaddr)
+// The part of connecting that follows the password check: the login record,
+// and for a good password, salary and A_LAST.
+//
+static dbref connect_player_finish(dbref player, bool bValidPass,
+    const UTF8 *host, const UTF8 *username, const UTF8 *ipaddr)
 {
     CLinearTimeAbsolute ltaNow;
     ltaNow.GetLocal();
     const UTF8 *time_str = ltaNow.ReturnDateString(7);
 
-    dbref player = lookup_player(NOTHING, name, false);
-    if (player == NOTHING)
-    {
-        return NOTHING;
-    }
-    if (!check_pass(player, password))
+    if (!bValidPass)
     {
         record_login(player, false, time_str, host, username, ipaddr);
         return NOTHING;
@@ -895,6 +1357,153 @@ dbref connect_player(UTF8 *name, UTF8 *password, UTF8 *host, UTF8 *username, UTF
     return player;
 }
 
+dbref connect_player(UTF8 *name, UTF8 *password, UTF8 *host, UTF8 *username, UTF8 *ipaddr)
+{
+    dbref player = lookup_player(NOTHING, name, false);
+    if (player == NOTHING)
+    {
+        return NOTHING;
+    }
+    return connect_player_finish(player, check_pass(player, password),
+        host, username, ipaddr);
+}
+
+// Connects whose password hash is still running, or whose answer the driver
+// has not collected yet.
+//
+struct PENDING_CONNECT
+{
+    FTASK *fpDone;
+    void  *pContext;
+    bool   bDone;
+    dbref  player;
+};
+
+static std::unordered_map<int, PENDING_CONNECT> s_pending_connects;
+
+// connect_player() without waiting for the hash.  Returns true and a ticket
+// if the answer comes later: fpDone(pContext, ticket) is scheduled once it is
+// ready, and connect_player_end() collects it.  Returns false with the answer
+// in *pPlayer if it is known now.
+//
+bool connect_player_begin(const UTF8 *name, const UTF8 *password,
+    const UTF8 *host, const UTF8 *username, const UTF8 *ipaddr,
+    void (*fpDone)(void *, int), void *pContext, int *pTicket, dbref *pPlayer)
+{
+    dbref player = lookup_player(NOTHING, name, false);
+    if (NOTHING == player)
+    {
+        *pPlayer = NOTHING;
+        return false;
+    }
+
+    if (nullptr == password_hasher())
+    {
+        *pPlayer = connect_player_finish(player, check_pass(player, password),
+            host, username, ipaddr);
+        return false;
+    }
+
+    const int ticket = next_password_ticket();
+    s_pending_connects[ticket] = { fpDone, pContext, false, NOTHING };
+    *pTicket = ticket;
+
+    std::string strPassword(reinterpret_cast<const char *>(password));
+    std::string strHost(reinterpret_cast<const char *>(host));
+    std::string strUser(reinterpret_cast<const char *>(username));
+    std::string strIp(reinterpret_cast<const char *>(ipaddr));
+    password_work_start(player,
+        [player, ticket, strPassword, strHost, strUser, strIp]()
+        {
+            // A connect cancelled while it waited its turn is not checked.
+            //
+            if (s_pending_connects.end() == s_pending_connects.find(ticket))
+            {
+                password_work_done(player);
+                return;
+            }
+
+            auto fnChecked = [player, ticket, strPassword, strHost, strUser, strIp](bool bValidPass, bool bRehash)
+            {
+                // A cancelled connect still goes on the record if it failed,
+                // but one that succeeded never happened.
+                //
+                const auto it = s_pending_connects.find(ticket);
+                if (  s_pending_connects.end() != it
+                   || !bValidPass)
+                {
+                    dbref result = connect_player_finish(player, bValidPass,
+                        reinterpret_cast<const UTF8 *>(strHost.c_str()),
+                        reinterpret_cast<const UTF8 *>(strUser.c_str()),
+                        reinterpret_cast<const UTF8 *>(strIp.c_str()));
+                    if (s_pending_connects.end() != it)
+                    {
+                        it->second.bDone = true;
+                        it->second.player = result;
+                        scheduler.DeferImmediateTask(PRIORITY_SYSTEM, it->second.fpDone,
+                            it->second.pContext, ticket);
+                    }
+                }
+
+                if (bRehash)
+                {
+                    const int iSet = next_password_ticket();
+                    s_pending_sets[player] = iSet;
+                    set_password_later(player, iSet, strPassword,
+                        [player](bool bApplied)
+                        {
+                            UNUSED_PARAMETER(bApplied);
+                            password_work_done(player);
+                        });
+                }
+                else
+                {
+                    password_work_done(player);
+                }
+            };
+
+            // The worker went away while this waited.
+            //
+            if (!check_pass_later(player, strPassword, fnChecked))
+            {
+                fnChecked(check_pass(player,
+                    reinterpret_cast<const UTF8 *>(strPassword.c_str())), false);
+            }
+        });
+    return true;
+}
+
+// The answer to a connect_player_begin(), once its fpDone has been
+// scheduled.  Returns false if the ticket is unknown or not done yet.
+//
+bool connect_player_end(int ticket, dbref *pPlayer)
+{
+    const auto it = s_pending_connects.find(ticket);
+    if (  s_pending_connects.end() == it
+       || !it->second.bDone)
+    {
+        return false;
+    }
+    *pPlayer = it->second.player;
+    s_pending_connects.erase(it);
+    return true;
+}
+
+// The connection went away.  Its fpDone will not be called.
+//
+void connect_player_cancel(int ticket)
+{
+    const auto it = s_pending_connects.find(ticket);
+    if (s_pending_connects.end() != it)
+    {
+        if (it->second.bDone)
+        {
+            scheduler.CancelTask(it->second.fpDone, it->second.pContext, ticket);
+        }
+        s_pending_connects.erase(it);
+    }
+}
+
 void AddToPublicChannel(dbref player)
 {
     if (  mudconf.public_channel[0] != '\0'
@@ -981,6 +1590,7 @@ dbref create_player
     const UTF8 *password,
     dbref creator,
     bool isrobot,
+    bool bHashLater,
     const UTF8 **pmsg
 )
 {
@@ -1019,9 +1629,17 @@ dbref create_player
         return NOTHING;
     }
 
-    // Initialize everything.
+    // Initialize everything.  A player created with bHashLater has no
+    // password for the moment it takes the worker to hash it.
     //
-    ChangePassword(player, pbuf);
+    if (bHashLater)
+    {
+        ChangePasswordLater(player, pbuf, nullptr);
+    }
+    else
+    {
+        ChangePassword(player, pbuf);
+    }
     s_Home(player, start_home());
     pbuf.reset();
     if (mudconf.talk_mode_default)
@@ -1064,19 +1682,72 @@ void do_password
     UNUSED_PARAMETER(cargs);
     UNUSED_PARAMETER(ncargs);
 
+    const UTF8 *pmsg;
+
+    // Both hashes -- checking the old password and encoding the new one --
+    // run on the worker, after any password work already asked for this
+    // player; the answer comes when they are done.
+    //
+    const bool bNewOk = ok_password(newpass, &pmsg);
+    if (nullptr != password_hasher())
+    {
+        std::string strOld(reinterpret_cast<const char *>(oldpass));
+        std::string strNew(reinterpret_cast<const char *>(newpass));
+        password_work_start(executor, [executor, bNewOk, pmsg, strOld, strNew]()
+        {
+            auto fnChecked = [executor, bNewOk, pmsg, strNew](bool bValidPass, bool bRehash)
+            {
+                UNUSED_PARAMETER(bRehash);
+                if (!bValidPass)
+                {
+                    notify(executor, M_("Sorry."));
+                }
+                else if (bNewOk)
+                {
+                    const int ticket = next_password_ticket();
+                    s_pending_sets[executor] = ticket;
+                    set_password_later(executor, ticket, strNew,
+                        [executor](bool bApplied)
+                        {
+                            if (bApplied)
+                            {
+                                notify(executor, M_("Password changed."));
+                            }
+                            password_work_done(executor);
+                        });
+                    return;
+                }
+                else
+                {
+                    notify(executor, pmsg);
+                }
+                password_work_done(executor);
+            };
+
+            if (!check_pass_later(executor, strOld, fnChecked))
+            {
+                fnChecked(check_pass(executor,
+                    reinterpret_cast<const UTF8 *>(strOld.c_str())), false);
+            }
+        });
+        return;
+    }
+
     dbref aowner;
     int   aflags;
     LBuf target = LBuf_Adopt(atr_get("do_password.618", executor, A_PASS, &aowner, &aflags));
-    const UTF8 *pmsg;
-    if (  !*target
-       || !check_pass(executor, oldpass))
+    if (!*target)
+    {
+        notify(executor, M_("Sorry."));
+    }
+    else if (!check_pass(executor, oldpass))
     {
         notify(executor, M_("Sorry."));
     }
-    else if (ok_password(newpass, &pmsg))
+    else if (bNewOk)
     {
         ChangePassword(executor, newpass);
-        notify(executor,M_("Password changed."));
+        notify(executor, M_("Password changed."));
     }
     else
     {
@@ -127,11 +127,7 @@ bool could_doit(dbref player, dbref thing, int locknum)
         return true;
     }
 
-    dbref aowner;
-    int   aflags;
-    LBuf key = LBuf_Adopt(atr_get("could_doit.134", thing, locknum, &aowner, &aflags));
-    bool doit = eval_boolexp_atr(player, thing, thing, key);
-    return doit;
+    return eval_boolexp_lock(player, thing, thing, locknum);
 }
 
 bool can_see(dbref player, dbref thing, bool can_see_loc)
@@ -1667,6 +1663,8 @@ void do_restart(dbref executor, dbref caller, dbref enactor, int eval, int key)
 
     g_GanlAdapter.prepare_for_restart();
 
+    backup_abort();
+    password_hash_shutdown();
     local_presync_database();
     ServerEventsSinkNode *p = g_pServerEventsSinkListHead;
     while (nullptr != p)
@@ -1692,6 +1690,7 @@ void do_restart(dbref executor, dbref caller, dbref enactor, int eval, int key)
     // re-serialise descriptors the teardown has since closed.
 
     Log.StopLogging();
+    eventlog_close();
 
     // #2199: build argv, omitting any option whose value is empty.
     //
@@ -10,6 +10,7 @@
 #include "autoconf.h"
 #include "config.h"
 #include "externs.h"
+#include "eventlog.h"
 #include "routing.h"
 
 void set_modified(dbref thing)
@@ -256,6 +257,7 @@ void do_name
         log_text(T(" renamed to "));
         log_text(buff);
         ENDLOG;
+        LOG_EVENT(LOG_SECURITY, EVLOG_RENAME, 0, thing, NOTHING, buff, nullptr);
         if (Suspect(thing))
         {
             raw_broadcast(WIZARD, M_("[Suspect] %s renamed to %s"), Name(thing), buff);
@@ -343,6 +343,7 @@ static void wall_broadcast_callback(dbref connected_player, void *ctx)
 static void wall_broadcast(int target, dbref player, UTF8 *message)
 {
     wall_broadcast_context ctx = { target, player, message };
+    CBroadcastScope broadcast;
     for_each_connected_player(wall_broadcast_callback, &ctx);
 }
 
@@ -91,6 +91,18 @@ bool CSQLiteBackend::GetBuiltin(unsigned int object, AttrCallback cb)
         });
 }
 
+bool CSQLiteBackend::GetMulti(const unsigned int *objects, size_t nObjects,
+                              unsigned int attrnum, ObjAttrCallback cb)
+{
+    return m_db.GetAttributeMulti(reinterpret_cast<const dbref *>(objects),
+        nObjects, static_cast<int>(attrnum),
+        [&cb](dbref object, const UTF8 *value, size_t len, dbref owner, int flags)
+        {
+            cb(static_cast<unsigned int>(object), value, len,
+               static_cast<int>(owner), flags);
+        });
+}
+
 int CSQLiteBackend::Count(unsigned int object)
 {
     return m_db.CountAttributes(static_cast<dbref>(object));
@@ -12,10 +12,12 @@
 
 #include "sqlitedb.h"
 #include "engine_api.h"
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <ctime>
 #include <string>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 // Construction / Destruction
@@ -23,6 +25,11 @@
 
 CSQLiteDB::CSQLiteDB()
     : m_db(nullptr),
+      m_walFrames(0),
+      m_walCommits(0),
+      m_pageSize(4096),
+      m_pGate(nullptr),
+      m_pbCancel(nullptr),
       m_stmtObjInsert(nullptr),
       m_stmtObjDelete(nullptr),
       m_stmtObjLoad(nullptr),
@@ -45,6 +52,7 @@ CSQLiteDB::CSQLiteDB()
       m_stmtAttrDelObj(nullptr),
       m_stmtAttrGetObj(nullptr),
       m_stmtAttrGetBuiltin(nullptr),
+      m_stmtAttrGetMulti(nullptr),
       m_stmtAttrCount(nullptr),
       m_stmtAttrNamePut(nullptr),
       m_stmtAttrNameDel(nullptr),
@@ -166,11 +174,11 @@ bool CSQLiteDB::ConfigurePragmas()
         "PRAGMA cache_size=-65536",
         "PRAGMA foreign_keys=ON",
 
-        // Disable automatic WAL checkpointing.  The WAL accumulates
-        // writes without fsync during normal operation; explicit
-        // checkpoint at @dump and shutdown handles persistence.
-        // This eliminates the fsync bottleneck from code cache writes
-        // while maintaining database structural integrity.
+        // Disable automatic WAL checkpointing.  SQLite would otherwise
+        // checkpoint inline on whichever connection happens to commit,
+        // stalling the game thread.  The server schedules its own
+        // checkpoints from WalHook() below (see attrcache.cpp), and does a
+        // full one at @dump and shutdown.
         "PRAGMA wal_autocheckpoint=0",
         nullptr
     };
@@ -187,9 +195,169 @@ bool CSQLiteDB::ConfigurePragmas()
             return false;
         }
     }
+
+    // An existing database keeps the page size it was created with.
+    //
+    sqlite3_stmt *stmt = nullptr;
+    if (SQLITE_OK == sqlite3_prepare_v2(m_db, "PRAGMA page_size", -1, &stmt, nullptr))
+    {
+        if (SQLITE_ROW == sqlite3_step(stmt))
+        {
+            m_pageSize = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    // Must follow wal_autocheckpoint, which replaces any WAL hook.
+    //
+    m_walFrames.store(0, std::memory_order_relaxed);
+    sqlite3_wal_hook(m_db, WalHook, this);
+
+    // Must follow busy_timeout, which the busy handler replaces.
+    //
+    if (nullptr != m_pGate)
+    {
+        sqlite3_busy_handler(m_db, BusyHandler, this);
+    }
     return true;
 }
 
+int CSQLiteDB::WalHook(void *pArg, sqlite3 *, const char *, int nFrames)
+{
+    CSQLiteDB *pThis = static_cast<CSQLiteDB *>(pArg);
+    pThis->m_walFrames.store(nFrames, std::memory_order_relaxed);
+    pThis->m_walCommits.fetch_add(1, std::memory_order_relaxed);
+    if (nullptr != pThis->m_pGate)
+    {
+        pThis->m_pGate->Done();
+    }
+    return SQLITE_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Write lock arbitration
+// ---------------------------------------------------------------------------
+
+// Matches PRAGMA busy_timeout above.
+//
+static const int BUSY_TIMEOUT_MS = 5000;
+
+// The foreground retries its statement as soon as the writer leaves, so a
+// claim still standing after this long belongs to a statement that wrote
+// nothing (and so never reached the WAL hook) or gave up.
+//
+static const std::chrono::milliseconds WRITE_GATE_GRACE(10);
+
+void CSQLiteWriteGate::Enter()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait_until(lock, m_tClaim + WRITE_GATE_GRACE, [this]
+    {
+        return !m_bClaim.load(std::memory_order_relaxed);
+    });
+    m_bClaim.store(false, std::memory_order_release);
+    m_bHeld = true;
+}
+
+void CSQLiteWriteGate::Leave()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bHeld = false;
+    }
+    m_cv.notify_one();
+}
+
+bool CSQLiteWriteGate::WaitForWriter(std::chrono::milliseconds tMax)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_bHeld)
+    {
+        return false;
+    }
+    m_tClaim = std::chrono::steady_clock::now();
+    m_bClaim.store(true, std::memory_order_release);
+    return m_cv.wait_for(lock, tMax, [this]
+    {
+        return !m_bHeld;
+    });
+}
+
+void CSQLiteWriteGate::Done()
+{
+    if (!m_bClaim.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bClaim.store(false, std::memory_order_release);
+    }
+    m_cv.notify_one();
+}
+
+void CSQLiteDB::SetWriteGate(CSQLiteWriteGate *pGate)
+{
+    m_pGate = pGate;
+    if (nullptr == m_db)
+    {
+        return;
+    }
+    if (nullptr != pGate)
+    {
+        sqlite3_busy_handler(m_db, BusyHandler, this);
+    }
+    else
+    {
+        sqlite3_busy_timeout(m_db, BUSY_TIMEOUT_MS);
+    }
+}
+
+// Stands in for busy_timeout while a write gate is attached or a checkpoint
+// may be cancelled.  If it is the gate's writer that holds the lock, ask it
+// to commit and wait for it to go; anything else (a checkpoint, a backup,
+// another process) is waited out with busy_timeout's own back-off.  Either
+// way, within the same overall limit.
+//
+int CSQLiteDB::BusyHandler(void *pArg, int nCalls)
+{
+    CSQLiteDB *pThis = static_cast<CSQLiteDB *>(pArg);
+    const auto tNow = std::chrono::steady_clock::now();
+    if (0 == nCalls)
+    {
+        pThis->m_tBusyStart = tNow;
+    }
+    const auto tLeft = std::chrono::milliseconds(BUSY_TIMEOUT_MS)
+        - std::chrono::duration_cast<std::chrono::milliseconds>(tNow - pThis->m_tBusyStart);
+    if (  tLeft <= std::chrono::milliseconds::zero()
+       || (  nullptr != pThis->m_pbCancel
+          && pThis->m_pbCancel->load(std::memory_order_acquire)))
+    {
+        return 0;
+    }
+
+    if (  nullptr != pThis->m_pGate
+       && pThis->m_pGate->WaitForWriter(tLeft))
+    {
+        return 1;
+    }
+
+    static const int aDelays[] = { 1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100 };
+    const int nDelays = static_cast<int>(sizeof(aDelays) / sizeof(aDelays[0]));
+    int ms = aDelays[(nCalls < nDelays) ? nCalls : nDelays - 1];
+    if (tLeft.count() < ms)
+    {
+        ms = static_cast<int>(tLeft.count());
+    }
+    if (  nullptr != pThis->m_pbCancel
+       && 10 < ms)
+    {
+        ms = 10;
+    }
+    sqlite3_sleep(ms);
+    return 1;
+}
+
 bool CSQLiteDB::CreateSchema()
 {
     const char *schema =
@@ -919,6 +1087,23 @@ bool CSQLiteDB::PrepareStatements()
         return false;
     }
 
+    // ATTR_GET_MULTI_MAX object placeholders.  GetAttributeMulti pads a
+    // short list by repeating its first object, which IN ignores.
+    //
+    {
+        std::string sql("SELECT object, value, owner, flags FROM attributes"
+                        " WHERE attrnum=? AND object IN (?");
+        for (size_t i = 1; i < ATTR_GET_MULTI_MAX; i++)
+        {
+            sql += ",?";
+        }
+        sql += ")";
+        if (!Prepare(m_db, sql.c_str(), &m_stmtAttrGetMulti))
+        {
+            return false;
+        }
+    }
+
     if (!Prepare(m_db,
         "SELECT COUNT(*) FROM attributes WHERE object=?",
         &m_stmtAttrCount))
@@ -1196,6 +1381,7 @@ void CSQLiteDB::FinalizeStatements()
     Finalize(&m_stmtAttrDelObj);
     Finalize(&m_stmtAttrGetObj);
     Finalize(&m_stmtAttrGetBuiltin);
+    Finalize(&m_stmtAttrGetMulti);
     Finalize(&m_stmtAttrCount);
     Finalize(&m_stmtAttrNamePut);
     Finalize(&m_stmtAttrNameDel);
@@ -1479,8 +1665,13 @@ bool CSQLiteDB::PutAttribute(dbref obj, int attrnum, const UTF8 *value, size_t l
     // monotonicity even if the SQLite row has a higher value.
     // attr_mod_count_inc() in atr_add_raw_LEN runs AFTER this
     // call succeeds, so we pre-compute the next value here.
-    uint32_t mc = attr_mod_count_get(obj, attrnum) + 1;
+    return PutAttribute(obj, attrnum, value, len, owner, flags,
+        attr_mod_count_get(obj, attrnum) + 1);
+}
 
+bool CSQLiteDB::PutAttribute(dbref obj, int attrnum, const UTF8 *value, size_t len,
+                             dbref owner, int flags, uint32_t mc)
+{
     sqlite3_bind_int(m_stmtAttrPut, 1, obj);
     sqlite3_bind_int(m_stmtAttrPut, 2, attrnum);
     sqlite3_bind_blob(m_stmtAttrPut, 3, value, static_cast<int>(len), SQLITE_STATIC);
@@ -1730,6 +1921,62 @@ bool CSQLiteDB::GetBuiltinAttributes(dbref obj, AttrCallback cb)
     return true;
 }
 
+bool CSQLiteDB::GetAttributeMulti(const dbref *objs, size_t nObjs, int attrnum,
+                                  ObjAttrCallback cb)
+{
+    for (size_t iBase = 0; iBase < nObjs; iBase += ATTR_GET_MULTI_MAX)
+    {
+        const size_t nChunk = (nObjs - iBase < ATTR_GET_MULTI_MAX)
+                            ? nObjs - iBase : ATTR_GET_MULTI_MAX;
+
+        sqlite3_bind_int(m_stmtAttrGetMulti, 1, attrnum);
+        for (size_t i = 0; i < ATTR_GET_MULTI_MAX; i++)
+        {
+            const dbref obj = (i < nChunk) ? objs[iBase + i] : objs[iBase];
+            sqlite3_bind_int(m_stmtAttrGetMulti, static_cast<int>(i) + 2, obj);
+        }
+
+        int rc = SQLITE_DONE;
+        for (;;)
+        {
+            rc = sqlite3_step(m_stmtAttrGetMulti);
+            if (SQLITE_ROW != rc)
+            {
+                break;
+            }
+
+            dbref obj = static_cast<dbref>(sqlite3_column_int(m_stmtAttrGetMulti, 0));
+            const UTF8 *value = static_cast<const UTF8 *>(sqlite3_column_blob(m_stmtAttrGetMulti, 1));
+            size_t len = static_cast<size_t>(sqlite3_column_bytes(m_stmtAttrGetMulti, 1));
+            dbref owner = static_cast<dbref>(sqlite3_column_int(m_stmtAttrGetMulti, 2));
+            int flags = sqlite3_column_int(m_stmtAttrGetMulti, 3);
+
+            // Same clamp and OOM guard as GetAllAttributes.
+            //
+            if (len > LBUF_SIZE)
+            {
+                len = LBUF_SIZE;
+            }
+            if (NULL == value && 0 != len)
+            {
+                continue;
+            }
+
+            cb(obj, value, len, owner, flags);
+        }
+
+        sqlite3_reset(m_stmtAttrGetMulti);
+        if (SQLITE_DONE != rc)
+        {
+            fprintf(stderr, "CSQLiteDB::GetAttributeMulti(#%d/%d): %s\n",
+                objs[iBase], attrnum, sqlite3_errmsg(m_db));
+            return false;
+        }
+        m_stats.attr_multi_gets++;
+    }
+    return true;
+}
+
 // ---------------------------------------------------------------------------
 // Attribute name registry
 // ---------------------------------------------------------------------------
@@ -1844,7 +2091,7 @@ bool CSQLiteDB::GetMeta(const char *key, int *value)
 
 bool CSQLiteDB::Begin()
 {
-    return SQLITE_OK == sqlite3_exec(m_db, "BEGIN", nullptr, nullptr, nullptr);
+    return SQLITE_OK == sqlite3_exec(m_db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr);
 }
 
 bool CSQLiteDB::Commit()
@@ -1857,6 +2104,12 @@ bool CSQLiteDB::Rollback()
     return SQLITE_OK == sqlite3_exec(m_db, "ROLLBACK", nullptr, nullptr, nullptr);
 }
 
+bool CSQLiteDB::InTransaction() const
+{
+    return nullptr != m_db
+        && 0 == sqlite3_get_autocommit(m_db);
+}
+
 // ---------------------------------------------------------------------------
 // Search queries
 // ---------------------------------------------------------------------------
@@ -2248,12 +2501,38 @@ bool CSQLiteDB::SearchByFlags(FLAG f1, FLAG f2, FLAG f3,
 // Maintenance
 // ---------------------------------------------------------------------------
 
+// Sources with a CSQLiteBackup in progress.  Its read transaction pins the
+// WAL, so a TRUNCATE or RESTART checkpoint could only wait it out, holding
+// off every writer while it did.
+//
+static std::mutex s_backupMutex;
+static std::vector<std::string> s_backupSources;
+
+static bool backup_in_progress(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(s_backupMutex);
+    return std::find(s_backupSources.begin(), s_backupSources.end(), path)
+        != s_backupSources.end();
+}
+
 bool CSQLiteDB::Checkpoint()
 {
+    if (backup_in_progress(m_path))
+    {
+        const int rc = sqlite3_wal_checkpoint_v2(m_db, nullptr,
+            SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+        if (SQLITE_OK != rc)
+        {
+            fprintf(stderr, "CSQLiteDB::Checkpoint: %s\n", sqlite3_errmsg(m_db));
+        }
+        return SQLITE_OK == rc;
+    }
+
     // sqlite3_wal_checkpoint_v2() returns SQLITE_BUSY immediately if a reader
     // (e.g. another connection under dbconvert -m) holds the WAL. Without a
-    // retry @dump would report success while the WAL keeps growing. The engine
-    // is single-threaded so contention is rare; a few short backoffs clear it.
+    // retry @dump would report success while the WAL keeps growing. The
+    // engine's own background checkpoints are held off meanwhile (see
+    // cache_sync), so contention is rare; a few short backoffs clear it.
     const int kMaxAttempts = 5;
     int rc = SQLITE_OK;
     for (int attempt = 0; attempt < kMaxAttempts; ++attempt)
@@ -2276,11 +2555,216 @@ bool CSQLiteDB::Checkpoint()
     return SQLITE_OK == rc;
 }
 
+int CSQLiteDB::CheckpointStep(int eMode, int *pnLog, int *pnCkpt,
+    const std::atomic<bool> *pbCancel)
+{
+    if (  SQLITE_CHECKPOINT_PASSIVE != eMode
+       && backup_in_progress(m_path))
+    {
+        return SQLITE_BUSY;
+    }
+    if (nullptr == pbCancel)
+    {
+        return sqlite3_wal_checkpoint_v2(m_db, nullptr, eMode, pnLog, pnCkpt);
+    }
+
+    m_pbCancel = pbCancel;
+    sqlite3_busy_handler(m_db, BusyHandler, this);
+    const int rc = sqlite3_wal_checkpoint_v2(m_db, nullptr, eMode, pnLog, pnCkpt);
+    m_pbCancel = nullptr;
+    SetWriteGate(m_pGate);
+    return rc;
+}
+
 bool CSQLiteDB::Optimize()
 {
     return SQLITE_OK == sqlite3_exec(m_db, "PRAGMA optimize", nullptr, nullptr, nullptr);
 }
 
+// ---------------------------------------------------------------------------
+// Online backup
+// ---------------------------------------------------------------------------
+
+CSQLiteBackup::CSQLiteBackup()
+    : m_src(nullptr),
+      m_dest(nullptr),
+      m_backup(nullptr)
+{
+}
+
+CSQLiteBackup::~CSQLiteBackup()
+{
+    Finish();
+}
+
+bool CSQLiteBackup::Begin(const char *pSource, const char *pDest)
+{
+    if (  nullptr != m_src
+       || nullptr != m_dest)
+    {
+        m_error = "backup already begun";
+        return false;
+    }
+
+    int rc = sqlite3_open_v2(pSource, &m_src, SQLITE_OPEN_READONLY, nullptr);
+    if (SQLITE_OK == rc)
+    {
+        sqlite3_busy_timeout(m_src, 5000);
+
+        // BEGIN alone takes no snapshot; the first read does.
+        //
+        rc = sqlite3_exec(m_src,
+            "BEGIN; SELECT count(*) FROM sqlite_master;",
+            nullptr, nullptr, nullptr);
+    }
+    if (SQLITE_OK != rc)
+    {
+        m_error = m_src ? sqlite3_errmsg(m_src) : sqlite3_errstr(rc);
+        Finish();
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(s_backupMutex);
+        m_source.assign(pSource);
+        s_backupSources.push_back(m_source);
+    }
+
+    rc = sqlite3_open_v2(pDest, &m_dest,
+        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if (SQLITE_OK != rc)
+    {
+        m_error = m_dest ? sqlite3_errmsg(m_dest) : sqlite3_errstr(rc);
+        Finish();
+        return false;
+    }
+
+    m_backup = sqlite3_backup_init(m_dest, "main", m_src, "main");
+    if (nullptr == m_backup)
+    {
+        m_error = sqlite3_errmsg(m_dest);
+        Finish();
+        return false;
+    }
+    return true;
+}
+
+int CSQLiteBackup::Step(int nPages)
+{
+    if (nullptr == m_backup)
+    {
+        return SQLITE_MISUSE;
+    }
+    const int rc = sqlite3_backup_step(m_backup, nPages);
+    if (  SQLITE_OK != rc
+       && SQLITE_DONE != rc
+       && SQLITE_BUSY != rc
+       && SQLITE_LOCKED != rc)
+    {
+        m_error = sqlite3_errstr(rc);
+    }
+    return (SQLITE_BUSY == rc || SQLITE_LOCKED == rc) ? SQLITE_OK : rc;
+}
+
+int CSQLiteBackup::Remaining() const
+{
+    return m_backup ? sqlite3_backup_remaining(m_backup) : 0;
+}
+
+int CSQLiteBackup::PageCount() const
+{
+    return m_backup ? sqlite3_backup_pagecount(m_backup) : 0;
+}
+
+bool CSQLiteBackup::Finish()
+{
+    bool bOk = true;
+    if (nullptr != m_backup)
+    {
+        const int rc = sqlite3_backup_finish(m_backup);
+        m_backup = nullptr;
+        if (SQLITE_OK != rc)
+        {
+            m_error = sqlite3_errmsg(m_dest);
+            bOk = false;
+        }
+    }
+    if (nullptr != m_dest)
+    {
+        sqlite3_close(m_dest);
+        m_dest = nullptr;
+    }
+    if (nullptr != m_src)
+    {
+        sqlite3_exec(m_src, "COMMIT", nullptr, nullptr, nullptr);
+        sqlite3_close(m_src);
+        m_src = nullptr;
+    }
+    if (!m_source.empty())
+    {
+        std::lock_guard<std::mutex> lock(s_backupMutex);
+        auto it = std::find(s_backupSources.begin(), s_backupSources.end(), m_source);
+        if (it != s_backupSources.end())
+        {
+            s_backupSources.erase(it);
+        }
+        m_source.clear();
+    }
+    return bOk;
+}
+
+static int verify_progress(void *pArg)
+{
+    return static_cast<const std::atomic<bool> *>(pArg)->load(std::memory_order_acquire) ? 1 : 0;
+}
+
+std::string CSQLiteBackup::Verify(const char *pPath, const std::atomic<bool> *pbCancel)
+{
+    sqlite3 *db = nullptr;
+    int rc = sqlite3_open_v2(pPath, &db, SQLITE_OPEN_READWRITE, nullptr);
+    if (SQLITE_OK != rc)
+    {
+        std::string msg = db ? sqlite3_errmsg(db) : sqlite3_errstr(rc);
+        sqlite3_close(db);
+        return msg;
+    }
+    if (nullptr != pbCancel)
+    {
+        sqlite3_progress_handler(db, 1000, verify_progress,
+            const_cast<std::atomic<bool> *>(pbCancel));
+    }
+
+    std::string msg;
+    sqlite3_stmt *stmt = nullptr;
+    rc = sqlite3_prepare_v2(db, "PRAGMA quick_check", -1, &stmt, nullptr);
+    if (SQLITE_OK == rc)
+    {
+        // A sound database yields the single row "ok".
+        //
+        while (SQLITE_ROW == (rc = sqlite3_step(stmt)))
+        {
+            const char *row = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+            if (  nullptr == row
+               || 0 != strcmp(row, "ok"))
+            {
+                msg = row ? row : "quick_check failed";
+                break;
+            }
+        }
+        if (  msg.empty()
+           && SQLITE_DONE != rc)
+        {
+            msg = sqlite3_errmsg(db);
+        }
+        sqlite3_finalize(stmt);
+    }
+    else
+    {
+        msg = sqlite3_errmsg(db);
+    }
+    sqlite3_close(db);
+    return msg;
+}
+
 // ---------------------------------------------------------------------------
 // Comsys bulk operations
 // ---------------------------------------------------------------------------
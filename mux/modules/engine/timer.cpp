@@ -352,14 +352,419 @@ void do_timewarp(dbref executor, dbref caller, dbref enactor, int eval, int key,
 }
 
 
+CTaskWheel::CTaskWheel(void)
+{
+    for (int i = 0; i < WHEEL_LEVELS; i++)
+    {
+        for (int j = 0; j < WHEEL_SIZE; j++)
+        {
+            m_Buckets[i][j] = nullptr;
+        }
+        for (int j = 0; j < WHEEL_SIZE/64; j++)
+        {
+            m_Occupied[i][j] = 0;
+        }
+    }
+    m_slotCurrent = 0;
+    m_nWheel = 0;
+}
+
+uint64_t CTaskWheel::Slot(const CLinearTimeAbsolute &lta)
+{
+    const int64_t t = lta.Return100ns();
+    if (t <= 0)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(t) >> WHEEL_SHIFT;
+}
+
+void CTaskWheel::Place(PTASK_RECORD pTask)
+{
+    const uint64_t slot = Slot(pTask->ltaWhen);
+    if (slot <= m_slotCurrent)
+    {
+        pTask->m_iWheelSlot = -1;
+        m_Due.Insert(pTask);
+        return;
+    }
+
+    int iLevel = 0;
+    uint64_t diff = slot ^ m_slotCurrent;
+    while (diff >> WHEEL_BITS)
+    {
+        diff >>= WHEEL_BITS;
+        iLevel++;
+    }
+    const int iBucket = static_cast<int>((slot >> (WHEEL_BITS*iLevel)) & (WHEEL_SIZE - 1));
+
+    PTASK_RECORD &pHead = m_Buckets[iLevel][iBucket];
+    pTask->m_pWheelPrev = nullptr;
+    pTask->m_pWheelNext = pHead;
+    if (pHead)
+    {
+        pHead->m_pWheelPrev = pTask;
+    }
+    pHead = pTask;
+    m_Occupied[iLevel][iBucket/64] |= UINT64_C(1) << (iBucket % 64);
+    pTask->m_iWheelSlot = iLevel*WHEEL_SIZE + iBucket;
+    m_nWheel++;
+}
+
+void CTaskWheel::Unlink(PTASK_RECORD pTask)
+{
+    const int iLevel  = pTask->m_iWheelSlot / WHEEL_SIZE;
+    const int iBucket = pTask->m_iWheelSlot % WHEEL_SIZE;
+    if (pTask->m_pWheelPrev)
+    {
+        pTask->m_pWheelPrev->m_pWheelNext = pTask->m_pWheelNext;
+    }
+    else
+    {
+        m_Buckets[iLevel][iBucket] = pTask->m_pWheelNext;
+        if (nullptr == pTask->m_pWheelNext)
+        {
+            m_Occupied[iLevel][iBucket/64] &= ~(UINT64_C(1) << (iBucket % 64));
+        }
+    }
+    if (pTask->m_pWheelNext)
+    {
+        pTask->m_pWheelNext->m_pWheelPrev = pTask->m_pWheelPrev;
+    }
+    pTask->m_iWheelSlot = -1;
+    m_nWheel--;
+}
+
+// Take a whole bucket off the wheel.  The tasks stay chained through
+// m_pWheelNext, but no longer count as being in the wheel.
+//
+PTASK_RECORD CTaskWheel::Detach(int iLevel, int iBucket)
+{
+    PTASK_RECORD pList = m_Buckets[iLevel][iBucket];
+    m_Buckets[iLevel][iBucket] = nullptr;
+    m_Occupied[iLevel][iBucket/64] &= ~(UINT64_C(1) << (iBucket % 64));
+    for (PTASK_RECORD p = pList; p; p = p->m_pWheelNext)
+    {
+        p->m_iWheelSlot = -1;
+        m_nWheel--;
+    }
+    return pList;
+}
+
+// Every bucket at a level lies after the current slot, and every task at
+// one level is due before any task at the next, so the earliest bucket is
+// the lowest occupied one at the lowest occupied level.
+//
+bool CTaskWheel::FindEarliest(int &iLevel, int &iBucket) const
+{
+    if (0 == m_nWheel)
+    {
+        return false;
+    }
+    for (int i = 0; i < WHEEL_LEVELS; i++)
+    {
+        for (int j = 0; j < WHEEL_SIZE/64; j++)
+        {
+            uint64_t bits = m_Occupied[i][j];
+            if (bits)
+            {
+                int k = 0;
+                while (0 == (bits & 1))
+                {
+                    bits >>= 1;
+                    k++;
+                }
+                iLevel  = i;
+                iBucket = 64*j + k;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint64_t CTaskWheel::BucketStart(int iLevel, int iBucket) const
+{
+    const int shift = WHEEL_BITS*iLevel;
+    const uint64_t mask = (UINT64_C(1) << (shift + WHEEL_BITS)) - 1;
+    return (m_slotCurrent & ~mask) | (static_cast<uint64_t>(iBucket) << shift);
+}
+
+// Advance to the start of the earliest bucket and spread its tasks over
+// the due heap and the levels below.
+//
+bool CTaskWheel::CascadeEarliest(void)
+{
+    int iLevel, iBucket;
+    if (!FindEarliest(iLevel, iBucket))
+    {
+        return false;
+    }
+    m_slotCurrent = BucketStart(iLevel, iBucket);
+    PTASK_RECORD p = Detach(iLevel, iBucket);
+    while (p)
+    {
+        PTASK_RECORD pNext = p->m_pWheelNext;
+        Place(p);
+        p = pNext;
+    }
+    return true;
+}
+
+bool CTaskWheel::Insert(PTASK_RECORD pTask)
+{
+    Place(pTask);
+    return true;
+}
+
+bool CTaskWheel::Contains(PTASK_RECORD pTask) const
+{
+    return  0 <= pTask->m_iWheelSlot
+         || m_Due.Contains(pTask);
+}
+
+void CTaskWheel::Remove(PTASK_RECORD pTask)
+{
+    if (0 <= pTask->m_iWheelSlot)
+    {
+        Unlink(pTask);
+    }
+    else
+    {
+        m_Due.Remove(pTask);
+    }
+}
+
+void CTaskWheel::Update(PTASK_RECORD pTask)
+{
+    Remove(pTask);
+    Place(pTask);
+}
+
+int CTaskWheel::CountInPriorityRange(int iLo, int iHi) const
+{
+    int n = m_Due.CountInPriorityRange(iLo, iHi);
+    for (int i = 0; i < WHEEL_LEVELS && 0 != m_nWheel; i++)
+    {
+        for (int j = 0; j < WHEEL_SIZE; j++)
+        {
+            for (PTASK_RECORD p = m_Buckets[i][j]; p; p = p->m_pWheelNext)
+            {
+                if (  nullptr != p->fpTask
+                   && iLo < p->iPriority
+                   && p->iPriority < iHi)
+                {
+                    n++;
+                }
+            }
+        }
+    }
+    return n;
+}
+
+PTASK_RECORD CTaskWheel::PeekAtTopmost(void)
+{
+    while (  m_Due.empty()
+          && CascadeEarliest())
+    {
+        ; // Nothing.
+    }
+    return m_Due.PeekAtTopmost();
+}
+
+PTASK_RECORD CTaskWheel::RemoveTopmost(void)
+{
+    if (nullptr == PeekAtTopmost())
+    {
+        return nullptr;
+    }
+    return m_Due.RemoveTopmost();
+}
+
+// Collect every task due before ltaNow.
+//
+void CTaskWheel::Expire(const CLinearTimeAbsolute &ltaNow, std::vector<PTASK_RECORD> &ready)
+{
+    const uint64_t slotNow = Slot(ltaNow);
+    int iLevel, iBucket;
+    while (FindEarliest(iLevel, iBucket))
+    {
+        const uint64_t slotStart = BucketStart(iLevel, iBucket);
+        if (slotNow < slotStart)
+        {
+            break;
+        }
+
+        const uint64_t nSlots = UINT64_C(1) << (WHEEL_BITS*iLevel);
+        if (slotStart + nSlots <= slotNow)
+        {
+            // The whole bucket lies before the current slot, so all of it
+            // is due.  The order in which tasks reach the PriorityHeap
+            // does not matter.
+            //
+            m_slotCurrent = slotStart;
+            for (PTASK_RECORD p = Detach(iLevel, iBucket); p; p = p->m_pWheelNext)
+            {
+                ready.push_back(p);
+            }
+        }
+        else
+        {
+            CascadeEarliest();
+        }
+    }
+
+    PTASK_RECORD p = m_Due.PeekAtTopmost();
+    while (  p
+          && p->ltaWhen < ltaNow)
+    {
+        ready.push_back(m_Due.RemoveTopmost());
+        p = m_Due.PeekAtTopmost();
+    }
+}
+
+void CTaskWheel::Snapshot(std::vector<PTASK_RECORD> &v) const
+{
+    m_Due.Snapshot(v);
+    if (0 == m_nWheel)
+    {
+        return;
+    }
+    for (int i = 0; i < WHEEL_LEVELS; i++)
+    {
+        for (int j = 0; j < WHEEL_SIZE; j++)
+        {
+            for (PTASK_RECORD p = m_Buckets[i][j]; p; p = p->m_pWheelNext)
+            {
+                v.push_back(p);
+            }
+        }
+    }
+}
+
+void CTaskWheel::SnapshotOrdered(std::vector<PTASK_RECORD> &v) const
+{
+    const size_t iFirst = v.size();
+    Snapshot(v);
+    const CompareWhenGreater cmp;
+    std::sort(v.begin() + iFirst, v.end(),
+        [&cmp](PTASK_RECORD a, PTASK_RECORD b) { return cmp(b, a); });
+}
+
+PTASK_RECORD CScheduler::AllocTask(void)
+{
+    if (nullptr == m_pFreeTasks)
+    {
+        const int nBlock = 256;
+        std::unique_ptr<TASK_RECORD[]> block(new (std::nothrow) TASK_RECORD[nBlock]);
+        if (!block)
+        {
+            return nullptr;
+        }
+        for (int i = 0; i < nBlock; i++)
+        {
+            block[i].m_pWheelNext = m_pFreeTasks;
+            m_pFreeTasks = &block[i];
+        }
+        try
+        {
+            m_TaskBlocks.push_back(std::move(block));
+        }
+        catch (...)
+        {
+            m_pFreeTasks = nullptr;
+            return nullptr;
+        }
+    }
+    PTASK_RECORD pTask = m_pFreeTasks;
+    m_pFreeTasks = pTask->m_pWheelNext;
+    *pTask = TASK_RECORD();
+    pTask->m_iWheelSlot = -1;
+    return pTask;
+}
+
+void CScheduler::FreeTask(PTASK_RECORD pTask)
+{
+    pTask->fpTask = nullptr;
+    pTask->m_pWheelNext = m_pFreeTasks;
+    m_pFreeTasks = pTask;
+}
+
+bool CScheduler::Schedule(PTASK_RECORD pTask)
+{
+    pTask->m_Ticket = m_Ticket++;
+
+    // Must add to the WhenWheel so that network is still serviced.
+    //
+    if (!m_WhenWheel.Insert(pTask))
+    {
+        return false;
+    }
+
+    m_TaskByTicket[pTask->m_Ticket] = pTask;
+    m_TasksByArg.Add(pTask->arg_voidptr, pTask);
+    if (NOTHING != pTask->m_dbObject)
+    {
+        m_TasksByObject.Add(pTask->m_dbObject, pTask);
+    }
+    if (NOTHING != pTask->m_dbWaitOn)
+    {
+        m_TasksBySemaphore.Add(pTask->m_dbWaitOn, pTask);
+    }
+    return true;
+}
+
+// Drop a task from the indexes once it has left both heaps.
+//
+void CScheduler::Unindex(PTASK_RECORD pTask)
+{
+    m_TaskByTicket.erase(pTask->m_Ticket);
+    m_TasksByArg.Remove(pTask->arg_voidptr, pTask);
+    if (NOTHING != pTask->m_dbObject)
+    {
+        m_TasksByObject.Remove(pTask->m_dbObject, pTask);
+    }
+    if (NOTHING != pTask->m_dbWaitOn)
+    {
+        m_TasksBySemaphore.Remove(pTask->m_dbWaitOn, pTask);
+    }
+}
+
+void CScheduler::Remove(PTASK_RECORD pTask)
+{
+    if (m_WhenWheel.Contains(pTask))
+    {
+        m_WhenWheel.Remove(pTask);
+    }
+    else
+    {
+        m_PriorityHeap.Remove(pTask);
+    }
+    Unindex(pTask);
+    FreeTask(pTask);
+}
+
+void CScheduler::Update(PTASK_RECORD pTask)
+{
+    if (m_WhenWheel.Contains(pTask))
+    {
+        m_WhenWheel.Update(pTask);
+    }
+    else
+    {
+        m_PriorityHeap.Update(pTask);
+    }
+}
+
 bool CScheduler::DeferTask(const CLinearTimeAbsolute& ltaWhen, int iPriority,
-                           FTASK *fpTask, void *arg_voidptr, int arg_Integer)
+                           FTASK *fpTask, void *arg_voidptr, int arg_Integer,
+                           dbref dbObject, dbref dbWaitOn)
 {
     // #1871: nothrow so OOM is a clean false rather than an exception; the
     // previous void path treated both OOM and Insert failure as silent success
     // at wait_que, leaking the BQUE and queue accounting.
     //
-    PTASK_RECORD pTask = new (std::nothrow) TASK_RECORD;
+    PTASK_RECORD pTask = AllocTask();
     if (!pTask)
     {
         return false;
@@ -370,21 +775,21 @@ bool CScheduler::DeferTask(const CLinearTimeAbsolute& ltaWhen, int iPriority,
     pTask->fpTask = fpTask;
     pTask->arg_voidptr = arg_voidptr;
     pTask->arg_Integer = arg_Integer;
-    pTask->m_Ticket = m_Ticket++;
+    pTask->m_dbObject = dbObject;
+    pTask->m_dbWaitOn = dbWaitOn;
 
-    // Must add to the WhenHeap so that network is still serviced.
-    //
-    if (!m_WhenHeap.Insert(pTask))
+    if (!Schedule(pTask))
     {
-        delete pTask;
+        FreeTask(pTask);
         return false;
     }
     return true;
 }
 
-bool CScheduler::DeferImmediateTask(int iPriority, FTASK *fpTask, void *arg_voidptr, int arg_Integer)
+bool CScheduler::DeferImmediateTask(int iPriority, FTASK *fpTask, void *arg_voidptr, int arg_Integer,
+                                    dbref dbObject)
 {
-    PTASK_RECORD pTask = new (std::nothrow) TASK_RECORD;
+    PTASK_RECORD pTask = AllocTask();
     if (!pTask)
     {
         return false;
@@ -395,13 +800,12 @@ bool CScheduler::DeferImmediateTask(int iPriority, FTASK *fpTask, void *arg_void
     pTask->fpTask = fpTask;
     pTask->arg_voidptr = arg_voidptr;
     pTask->arg_Integer = arg_Integer;
-    pTask->m_Ticket = m_Ticket++;
+    pTask->m_dbObject = dbObject;
+    pTask->m_dbWaitOn = NOTHING;
 
-    // Must add to the WhenHeap so that network is still serviced.
-    //
-    if (!m_WhenHeap.Insert(pTask))
+    if (!Schedule(pTask))
     {
-        delete pTask;
+        FreeTask(pTask);
         return false;
     }
     return true;
@@ -409,29 +813,43 @@ bool CScheduler::DeferImmediateTask(int iPriority, FTASK *fpTask, void *arg_void
 
 void CScheduler::CancelTask(FTASK *fpTask, void *arg_voidptr, int arg_Integer)
 {
-    m_WhenHeap.CancelTask(fpTask, arg_voidptr, arg_Integer);
-    m_PriorityHeap.CancelTask(fpTask, arg_voidptr, arg_Integer);
+    std::vector<PTASK_RECORD> tasks;
+    m_TasksByArg.Find(arg_voidptr, tasks);
+    for (auto p : tasks)
+    {
+        if (  p->fpTask == fpTask
+           && p->arg_Integer == arg_Integer)
+        {
+            if (0 < m_nTraversals)
+            {
+                // A traversal may still hold this record, so leave it in
+                // place for ReadyTasks or RunTasks to discard.
+                //
+                p->fpTask = nullptr;
+            }
+            else
+            {
+                Remove(p);
+            }
+        }
+    }
 }
 
 void CScheduler::ReadyTasks(const CLinearTimeAbsolute& ltaNow)
 {
-    // Move ready-to-run tasks off the WhenHeap and onto the PriorityHeap.
+    // Move ready-to-run tasks off the WhenWheel and onto the PriorityHeap.
     //
-    PTASK_RECORD pTask = m_WhenHeap.PeekAtTopmost();
-    while (  pTask
-          && pTask->ltaWhen < ltaNow)
+    m_WhenWheel.Expire(ltaNow, m_Ready);
+    for (auto pTask : m_Ready)
     {
-        pTask = m_WhenHeap.RemoveTopmost();
-        if (pTask)
+        if (  nullptr == pTask->fpTask
+           || !m_PriorityHeap.Insert(pTask))
         {
-            if (  nullptr == pTask->fpTask
-               || !m_PriorityHeap.Insert(pTask))
-            {
-                delete pTask;
-            }
+            Unindex(pTask);
+            FreeTask(pTask);
         }
-        pTask = m_WhenHeap.PeekAtTopmost();
     }
+    m_Ready.clear();
 }
 
 int CScheduler::RunTasks(const CLinearTimeAbsolute& ltaNow)
@@ -466,6 +884,10 @@ int CScheduler::RunTasks(int iCount)
         pTask = m_PriorityHeap.RemoveTopmost();
         if (pTask)
         {
+            // Off the heap means out of the indexes, too, so neither @halt
+            // nor CancelTask can reach a task while it runs.
+            //
+            Unindex(pTask);
             if (pTask->fpTask)
             {
                 // #2009: exception barrier.  Everything softcode does runs
@@ -510,7 +932,7 @@ int CScheduler::RunTasks(int iCount)
                 }
                 nTasks++;
             }
-            delete pTask;
+            FreeTask(pTask);
         }
     }
     return nTasks;
@@ -546,7 +968,7 @@ bool CScheduler::WhenNext(CLinearTimeAbsolute  *ltaWhen)
 
     // Check the When Queue next.
     //
-    pTask = m_WhenHeap.PeekAtTopmost();
+    pTask = m_WhenWheel.PeekAtTopmost();
     if (pTask)
     {
         *ltaWhen = pTask->ltaWhen;
@@ -563,22 +985,112 @@ bool CScheduler::HasPendingUserTasks(void)
     // without an external notify).  A CLI run is finished once only those two
     // classes remain, even though delayed @wait tasks must still be honored.
     //
-    return 0 < m_WhenHeap.CountInPriorityRange(PRIORITY_SYSTEM, PRIORITY_SUSPEND)
+    return 0 < m_WhenWheel.CountInPriorityRange(PRIORITY_SYSTEM, PRIORITY_SUSPEND)
         || 0 < m_PriorityHeap.CountInPriorityRange(PRIORITY_SYSTEM, PRIORITY_SUSPEND);
 }
 
+// Hand each task to pfLook, then apply what it asks for.  The list is a
+// snapshot, so removing or re-keying a task cannot disturb the walk.
+//
+bool CScheduler::Visit(const std::vector<PTASK_RECORD> &tasks, SCHLOOK *pfLook)
+{
+    bool bContinue = true;
+    m_nTraversals++;
+    for (auto p : tasks)
+    {
+        const int cmd = pfLook(p);
+        if (IU_DONE == cmd)
+        {
+            bContinue = false;
+            break;
+        }
+        else if (IU_REMOVE_TASK == cmd)
+        {
+            Remove(p);
+        }
+        else if (IU_UPDATE_TASK == cmd)
+        {
+            Update(p);
+        }
+    }
+    m_nTraversals--;
+    return bContinue;
+}
+
 void CScheduler::TraverseUnordered(SCHLOOK *pfLook)
 {
-    if (m_WhenHeap.TraverseUnordered(pfLook))
+    std::vector<PTASK_RECORD> tasks;
+    m_WhenWheel.Snapshot(tasks);
+    if (Visit(tasks, pfLook))
     {
-        m_PriorityHeap.TraverseUnordered(pfLook);
+        tasks.clear();
+        m_PriorityHeap.Snapshot(tasks);
+        Visit(tasks, pfLook);
     }
 }
 
 void CScheduler::TraverseOrdered(SCHLOOK *pfLook)
 {
-    m_PriorityHeap.TraverseOrdered(pfLook);
-    m_WhenHeap.TraverseOrdered(pfLook);
+    std::vector<PTASK_RECORD> tasks;
+    m_PriorityHeap.SnapshotOrdered(tasks);
+    if (Visit(tasks, pfLook))
+    {
+        tasks.clear();
+        m_WhenWheel.SnapshotOrdered(tasks);
+        Visit(tasks, pfLook);
+    }
+}
+
+void CScheduler::TraverseObject(dbref dbObject, SCHLOOK *pfLook)
+{
+    std::vector<PTASK_RECORD> tasks;
+    m_TasksByObject.Find(dbObject, tasks);
+    Visit(tasks, pfLook);
+}
+
+void CScheduler::TraverseSemaphore(dbref dbSem, bool bOrdered, SCHLOOK *pfLook)
+{
+    std::vector<PTASK_RECORD> tasks;
+    m_TasksBySemaphore.Find(dbSem, tasks);
+    if (bOrdered)
+    {
+        // Same order as TraverseOrdered: ready tasks first, then waiting
+        // ones, each in the order they would run.
+        //
+        std::sort(tasks.begin(), tasks.end(),
+            [this](PTASK_RECORD a, PTASK_RECORD b)
+            {
+                const bool bReadyA = m_PriorityHeap.Contains(a);
+                const bool bReadyB = m_PriorityHeap.Contains(b);
+                if (bReadyA != bReadyB)
+                {
+                    return bReadyA;
+                }
+                if (bReadyA)
+                {
+                    return ComparePriorityGreater()(b, a);
+                }
+                return CompareWhenGreater()(b, a);
+            });
+    }
+    Visit(tasks, pfLook);
+}
+
+void CScheduler::TraverseTicket(uint64_t iTicket, SCHLOOK *pfLook)
+{
+    const auto it = m_TaskByTicket.find(iTicket);
+    if (it != m_TaskByTicket.end())
+    {
+        const std::vector<PTASK_RECORD> tasks(1, it->second);
+        Visit(tasks, pfLook);
+    }
+}
+
+// Objects that have at least one queue entry in the scheduler.
+//
+void CScheduler::QueuedObjects(std::vector<dbref> &objects) const
+{
+    m_TasksByObject.Keys(objects);
 }
 
 void CScheduler::SetMinPriority(int arg_minPriority)
@@ -588,6 +1100,6 @@ void CScheduler::SetMinPriority(int arg_minPriority)
 
 void CScheduler::Shrink(void)
 {
-    m_WhenHeap.Shrink();
+    m_WhenWheel.Shrink();
     m_PriorityHeap.Shrink();
 }
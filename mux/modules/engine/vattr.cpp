@@ -145,6 +145,10 @@ void do_dbclean(dbref executor, dbref caller, dbref enactor, int eval, int key)
             MEMFREE(vp);
         }
     }
+    if (!orphans.empty())
+    {
+        lock_cache_invalidate_all();
+    }
 
     g_pSQLiteBackend->GetDB().Analyze();
 
@@ -212,6 +216,7 @@ ATTR *vattr_rename_LEN(UTF8 *pOldName, size_t nOldName, UTF8 *pNewName, size_t n
         return nullptr;
     }
     vp->name = reinterpret_cast<const UTF8 *>(newit->first.c_str());
+    lock_cache_invalidate_all();
 
     if (  !mudstate.bSQLiteLoading
        && anum >= A_USER_START)
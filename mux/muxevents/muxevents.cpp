@@ -0,0 +1,569 @@
+/*! \file muxevents.cpp
+ * \brief Read the binary event log written by the event_log parameter.
+ *
+ * Prints the records of one or more .evlog files as text, optionally
+ * filtered by time, object, socket, or event type, or just counts them.
+ * The file format is described in eventlog.h.
+ *
+ * Build:
+ *   c++ -std=c++17 -O2 -Wall -Wextra -I../include -o muxevents muxevents.cpp
+ *
+ * Usage:
+ *   muxevents [options] file...
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "eventlog.h"
+
+#define NOTHING (-1)
+
+struct EventType
+{
+    int         type;
+    const char *name;
+};
+
+static const EventType event_types[] =
+{
+    { EVLOG_NET_CONNECT,     "connect"      },
+    { EVLOG_NET_DISCONNECT,  "disconnect"   },
+    { EVLOG_NET_REFUSED,     "refused"      },
+    { EVLOG_LOGIN,           "login"        },
+    { EVLOG_LOGIN_FAILED,    "loginfail"    },
+    { EVLOG_LOGIN_REFUSED,   "loginrefused" },
+    { EVLOG_CREATE,          "create"       },
+    { EVLOG_CREATE_FAILED,   "createfail"   },
+    { EVLOG_COMMAND,         "command"      },
+    { EVLOG_COMMAND_SUSPECT, "suspect"      },
+    { EVLOG_COMMAND_BAD,     "badcommand"   },
+    { EVLOG_RENAME,          "rename"       },
+};
+
+static const size_t num_event_types = sizeof(event_types) / sizeof(event_types[0]);
+
+static const char *type_name(int type)
+{
+    for (size_t i = 0; i < num_event_types; i++)
+    {
+        if (event_types[i].type == type)
+        {
+            return event_types[i].name;
+        }
+    }
+    return nullptr;
+}
+
+struct Filter
+{
+    bool             bSince = false;
+    int64_t          usecSince = 0;
+    bool             bUntil = false;
+    int64_t          usecUntil = 0;
+    std::set<int>    dbrefs;
+    std::set<int>    types;
+    bool             bSocket = false;
+    uint32_t         socket = 0;
+};
+
+static void usage(FILE *fp)
+{
+    std::fprintf(fp,
+        "Usage: muxevents [options] file...\n"
+        "\n"
+        "  --since TIME       Only events at or after TIME.\n"
+        "  --until TIME       Only events before TIME.\n"
+        "  --dbref N          Only events naming object N (or #N).  Repeatable.\n"
+        "  --type T[,T...]    Only events of these types.  Repeatable.\n"
+        "  --socket N         Only events on socket N.\n"
+        "  --stats            Count the matching events by type instead of\n"
+        "                     printing them.\n"
+        "\n"
+        "TIME is seconds since 1970, or local time as YYYY-MM-DD[ HH:MM[:SS]].\n"
+        "\n"
+        "Types:");
+    for (size_t i = 0; i < num_event_types; i++)
+    {
+        std::fprintf(fp, " %s", event_types[i].name);
+    }
+    std::fprintf(fp, "\n");
+}
+
+static bool parse_time(const char *p, int64_t *pusec)
+{
+    char *end;
+    errno = 0;
+    long long n = std::strtoll(p, &end, 10);
+    if (  end != p
+       && '\0' == *end
+       && 0 == errno)
+    {
+        *pusec = static_cast<int64_t>(n) * 1000000;
+        return true;
+    }
+
+    struct tm tm;
+    std::memset(&tm, 0, sizeof(tm));
+    int nFields = std::sscanf(p, "%d-%d-%d%*[ T]%d:%d:%d", &tm.tm_year,
+        &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec);
+    if (  3 != nFields
+       && 5 != nFields
+       && 6 != nFields)
+    {
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    time_t t = std::mktime(&tm);
+    if (static_cast<time_t>(-1) == t)
+    {
+        return false;
+    }
+    *pusec = static_cast<int64_t>(t) * 1000000;
+    return true;
+}
+
+static bool parse_dbref(const char *p, int *pdbref)
+{
+    if ('#' == *p)
+    {
+        p++;
+    }
+    char *end;
+    errno = 0;
+    long n = std::strtol(p, &end, 10);
+    if (  end == p
+       || '\0' != *end
+       || 0 != errno
+       || n < NOTHING
+       || INT32_MAX < n)
+    {
+        return false;
+    }
+    *pdbref = static_cast<int>(n);
+    return true;
+}
+
+static bool parse_types(const char *p, std::set<int> &types)
+{
+    std::string list(p);
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t comma = list.find(',', start);
+        if (std::string::npos == comma)
+        {
+            comma = list.size();
+        }
+        std::string name = list.substr(start, comma - start);
+        bool bFound = false;
+        for (size_t i = 0; i < num_event_types; i++)
+        {
+            if (name == event_types[i].name)
+            {
+                types.insert(event_types[i].type);
+                bFound = true;
+                break;
+            }
+        }
+        if (!bFound)
+        {
+            std::fprintf(stderr, "muxevents: unknown type '%s'.\n", name.c_str());
+            return false;
+        }
+        start = comma + 1;
+    }
+    return true;
+}
+
+// Only these types carry a dbref (the location) in 'other'; elsewhere it is
+// a port, a length, or unused.
+//
+static bool other_is_dbref(int type)
+{
+    return  EVLOG_LOGIN == type
+         || EVLOG_COMMAND == type
+         || EVLOG_COMMAND_SUSPECT == type
+         || EVLOG_COMMAND_BAD == type;
+}
+
+static bool matches(const Filter &f, const EVLOG_RECORD &rec)
+{
+    if (  (f.bSince && rec.usec < f.usecSince)
+       || (f.bUntil && f.usecUntil <= rec.usec)
+       || (f.bSocket && rec.socket != f.socket))
+    {
+        return false;
+    }
+    if (  !f.types.empty()
+       && f.types.end() == f.types.find(rec.type))
+    {
+        return false;
+    }
+    if (  !f.dbrefs.empty()
+       && f.dbrefs.end() == f.dbrefs.find(rec.player)
+       && (  !other_is_dbref(rec.type)
+          || f.dbrefs.end() == f.dbrefs.find(rec.other)))
+    {
+        return false;
+    }
+    return true;
+}
+
+static void format_time(int64_t usec, char *buf, size_t nbuf)
+{
+    time_t t = static_cast<time_t>(usec / 1000000);
+    struct tm tm;
+    localtime_r(&t, &tm);
+    size_t n = std::strftime(buf, nbuf, "%Y-%m-%d %H:%M:%S", &tm);
+    std::snprintf(buf + n, nbuf - n, ".%06ld",
+        static_cast<long>(usec % 1000000));
+}
+
+static void print_record(const EVLOG_RECORD &rec,
+    const std::vector<std::string> &strings)
+{
+    auto str = [&strings](uint32_t id) -> const char *
+    {
+        if (  0 == id
+           || strings.size() <= id)
+        {
+            return "";
+        }
+        return strings[id].c_str();
+    };
+
+    char szTime[64];
+    format_time(rec.usec, szTime, sizeof(szTime));
+    const char *name = type_name(rec.type);
+    if (nullptr == name)
+    {
+        std::printf("%s type%u\n", szTime, static_cast<unsigned>(rec.type));
+        return;
+    }
+    std::printf("%s %-12s ", szTime, name);
+
+    switch (rec.type)
+    {
+    case EVLOG_NET_CONNECT:
+        std::printf("[%u/%s] port %d\n", rec.socket, str(rec.str1), rec.other);
+        break;
+
+    case EVLOG_NET_DISCONNECT:
+        if (NOTHING == rec.player)
+        {
+            std::printf("[%u/%s] never connected", rec.socket, str(rec.str1));
+        }
+        else
+        {
+            std::printf("[%u/%s] #%d", rec.socket, str(rec.str1), rec.player);
+        }
+        if (0 != rec.str2)
+        {
+            std::printf(" <%s>", str(rec.str2));
+        }
+        std::printf("\n");
+        break;
+
+    case EVLOG_NET_REFUSED:
+        std::printf("[%u/%s] %s\n", rec.socket, str(rec.str1), str(rec.str2));
+        break;
+
+    case EVLOG_LOGIN:
+        std::printf("[%u/%s] #%d in #%d\n", rec.socket, str(rec.str1),
+            rec.player, rec.other);
+        break;
+
+    case EVLOG_LOGIN_FAILED:
+    case EVLOG_CREATE_FAILED:
+        std::printf("[%u/%s] '%s'\n", rec.socket, str(rec.str1), str(rec.str2));
+        break;
+
+    case EVLOG_LOGIN_REFUSED:
+        std::printf("[%u/%s]", rec.socket, str(rec.str1));
+        if (NOTHING != rec.player)
+        {
+            std::printf(" #%d", rec.player);
+        }
+        std::printf(" %s\n", str(rec.str2));
+        break;
+
+    case EVLOG_CREATE:
+        std::printf("[%u/%s] #%d\n", rec.socket, str(rec.str1), rec.player);
+        break;
+
+    case EVLOG_COMMAND:
+    case EVLOG_COMMAND_SUSPECT:
+    case EVLOG_COMMAND_BAD:
+        std::printf("#%d in #%d: %s\n", rec.player, rec.other, str(rec.str1));
+        break;
+
+    case EVLOG_RENAME:
+        std::printf("#%d to '%s'\n", rec.player, str(rec.str1));
+        break;
+    }
+}
+
+// Read one file, print or count what matches.  Returns false if the file
+// could not be read, is not an event log, or turns out to be corrupt.
+//
+// Files are printed oldest first whatever order they are named in, so a glob
+// works even though a file's sequence number (two files started in the same
+// second) sorts it ahead of the first.  A file without a readable header
+// sorts first, and process_file() reports it.
+//
+static int64_t file_created(const char *filename)
+{
+    int64_t usec = INT64_MIN;
+    FILE *fp = std::fopen(filename, "rb");
+    if (nullptr != fp)
+    {
+        EVLOG_HEADER hdr;
+        if (  1 == std::fread(&hdr, sizeof(hdr), 1, fp)
+           && 0 == std::memcmp(hdr.magic, EVLOG_MAGIC, sizeof(hdr.magic)))
+        {
+            usec = hdr.created_usec;
+        }
+        std::fclose(fp);
+    }
+    return usec;
+}
+
+static bool process_file(const char *filename, const Filter &f, bool bStats,
+    std::vector<unsigned long> &counts)
+{
+    FILE *fp = std::fopen(filename, "rb");
+    if (nullptr == fp)
+    {
+        std::fprintf(stderr, "muxevents: %s: %s\n", filename, std::strerror(errno));
+        return false;
+    }
+
+    EVLOG_HEADER hdr;
+    if (  1 != std::fread(&hdr, sizeof(hdr), 1, fp)
+       || 0 != std::memcmp(hdr.magic, EVLOG_MAGIC, sizeof(hdr.magic))
+       || EVLOG_VERSION != hdr.version
+       || EVLOG_RECORD_SIZE != hdr.record_size)
+    {
+        std::fprintf(stderr, "muxevents: %s: not a version %d event log.\n",
+            filename, EVLOG_VERSION);
+        std::fclose(fp);
+        return false;
+    }
+
+    // A string record's size and id come from the file, so check them
+    // before allocating anything on their say-so.
+    //
+    long cbFile = -1;
+    if (0 == std::fseek(fp, 0, SEEK_END))
+    {
+        cbFile = std::ftell(fp);
+    }
+    if (  cbFile < 0
+       || 0 != std::fseek(fp, sizeof(hdr), SEEK_SET))
+    {
+        std::fprintf(stderr, "muxevents: %s: %s\n", filename, std::strerror(errno));
+        std::fclose(fp);
+        return false;
+    }
+    const int32_t nMaxSlots = (EVLOG_MAX_STRING + EVLOG_RECORD_SIZE - 1) / EVLOG_RECORD_SIZE;
+
+    std::vector<std::string> strings(1);
+    EVLOG_RECORD rec;
+    bool bOk = true;
+    while (1 == std::fread(&rec, sizeof(rec), 1, fp))
+    {
+        if (EVLOG_NONE == rec.type)
+        {
+            break;
+        }
+
+        if (EVLOG_STRING == rec.type)
+        {
+            const long cbRemaining = cbFile - std::ftell(fp);
+            if (  rec.other < 0
+               || nMaxSlots < rec.other
+               || cbRemaining < static_cast<long>(rec.other) * EVLOG_RECORD_SIZE
+               || EVLOG_MAX_STRINGS <= rec.str1)
+            {
+                std::fprintf(stderr, "muxevents: %s: corrupt string record at offset %ld.\n",
+                    filename, std::ftell(fp) - static_cast<long>(sizeof(rec)));
+                bOk = false;
+                break;
+            }
+            const size_t n = static_cast<size_t>(rec.player);
+            const size_t nSlots = static_cast<size_t>(rec.other);
+            std::string s(nSlots * EVLOG_RECORD_SIZE, '\0');
+            if (  0 < nSlots
+               && 1 != std::fread(&s[0], s.size(), 1, fp))
+            {
+                break;
+            }
+            s.resize(n < s.size() ? n : s.size());
+            if (strings.size() <= rec.str1)
+            {
+                strings.resize(rec.str1 + 1);
+            }
+            strings[rec.str1] = std::move(s);
+            continue;
+        }
+
+        if (!matches(f, rec))
+        {
+            continue;
+        }
+        if (bStats)
+        {
+            for (size_t i = 0; i < num_event_types; i++)
+            {
+                if (event_types[i].type == rec.type)
+                {
+                    counts[i]++;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            print_record(rec, strings);
+        }
+    }
+    std::fclose(fp);
+    return bOk;
+}
+
+int main(int argc, char *argv[])
+{
+    Filter f;
+    bool bStats = false;
+    std::vector<const char *> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool bNeedsValue = true;
+        bool bOk = true;
+
+        if (0 == std::strcmp(arg, "--help") || 0 == std::strcmp(arg, "-h"))
+        {
+            usage(stdout);
+            return 0;
+        }
+        else if (0 == std::strcmp(arg, "--stats"))
+        {
+            bStats = true;
+            bNeedsValue = false;
+        }
+        else if (0 == std::strcmp(arg, "--since"))
+        {
+            bOk = val && parse_time(val, &f.usecSince);
+            f.bSince = true;
+        }
+        else if (0 == std::strcmp(arg, "--until"))
+        {
+            bOk = val && parse_time(val, &f.usecUntil);
+            f.bUntil = true;
+        }
+        else if (0 == std::strcmp(arg, "--dbref"))
+        {
+            int dbref;
+            bOk = val && parse_dbref(val, &dbref);
+            if (bOk)
+            {
+                f.dbrefs.insert(dbref);
+            }
+        }
+        else if (0 == std::strcmp(arg, "--type"))
+        {
+            bOk = val && parse_types(val, f.types);
+        }
+        else if (0 == std::strcmp(arg, "--socket"))
+        {
+            char *end;
+            unsigned long n = val ? std::strtoul(val, &end, 10) : 0;
+            bOk = val && end != val && '\0' == *end && n <= UINT32_MAX;
+            f.socket = static_cast<uint32_t>(n);
+            f.bSocket = true;
+        }
+        else if ('-' == arg[0] && '\0' != arg[1])
+        {
+            std::fprintf(stderr, "muxevents: unknown option '%s'.\n", arg);
+            usage(stderr);
+            return 2;
+        }
+        else
+        {
+            files.push_back(arg);
+            bNeedsValue = false;
+        }
+
+        if (!bOk)
+        {
+            std::fprintf(stderr, "muxevents: bad or missing value for %s.\n", arg);
+            return 2;
+        }
+        if (bNeedsValue)
+        {
+            i++;
+        }
+    }
+
+    if (files.empty())
+    {
+        usage(stderr);
+        return 2;
+    }
+
+    std::vector<std::pair<int64_t, const char *>> order;
+    for (const char *filename : files)
+    {
+        order.emplace_back(file_created(filename), filename);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [](const std::pair<int64_t, const char *> &a,
+           const std::pair<int64_t, const char *> &b)
+        {
+            return a.first < b.first;
+        });
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        files[i] = order[i].second;
+    }
+
+    std::vector<unsigned long> counts(num_event_types, 0);
+    int rc = 0;
+    for (const char *filename : files)
+    {
+        if (!process_file(filename, f, bStats, counts))
+        {
+            rc = 1;
+        }
+    }
+
+    if (bStats)
+    {
+        unsigned long total = 0;
+        for (size_t i = 0; i < num_event_types; i++)
+        {
+            if (0 < counts[i])
+            {
+                std::printf("%-12s %10lu\n", event_types[i].name, counts[i]);
+                total += counts[i];
+            }
+        }
+        std::printf("%-12s %10lu\n", "total", total);
+    }
+    return rc;
+}
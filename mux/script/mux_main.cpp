@@ -86,6 +86,8 @@ public:
     virtual MUX_RESULT SendText(dbref target, const UTF8 *text);
     virtual MUX_RESULT SendRaw(dbref target, const UTF8 *data, size_t len);
     virtual MUX_RESULT BroadcastAndFlush(int inflags, const UTF8 *text);
+    virtual MUX_RESULT BeginBroadcast(void);
+    virtual MUX_RESULT EndBroadcast(void);
     virtual MUX_RESULT SendProgPrompt(dbref target);
     virtual MUX_RESULT SendKeepaliveNops(void);
     virtual MUX_RESULT SendGmcp(dbref target, const UTF8 *pkg, const UTF8 *json);
@@ -246,6 +248,16 @@ MUX_RESULT CScriptConnectionManager::BroadcastAndFlush(int inflags, const UTF8 *
     return MUX_S_OK;
 }
 
+MUX_RESULT CScriptConnectionManager::BeginBroadcast(void)
+{
+    return MUX_S_OK;
+}
+
+MUX_RESULT CScriptConnectionManager::EndBroadcast(void)
+{
+    return MUX_S_OK;
+}
+
 MUX_RESULT CScriptConnectionManager::SendProgPrompt(dbref target)
 {
     UNUSED_PARAMETER(target);
@@ -14,6 +14,7 @@
 #include "modules.h"
 #include "driverstate.h"
 #include "driver_log.h"
+#include "eventlog.h"
 #include "driver_bridge.h"
 using namespace std;
 
@@ -203,6 +204,8 @@ void shutdownsock(DESC *d, int reason)
             ENDLOG;
             site_mon_send(d->socket, d->addr, d, T("Disconnection"));
         }
+        LOG_EVENT(LOG_NET | LOG_LOGIN, EVLOG_NET_DISCONNECT, d->socket,
+            d->player, NOTHING, d->addr, disc_reasons[reason]);
 
         // If requested, write an accounting record of the form:
         // Plyr# Flags Cmds ConnTime Loc Money [Site] <DiscRsn> Name
@@ -237,6 +240,8 @@ void shutdownsock(DESC *d, int reason)
         g_pILog->log_text(buff);
         free_mbuf(buff);
         ENDLOG;
+        LOG_EVENT(LOG_SECURITY | LOG_NET, EVLOG_NET_DISCONNECT, d->socket,
+            NOTHING, NOTHING, d->addr, disc_reasons[reason]);
         site_mon_send(d->socket, d->addr, d, T("N/C Connection Closed"));
     }
 
@@ -294,6 +299,7 @@ void shutdownsock(DESC *d, int reason)
         // Cancel any scheduled processing on this socket.
         //
         drv_CancelTask(Task_ProcessCommand, d, 0);
+        cancel_pending_login(d);
 
         shutdown(d->socket, SD_BOTH);
         if (0 == SOCKET_CLOSE(d->socket))
@@ -329,11 +335,11 @@ void process_output(DESC *d, int bHandleShutdown)
 
     while (!d->output_queue.empty())
     {
-        auto &entry = d->output_queue.front();
-        if (!entry.empty())
+        const auto &entry = d->output_queue.front();
+        if (!entry->empty())
         {
-            g_GanlAdapter.send_data(d, entry.c_str(), entry.size());
-            d->output_size -= entry.size();
+            g_GanlAdapter.send_data(d, entry);
+            d->output_size -= entry->size();
         }
         d->output_queue.pop_front();
     }
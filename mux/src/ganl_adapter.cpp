@@ -5,6 +5,7 @@
 #include "modules.h"
 #include "driverstate.h"
 #include "driver_log.h"
+#include "eventlog.h"
 #include "driver_bridge.h"
 #include "interface.h"
 #include "websocket.h"
@@ -17,6 +18,7 @@
 #include <cstdio>
 #include <limits>
 #include <cerrno>
+#include <thread>
 
 #ifdef UNIX_SSL
 #include <openssl/ssl.h>
@@ -30,6 +32,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #if defined(__linux__)
 #include <dirent.h>      // count_open_fds() reads /proc/self/fd
@@ -423,6 +426,8 @@ namespace
             ENDLOG;
             site_mon_send(d->socket, d->addr, d, T("Disconnection"));
         }
+        LOG_EVENT(LOG_NET | LOG_LOGIN, EVLOG_NET_DISCONNECT, d->socket,
+            d->player, NOTHING, d->addr, disc_reasons[mux_reason]);
 
         STARTLOG(LOG_ACCOUNTING, "DIS", "ACCT");
         CLinearTimeDelta ltd = ltaNow - d->connected_at;
@@ -455,6 +460,8 @@ namespace
         g_pILog->log_text(buff);
         free_mbuf(buff);
         ENDLOG;
+        LOG_EVENT(LOG_SECURITY | LOG_NET, EVLOG_NET_DISCONNECT, d->socket,
+            NOTHING, NOTHING, d->addr, nullptr);
         site_mon_send(d->socket, d->addr, d, T("N/C Connection Closed"));
     }
 
@@ -501,6 +508,7 @@ namespace
         }
 
         drv_CancelTask(Task_ProcessCommand, d, 0);
+        cancel_pending_login(d);
 
         if (d->player != NOTHING)
         {
@@ -607,12 +615,15 @@ public:
             adapter_.pending_tls_flags_.erase(tlsIt);
         }
 
+        // A connection bound for an I/O shard is in the map with no
+        // ConnectionBase; accept_to_shard() closes it if this refuses.
+        //
         std::shared_ptr<ganl::ConnectionBase> conn;
         auto itConn = adapter_.handle_to_conn_.find(handle);
         if (itConn != adapter_.handle_to_conn_.end()) {
             conn = itConn->second;
         }
-        if (!conn) {
+        if (!conn && (!adapter_.ioShards_ || itConn == adapter_.handle_to_conn_.end())) {
             g_pILog->WriteString(tprintf(T("GANL: Missing ConnectionBase for handle %llu\n"),
                 static_cast<unsigned long long>(handle)));
             return ganl::InvalidSessionId;
@@ -631,7 +642,9 @@ public:
             g_pILog->WriteString(tprintf(
                 T("GANL: connection handle %llu exceeds SOCKET range; refusing.\n"),
                 static_cast<unsigned long long>(handle)));
-            conn->close(ganl::DisconnectReason::NetworkError);
+            if (conn) {
+                conn->close(ganl::DisconnectReason::NetworkError);
+            }
             return ganl::InvalidSessionId;
         }
 
@@ -715,6 +728,8 @@ public:
                 : (!remoteAddress.empty()
                     ? reinterpret_cast<const UTF8 *>(remoteAddress.c_str())
                     : T("UNKNOWN"));
+            LOG_EVENT(LOG_NET | LOG_SECURITY, EVLOG_NET_REFUSED, handle,
+                NOTHING, NOTHING, addrLabel, T("no address"));
             if (refusal_log_wanted(addrLabel))
             {
                 STARTLOG(LOG_NET | LOG_SECURITY, "NET", "SITE");
@@ -763,6 +778,8 @@ public:
             // A flood against a known-forbidden site (or a large Tor include
             // list) must not turn into disk/output amplification.
             //
+            LOG_EVENT(LOG_NET | LOG_SECURITY, EVLOG_NET_REFUSED, d->socket,
+                NOTHING, NOTHING, addrText, T("site"));
             const bool bTell = refusal_log_wanted(
                 addrText[0] != '\0' ? addrText : T("UNKNOWN"));
             if (bTell)
@@ -820,6 +837,8 @@ public:
                 // connection turns a connection flood into an output flood,
                 // with work proportional to refusals x staff online.
                 //
+                LOG_EVENT(LOG_NET | LOG_SECURITY, EVLOG_NET_REFUSED, d->socket,
+                    NOTHING, NOTHING, addrText, T("rate"));
                 const bool bTell = refusal_log_wanted(
                     addrText[0] != '\0' ? addrText : T("UNKNOWN"));
                 if (bTell)
@@ -909,6 +928,8 @@ public:
 
             if (g_dc.max_preauth_sitecons <= nPreauth)
             {
+                LOG_EVENT(LOG_NET | LOG_SECURITY, EVLOG_NET_REFUSED, d->socket,
+                    NOTHING, NOTHING, addrText, T("preauth"));
                 const bool bTell = refusal_log_wanted(
                     addrText[0] != '\0' ? addrText : T("UNKNOWN"));
                 if (bTell)
@@ -990,6 +1011,8 @@ public:
             addrText[0] != '\0' ? addrText : T("UNKNOWN"),
             static_cast<unsigned int>(resolvedPort)));
         ENDLOG;
+        LOG_EVENT(LOG_NET | LOG_LOGIN, EVLOG_NET_CONNECT, d->socket, NOTHING,
+            static_cast<int>(resolvedPort), addrText, nullptr);
 
         // GANL ACPT — suppressed (redundant with NET/CONN log).
 
@@ -1022,6 +1045,8 @@ public:
 
         // GANL RECV — suppressed (per-packet noise).
 
+        adapter_.loop_bytes_in_ += data.size();
+
         // Undo autodark
         //
         if (d->flags & DS_AUTODARK)
@@ -1238,6 +1263,7 @@ public:
         }
 
         drv_CancelTask(Task_ProcessCommand, d, 0);
+        cancel_pending_login(d);
 
         if (d->player != NOTHING)
         {
@@ -1636,6 +1662,8 @@ public:
         return true;
     }
 
+    bool passesOutputThrough() const override { return true; }
+
     // Negotiation is a no-op. TinyMUX sends its own IAC sequences via
     // the output queue through process_input_helper().
     void startNegotiation(ganl::ConnectionHandle, ganl::IoBuffer&) override {}
@@ -1686,8 +1714,28 @@ bool GanlAdapter::initialize() {
 
     g_pILog->WriteString(T("Initializing GANL Adapter...\n"));
 
-    // 1. Create Network Engine
-    networkEngine_ = ganl::NetworkEngineFactory::createEngine();
+    // 1. Create Network Engine.  An engine named by network_engine that this
+    // build or kernel cannot provide falls back to the platform default.
+    ganl::NetworkEngineType engineType = ganl::NetworkEngineType::Auto;
+    switch (g_dc.network_engine)
+    {
+    case NE_SELECT:   engineType = ganl::NetworkEngineType::Select;  break;
+    case NE_EPOLL:    engineType = ganl::NetworkEngineType::Epoll;   break;
+    case NE_KQUEUE:   engineType = ganl::NetworkEngineType::Kqueue;  break;
+    case NE_IO_URING: engineType = ganl::NetworkEngineType::IoUring; break;
+    }
+    networkEngine_ = ganl::NetworkEngineFactory::createEngine(engineType);
+    if (  networkEngine_
+       && engineType != ganl::NetworkEngineType::Auto
+       && !networkEngine_->initialize()) {
+        networkEngine_.reset();
+    }
+    if (  !networkEngine_
+       && engineType != ganl::NetworkEngineType::Auto) {
+        g_pILog->WriteString(T("Requested network_engine is not available; using the default.\n"));
+        engineType = ganl::NetworkEngineType::Auto;
+        networkEngine_ = ganl::NetworkEngineFactory::createEngine(engineType);
+    }
     if (!networkEngine_) {
         g_pILog->WriteString(T("FATAL: Failed to create GANL network engine.\n"));
         return false;
@@ -1695,8 +1743,9 @@ bool GanlAdapter::initialize() {
     g_pILog->WriteString(tprintf(T("Using GANL Network Engine: %d\n"), networkEngine_->getIoModelType()));
 
 
-    // 2. Initialize Network Engine
-    if (!networkEngine_->initialize()) {
+    // 2. Initialize Network Engine (an explicitly chosen one already is).
+    if (  engineType == ganl::NetworkEngineType::Auto
+       && !networkEngine_->initialize()) {
         g_pILog->WriteString(T("FATAL: Failed to initialize GANL network engine.\n"));
         networkEngine_.reset(); // Release the failed engine
         return false;
@@ -1742,6 +1791,10 @@ bool GanlAdapter::initialize() {
         return false;
     }
 
+    // 5a. I/O threads, if configured.  Started before the restart path below
+    // so the connections that survived an @restart go to them, too.
+    start_io_shards(engineType);
+
     // 6. Set up listeners and connections — branching on restart vs. fresh start.
     ganl::ErrorCode error = 0;
 
@@ -1802,6 +1855,28 @@ bool GanlAdapter::initialize() {
                 continue;
             }
 
+            if (ioShards_) {
+                // The handle is the descriptor, as on the inline path, and
+                // onConnectionOpen() (restarting_) wires up the DESC mapping.
+                //
+                const ganl::ConnectionHandle h = static_cast<ganl::ConnectionHandle>(d->socket);
+                handle_to_conn_[h] = nullptr;
+                if (  ganl::InvalidSessionId == sessionManager_->onConnectionOpen(h, "")
+                   || !ioShards_->adopt(h, false)) {
+                    g_pILog->WriteString(tprintf(
+                        T("GANL: Failed to hand adopted fd %llu to an I/O thread\n"),
+                        static_cast<unsigned long long>(d->socket)));
+                    remove_mapping(d);
+                    handle_to_conn_.erase(h);
+                    adopt_failed.push_back(d);
+                    continue;
+                }
+                g_pILog->WriteString(tprintf(
+                    T("GANL: Adopted connection fd %llu (player %d)\n"),
+                    static_cast<unsigned long long>(d->socket), d->player));
+                continue;
+            }
+
             ganl::ConnectionHandle connHandle = networkEngine_->adoptConnection(
                 d->socket, nullptr, error);
             if (connHandle == ganl::InvalidConnectionHandle) {
@@ -1950,6 +2025,7 @@ bool GanlAdapter::initialize() {
             // Tear down the partially-built engine so a second init attempt
             // (if any) and process exit are coherent.
             //
+            stop_io_shards();
             if (sessionManager_) {
                 sessionManager_->shutdown();
                 sessionManager_.reset();
@@ -1971,6 +2047,10 @@ bool GanlAdapter::initialize() {
         g_pILog->WriteString(T("GANL: no listen ports configured.\n"));
     }
 
+    if (!ssl_port_listeners_.empty()) {
+        start_tls_workers();
+    }
+
     initialized_ = true;
     g_pILog->WriteString(T("GANL Adapter initialized.\n"));
     return true;
@@ -2009,7 +2089,11 @@ void GanlAdapter::shutdown() {
 
     // process_output buffers data in GANL's encryptedOutput_ and registers
     // write interest via postWrite(). We must process events so the network
-    // engine actually flushes the farewell message to the wire.
+    // engine actually flushes the farewell message to the wire.  Output for
+    // a TLS connection may still be on a worker; collect it first.  An I/O
+    // thread writes its own, and stop_io_shards() gives it time to drain.
+    flush_tls_workers();
+    flush_io_shards();
     {
         constexpr int MAX_EVENTS = 64;
         ganl::IoEvent events[MAX_EVENTS];
@@ -2024,6 +2108,8 @@ void GanlAdapter::shutdown() {
         }
     }
 
+    stop_io_shards();
+
     // Close all connections before destroying the network engine.
     // We must close them explicitly so their destructors don't try to access
     // a destroyed engine.
@@ -2039,8 +2125,10 @@ void GanlAdapter::shutdown() {
                 conn->close(ganl::DisconnectReason::ServerShutdown);
             }
         }
+        flush_tls_workers();
         connsToClose.clear();
     }
+    stop_tls_workers();
 
     if (sessionManager_) {
         sessionManager_->shutdown();
@@ -2061,6 +2149,7 @@ void GanlAdapter::shutdown() {
         networkEngine_->shutdown();
         networkEngine_.reset();
     }
+    tlsWorkers_.reset();
 
     port_listeners_.clear();
     ssl_port_listeners_.clear();
@@ -2153,9 +2242,37 @@ void GanlAdapter::close_tls_for_restart() {
                 drop_descs.push_back(d);
             }
         }
+        std::vector<ganl::ConnectionHandle> shardHandles;
         for (DESC* d : drop_descs) {
+            if (ioShards_ && ioShards_->owns(get_handle(d))) {
+                shardHandles.push_back(get_handle(d));
+            }
             close_connection(d, ganl::DisconnectReason::ServerShutdown);
         }
+
+        // A shard's close frees its DESC only when runCompletions() delivers
+        // it.  Wait a little for those, so they are not written to
+        // restart.db.  Any still draining after that are written anyway;
+        // releaseAll() closes their descriptors, and the successor drops them
+        // as it does any connection it cannot adopt.
+        //
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!shardHandles.empty()) {
+            flush_io_shards();
+            for (size_t i = 0; i < shardHandles.size(); ) {
+                if (ioShards_->owns(shardHandles[i])) {
+                    ++i;
+                } else {
+                    shardHandles[i] = shardHandles.back();
+                    shardHandles.pop_back();
+                }
+            }
+            if (  shardHandles.empty()
+               || deadline <= std::chrono::steady_clock::now()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
     }
 
 }
@@ -2169,12 +2286,15 @@ void GanlAdapter::prepare_for_restart() {
     record_listeners_for_restart();
     close_tls_for_restart();
 
-    // 3. Flush output for remaining plain-telnet connections.
+    // 3. Flush output for remaining plain-telnet connections, and the
+    //    close_notify step 2 left on the TLS workers.
     for (DESC* d : g_descriptors_list) {
         if (d) {
             process_output(d, false);
         }
     }
+    flush_tls_workers();
+    flush_io_shards();
     {
         constexpr int MAX_EVENTS = 64;
         ganl::IoEvent events[MAX_EVENTS];
@@ -2204,6 +2324,9 @@ void GanlAdapter::prepare_for_restart() {
         for (ganl::ConnectionHandle h : connHandles) {
             networkEngine_->detachConnection(h);
         }
+        if (ioShards_) {
+            ioShards_->releaseAll();
+        }
     }
 
     // 6. Detach all listener fds from the engine.
@@ -2267,6 +2390,8 @@ void GanlAdapter::prepare_for_restart() {
     // 8. Shut down engine, transport, session manager, protocol handler.
     shutdown_dns_slave();
     shutdown_email_channel();
+    stop_tls_workers();
+    stop_io_shards();
     if (sessionManager_) {
         sessionManager_->shutdown();
         sessionManager_.reset();
@@ -2282,6 +2407,7 @@ void GanlAdapter::prepare_for_restart() {
         networkEngine_->shutdown();
         networkEngine_.reset();
     }
+    tlsWorkers_.reset();
 
     port_listeners_.clear();
     ssl_port_listeners_.clear();
@@ -2389,6 +2515,267 @@ void GanlAdapter::accept_cleanup_contained(ganl::ConnectionHandle handle)
     }
 }
 
+// Accept for an I/O shard (io_threads).  The DESC is opened here, the same
+// way ConnectionBase::initialize() would open it, and only a connection the
+// game keeps is handed over.  Once a shard has the socket it leaves this
+// engine.  Same exception barrier as the inline accept (#2018).
+//
+void GanlAdapter::accept_to_shard(ganl::ConnectionHandle handle, const ListenerContext& listenerCtx,
+                                  const ganl::NetworkAddress& remoteAddress, bool useTls)
+{
+    try
+    {
+        connection_listener_map_[handle] = listenerCtx;
+        pending_remote_addresses_[handle] = remoteAddress;
+        pending_tls_flags_[handle] = useTls;
+        handle_to_conn_[handle] = nullptr;
+
+        if (ganl::InvalidSessionId == sessionManager_->onConnectionOpen(handle,
+                networkEngine_->getRemoteAddress(handle))) {
+            accept_cleanup_contained(handle);
+            return;
+        }
+        connections_accepted_++;
+
+        if (!ioShards_->adopt(handle, useTls)) {
+            g_pILog->WriteString(tprintf(
+                T("GANL: could not hand handle %llu to an I/O thread; dropping the connection.\n"),
+                static_cast<unsigned long long>(handle)));
+            sessionManager_->onConnectionClose(static_cast<ganl::SessionId>(handle),
+                ganl::DisconnectReason::NetworkError);
+            networkEngine_->closeConnection(handle);
+            return;
+        }
+        networkEngine_->detachConnection(handle);
+    }
+    catch (const std::exception &e)
+    {
+        g_pILog->WriteString(tprintf(
+            T("GANL: exception accepting handle %llu (%s); dropping the connection.\n"),
+            static_cast<unsigned long long>(handle), e.what()));
+        accept_cleanup_contained(handle);
+    }
+    catch (...)
+    {
+        g_pILog->WriteString(tprintf(
+            T("GANL: unknown exception accepting handle %llu; dropping the connection.\n"),
+            static_cast<unsigned long long>(handle)));
+        accept_cleanup_contained(handle);
+    }
+}
+
+// Bucket i counts main loop phases that took [2^i, 2^(i+1)) microseconds;
+// the first bucket also takes anything shorter and the last anything longer.
+//
+static void record_loop_time(uint64_t* hist, const CLinearTimeDelta& ltd)
+{
+    const UnderlyingTickType us = ltd.ReturnMicroseconds();
+    int i = 0;
+    while (  i < GanlAdapter::LOOP_HIST_BUCKETS - 1
+          && (static_cast<UnderlyingTickType>(2) << i) <= us)
+    {
+        i++;
+    }
+    hist[i]++;
+}
+
+// Hand one processEvents batch to the DNS slave, email channel, listener,
+// and Connection objects.
+//
+void GanlAdapter::dispatch_network_events(ganl::IoEvent* events, int num_events,
+                                         unsigned int avail_descriptors) {
+    for (int i = 0; i < num_events; ++i) {
+        if (dns_slave_ && (events[i].connection == dns_slave_->handle || events[i].context == dns_slave_.get())) {
+            handle_dns_slave_event(events[i]);
+            continue;
+        }
+
+        if (email_channel_ && (events[i].connection == email_channel_->handle || events[i].context == email_channel_.get())) {
+            handle_email_channel_event(events[i]);
+            continue;
+        }
+
+        if (  tlsWakeHandle_ != ganl::InvalidConnectionHandle
+           && (events[i].connection == tlsWakeHandle_ || events[i].context == &tlsWakeHandle_)) {
+            drain_tls_wake_pipe();
+            continue;
+        }
+
+        if (  ioWakeHandle_ != ganl::InvalidConnectionHandle
+           && (events[i].connection == ioWakeHandle_ || events[i].context == &ioWakeHandle_)) {
+            drain_io_wake_pipe();
+            continue;
+        }
+
+        if (events[i].type == ganl::IoEventType::Accept) {
+            ganl::ConnectionHandle connHandle = events[i].connection;
+            if (connHandle != ganl::InvalidConnectionHandle) {
+
+                // Reject if we've exhausted available descriptors.
+                //
+                if (g_descriptors_list.size() >= avail_descriptors)
+                {
+                    STARTLOG(LOG_NET, "NET", "FULL");
+                    g_pILog->WriteString(tprintf(T("%.90s"), T("Descriptor limit reached, rejecting connection.")));
+                    ENDLOG;
+                    networkEngine_->closeConnection(connHandle);
+                    continue;
+                }
+
+                ListenerContext listenerCtx{0, false};
+                bool useTls = false;
+                if (events[i].context) {
+                    auto* ctx = static_cast<ListenerContext*>(events[i].context);
+                    listenerCtx = *ctx;
+                    useTls = ctx->is_ssl;
+                }
+
+                if (ioShards_) {
+                    accept_to_shard(connHandle, listenerCtx, events[i].remoteAddress, useTls);
+                    continue;
+                }
+
+                // Exception barrier (#2018).  Everything from here to the
+                // end of the accept allocates: createConnection is a
+                // make_shared, the four map insertions allocate nodes (one
+                // copying a std::string), and initialize() reaches
+                // onConnectionOpen -> allocate_desc -> init_desc.  This is
+                // the accept branch of run_main_loop, and unlike the
+                // established-connection branch below it had no handler --
+                // nor does anything above it, since run_main_loop <-
+                // ganl_main_loop <- driver.cpp has no catch.  A throw here
+                // reached std::terminate.
+                //
+                // Demonstrated by injecting a one-shot bad_alloc in
+                // init_desc: inside the first 15s the game died and stayed
+                // dead, and past that window it took the #2012 SIGABRT arm
+                // and re-execed -- surviving, but dropping every session
+                // for one bad accept.  Contain it to the one connection.
+                //
+                // Cleanup mirrors the initialize()-failed path below: erase
+                // whichever of the four maps got populated (erase of an
+                // absent key is a no-op, so this is correct wherever the
+                // throw landed) and close the fd, which is otherwise leaked
+                // because onConnectionClose never runs for a connection
+                // that never opened.
+                //
+                try
+                {
+                    std::shared_ptr<ganl::ConnectionBase> conn = ganl::ConnectionFactory::createConnection(
+                        connHandle,
+                        *networkEngine_,
+                        secureTransport_.get(),
+                        *protocolHandler_,
+                        *sessionManager_);
+
+                    if (!conn) {
+                        g_pILog->WriteString(tprintf(T("GANL: Failed to allocate ConnectionBase for handle %llu\n"),
+                            static_cast<unsigned long long>(connHandle)));
+                        networkEngine_->closeConnection(connHandle);
+                        continue;
+                    }
+
+                    connection_listener_map_[connHandle] = listenerCtx;
+                    pending_remote_addresses_[connHandle] = events[i].remoteAddress;
+                    pending_tls_flags_[connHandle] = useTls;
+                    handle_to_conn_[connHandle] = conn;
+
+                    // Count only connections that fully initialize.  Failed
+                    // init closes the fd itself and never reaches
+                    // onConnectionClose, so accepting first would permanently
+                    // inflate NET/STAT live = accepted - closed.
+                    if (useTls) {
+                        conn->setTlsWorkerPool(tlsWorkers_.get());
+                    }
+                    if (!conn->initialize(useTls)) {
+                        handle_to_conn_.erase(connHandle);
+                        connection_listener_map_.erase(connHandle);
+                        pending_remote_addresses_.erase(connHandle);
+                        pending_tls_flags_.erase(connHandle);
+                    } else {
+                        connections_accepted_++;
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    g_pILog->WriteString(tprintf(
+                        T("GANL: exception accepting handle %llu (%s); dropping the connection.\n"),
+                        static_cast<unsigned long long>(connHandle), e.what()));
+                    accept_cleanup_contained(connHandle);
+                }
+                catch (...)
+                {
+                    g_pILog->WriteString(tprintf(
+                        T("GANL: unknown exception accepting handle %llu; dropping the connection.\n"),
+                        static_cast<unsigned long long>(connHandle)));
+                    accept_cleanup_contained(connHandle);
+                }
+            }
+            continue;
+        }
+        else if (events[i].connection != ganl::InvalidConnectionHandle) {
+            std::shared_ptr<ganl::ConnectionBase> conn = nullptr;
+            auto it = handle_to_conn_.find(events[i].connection);
+            if (it != handle_to_conn_.end()) {
+                conn = it->second; // Get the shared_ptr
+            }
+            if (conn) {
+                // Event context should be the ConnectionBase* itself
+                if (events[i].context == conn.get()) {
+                    // Exception barrier (#794).  A throw from the per-
+                    // connection I/O path (IoBuffer accounting throws
+                    // out_of_range, ensureWritable's resize throws
+                    // bad_alloc, ...) must be contained to this connection,
+                    // not abort the whole server.  Unlike send_data, it IS
+                    // safe to close here: conn is a local shared_ptr that
+                    // outlives close(), and we touch neither conn nor
+                    // events[i] afterward.
+                    try {
+                        conn->handleNetworkEvent(events[i]);
+                    } catch (const std::exception& e) {
+                        g_pILog->WriteString(tprintf(
+                            T("GANL: exception in event handler for handle %llu (%s); closing.\n"),
+                            static_cast<unsigned long long>(events[i].connection), e.what()));
+                        close_contained(conn, static_cast<unsigned long long>(events[i].connection));
+                    } catch (...) {
+                        g_pILog->WriteString(tprintf(
+                            T("GANL: unknown exception in event handler for handle %llu; closing.\n"),
+                            static_cast<unsigned long long>(events[i].connection)));
+                        close_contained(conn, static_cast<unsigned long long>(events[i].connection));
+                    }
+                }
+                else {
+                    g_pILog->WriteString(tprintf(T("GANL: Mismatched context for event on handle %llu\n"),
+                        static_cast<unsigned long long>(events[i].connection)));
+                }
+            }
+        }
+        else if (events[i].listener != ganl::InvalidListenerHandle
+              && events[i].type == ganl::IoEventType::Error)
+        {
+            // A listener experienced an error (e.g., failed accept).
+            // The network engines re-arm the listener internally, so
+            // we just log the event for diagnostics.
+            //
+            int port = 0;
+            bool isSsl = false;
+            auto ctxIt = listener_contexts_.find(events[i].listener);
+            if (ctxIt != listener_contexts_.end()) {
+                port = ctxIt->second.port;
+                isSsl = ctxIt->second.is_ssl;
+            }
+
+            STARTLOG(LOG_NET, "NET", "LERR");
+            g_pILog->WriteString(tprintf(T("Listener error on %sport %d (handle %llu): error %d"),
+                isSsl ? T("SSL ") : T(""),
+                port,
+                static_cast<unsigned long long>(events[i].listener),
+                events[i].error));
+            ENDLOG;
+        }
+    }
+}
+
 void GanlAdapter::run_main_loop() {
     g_pILog->WriteString(T("GANL: Entering main loop.\n"));
     g_pILog->Flush();
@@ -2517,188 +2904,69 @@ void GanlAdapter::run_main_loop() {
         }
 
         // Process Network Events
+        //
+        // Read every ready connection before running any commands: when a
+        // poll fills the event array, poll again without waiting rather than
+        // interleaving command execution with the rest of the ready set.
+        // A connection that hits ReadinessConnection's per-event read budget
+        // is re-armed, so it comes back from a later zero-timeout poll in
+        // this same batch, behind the rest of the ready set.  Stop early once
+        // loop_bytes_in_ passes the budget; whatever is left over is
+        // reported again on the next pass.
+        //
         constexpr int MAX_EVENTS_PER_CALL = 64;
+        constexpr int MAX_POLLS_PER_LOOP = 16;
+        constexpr size_t MAX_BYTES_PER_LOOP = 1024 * 1024;
         ganl::IoEvent events[MAX_EVENTS_PER_CALL];
-        int num_events = networkEngine_->processEvents(timeout_ms, events, MAX_EVENTS_PER_CALL);
-
-        if (num_events < 0) {
-            g_pILog->WriteString(T("GANL: Network engine processEvents error. Shutting down.\n"));
-            g_shutdown_flag = 1;
-            break;
-        }
-
-        // Dispatch network events to Connection objects
-        for (int i = 0; i < num_events; ++i) {
-            if (dns_slave_ && (events[i].connection == dns_slave_->handle || events[i].context == dns_slave_.get())) {
-                handle_dns_slave_event(events[i]);
-                continue;
+        CLinearTimeAbsolute ltaIoStart;
+        bool bPollError = false;
+        loop_bytes_in_ = 0;
+        for (int nPoll = 0; nPoll < MAX_POLLS_PER_LOOP; ++nPoll) {
+            int num_events = networkEngine_->processEvents((0 == nPoll) ? timeout_ms : 0,
+                events, MAX_EVENTS_PER_CALL);
+            if (0 == nPoll) {
+                ltaIoStart.GetUTC();
             }
 
-            if (email_channel_ && (events[i].connection == email_channel_->handle || events[i].context == email_channel_.get())) {
-                handle_email_channel_event(events[i]);
-                continue;
+            if (num_events < 0) {
+                bPollError = true;
+                break;
             }
 
-            if (events[i].type == ganl::IoEventType::Accept) {
-                ganl::ConnectionHandle connHandle = events[i].connection;
-                if (connHandle != ganl::InvalidConnectionHandle) {
-
-                    // Reject if we've exhausted available descriptors.
-                    //
-                    if (g_descriptors_list.size() >= avail_descriptors)
-                    {
-                        STARTLOG(LOG_NET, "NET", "FULL");
-                        g_pILog->WriteString(tprintf(T("%.90s"), T("Descriptor limit reached, rejecting connection.")));
-                        ENDLOG;
-                        networkEngine_->closeConnection(connHandle);
-                        continue;
-                    }
-
-                    ListenerContext listenerCtx{0, false};
-                    bool useTls = false;
-                    if (events[i].context) {
-                        auto* ctx = static_cast<ListenerContext*>(events[i].context);
-                        listenerCtx = *ctx;
-                        useTls = ctx->is_ssl;
-                    }
+            dispatch_network_events(events, num_events, avail_descriptors);
 
-                    // Exception barrier (#2018).  Everything from here to the
-                    // end of the accept allocates: createConnection is a
-                    // make_shared, the four map insertions allocate nodes (one
-                    // copying a std::string), and initialize() reaches
-                    // onConnectionOpen -> allocate_desc -> init_desc.  This is
-                    // the accept branch of run_main_loop, and unlike the
-                    // established-connection branch below it had no handler --
-                    // nor does anything above it, since run_main_loop <-
-                    // ganl_main_loop <- driver.cpp has no catch.  A throw here
-                    // reached std::terminate.
-                    //
-                    // Demonstrated by injecting a one-shot bad_alloc in
-                    // init_desc: inside the first 15s the game died and stayed
-                    // dead, and past that window it took the #2012 SIGABRT arm
-                    // and re-execed -- surviving, but dropping every session
-                    // for one bad accept.  Contain it to the one connection.
-                    //
-                    // Cleanup mirrors the initialize()-failed path below: erase
-                    // whichever of the four maps got populated (erase of an
-                    // absent key is a no-op, so this is correct wherever the
-                    // throw landed) and close the fd, which is otherwise leaked
-                    // because onConnectionClose never runs for a connection
-                    // that never opened.
-                    //
-                    try
-                    {
-                        std::shared_ptr<ganl::ConnectionBase> conn = ganl::ConnectionFactory::createConnection(
-                            connHandle,
-                            *networkEngine_,
-                            secureTransport_.get(),
-                            *protocolHandler_,
-                            *sessionManager_);
-
-                        if (!conn) {
-                            g_pILog->WriteString(tprintf(T("GANL: Failed to allocate ConnectionBase for handle %llu\n"),
-                                static_cast<unsigned long long>(connHandle)));
-                            networkEngine_->closeConnection(connHandle);
-                            continue;
-                        }
-
-                        connection_listener_map_[connHandle] = listenerCtx;
-                        pending_remote_addresses_[connHandle] = events[i].remoteAddress;
-                        pending_tls_flags_[connHandle] = useTls;
-                        handle_to_conn_[connHandle] = conn;
-
-                        // Count only connections that fully initialize.  Failed
-                        // init closes the fd itself and never reaches
-                        // onConnectionClose, so accepting first would permanently
-                        // inflate NET/STAT live = accepted - closed.
-                        if (!conn->initialize(useTls)) {
-                            handle_to_conn_.erase(connHandle);
-                            connection_listener_map_.erase(connHandle);
-                            pending_remote_addresses_.erase(connHandle);
-                            pending_tls_flags_.erase(connHandle);
-                        } else {
-                            connections_accepted_++;
-                        }
-                    }
-                    catch (const std::exception &e)
-                    {
-                        g_pILog->WriteString(tprintf(
-                            T("GANL: exception accepting handle %llu (%s); dropping the connection.\n"),
-                            static_cast<unsigned long long>(connHandle), e.what()));
-                        accept_cleanup_contained(connHandle);
-                    }
-                    catch (...)
-                    {
-                        g_pILog->WriteString(tprintf(
-                            T("GANL: unknown exception accepting handle %llu; dropping the connection.\n"),
-                            static_cast<unsigned long long>(connHandle)));
-                        accept_cleanup_contained(connHandle);
-                    }
-                }
-                continue;
+            if (num_events < MAX_EVENTS_PER_CALL) {
+                break;
             }
-            else if (events[i].connection != ganl::InvalidConnectionHandle) {
-                std::shared_ptr<ganl::ConnectionBase> conn = nullptr;
-                auto it = handle_to_conn_.find(events[i].connection);
-                if (it != handle_to_conn_.end()) {
-                    conn = it->second; // Get the shared_ptr
-                }
-                if (conn) {
-                    // Event context should be the ConnectionBase* itself
-                    if (events[i].context == conn.get()) {
-                        // Exception barrier (#794).  A throw from the per-
-                        // connection I/O path (IoBuffer accounting throws
-                        // out_of_range, ensureWritable's resize throws
-                        // bad_alloc, ...) must be contained to this connection,
-                        // not abort the whole server.  Unlike send_data, it IS
-                        // safe to close here: conn is a local shared_ptr that
-                        // outlives close(), and we touch neither conn nor
-                        // events[i] afterward.
-                        try {
-                            conn->handleNetworkEvent(events[i]);
-                        } catch (const std::exception& e) {
-                            g_pILog->WriteString(tprintf(
-                                T("GANL: exception in event handler for handle %llu (%s); closing.\n"),
-                                static_cast<unsigned long long>(events[i].connection), e.what()));
-                            close_contained(conn, static_cast<unsigned long long>(events[i].connection));
-                        } catch (...) {
-                            g_pILog->WriteString(tprintf(
-                                T("GANL: unknown exception in event handler for handle %llu; closing.\n"),
-                                static_cast<unsigned long long>(events[i].connection)));
-                            close_contained(conn, static_cast<unsigned long long>(events[i].connection));
-                        }
-                    }
-                    else {
-                        g_pILog->WriteString(tprintf(T("GANL: Mismatched context for event on handle %llu\n"),
-                            static_cast<unsigned long long>(events[i].connection)));
-                    }
-                }
+            if (MAX_BYTES_PER_LOOP <= loop_bytes_in_) {
+                loop_budget_stops_++;
+                break;
             }
-            else if (events[i].listener != ganl::InvalidListenerHandle
-                  && events[i].type == ganl::IoEventType::Error)
-            {
-                // A listener experienced an error (e.g., failed accept).
-                // The network engines re-arm the listener internally, so
-                // we just log the event for diagnostics.
-                //
-                int port = 0;
-                bool isSsl = false;
-                auto ctxIt = listener_contexts_.find(events[i].listener);
-                if (ctxIt != listener_contexts_.end()) {
-                    port = ctxIt->second.port;
-                    isSsl = ctxIt->second.is_ssl;
-                }
+        }
 
-                STARTLOG(LOG_NET, "NET", "LERR");
-                g_pILog->WriteString(tprintf(T("Listener error on %sport %d (handle %llu): error %d"),
-                    isSsl ? T("SSL ") : T(""),
-                    port,
-                    static_cast<unsigned long long>(events[i].listener),
-                    events[i].error));
-                ENDLOG;
-            }
+        // Hand TLS worker results to their connections: decrypted input
+        // joins what the poll just read, and new records go to the socket.
+        //
+        if (tlsWorkers_) {
+            tlsWorkers_->runCompletions();
+        }
+
+        // Bytes the I/O shards read, and connections they saw close.
+        //
+        if (ioShards_) {
+            ioShards_->runCompletions(*sessionManager_);
         }
 
+        if (bPollError) {
+            g_pILog->WriteString(T("GANL: Network engine processEvents error. Shutting down.\n"));
+            g_shutdown_flag = 1;
+            break;
+        }
+
+        CLinearTimeAbsolute ltaTaskStart;
+        ltaTaskStart.GetUTC();
+        record_loop_time(loop_io_hist_, ltaTaskStart - ltaIoStart);
+
         // ---------------------------------------------------------------
         // Deferred signal processing — safe context, not a signal handler.
         // ---------------------------------------------------------------
@@ -2796,6 +3064,10 @@ void GanlAdapter::run_main_loop() {
         // Process TinyMUX Tasks (Timers, Idle, Quotas, etc.)
         process_tinyMUX_tasks();
 
+        CLinearTimeAbsolute ltaTaskEnd;
+        ltaTaskEnd.GetUTC();
+        record_loop_time(loop_task_hist_, ltaTaskEnd - ltaTaskStart);
+
     } // end while (!g_shutdown_flag)
 
     // Shutdown broadcast — deferred from signal handler to safe context.
@@ -2847,6 +3119,7 @@ static long count_open_fds()
 //   osfds >> conn_map   -> fds leaked below the engine (unclosed sockets)
 //   conn_map >> descs   -> engine connections never reaped into DESCs
 //   accepted-closed >> descs -> close callback not firing
+// A NET/LOOP line follows with the main loop timing histograms.
 void GanlAdapter::log_socket_stats(bool force)
 {
     static CLinearTimeAbsolute lta_last;
@@ -2881,6 +3154,27 @@ void GanlAdapter::log_socket_stats(bool force)
         live,
         osfds));
     ENDLOG;
+
+    // Main loop phase times since startup: counts per log2 microsecond
+    // bucket, <2us first and >=32ms last.
+    //
+    std::string io_hist;
+    std::string task_hist;
+    for (int i = 0; i < LOOP_HIST_BUCKETS; i++)
+    {
+        io_hist += (0 == i) ? "" : " ";
+        io_hist += std::to_string(loop_io_hist_[i]);
+        task_hist += (0 == i) ? "" : " ";
+        task_hist += std::to_string(loop_task_hist_[i]);
+    }
+
+    STARTLOG(LOG_NET, "NET", "LOOP");
+    g_pILog->WriteString(tprintf(
+        T("loop io_us=[%s] task_us=[%s] budget_stops=%llu"),
+        io_hist.c_str(),
+        task_hist.c_str(),
+        static_cast<unsigned long long>(loop_budget_stops_)));
+    ENDLOG;
 }
 
 // Helper to run periodic TinyMUX tasks (quotas, scheduler, output flush).
@@ -2900,8 +3194,11 @@ void GanlAdapter::process_tinyMUX_tasks() {
         auto it = pending_finalizations_.begin();
         while (it != pending_finalizations_.end()) {
             auto connIt = handle_to_conn_.find(it->handle);
-            if (connIt != handle_to_conn_.end() && connIt->second &&
-                connIt->second->getState() == ganl::ConnectionState::Running) {
+            const bool bRunning = (connIt != handle_to_conn_.end())
+                && (connIt->second
+                    ? connIt->second->getState() == ganl::ConnectionState::Running
+                    : (ioShards_ && ioShards_->isRunning(it->handle)));
+            if (bRunning) {
                 ready.push_back(*it);
                 it = pending_finalizations_.erase(it);
             } else if (connIt == handle_to_conn_.end()) {
@@ -3082,6 +3379,233 @@ void GanlAdapter::process_tinyMUX_tasks() {
 }
 
 
+#if !defined(_WIN32)
+// A channel a worker thread writes a byte to so that the main loop's poll
+// returns.  Both ends are non-blocking, so a worker never waits on a full
+// pipe (a full pipe means a wake is already pending), and CLOEXEC, so
+// neither end follows an @restart exec.  The read end is adopted into the
+// engine with the given context.  Returns its handle, or
+// InvalidConnectionHandle after logging why not.
+//
+static ganl::ConnectionHandle open_wake_channel(ganl::NetworkEngine& engine,
+    void* context, int& writeFd, const char* who)
+{
+    int sv[2] = {-1, -1};
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        g_pILog->WriteString(tprintf(T("GANL: %s not started: socketpair: %s\n"), who, strerror(errno)));
+        return ganl::InvalidConnectionHandle;
+    }
+    for (int fd : sv) {
+        const int fl = fcntl(fd, F_GETFL, 0);
+        const int fdflags = fcntl(fd, F_GETFD, 0);
+        if (  fl < 0
+           || fcntl(fd, F_SETFL, fl | O_NONBLOCK) < 0
+           || fdflags < 0
+           || fcntl(fd, F_SETFD, fdflags | FD_CLOEXEC) < 0) {
+            g_pILog->WriteString(tprintf(T("GANL: %s not started: fcntl: %s\n"), who, strerror(errno)));
+            close(sv[0]);
+            close(sv[1]);
+            return ganl::InvalidConnectionHandle;
+        }
+    }
+
+    ganl::ErrorCode error = 0;
+    ganl::ConnectionHandle handle = engine.adoptConnection(sv[0], context, error);
+    if (handle == ganl::InvalidConnectionHandle) {
+        g_pILog->WriteString(tprintf(T("GANL: %s not started: %s\n"), who,
+            engine.getErrorString(error).c_str()));
+        close(sv[0]);
+        close(sv[1]);
+        return ganl::InvalidConnectionHandle;
+    }
+    writeFd = sv[1];
+    return handle;
+}
+
+static void ring_wake_channel(int writeFd)
+{
+    const char ch = 0;
+    ssize_t n;
+    do {
+        n = write(writeFd, &ch, 1);
+    } while (n < 0 && EINTR == errno);
+}
+
+static void drain_wake_channel(ganl::ConnectionHandle handle)
+{
+    char buf[256];
+    for (;;) {
+        const ssize_t n = read(static_cast<int>(handle), buf, sizeof(buf));
+        if (0 < n) {
+            continue;
+        }
+        if (n < 0 && EINTR == errno) {
+            continue;
+        }
+        break;
+    }
+}
+#endif // !_WIN32
+
+// Start the TLS worker pool named by tls_workers.  Any failure leaves TLS on
+// the main thread, which is how it always ran.
+void GanlAdapter::start_tls_workers() {
+#if defined(_WIN32)
+    return;
+#else
+    constexpr int MAX_TLS_WORKERS = 64;
+    if (!secureTransport_ || !networkEngine_ || tlsWorkers_ || g_dc.tls_workers <= 0) {
+        return;
+    }
+    const int nThreads = (MAX_TLS_WORKERS < g_dc.tls_workers) ? MAX_TLS_WORKERS : g_dc.tls_workers;
+
+    int wakeFd = -1;
+    ganl::ConnectionHandle handle = open_wake_channel(*networkEngine_, &tlsWakeHandle_, wakeFd, "TLS workers");
+    if (handle == ganl::InvalidConnectionHandle) {
+        return;
+    }
+
+    auto pool = std::make_unique<ganl::TlsWorkerPool>(*secureTransport_, [wakeFd]() {
+        ring_wake_channel(wakeFd);
+    });
+    if (!pool->start(nThreads)) {
+        g_pILog->WriteString(T("GANL: TLS workers not started: no thread could be created.\n"));
+        networkEngine_->closeConnection(handle);
+        close(wakeFd);
+        return;
+    }
+
+    tlsWakeHandle_ = handle;
+    tlsWakeWriteFd_ = wakeFd;
+    tlsWorkers_ = std::move(pool);
+    g_pILog->WriteString(tprintf(T("GANL: %d TLS worker threads started.\n"), nThreads));
+#endif
+}
+
+// Wait for the workers to finish what has been submitted, and hand the
+// results to their connections.  Shutdown and @restart call this so output
+// queued on a worker reaches the socket before the last flush.
+//
+void GanlAdapter::flush_tls_workers() {
+    if (tlsWorkers_) {
+        tlsWorkers_->waitIdle();
+        tlsWorkers_->runCompletions();
+    }
+}
+
+// Join the workers and close the wake channel.  The pool object stays until
+// the adapter goes, because connections that outlive this still detach from
+// it on their way out.
+//
+void GanlAdapter::stop_tls_workers() {
+    if (!tlsWorkers_) {
+        return;
+    }
+    tlsWorkers_->stop();
+
+#if !defined(_WIN32)
+    if (networkEngine_ && tlsWakeHandle_ != ganl::InvalidConnectionHandle) {
+        networkEngine_->closeConnection(tlsWakeHandle_);
+    }
+    tlsWakeHandle_ = ganl::InvalidConnectionHandle;
+    if (0 <= tlsWakeWriteFd_) {
+        close(tlsWakeWriteFd_);
+        tlsWakeWriteFd_ = -1;
+    }
+#endif
+}
+
+void GanlAdapter::drain_tls_wake_pipe() {
+#if !defined(_WIN32)
+    drain_wake_channel(tlsWakeHandle_);
+#endif
+}
+
+// Start the socket I/O threads named by io_threads.  Any failure leaves
+// socket I/O on the main thread.
+void GanlAdapter::start_io_shards(ganl::NetworkEngineType engineType) {
+#if defined(_WIN32)
+    UNUSED_PARAMETER(engineType);
+    return;
+#else
+    constexpr int MAX_IO_THREADS = 64;
+    if (!networkEngine_ || !protocolHandler_ || ioShards_ || g_dc.io_threads <= 0) {
+        return;
+    }
+    const int nThreads = (MAX_IO_THREADS < g_dc.io_threads) ? MAX_IO_THREADS : g_dc.io_threads;
+
+    if (!ganl::NetworkEngineFactory::supportsConnectionAdoption(engineType)) {
+        g_pILog->WriteString(T("GANL: I/O threads not started: this network engine cannot hand off sockets.\n"));
+        return;
+    }
+
+    int wakeFd = -1;
+    ganl::ConnectionHandle handle = open_wake_channel(*networkEngine_, &ioWakeHandle_, wakeFd, "I/O threads");
+    if (handle == ganl::InvalidConnectionHandle) {
+        return;
+    }
+
+    auto pool = std::make_unique<ganl::IoShardPool>(engineType, secureTransport_.get(),
+        *protocolHandler_, [wakeFd]() {
+            ring_wake_channel(wakeFd);
+        });
+    const int nStarted = pool->start(nThreads);
+    if (nStarted <= 0) {
+        g_pILog->WriteString(T("GANL: I/O threads not started: an I/O thread could not be set up.\n"));
+        networkEngine_->closeConnection(handle);
+        close(wakeFd);
+        return;
+    }
+
+    ioWakeHandle_ = handle;
+    ioWakeWriteFd_ = wakeFd;
+    ioShards_ = std::move(pool);
+    g_pILog->WriteString(tprintf(T("GANL: %d I/O threads started.\n"), nStarted));
+#endif
+}
+
+void GanlAdapter::drain_io_wake_pipe() {
+#if !defined(_WIN32)
+    drain_wake_channel(ioWakeHandle_);
+#endif
+}
+
+// Wait for the shards to apply everything queued to them (sends reach the
+// socket or the connection's buffer), and deliver what they posted.
+//
+void GanlAdapter::flush_io_shards() {
+    if (ioShards_) {
+        ioShards_->waitIdle();
+        ioShards_->runCompletions(*sessionManager_);
+    }
+}
+
+// Close what the shards still run, join them, and deliver the closes, which
+// frees their DESCs.  After an @restart's releaseAll() there is nothing left
+// to close.
+//
+void GanlAdapter::stop_io_shards() {
+    if (!ioShards_) {
+        return;
+    }
+    ioShards_->stop();
+    if (sessionManager_) {
+        ioShards_->runCompletions(*sessionManager_);
+    }
+    ioShards_.reset();
+
+#if !defined(_WIN32)
+    if (networkEngine_ && ioWakeHandle_ != ganl::InvalidConnectionHandle) {
+        networkEngine_->closeConnection(ioWakeHandle_);
+    }
+    ioWakeHandle_ = ganl::InvalidConnectionHandle;
+    if (0 <= ioWakeWriteFd_) {
+        close(ioWakeWriteFd_);
+        ioWakeWriteFd_ = -1;
+    }
+#endif
+}
+
 bool GanlAdapter::start_dns_slave() {
 #if defined(_WIN32)
     if (!g_dc.use_hostname) {
@@ -4253,8 +4777,19 @@ MUX_RESULT GanlAdapter::pump_stubslave()
 
 void GanlAdapter::send_data(DESC* d, const char* data, size_t len) {
     if (!d) return;
+    send_data(d, std::make_shared<const std::string>(data, len));
+}
+
+// Hand one output_queue entry to the connection.  On a plaintext socket the
+// connection keeps a reference to the segment and writes it from there, so
+// the text is not copied again between queue_string() and the kernel.
+//
+void GanlAdapter::send_data(DESC* d, const ganl::OutputSegment& segment) {
+    if (!d) return;
+    const size_t len = segment->size();
     std::shared_ptr<ganl::ConnectionBase> conn = get_connection(d);
-    if (!conn) {
+    const bool bShard = !conn && ioShards_ && ioShards_->owns(get_handle(d));
+    if (!conn && !bShard) {
         return;
     }
 
@@ -4265,7 +4800,7 @@ void GanlAdapter::send_data(DESC* d, const char* data, size_t len) {
     // (the map release is what triggers ~ConnectionBase), so this never fires;
     // it future-proofs the chokepoint against an ownership change that keeps the
     // object reachable while it is being destroyed.
-    if (conn->isTearingDown()) {
+    if (conn && conn->isTearingDown()) {
         return;
     }
 
@@ -4290,7 +4825,10 @@ void GanlAdapter::send_data(DESC* d, const char* data, size_t len) {
         : static_cast<size_t>(2 * LBUF_SIZE);
     const size_t backlogLimit = std::max<size_t>(perFlush * 16,
                                                  static_cast<size_t>(1) << 20);
-    if (conn->pendingOutputBytes() + len > backlogLimit) {
+    const size_t pending = bShard
+        ? ioShards_->pendingOutputBytes(get_handle(d))
+        : conn->pendingOutputBytes();
+    if (pending + len > backlogLimit) {
         d->output_lost += len;
         return;
     }
@@ -4301,7 +4839,11 @@ void GanlAdapter::send_data(DESC* d, const char* data, size_t len) {
     // process_output), so drop the write and let the idle/write-error paths
     // reap the connection; the high-water mark above keeps memory bounded.
     try {
-        conn->sendDataToClient(std::string(data, len));
+        if (bShard) {
+            ioShards_->send(get_handle(d), segment);
+        } else {
+            conn->sendDataToClient(segment);
+        }
     } catch (const std::exception& e) {
         d->output_lost += len;
         g_pILog->WriteString(tprintf(T("GANL: send dropped on handle %llu (%s)\n"),
@@ -4320,6 +4862,14 @@ void GanlAdapter::close_connection(DESC* d, ganl::DisconnectReason reason) {
         // Note: Connection::close() might trigger SessionManager::onConnectionClose
         // which can lead to remove_mapping and free_desc being called.
     }
+    else if (ioShards_ && ioShards_->owns(get_handle(d))) {
+        // The shard closes the socket once this last output is written, and
+        // the DESC is torn down when its Closed comes back through
+        // runCompletions().
+        //
+        process_output(d, false);
+        ioShards_->close(get_handle(d), reason);
+    }
     else {
         const CLinearTimeAbsolute ltaNow = [&]() {
             CLinearTimeAbsolute tmp; tmp.GetUTC(); return tmp;
@@ -4361,6 +4911,7 @@ void GanlAdapter::close_connection(DESC* d, ganl::DisconnectReason reason) {
             d->flags &= ~DS_CONNECTED;
         }
         drv_CancelTask(Task_ProcessCommand, d, 0);
+        cancel_pending_login(d);
 
         // This branch frees a DESC that GANL has no live connection for.
         // Mirror onConnectionClose's teardown so the freed pointer cannot
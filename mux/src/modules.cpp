@@ -231,6 +231,8 @@ public:
     virtual MUX_RESULT SendText(dbref target, const UTF8 *text);
     virtual MUX_RESULT SendRaw(dbref target, const UTF8 *data, size_t len);
     virtual MUX_RESULT BroadcastAndFlush(int inflags, const UTF8 *text);
+    virtual MUX_RESULT BeginBroadcast(void);
+    virtual MUX_RESULT EndBroadcast(void);
     virtual MUX_RESULT SendProgPrompt(dbref target);
     virtual MUX_RESULT SendKeepaliveNops(void);
     virtual MUX_RESULT SendGmcp(dbref target, const UTF8 *pkg, const UTF8 *json);
@@ -423,6 +425,18 @@ MUX_RESULT CConnectionManager::BroadcastAndFlush(int inflags, const UTF8 *text)
     return MUX_S_OK;
 }
 
+MUX_RESULT CConnectionManager::BeginBroadcast(void)
+{
+    begin_broadcast();
+    return MUX_S_OK;
+}
+
+MUX_RESULT CConnectionManager::EndBroadcast(void)
+{
+    end_broadcast();
+    return MUX_S_OK;
+}
+
 MUX_RESULT CConnectionManager::SendProgPrompt(dbref target)
 {
     send_prog_prompt(target);
@@ -16,6 +16,7 @@
 #include "modules.h"
 #include "driverstate.h"
 #include "driver_log.h"
+#include "eventlog.h"
 #include "driver_bridge.h"
 #include "ganl_adapter.h"
 #include "mux_table.h"
@@ -97,18 +98,79 @@ void clearstrings(DESC *d)
  * This is private, lower-level helper function for adding a buffer to the
  * output queue. Unlike queue_write_LEN(), it does not attempt to control or
  * manage the output side of the network layer. It only changes the output
- * queue to include the requested buffer.  The only function that should
- * call this function is queue_write_LEN().
+ * queue to include the requested buffer.  Callers are queue_write_LEN() and
+ * queue_string(), after make_room_in_output_queue().
+ *
+ * The segment is shared rather than copied: process_output() hands the same
+ * string to the network layer, which writes it to the socket from there.
  *
  * \param d         Network descriptor state.
- * \param b         buffer to add to the output queue.
- * \param n         Number of bytes in buffer, b, to add to the output queue.
+ * \param segment   Text to add to the output queue.
+ * \param nPayload  Bytes of the segment that count toward output_tot
+ *                  (less than its size when it carries WebSocket framing).
  * \return          None.
  */
 
-static void add_to_output_queue(DESC *d, const UTF8 *b, size_t n)
+static void add_to_output_queue(DESC *d, std::shared_ptr<const std::string> segment,
+    size_t nPayload)
 {
-    d->output_queue.emplace_back(reinterpret_cast<const char *>(b), n);
+    const size_t n = segment->size();
+    d->output_queue.emplace_back(std::move(segment));
+    d->output_size += n;
+    d->output_tot += nPayload;
+}
+
+/*! \brief Make room in the output queue for another n bytes.
+ *
+ * If the output queue has grown past output_limit, it is flushed into GANL's
+ * internal buffers first.  With GANL, process_output() always fully drains
+ * the queue, so this is never unproductive.  Anything still in the way is
+ * discarded, oldest first.
+ *
+ * \param d         Network descriptor state.
+ * \param n         Number of bytes about to be queued.
+ * \return          None.
+ */
+
+static void make_room_in_output_queue(DESC *d, size_t n)
+{
+    // #1134: match WS path — output_limit <= 0 means unset/unlimited
+    // (skip drop-oldest).  Casting 0 or negative to size_t was wrong:
+    // 0 forced flush every write; negative became huge and never dropped.
+    //
+    if (g_dc.output_limit <= 0)
+    {
+        return;
+    }
+
+    if (static_cast<size_t>(g_dc.output_limit) < d->output_size + n)
+    {
+        process_output(d, false);
+    }
+
+    while (  static_cast<size_t>(g_dc.output_limit) < d->output_size + n
+          && !d->output_queue.empty())
+    {
+        // Drop the oldest entry to make room.
+        //
+        const size_t nchars = d->output_queue.front()->size();
+
+        STARTLOG(LOG_NET, "NET", "WRITE");
+        UTF8 *buf = alloc_lbuf("queue_write.LOG");
+        mux_sprintf(buf, LBUF_SIZE, T("[%llu/%s] Output buffer overflow, %zu chars discarded by "),
+            static_cast<unsigned long long>(d->socket), d->addr, nchars);
+        g_pILog->log_text(buf);
+        free_lbuf(buf);
+        if (d->flags & DS_CONNECTED)
+        {
+            g_pILog->log_name(d->player);
+        }
+        ENDLOG;
+
+        d->output_size -= nchars;
+        d->output_lost += nchars;
+        d->output_queue.pop_front();
+    }
 }
 
 /*! \brief Add text to the output queue of the indicated network descriptor.
@@ -138,63 +200,35 @@ void queue_write_LEN(DESC *d, const UTF8 *b, size_t n)
         return;
     }
 
-    // If the output queue has grown past output_limit, flush it into GANL's
-    // internal buffers before appending more.  With GANL, process_output()
-    // always fully drains the queue (buffer-to-buffer copy), so this call
-    // is never unproductive.
-    //
-    // #1134: match WS path — output_limit <= 0 means unset/unlimited
-    // (skip drop-oldest).  Casting 0 or negative to size_t was wrong:
-    // 0 forced flush every write; negative became huge and never dropped.
-    //
-    if (g_dc.output_limit > 0)
-    {
-        if (static_cast<size_t>(g_dc.output_limit) < d->output_size + n)
-        {
-            process_output(d, false);
-        }
-
-        while (  static_cast<size_t>(g_dc.output_limit) < d->output_size + n
-              && !d->output_queue.empty())
-        {
-            // Drop the oldest entry to make room.
-            //
-            const size_t nchars = d->output_queue.front().size();
-
-            STARTLOG(LOG_NET, "NET", "WRITE");
-            UTF8 *buf = alloc_lbuf("queue_write.LOG");
-            mux_sprintf(buf, LBUF_SIZE, T("[%llu/%s] Output buffer overflow, %zu chars discarded by "),
-                static_cast<unsigned long long>(d->socket), d->addr, nchars);
-            g_pILog->log_text(buf);
-            free_lbuf(buf);
-            if (d->flags & DS_CONNECTED)
-            {
-                g_pILog->log_name(d->player);
-            }
-            ENDLOG;
-
-            d->output_size -= nchars;
-            d->output_lost += nchars;
-            d->output_queue.pop_front();
-        }
-    }
-
     if (d->flags & DS_WEBSOCKET)
     {
-        // Wrap in a WebSocket text frame.  ws_queue_frame handles
-        // pushing to d->output_queue and updating d->output_size.
+        // Wrap in a WebSocket text frame.
         //
-        ws_queue_frame(d, reinterpret_cast<const uint8_t *>(b), n);
-        d->output_tot += n;
+        std::string frame = ws_make_frame(reinterpret_cast<const uint8_t *>(b), n);
+        make_room_in_output_queue(d, frame.size());
+        add_to_output_queue(d, std::make_shared<const std::string>(std::move(frame)), n);
     }
     else
     {
         // Append the request to the end of the output queue for later
-        // transmission.
+        // transmission.  Every notification ends with a CRLF of its own, so
+        // all descriptors share one copy of it.
         //
-        add_to_output_queue(d, b, n);
-        d->output_size += n;
-        d->output_tot += n;
+        static const std::shared_ptr<const std::string> crlf =
+            std::make_shared<const std::string>("\r\n");
+
+        make_room_in_output_queue(d, n);
+        if (  2 == n
+           && '\r' == b[0]
+           && '\n' == b[1])
+        {
+            add_to_output_queue(d, crlf, n);
+        }
+        else
+        {
+            add_to_output_queue(d, std::make_shared<const std::string>(
+                reinterpret_cast<const char *>(b), n), n);
+        }
     }
 }
 
@@ -233,7 +267,59 @@ static std::string encode_iac(const UTF8 *szString)
     return encoded;
 }
 
-void queue_string(DESC *d, const UTF8 *s)
+// The output encodings a descriptor can ask for.  Two descriptors with the
+// same key receive byte-for-byte identical output for the same text.
+//
+static unsigned int output_encoding_key(const DESC *d)
+{
+    unsigned int key = static_cast<unsigned int>(d->encoding) & 0xFF;
+    if (d->flags & DS_WEBSOCKET)
+    {
+        key |= 0x100;
+    }
+    if (d->flags & DS_CONNECTED)
+    {
+        const unsigned int f2 = drv_Flags(d->player, FLAG_WORD2);
+        if (f2 & ANSI)
+        {
+            if (f2 & HTML)
+            {
+                key |= 0x1000;
+            }
+            else if (f2 & TRUECOLOR)
+            {
+                key |= 0x2000;
+            }
+            else if (f2 & COLOR256)
+            {
+                key |= 0x3000;
+            }
+            else
+            {
+                key |= 0x4000;
+            }
+            if (f2 & NOBLEED)
+            {
+                key |= 0x200;
+            }
+        }
+    }
+    return key;
+}
+
+/*! \brief Render text for a descriptor, ready for its output queue.
+ *
+ * Applies the descriptor's color rendering and charset conversion, and then
+ * either the telnet IAC escaping or the WebSocket framing.
+ *
+ * \param d         Network descriptor state.
+ * \param s         Text to render.
+ * \param nPayload  Receives the size of the rendered text before framing.
+ * \return          The queue entry, or nullptr if there is nothing to send.
+ */
+
+static std::shared_ptr<const std::string> render_output(DESC *d, const UTF8 *s,
+    size_t &nPayload)
 {
     // thread_local so the color-render scratch is per-thread when the
     // evaluator moves off the single-thread model. Keeps the zero-
@@ -305,20 +391,122 @@ void queue_string(DESC *d, const UTF8 *s)
     //
     if (!(d->flags & DS_WEBSOCKET))
     {
+        // The encoded text becomes the output queue entry as it stands.
+        //
         std::string encoded = encode_iac(q);
-        queue_write_LEN(d, reinterpret_cast<const UTF8 *>(encoded.data()), encoded.size());
+        nPayload = encoded.size();
+        if (0 == nPayload)
+        {
+            return nullptr;
+        }
+        return std::make_shared<const std::string>(std::move(encoded));
     }
-    else
+
+    nPayload = strlen(reinterpret_cast<const char *>(q));
+    if (0 == nPayload)
     {
-        queue_write(d, q);
+        return nullptr;
+    }
+    return std::make_shared<const std::string>(
+        ws_make_frame(reinterpret_cast<const uint8_t *>(q), nPayload));
+}
+
+/* ---------------------------------------------------------------------------
+ * Render-once broadcasts.
+ *
+ * A room or channel message goes to every recipient through queue_string(),
+ * and each of them used to render its color, charset, and IAC escaping
+ * separately.  Between begin_broadcast() and end_broadcast(), queue_string()
+ * remembers what it rendered for each text and output encoding, and the
+ * recipients that share an encoding share one output queue entry.  Scopes
+ * nest; the renders are forgotten when the outermost one ends.
+ */
+
+struct rendered_output
+{
+    unsigned int key;
+    std::string  source;
+    size_t       nPayload;
+    std::shared_ptr<const std::string> segment;
+};
+
+static int g_broadcast_depth = 0;
+static std::vector<rendered_output> g_broadcast_renders;
+
+// Recipients may see different text (prefixes, per-player formats), so a
+// broadcast can produce more than one message.  Keep only the most recent.
+//
+constexpr size_t BROADCAST_RENDERS_MAX = 32;
+
+void begin_broadcast(void)
+{
+    g_broadcast_depth++;
+}
+
+void end_broadcast(void)
+{
+    if (  0 < g_broadcast_depth
+       && 0 == --g_broadcast_depth)
+    {
+        g_broadcast_renders.clear();
+    }
+}
+
+void queue_string(DESC *d, const UTF8 *s)
+{
+    size_t nPayload = 0;
+    if (0 == g_broadcast_depth)
+    {
+        std::shared_ptr<const std::string> segment = render_output(d, s, nPayload);
+        if (segment)
+        {
+            make_room_in_output_queue(d, segment->size());
+            add_to_output_queue(d, std::move(segment), nPayload);
+        }
+        return;
+    }
+
+    const unsigned int key = output_encoding_key(d);
+    const size_t n = strlen(reinterpret_cast<const char *>(s));
+    const rendered_output *pr = nullptr;
+    for (const auto &r : g_broadcast_renders)
+    {
+        if (  r.key == key
+           && r.source.size() == n
+           && 0 == memcmp(r.source.data(), s, n))
+        {
+            pr = &r;
+            break;
+        }
+    }
+
+    if (nullptr == pr)
+    {
+        if (BROADCAST_RENDERS_MAX <= g_broadcast_renders.size())
+        {
+            g_broadcast_renders.erase(g_broadcast_renders.begin());
+        }
+        std::shared_ptr<const std::string> segment = render_output(d, s, nPayload);
+        g_broadcast_renders.push_back({key,
+            std::string(reinterpret_cast<const char *>(s), n), nPayload,
+            std::move(segment)});
+        pr = &g_broadcast_renders.back();
+    }
+
+    if (pr->segment)
+    {
+        make_room_in_output_queue(d, pr->segment->size());
+        add_to_output_queue(d, pr->segment, pr->nPayload);
     }
 }
 
 
 void init_desc(DESC *d)
 {
-    new (&d->output_queue) std::deque<std::string>();
+    new (&d->output_queue) std::deque<std::shared_ptr<const std::string>>();
     new (&d->input_queue) std::deque<std::string>();
+    d->login_ticket = 0;
+    d->login_user = nullptr;
 }
 
 void destroy_desc(DESC *d)
@@ -328,6 +516,11 @@ void destroy_desc(DESC *d)
         delete d->ws;
         d->ws = nullptr;
     }
+    if (nullptr != d->login_user)
+    {
+        MEMFREE(d->login_user);
+        d->login_user = nullptr;
+    }
     d->output_queue.~deque();
     d->input_queue.~deque();
 }
@@ -1977,11 +2170,11 @@ static source_bucket *bucket_find(source_bucket *aTable, const UTF8 *pKey,
 }
 
 // True if this source has spent its budget.  *pWait gets the whole seconds
-// until one unit is affordable again.  A source with no bucket has spent
-// nothing and is always allowed.
+// until one unit is affordable again.  nHeld units are spoken for already and
+// must be affordable too.  A source with no bucket has spent nothing.
 //
 static bool bucket_over_budget(source_bucket *aTable, int nLimit, int nPeriod,
-                               const MUX_SOCKADDR &sa, int *pWait)
+                               const MUX_SOCKADDR &sa, int *pWait, int nHeld)
 {
     if (nLimit <= 0)
     {
@@ -1999,14 +2192,15 @@ static bool bucket_over_budget(source_bucket *aTable, int nLimit, int nPeriod,
     ltaNow.GetUTC();
     source_bucket *p = bucket_find(aTable, aKey, nKey, nLimit, nPeriod,
         static_cast<int64_t>(ltaNow.ReturnSeconds()), false);
-    if (  nullptr == p
-       || 1.0 <= p->tokens)
+    const double tokens = (nullptr != p) ? p->tokens : static_cast<double>(nLimit);
+    const double need = 1.0 + nHeld;
+    if (need <= tokens)
     {
         return false;
     }
 
     double rate = bucket_rate(nLimit, nPeriod);
-    int nWait = (0.0 < rate) ? static_cast<int>((1.0 - p->tokens) / rate) + 1 : 1;
+    int nWait = (0.0 < rate) ? static_cast<int>((need - tokens) / rate) + 1 : 1;
     if (nullptr != pWait)
     {
         *pWait = nWait;
@@ -2080,10 +2274,27 @@ static void bucket_charge(source_bucket *aTable, int nLimit, int nPeriod,
 //
 static source_bucket g_login_fail[SOURCE_BUCKET_SLOTS];
 
+// Logins from this source whose passwords are still being hashed count as
+// if they had failed.  Otherwise a source could open several connections and
+// have a guess in flight on each before the first failure is charged.
+//
 static bool login_fail_over_budget(const MUX_SOCKADDR &sa, int *pWait)
 {
+    int nPending = 0;
+    if (0 < g_dc.login_fail_limit)
+    {
+        for (auto it = g_descriptors_list.begin(); it != g_descriptors_list.end(); ++it)
+        {
+            DESC *d = *it;
+            if (  (d->flags & DS_LOGIN_PENDING)
+               && d->address.same_source_key(sa))
+            {
+                nPending++;
+            }
+        }
+    }
     return bucket_over_budget(g_login_fail, g_dc.login_fail_limit,
-                              g_dc.login_fail_period, sa, pWait);
+                              g_dc.login_fail_period, sa, pWait, nPending);
 }
 
 static void login_fail_record(const MUX_SOCKADDR &sa)
@@ -2125,7 +2336,7 @@ static source_bucket g_connect_rate[SOURCE_BUCKET_SLOTS];
 bool connect_rate_exceeded(const MUX_SOCKADDR &sa, int *pWait)
 {
     return bucket_over_budget(g_connect_rate, g_dc.max_lastsite_cnt,
-                              g_dc.min_con_attempt, sa, pWait);
+                              g_dc.min_con_attempt, sa, pWait, 0);
 }
 
 void connect_rate_charge(const MUX_SOCKADDR &sa)
@@ -2156,6 +2367,8 @@ static void failconn(const UTF8 *logcode, const UTF8 *logtype, const UTF8 *logre
     g_pILog->log_text(logreason);
     g_pILog->log_text(T(")"));
     ENDLOG;
+    LOG_EVENT(LOG_LOGIN | LOG_SECURITY, EVLOG_LOGIN_REFUSED, d->socket,
+        player, NOTHING, d->addr, logreason);
     fcache_dump(d, filecache);
     if (*motd_msg)
     {
@@ -2174,12 +2387,268 @@ void site_mon_send(SOCKET, const UTF8 *, DESC *, const UTF8 *);
 
 const UTF8 *connect_fail = T("Either that player does not exist, or has a different password.\r\n");
 
-static bool check_connect(DESC *d, UTF8 *msg)
+// Everything check_connect() does for "connect" once the password has been
+// checked; player is NOTHING if it was wrong.  Returns false if the
+// connection was closed, in which case command, user, and password have been
+// freed -- the same contract as check_connect().
+//
+static bool connect_checked(DESC *d, dbref player, bool isGuest, UTF8 *command,
+    UTF8 *user, UTF8 *password, const UTF8 *cmdsave)
 {
     UTF8 *buff;
-    dbref player, aowner;
+    dbref aowner;
     int aflags, nplayers;
 
+    int host_info = g_access_list.check(&d->address);
+    UTF8 host_address[MBUF_SIZE];
+    d->address.ntop(host_address, sizeof(host_address));
+
+    // See if this connection would exceed the max #players.
+    //
+    if (g_dc.max_players < 0)
+    {
+        nplayers = g_dc.max_players - 1;
+    }
+    else
+    {
+        nplayers = 0;
+        for (auto it = g_descriptors_list.begin(); it != g_descriptors_list.end(); ++it)
+        {
+            DESC* d2 = *it;
+            if (d2->flags & DS_CONNECTED)
+            {
+                nplayers++;
+            }
+        }
+    }
+
+    if (  player == NOTHING
+       || (!isGuest && drv_CheckGuest(player)))
+    {
+        // Not a player, or wrong password.
+        //
+        if (!isGuest)
+        {
+            login_fail_record(d->address);
+        }
+        queue_write(d, connect_fail);
+        STARTLOG(LOG_LOGIN | LOG_SECURITY, "CON", "BAD");
+        buff = alloc_lbuf("check_conn.LOG.bad");
+        mux_sprintf(buff, LBUF_SIZE, T("[%llu/%s] Failed connect to ‘%s’"), static_cast<unsigned long long>(d->socket), d->addr, user);
+        g_pILog->log_text(buff);
+        free_lbuf(buff);
+        ENDLOG;
+        LOG_EVENT(LOG_LOGIN | LOG_SECURITY, EVLOG_LOGIN_FAILED, d->socket,
+            NOTHING, NOTHING, d->addr, user);
+        if (--(d->retries_left) <= 0)
+        {
+            free_lbuf(command);
+            free_lbuf(user);
+            free_lbuf(password);
+            ganl_close_connection(d, R_BADLOGIN);
+            g_debug_cmd = cmdsave;
+            return false;
+        }
+    }
+    else if (  (  (g_dc.control_flags & CF_LOGIN)
+               && (nplayers < g_dc.max_players))
+            || drv_WizRoy(player)
+            || God(player))
+    {
+        if (  strncmp(reinterpret_cast<char*>(command), "cd", 2) == 0
+           && (  drv_Wizard(player)
+              || God(player)))
+        {
+            drv_s_Flags(player, FLAG_WORD1, drv_Flags(player, FLAG_WORD1) | DARK);
+        }
+
+        // Make sure we don't have a guest from an unwanted host.
+        // The majority of these are handled above.
+        //
+        // The following code handles the case where a staffer
+        // (#1-only by default) has specifically given the guest 'power'
+        // to an existing player.
+        //
+        // In this case, the player -already- has an account complete
+        // with password. We still fail the connection to -this- player
+        // but if the site isn't register_sited, this player can simply
+        // auto-create another player. So, the procedure is not much
+        // different from @newpassword'ing them. Oh well. We are just
+        // following orders. ;)
+        //
+        if (  (drv_Powers(player) & POW_GUEST)
+           && (host_info & HI_NOGUEST))
+        {
+            failconn(T("CON"), T("Connect"), T("Guest Site Forbidden"), d,
+                R_GAMEDOWN, player, FC_CONN_SITE,
+                g_dc.downmotd_msg, command, user, password,
+                cmdsave);
+            return false;
+        }
+
+        // Logins are enabled, or wiz or god.
+        //
+        STARTLOG(LOG_LOGIN, "CON", "LOGIN");
+        buff = alloc_mbuf("check_conn.LOG.login");
+        mux_sprintf(buff, MBUF_SIZE, T("[%llu/%s] Connected to "), static_cast<unsigned long long>(d->socket), d->addr);
+        g_pILog->log_text(buff);
+        g_pILog->log_name_and_loc(player);
+        free_mbuf(buff);
+        ENDLOG;
+        LOG_EVENT(LOG_LOGIN, EVLOG_LOGIN, d->socket, player,
+            drv_Location(player), d->addr, nullptr);
+        d->flags |= DS_CONNECTED;
+        d->connected_at.GetUTC();
+        d->player = player;
+
+        // Check to see if the player is currently running an
+        // @program. If so, drop the new descriptor into it.
+        //
+        const auto range = g_dbref_to_descriptors_map.equal_range(player);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            DESC* d2 = it->second;
+            if (  nullptr != d2->program_data
+               && nullptr == d->program_data)
+            {
+                d->program_data = d2->program_data;
+            }
+            else if (nullptr != d2->program_data)
+            {
+                // Enforce that all program_data pointers for this player
+                // are the same.
+                //
+                mux_assert(d->program_data == d2->program_data);
+            }
+        }
+
+        // Give the player the MOTD file and the settable MOTD
+        // message(s). Use raw notifies so the player doesn't try
+        // to match on the text.
+        //
+        if (drv_Powers(player) & POW_GUEST)
+        {
+            fcache_dump(d, FC_CONN_GUEST);
+        }
+        else
+        {
+            buff = atr_get("check_connect.2375", player, A_LAST, &aowner, &aflags);
+            if (*buff == '\0')
+                fcache_dump(d, FC_CREA_NEW);
+            else
+                fcache_dump(d, FC_MOTD);
+            if (drv_Wizard(player))
+                fcache_dump(d, FC_WIZMOTD);
+            free_lbuf(buff);
+        }
+        {
+            desc_addhash(d);
+            int num_con = count_player_descs(player);
+            bool isPueblo = (d->flags & DS_PUEBLOCLIENT) != 0;
+            bool isSusp = g_access_list.isSuspect(&d->address);
+            int timeout = g_dc.idle_timeout;
+            refusal_log_flush();
+            g_pIPlayerSession->AnnounceConnect(player, num_con,
+                isPueblo, isSusp, d->addr, d->username, host_address,
+                &timeout, &d->connlog_id);
+            d->timeout = timeout;
+        }
+
+        // If stuck in an @prog, show the prompt.
+        //
+        if (nullptr != d->program_data)
+        {
+            queue_write_LEN(d, T(">\377\371"), 3);
+        }
+
+    }
+    else if (!(g_dc.control_flags & CF_LOGIN))
+    {
+        failconn(T("CON"), T("Connect"), T("Logins Disabled"), d, R_GAMEDOWN, player, FC_CONN_DOWN,
+            g_dc.downmotd_msg, command, user, password, cmdsave);
+        return false;
+    }
+    else
+    {
+        failconn(T("CON"), T("Connect"), T("Game Full"), d, R_GAMEFULL, player, FC_CONN_FULL,
+            g_dc.fullmotd_msg, command, user, password, cmdsave);
+        return false;
+    }
+    return true;
+}
+
+// The password check for a held connection has finished.  arg_iInteger is
+// its ticket.
+//
+static void Task_ConnectPlayerDone(void *arg_voidptr, int arg_iInteger)
+{
+    DESC *d = static_cast<DESC *>(arg_voidptr);
+    dbref player = NOTHING;
+    if (  nullptr == d
+       || !(d->flags & DS_LOGIN_PENDING)
+       || d->login_ticket != arg_iInteger
+       || MUX_S_OK != g_pIPlayerSession->EndConnectPlayer(arg_iInteger, &player))
+    {
+        return;
+    }
+
+    const UTF8 *cmdsave = g_debug_cmd;
+    g_debug_cmd = T("< check_connect >");
+
+    UTF8 *command = alloc_lbuf("check_conn.cmd");
+    UTF8 *user = alloc_lbuf("check_conn.user");
+    UTF8 *password = alloc_lbuf("check_conn.pass");
+    mux_strncpy(command, d->login_dark ? T("cd") : T("co"), LBUF_SIZE-1);
+    mux_strncpy(user, d->login_user, LBUF_SIZE-1);
+    password[0] = '\0';
+    const bool isGuest = d->login_guest;
+
+    d->flags &= ~DS_LOGIN_PENDING;
+    d->login_ticket = 0;
+    MEMFREE(d->login_user);
+    d->login_user = nullptr;
+
+    drv_PrepareForCommand(NOTHING);
+    if (connect_checked(d, player, isGuest, command, user, password, cmdsave))
+    {
+        free_lbuf(command);
+        free_lbuf(user);
+        free_lbuf(password);
+        g_debug_cmd = cmdsave;
+
+        if (!d->input_queue.empty())
+        {
+            drv_DeferImmediateTask(PRIORITY_SYSTEM, Task_ProcessCommand, d, 0);
+        }
+    }
+}
+
+// The connection is going away with its password check still running.
+//
+void cancel_pending_login(DESC *d)
+{
+    if (d->flags & DS_LOGIN_PENDING)
+    {
+        if (nullptr != g_pIPlayerSession)
+        {
+            g_pIPlayerSession->CancelConnectPlayer(d->login_ticket);
+        }
+        d->flags &= ~DS_LOGIN_PENDING;
+        d->login_ticket = 0;
+    }
+    if (nullptr != d->login_user)
+    {
+        MEMFREE(d->login_user);
+        d->login_user = nullptr;
+    }
+}
+
+static bool check_connect(DESC *d, UTF8 *msg)
+{
+    UTF8 *buff;
+    dbref player;
+    int nplayers;
+
     const UTF8 *cmdsave = g_debug_cmd;
     g_debug_cmd = T("< check_connect >");
 
@@ -2263,25 +2732,6 @@ static bool check_connect(DESC *d, UTF8 *msg)
             }
         }
 
-        // See if this connection would exceed the max #players.
-        //
-        if (g_dc.max_players < 0)
-        {
-            nplayers = g_dc.max_players - 1;
-        }
-        else
-        {
-            nplayers = 0;
-            for (auto it = g_descriptors_list.begin(); it != g_descriptors_list.end(); ++it)
-            {
-                DESC* d2 = *it;
-                if (d2->flags & DS_CONNECTED)
-                {
-                    nplayers++;
-                }
-            }
-        }
-
         // Has this source spent its failure budget?  Checked BEFORE the
         // password test, so a source under throttle also stops costing us the
         // password hash on every guess.  Guests are exempt: they authenticate
@@ -2303,6 +2753,8 @@ static bool check_connect(DESC *d, UTF8 *msg)
             // broadcast; refusal_log_wanted() advances the run counter, so it
             // must be called exactly once per refusal.
             //
+            LOG_EVENT(LOG_LOGIN | LOG_SECURITY, EVLOG_LOGIN_REFUSED, d->socket,
+                NOTHING, NOTHING, d->addr, T("throttled"));
             const bool bTell = refusal_log_wanted(d->addr);
             if (bTell)
             {
@@ -2340,154 +2792,23 @@ static bool check_connect(DESC *d, UTF8 *msg)
 
         UTF8 host_address[MBUF_SIZE];
         d->address.ntop(host_address, sizeof(host_address));
-        g_pIPlayerSession->ConnectPlayer(user, password,
-            d->addr, d->username, host_address, &player);
-        if (  player == NOTHING
-           || (!isGuest && drv_CheckGuest(player)))
+        int ticket = 0;
+        if (MUX_S_FALSE == g_pIPlayerSession->BeginConnectPlayer(user, password,
+                d->addr, d->username, host_address, Task_ConnectPlayerDone, d,
+                &ticket, &player))
         {
-            // Not a player, or wrong password.
+            // The password is being hashed off the game thread.  This
+            // connection's input waits until Task_ConnectPlayerDone has the
+            // answer.
             //
-            if (!isGuest)
-            {
-                login_fail_record(d->address);
-            }
-            queue_write(d, connect_fail);
-            STARTLOG(LOG_LOGIN | LOG_SECURITY, "CON", "BAD");
-            buff = alloc_lbuf("check_conn.LOG.bad");
-            mux_sprintf(buff, LBUF_SIZE, T("[%llu/%s] Failed connect to ‘%s’"), static_cast<unsigned long long>(d->socket), d->addr, user);
-            g_pILog->log_text(buff);
-            free_lbuf(buff);
-            ENDLOG;
-            if (--(d->retries_left) <= 0)
-            {
-                free_lbuf(command);
-                free_lbuf(user);
-                free_lbuf(password);
-                ganl_close_connection(d, R_BADLOGIN);
-                g_debug_cmd = cmdsave;
-                return false;
-            }
+            d->flags |= DS_LOGIN_PENDING;
+            d->login_ticket = ticket;
+            d->login_dark = (strncmp(reinterpret_cast<char*>(command), "cd", 2) == 0);
+            d->login_guest = isGuest;
+            d->login_user = StringClone(user);
         }
-        else if (  (  (g_dc.control_flags & CF_LOGIN)
-                   && (nplayers < g_dc.max_players))
-                || drv_WizRoy(player)
-                || God(player))
+        else if (!connect_checked(d, player, isGuest, command, user, password, cmdsave))
         {
-            if (  strncmp(reinterpret_cast<char*>(command), "cd", 2) == 0
-               && (  drv_Wizard(player)
-                  || God(player)))
-            {
-                drv_s_Flags(player, FLAG_WORD1, drv_Flags(player, FLAG_WORD1) | DARK);
-            }
-
-            // Make sure we don't have a guest from an unwanted host.
-            // The majority of these are handled above.
-            //
-            // The following code handles the case where a staffer
-            // (#1-only by default) has specifically given the guest 'power'
-            // to an existing player.
-            //
-            // In this case, the player -already- has an account complete
-            // with password. We still fail the connection to -this- player
-            // but if the site isn't register_sited, this player can simply
-            // auto-create another player. So, the procedure is not much
-            // different from @newpassword'ing them. Oh well. We are just
-            // following orders. ;)
-            //
-            if (  (drv_Powers(player) & POW_GUEST)
-               && (host_info & HI_NOGUEST))
-            {
-                failconn(T("CON"), T("Connect"), T("Guest Site Forbidden"), d,
-                    R_GAMEDOWN, player, FC_CONN_SITE,
-                    g_dc.downmotd_msg, command, user, password,
-                    cmdsave);
-                return false;
-            }
-
-            // Logins are enabled, or wiz or god.
-            //
-            STARTLOG(LOG_LOGIN, "CON", "LOGIN");
-            buff = alloc_mbuf("check_conn.LOG.login");
-            mux_sprintf(buff, MBUF_SIZE, T("[%llu/%s] Connected to "), static_cast<unsigned long long>(d->socket), d->addr);
-            g_pILog->log_text(buff);
-            g_pILog->log_name_and_loc(player);
-            free_mbuf(buff);
-            ENDLOG;
-            d->flags |= DS_CONNECTED;
-            d->connected_at.GetUTC();
-            d->player = player;
-
-            // Check to see if the player is currently running an
-            // @program. If so, drop the new descriptor into it.
-            //
-            const auto range = g_dbref_to_descriptors_map.equal_range(player);
-            for (auto it = range.first; it != range.second; ++it)
-            {
-                DESC* d2 = it->second;
-                if (  nullptr != d2->program_data
-                   && nullptr == d->program_data)
-                {
-                    d->program_data = d2->program_data;
-                }
-                else if (nullptr != d2->program_data)
-                {
-                    // Enforce that all program_data pointers for this player
-                    // are the same.
-                    //
-                    mux_assert(d->program_data == d2->program_data);
-                }
-            }
-
-            // Give the player the MOTD file and the settable MOTD
-            // message(s). Use raw notifies so the player doesn't try
-            // to match on the text.
-            //
-            if (drv_Powers(player) & POW_GUEST)
-            {
-                fcache_dump(d, FC_CONN_GUEST);
-            }
-            else
-            {
-                buff = atr_get("check_connect.2375", player, A_LAST, &aowner, &aflags);
-                if (*buff == '\0')
-                    fcache_dump(d, FC_CREA_NEW);
-                else
-                    fcache_dump(d, FC_MOTD);
-                if (drv_Wizard(player))
-                    fcache_dump(d, FC_WIZMOTD);
-                free_lbuf(buff);
-            }
-            {
-                desc_addhash(d);
-                int num_con = count_player_descs(player);
-                bool isPueblo = (d->flags & DS_PUEBLOCLIENT) != 0;
-                bool isSusp = g_access_list.isSuspect(&d->address);
-                int timeout = g_dc.idle_timeout;
-                refusal_log_flush();
-                g_pIPlayerSession->AnnounceConnect(player, num_con,
-                    isPueblo, isSusp, d->addr, d->username, host_address,
-                    &timeout, &d->connlog_id);
-                d->timeout = timeout;
-            }
-
-            // If stuck in an @prog, show the prompt.
-            //
-            if (nullptr != d->program_data)
-            {
-                queue_write_LEN(d, T(">\377\371"), 3);
-            }
-
-        }
-        else if (!(g_dc.control_flags & CF_LOGIN))
-        {
-            failconn(T("CON"), T("Connect"), T("Logins Disabled"), d, R_GAMEDOWN, player, FC_CONN_DOWN,
-                g_dc.downmotd_msg, command, user, password, cmdsave);
-            return false;
-        }
-        else
-        {
-            failconn(T("CON"), T("Connect"), T("Game Full"), d, R_GAMEFULL, player, FC_CONN_FULL,
-                g_dc.fullmotd_msg, command, user, password, cmdsave);
             return false;
         }
     }
@@ -2552,6 +2873,8 @@ static bool check_connect(DESC *d, UTF8 *msg)
                 g_pILog->log_text(buff);
                 free_lbuf(buff);
                 ENDLOG;
+                LOG_EVENT(LOG_SECURITY | LOG_PCREATES, EVLOG_CREATE_FAILED,
+                    d->socket, NOTHING, NOTHING, d->addr, user);
             }
             else
             {
@@ -2564,6 +2887,8 @@ static bool check_connect(DESC *d, UTF8 *msg)
                 g_pILog->log_name(player);
                 free_mbuf(buff);
                 ENDLOG;
+                LOG_EVENT(LOG_LOGIN | LOG_PCREATES, EVLOG_CREATE, d->socket,
+                    player, NOTHING, d->addr, nullptr);
                 drv_MoveObject(player, g_dc.start_room);
                 d->flags |= DS_CONNECTED;
                 d->connected_at.GetUTC();
@@ -2596,6 +2921,8 @@ static bool check_connect(DESC *d, UTF8 *msg)
         g_pILog->log_text(buff);
         free_mbuf(buff);
         ENDLOG;
+        LOG_EVENT(LOG_LOGIN | LOG_SECURITY, EVLOG_LOGIN_FAILED, d->socket,
+            NOTHING, NOTHING, d->addr, msg);
     }
     free_lbuf(command);
     free_lbuf(user);
@@ -2940,6 +3267,14 @@ void Task_ProcessCommand(void *arg_voidptr, int arg_iInteger)
     DESC *d = static_cast<DESC *>(arg_voidptr);
     if (d)
     {
+        // Input waits while the password is checked; Task_ConnectPlayerDone
+        // starts it again.
+        //
+        if (d->flags & DS_LOGIN_PENDING)
+        {
+            return;
+        }
+
         if (!d->input_queue.empty())
         {
             if (d->quota > 0)
@@ -4059,7 +4394,8 @@ void load_restart_db(void)
         d->flags = getref(f);
         // Protocol state cannot survive exec; strip if prepare_for_restart
         // missed any (defense in depth for #1040/#1041).
-        d->flags &= ~(DS_TLS | DS_WEBSOCKET | DS_WEBSOCKET_HS | DS_NEED_PROTO);
+        d->flags &= ~(DS_TLS | DS_WEBSOCKET | DS_WEBSOCKET_HS | DS_NEED_PROTO
+                     | DS_LOGIN_PENDING);
         d->connected_at.SetSeconds(5 <= version ? getref64(f) : getref(f));
         d->command_count = getref(f);
         d->timeout = getref(f);
@@ -4379,6 +4715,8 @@ void load_restart_db(void)
             g_pILog->log_text(logBuf);
             free_mbuf(logBuf);
             ENDLOG;
+            LOG_EVENT(LOG_NET | LOG_SECURITY, EVLOG_NET_REFUSED, d->socket,
+                NOTHING, NOTHING, d->addr, T("no address"));
 
             // Never inserted into g_descriptors_list, so ganl_initialize()'s
             // adopt loop will not see this fd -- close it here or it leaks.
@@ -340,7 +340,7 @@ bool ws_process_handshake(DESC *d, const char *data, size_t len)
 // Frame encoding (server → client)
 // --------------------------------------------------------------------------
 
-void ws_queue_frame(DESC *d, const uint8_t *data, size_t len, uint8_t opcode)
+std::string ws_make_frame(const uint8_t *data, size_t len, uint8_t opcode)
 {
     // Server frames are never masked (RFC 6455 Section 5.1).
     //
@@ -384,12 +384,21 @@ void ws_queue_frame(DESC *d, const uint8_t *data, size_t len, uint8_t opcode)
         hdrlen = 10;
     }
 
+    std::string frame(reinterpret_cast<const char *>(hdr), hdrlen);
+    frame.append(reinterpret_cast<const char *>(data), len);
+    return frame;
+}
+
+void ws_queue_frame(DESC *d, const uint8_t *data, size_t len, uint8_t opcode)
+{
+    std::string frame = ws_make_frame(data, len, opcode);
+
     // Queue header + payload as a single write.  #1083: enforce the same
     // output_limit / drop-oldest policy as queue_write_LEN, accounting
     // framed size (hdr + payload) so control-frame floods cannot grow
     // the queue without bound.  Skip when output_limit is unset (0).
     //
-    const size_t framed = hdrlen + len;
+    const size_t framed = frame.size();
     if (g_dc.output_limit > 0)
     {
         if (static_cast<size_t>(g_dc.output_limit) < d->output_size + framed)
@@ -399,7 +408,7 @@ void ws_queue_frame(DESC *d, const uint8_t *data, size_t len, uint8_t opcode)
         while (  static_cast<size_t>(g_dc.output_limit) < d->output_size + framed
               && !d->output_queue.empty())
         {
-            const size_t nchars = d->output_queue.front().size();
+            const size_t nchars = d->output_queue.front()->size();
             STARTLOG(LOG_NET, "NET", "WRITE");
             UTF8 *buf = alloc_lbuf("ws_queue_frame.LOG");
             mux_sprintf(buf, LBUF_SIZE,
@@ -418,10 +427,7 @@ void ws_queue_frame(DESC *d, const uint8_t *data, size_t len, uint8_t opcode)
         }
     }
 
-    std::string frame(reinterpret_cast<const char *>(hdr), hdrlen);
-    frame.append(reinterpret_cast<const char *>(data), len);
-
-    d->output_queue.emplace_back(std::move(frame));
+    d->output_queue.emplace_back(std::make_shared<const std::string>(std::move(frame)));
     d->output_size += framed;
 }
 
@@ -92,6 +92,11 @@ bool ws_process_handshake(descriptor_data *d, const char *data, size_t len);
 //
 void ws_process_input(descriptor_data *d, const char *data, size_t len);
 
+// Build a WebSocket frame (header + payload) around raw output bytes.
+//
+std::string ws_make_frame(const uint8_t *data, size_t len,
+                          uint8_t opcode = WS_OPCODE_TEXT);
+
 // Wrap raw output bytes in a WebSocket text frame.
 //
 void ws_queue_frame(descriptor_data *d, const uint8_t *data, size_t len,
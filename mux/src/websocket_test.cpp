@@ -75,7 +75,7 @@ static void feed(descriptor_data &d, const std::vector<uint8_t> &b,
 
 static int last_opcode(descriptor_data &d) {
     if (d.output_queue.empty()) return -1;
-    return static_cast<uint8_t>(d.output_queue.back()[0]) & 0x0F;
+    return static_cast<uint8_t>((*d.output_queue.back())[0]) & 0x0F;
 }
 
 int main() {
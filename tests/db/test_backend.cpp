@@ -224,6 +224,62 @@ static void test_backend_get_all()
     PASS();
 }
 
+static void test_backend_get_multi()
+{
+    auto be = CreateBackend();
+
+    // A parent chain 40 -> 41 -> ... -> 59 with attr 7 on every third
+    // object, long enough to need more than one query.
+    //
+    unsigned int chain[20];
+    for (unsigned int i = 0; i < 20; i++)
+    {
+        chain[i] = 40 + i;
+        if (0 == i % 3)
+        {
+            char val[64];
+            int len = snprintf(val, sizeof(val), "obj_%u", chain[i]);
+            ASSERT_TRUE(be->Put(chain[i], 7, (const UTF8 *)val, len + 1, 2, 4));
+        }
+        ASSERT_TRUE(be->Put(chain[i], 8, (const UTF8 *)"decoy", 6, 1, 0));
+    }
+
+    int count = 0;
+    bool seen[20] = {};
+    ASSERT_TRUE(be->GetMulti(chain, 20, 7,
+        [&](unsigned int object, const UTF8 *value, size_t len, int owner, int flags)
+        {
+            count++;
+            ASSERT_TRUE(object >= 40 && object < 60);
+            ASSERT_TRUE(0 == (object - 40) % 3);
+            ASSERT_TRUE(!seen[object - 40]);
+            seen[object - 40] = true;
+
+            char val[64];
+            int vlen = snprintf(val, sizeof(val), "obj_%u", object);
+            ASSERT_EQ(len, (size_t)(vlen + 1));
+            ASSERT_TRUE(0 == memcmp(value, val, len));
+            ASSERT_EQ(owner, 2);
+            ASSERT_EQ(flags, 4);
+        }));
+    ASSERT_EQ(count, 7);
+
+    // A short list, and one naming an object twice.
+    //
+    unsigned int some[3] = { 41, 43, 43 };
+    count = 0;
+    ASSERT_TRUE(be->GetMulti(some, 3, 7,
+        [&](unsigned int object, const UTF8 *, size_t, int, int)
+        {
+            count++;
+            ASSERT_EQ(object, 43u);
+        }));
+    ASSERT_EQ(count, 1);
+
+    be->Close();
+    PASS();
+}
+
 static void test_backend_sync_tick()
 {
     auto be = CreateBackend();
@@ -423,6 +479,7 @@ int main()
     test_backend_del();
     test_backend_del_all();
     test_backend_get_all();
+    test_backend_get_multi();
     test_backend_sync_tick();
     test_backend_persist_reopen();
     test_backend_many_objects();
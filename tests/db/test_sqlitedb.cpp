@@ -9,7 +9,9 @@
 #include <cstdio>
 #include <cstring>
 #include <cassert>
+#include <atomic>
 #include <chrono>
+#include <thread>
 #include <vector>
 
 static int g_tests_passed = 0;
@@ -331,6 +333,298 @@ TEST(statistics)
     PASS();
 }
 
+TEST(wal_checkpoint_step)
+{
+    remove("wal_test.db");
+    remove("wal_test.db-wal");
+    remove("wal_test.db-shm");
+
+    CSQLiteDB db;
+    ASSERT_TRUE(db.Open("wal_test.db"));
+    ASSERT_TRUE(0 < db.PageSize());
+
+    const uint32_t nCommits = db.WalCommits();
+    for (int i = 0; i < 20; i++)
+    {
+        db.PutAttribute(i, 1, (const UTF8 *)"value", 6, 1, 0);
+    }
+    ASSERT_EQ(db.WalCommits(), nCommits + 20);
+    ASSERT_TRUE(0 < db.WalFrames());
+
+    // A second connection sees the same WAL and can copy it back.
+    //
+    CSQLiteDB other;
+    ASSERT_TRUE(other.Open("wal_test.db"));
+    int nLog = -1;
+    int nCkpt = -1;
+    ASSERT_EQ(other.CheckpointStep(SQLITE_CHECKPOINT_PASSIVE, &nLog, &nCkpt), SQLITE_OK);
+    ASSERT_TRUE(db.WalFrames() <= nLog);
+    ASSERT_EQ(nCkpt, nLog);
+
+    ASSERT_EQ(other.CheckpointStep(SQLITE_CHECKPOINT_TRUNCATE, &nLog, &nCkpt), SQLITE_OK);
+    ASSERT_EQ(nLog, 0);
+
+    UTF8 buf[64];
+    size_t rlen = 0;
+    ASSERT_TRUE(other.GetAttribute(19, 1, buf, sizeof(buf), &rlen, nullptr, nullptr));
+    ASSERT_EQ(rlen, (size_t)6);
+
+    other.Close();
+    db.Close();
+    remove("wal_test.db");
+    remove("wal_test.db-wal");
+    remove("wal_test.db-shm");
+    PASS();
+}
+
+// A TRUNCATE step waits on readers; a cancelled one gives up at once
+// rather than sit out busy_timeout.
+//
+TEST(wal_checkpoint_cancel)
+{
+    const char *files[] = { "ckpt_test.db", "ckpt_test.db-wal", "ckpt_test.db-shm", nullptr };
+    for (int i = 0; files[i]; i++)
+    {
+        remove(files[i]);
+    }
+
+    CSQLiteDB db;
+    ASSERT_TRUE(db.Open("ckpt_test.db"));
+    for (int i = 0; i < 20; i++)
+    {
+        db.PutAttribute(i, 1, (const UTF8 *)"value", 6, 1, 0);
+    }
+
+    sqlite3 *reader = nullptr;
+    ASSERT_EQ(sqlite3_open("ckpt_test.db", &reader), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(reader, "BEGIN; SELECT count(*) FROM sqlite_master;",
+        nullptr, nullptr, nullptr), SQLITE_OK);
+    db.PutAttribute(0, 1, (const UTF8 *)"later", 6, 1, 0);
+
+    std::atomic<bool> bCancel(true);
+    int nLog = -1;
+    int nCkpt = -1;
+    const auto tStart = std::chrono::steady_clock::now();
+    const int rc = db.CheckpointStep(SQLITE_CHECKPOINT_TRUNCATE, &nLog, &nCkpt, &bCancel);
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - tStart).count();
+    ASSERT_EQ(rc, SQLITE_BUSY);
+    ASSERT_TRUE(ms < 1000);
+
+    sqlite3_exec(reader, "COMMIT", nullptr, nullptr, nullptr);
+    sqlite3_close(reader);
+    ASSERT_EQ(db.CheckpointStep(SQLITE_CHECKPOINT_TRUNCATE, &nLog, &nCkpt, &bCancel), SQLITE_OK);
+    ASSERT_EQ(nLog, 0);
+
+    db.Close();
+    for (int i = 0; files[i]; i++)
+    {
+        remove(files[i]);
+    }
+    PASS();
+}
+
+// Object-row updates on the game thread's connection while a background
+// writer is part way through a batch on its own.  With the gate attached the
+// writer commits early and the update goes through at once, instead of
+// waiting on busy_timeout for the batch to finish.
+//
+TEST(write_gate_object_updates)
+{
+    const char *files[] = { "gate_test.db", "gate_test.db-wal", "gate_test.db-shm", nullptr };
+    for (int i = 0; files[i]; i++)
+    {
+        remove(files[i]);
+    }
+
+    CSQLiteDB db;
+    ASSERT_TRUE(db.Open("gate_test.db"));
+    CSQLiteDB::ObjectRecord obj = {};
+    obj.dbref_val = 7;
+    obj.location  = 0;
+    obj.contents  = -1;
+    obj.exits     = -1;
+    obj.next      = -1;
+    obj.link      = 0;
+    obj.owner     = 1;
+    obj.parent    = -1;
+    obj.zone      = -1;
+    ASSERT_TRUE(db.InsertObject(obj));
+
+    CSQLiteDB writer;
+    ASSERT_TRUE(writer.Open("gate_test.db"));
+    CSQLiteWriteGate gate;
+    db.SetWriteGate(&gate);
+
+    // The writer's batch would run for ten seconds if nobody cut in.
+    //
+    std::atomic<bool> bOpen(false);
+    std::atomic<int>  nWritten(0);
+    std::atomic<int>  nTransactions(0);
+    std::thread t([&]
+    {
+        const auto tEnd = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        int i = 0;
+        while (i < 40 && std::chrono::steady_clock::now() < tEnd)
+        {
+            gate.Enter();
+            if (!writer.Begin())
+            {
+                gate.Leave();
+                break;
+            }
+            nTransactions++;
+            do
+            {
+                writer.PutAttribute(100 + i, 1, (const UTF8 *)"batch", 6, 1, 0);
+                nWritten++;
+                i++;
+                bOpen = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(i < 20 ? 250 : 1));
+            } while (  i < 40
+                    && !gate.YieldRequested()
+                    && std::chrono::steady_clock::now() < tEnd);
+            writer.Commit();
+            gate.Leave();
+        }
+    });
+    while (!bOpen)
+    {
+        std::this_thread::yield();
+    }
+
+    const char *aField[] = { "location", "contents", "owner", "parent", "flags" };
+    bool bOk = true;
+    const auto tStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < 5 && bOk; i++)
+    {
+        switch (i)
+        {
+        case 0: bOk = db.UpdateLocation(7, 3); break;
+        case 1: bOk = db.UpdateContents(7, 8); break;
+        case 2: bOk = db.UpdateOwner(7, 2); break;
+        case 3: bOk = db.UpdateParent(7, 4); break;
+        case 4: bOk = db.UpdateFlags(7, 0x11, 0x22, 0x33); break;
+        }
+        if (!bOk)
+        {
+            fprintf(stderr, "  update of %s failed\n", aField[i]);
+        }
+    }
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - tStart).count();
+    const int nWrittenBefore = nWritten;
+    t.join();
+
+    ASSERT_TRUE(bOk);
+    ASSERT_TRUE(ms < 2000);
+    ASSERT_TRUE(nWrittenBefore < 20);
+    ASSERT_TRUE(1 < nTransactions);
+    ASSERT_EQ(nWritten, 40);
+
+    CSQLiteDB::ObjectRecord loaded = {};
+    ASSERT_TRUE(db.LoadObject(7, loaded));
+    ASSERT_EQ(loaded.location, 3);
+    ASSERT_EQ(loaded.contents, 8);
+    ASSERT_EQ(loaded.owner, 2);
+    ASSERT_EQ(loaded.parent, 4);
+    ASSERT_EQ(loaded.flags3, 0x33u);
+
+    UTF8 buf[64];
+    size_t rlen = 0;
+    ASSERT_TRUE(db.GetAttribute(139, 1, buf, sizeof(buf), &rlen, nullptr, nullptr));
+    ASSERT_EQ(rlen, (size_t)6);
+
+    db.SetWriteGate(nullptr);
+    writer.Close();
+    db.Close();
+    for (int i = 0; files[i]; i++)
+    {
+        remove(files[i]);
+    }
+    PASS();
+}
+
+TEST(online_backup)
+{
+    const char *files[] =
+    {
+        "backup_src.db", "backup_src.db-wal", "backup_src.db-shm",
+        "backup_dst.db", "backup_dst.db-wal", "backup_dst.db-shm",
+        nullptr
+    };
+    for (int i = 0; files[i]; i++)
+    {
+        remove(files[i]);
+    }
+
+    CSQLiteDB db;
+    ASSERT_TRUE(db.Open("backup_src.db"));
+    for (int i = 0; i < 200; i++)
+    {
+        db.PutAttribute(i, 1, (const UTF8 *)"before", 7, 1, 0);
+    }
+
+    CSQLiteBackup backup;
+    ASSERT_TRUE(backup.Begin("backup_src.db", "backup_dst.db"));
+
+    // Changes committed during the copy are not part of the snapshot.
+    //
+    int rc = backup.Step(1);
+    ASSERT_EQ(rc, SQLITE_OK);
+    ASSERT_TRUE(0 < backup.PageCount());
+    for (int i = 0; i < 200; i++)
+    {
+        db.PutAttribute(i, 1, (const UTF8 *)"after", 6, 1, 0);
+    }
+
+    // The backup's snapshot pins the WAL: a checkpoint meanwhile copies what
+    // it can instead of waiting out busy_timeout for a reset.
+    //
+    const auto tStart = std::chrono::steady_clock::now();
+    ASSERT_TRUE(db.Checkpoint());
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - tStart).count();
+    ASSERT_TRUE(ms < 1000);
+    int nLog = -1;
+    int nCkpt = -1;
+    ASSERT_EQ(db.CheckpointStep(SQLITE_CHECKPOINT_TRUNCATE, &nLog, &nCkpt), SQLITE_BUSY);
+
+    int nSteps = 1;
+    while (SQLITE_OK == (rc = backup.Step(1)))
+    {
+        nSteps++;
+    }
+    ASSERT_EQ(rc, SQLITE_DONE);
+    ASSERT_TRUE(1 < nSteps);
+    ASSERT_TRUE(backup.Finish());
+    ASSERT_EQ(db.CheckpointStep(SQLITE_CHECKPOINT_TRUNCATE, &nLog, &nCkpt), SQLITE_OK);
+    ASSERT_EQ(nLog, 0);
+    ASSERT_TRUE(CSQLiteBackup::Verify("backup_dst.db").empty());
+
+    // A cancelled check reports failure rather than running on.
+    //
+    std::atomic<bool> bCancel(true);
+    ASSERT_TRUE(!CSQLiteBackup::Verify("backup_dst.db", &bCancel).empty());
+
+    CSQLiteDB copy;
+    ASSERT_TRUE(copy.Open("backup_dst.db"));
+    UTF8 buf[64];
+    size_t rlen = 0;
+    ASSERT_TRUE(copy.GetAttribute(199, 1, buf, sizeof(buf), &rlen, nullptr, nullptr));
+    ASSERT_TRUE(0 == memcmp(buf, "before", 7));
+    copy.Close();
+
+    ASSERT_TRUE(!CSQLiteBackup::Verify("backup_missing.db").empty());
+
+    db.Close();
+    for (int i = 0; files[i]; i++)
+    {
+        remove(files[i]);
+    }
+    PASS();
+}
+
 // ---------------------------------------------------------------------------
 // Performance benchmarks
 // ---------------------------------------------------------------------------
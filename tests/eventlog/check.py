@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+#
+# check.py — the binary event log, from CEventLog through muxevents.
+#
+# The first half has the server write a file: a login, commands, a bad
+# command, a player rename, and failed logins whose names take one, two, and
+# four string slots, or are longer than a string may be.  @logrotate closes
+# the file cleanly, and muxevents must read back exactly those events, with
+# each filter selecting what it says it does.
+#
+# The second half works on copies of that file, because the cases that matter
+# for a reader are the ones a running server rarely leaves behind:
+#
+#   * a crash leaves the zero-filled rest of the current window after the
+#     last record, which must read as the end of the data;
+#   * a crash just as a window fills leaves a file that ends exactly at the
+#     window boundary with no terminating slot;
+#   * a string definition whose bytes were to go in the next window, torn at
+#     that boundary, and string records whose length or id is out of range,
+#     must be reported as corrupt after the records before them are printed
+#     (the bounds checks in process_file()).
+#
+# Driven by tests/eventlog/run.sh.
+# Usage: check.py host port workdir muxevents
+
+import glob
+import os
+import socket
+import struct
+import subprocess
+import sys
+import time
+
+HOST = sys.argv[1]
+PORT = int(sys.argv[2])
+WORK = sys.argv[3]
+MUXEVENTS = sys.argv[4]
+
+WIZ_LOGIN = "connect Wizard potrzebie"
+
+# Layout from mux/include/eventlog.h.
+HEADER = struct.Struct("<8sIIq40x")
+RECORD = struct.Struct("<qHHIiiII")
+RECORD_SIZE = 32
+WINDOW_SIZE = 1024 * 1024
+EVLOG_STRING = 1
+EVLOG_NET_CONNECT = 10
+EVLOG_MAX_STRING = 255
+EVLOG_MAX_STRINGS = 65536
+
+PLAYER = "EvPlayer"
+RENAMED = "EvRenamed"
+
+# Failed login names, as (bytes sent, text recorded).  The first three land
+# either side of a slot boundary.  A connection reads Latin-1 until it
+# negotiates a charset, so the last arrives as 150 two-byte characters; the
+# writer cuts strings to EVLOG_MAX_STRING bytes on a character boundary, so
+# 127 survive.
+BAD_USERS = (
+    (b"E" * 32, "E" * 32),
+    (b"F" * 33, "F" * 33),
+    (b"G" * 100, "G" * 100),
+    (b"\xe9" * 150, "\u00e9" * 127),
+)
+
+
+def sendline(sock, line):
+    sock.sendall(line.encode("utf-8") + b"\r\n")
+
+
+def read_for(sock, marker, timeout=5.0):
+    sock.settimeout(0.3)
+    deadline = time.monotonic() + timeout
+    buf = ""
+    while time.monotonic() < deadline:
+        try:
+            data = sock.recv(8192)
+            if not data:
+                break
+            buf += data.decode("utf-8", "replace")
+            if marker is not None and marker in buf:
+                return buf
+        except socket.timeout:
+            pass
+    return buf
+
+
+def connect(login=None):
+    sock = socket.socket()
+    sock.settimeout(5)
+    sock.connect((HOST, PORT))
+    read_for(sock, None, 1.0)
+    if login is not None:
+        sendline(sock, login)
+        read_for(sock, None, 2.0)
+    return sock
+
+
+def command(sock, line, marker):
+    sendline(sock, line)
+    return read_for(sock, marker, 5.0)
+
+
+def muxevents(*args):
+    p = subprocess.run([MUXEVENTS] + list(args), stdout=subprocess.PIPE,
+                       stderr=subprocess.PIPE)
+    return (p.returncode, p.stdout.decode("utf-8", "replace"),
+            p.stderr.decode("utf-8", "replace"))
+
+
+def body(line):
+    # Drop the date, time, and type columns.
+    parts = line.split(None, 3)
+    return parts[3] if len(parts) == 4 else ""
+
+
+def records(data):
+    # (offset, record) for every slot after the header, skipping the bytes of
+    # string definitions.
+    out = []
+    off = HEADER.size
+    while off + RECORD_SIZE <= len(data):
+        rec = RECORD.unpack_from(data, off)
+        if 0 == rec[1]:
+            break
+        out.append((off, rec))
+        off += RECORD_SIZE
+        if EVLOG_STRING == rec[1]:
+            off += rec[5] * RECORD_SIZE
+    return out
+
+
+def main():
+    npass = nfail = 0
+
+    def check(ok, msg, detail=""):
+        nonlocal npass, nfail
+        if ok:
+            npass += 1
+            print("ok %d - %s" % (npass + nfail, msg))
+        else:
+            nfail += 1
+            print("not ok %d - %s%s"
+                  % (npass + nfail, msg, (" (%s)" % detail) if detail else ""))
+
+    # --- The server writes a file -------------------------------------------
+    try:
+        wiz = connect(WIZ_LOGIN)
+    except OSError as e:
+        print("not ok - could not connect to %s:%d (%s)" % (HOST, PORT, e))
+        return 1
+
+    command(wiz, "@pcreate %s=hunter2" % PLAYER, "created")
+    out = command(wiz, "think EVNUM<[num(*%s)]>" % PLAYER, ">")
+    try:
+        thing = int(out.split("EVNUM<#", 1)[1].split(">", 1)[0])
+    except (IndexError, ValueError):
+        print("not ok - could not find %s's dbref (%r)" % (PLAYER, out))
+        return 1
+    command(wiz, "@name *%s=%s" % (PLAYER, RENAMED), "Name set.")
+    command(wiz, "xyzzyevlog", "Huh?")
+
+    # One connection each: a connection is dropped after a few failures.
+    bad_port = None
+    for sent, _ in BAD_USERS:
+        bad = connect()
+        bad_port = bad.getsockname()[1]
+        bad.sendall(b"connect " + sent + b" nopassword\r\n")
+        read_for(bad, "ither", 3.0)
+        bad.close()
+
+    before = set(glob.glob(os.path.join(WORK, "*.evlog")))
+    command(wiz, "@logrotate", "ogs")
+    wiz.close()
+
+    files = sorted(before)
+    check(1 == len(files), "one event log file before @logrotate",
+          "found %r" % files)
+    if 1 != len(files):
+        print("=== event log: %d passed, %d failed ===" % (npass, nfail))
+        return 1
+    path = files[0]
+
+    rc, text, err = muxevents(path)
+    lines = text.splitlines()
+    check(0 == rc and "" == err, "muxevents reads the closed file cleanly",
+          "rc=%d err=%r" % (rc, err))
+    bodies = [body(l) for l in lines]
+    check(any(" login " in l and body(l).startswith("[")
+              and " #1 in #" in body(l) for l in lines),
+          "the Wizard login is recorded")
+    check("#%d to '%s'" % (thing, RENAMED) in bodies,
+          "the player rename is recorded")
+    for sent, kept in BAD_USERS:
+        check(any(b.endswith("'%s'" % kept) for b in bodies),
+              "a %d-byte failed-login name reads back as %d bytes"
+              % (len(sent.decode("latin-1").encode()), len(kept.encode())))
+    check(any(" badcommand " in l and l.endswith(": xyzzyevlog")
+              for l in lines), "the bad command is recorded")
+
+    rc, text, _ = muxevents("--type", "loginfail", path)
+    check(len(BAD_USERS) == len(text.splitlines())
+          and all(" loginfail " in l for l in text.splitlines()),
+          "--type loginfail selects the failed logins only", repr(text))
+
+    rc, text, _ = muxevents("--dbref", str(thing), path)
+    check(1 == len(text.splitlines()) and " rename " in text,
+          "--dbref selects the record naming the player", repr(text))
+
+    # 'other' is the client's port in a connect record, not a dbref.
+    rc, text, _ = muxevents("--dbref", str(bad_port), path)
+    check("" == text, "--dbref does not match a connect record's port",
+          repr(text))
+
+    rc, text, _ = muxevents("--stats", "--type", "loginfail,rename", path)
+    check(text.splitlines()[-1].split() == ["total", str(len(BAD_USERS) + 1)],
+          "--stats counts the selected types", repr(text))
+
+    # --- Copies of that file --------------------------------------------------
+    with open(path, "rb") as f:
+        data = f.read()
+    rc, full, _ = muxevents(path)
+    recs = records(data)
+    check(len(recs) > 0 and len(data) == recs[-1][0] + RECORD_SIZE
+          * (1 + (recs[-1][1][5] if EVLOG_STRING == recs[-1][1][1] else 0)),
+          "a cleanly closed file ends at its last record")
+
+    def variant(name, content):
+        p = os.path.join(WORK, name)
+        with open(p, "wb") as f:
+            f.write(content)
+        return p
+
+    # A crash leaves zeros after the last record.
+    p = variant("zeros.bin", data + b"\0" * (64 * 1024))
+    rc, text, err = muxevents(p)
+    check(0 == rc and text == full and "" == err,
+          "zeros after the last record end the data")
+
+    # Pad with connect records up to the end of the first window.
+    def filler(n):
+        return b"".join(RECORD.pack(0, EVLOG_NET_CONNECT, 0, 7, -1, 4201, 0, 0)
+                        for _ in range(n))
+
+    nfill = (WINDOW_SIZE - len(data)) // RECORD_SIZE
+    p = variant("window.bin", data + filler(nfill))
+    rc, text, err = muxevents(p)
+    check(0 == rc and "" == err
+          and len(text.splitlines()) == len(full.splitlines()) + nfill,
+          "a file that ends exactly at a window boundary reads to the end",
+          "rc=%d err=%r" % (rc, err))
+
+    # The last slot of the window defines a two-slot string whose bytes never
+    # made it out.
+    torn = RECORD.pack(0, EVLOG_STRING, 0, 0, 40, 2, 9999, 0)
+    p = variant("torn.bin", data + filler(nfill - 1) + torn)
+    rc, text, err = muxevents(p)
+    check(1 == rc and "corrupt string record at offset %d" % (WINDOW_SIZE
+          - RECORD_SIZE) in err
+          and len(text.splitlines()) == len(full.splitlines()) + nfill - 1,
+          "a string torn at the window boundary is reported after the records before it",
+          "rc=%d err=%r" % (rc, err))
+
+    # Out-of-range string records, each appended after the real data.
+    slots = (EVLOG_MAX_STRING + RECORD_SIZE - 1) // RECORD_SIZE
+    for what, rec in (
+            ("too many slots",
+             RECORD.pack(0, EVLOG_STRING, 0, 0, 300, slots + 1, 9999, 0)),
+            ("a negative slot count",
+             RECORD.pack(0, EVLOG_STRING, 0, 0, 10, -1, 9999, 0)),
+            ("an id past the limit",
+             RECORD.pack(0, EVLOG_STRING, 0, 0, 10, 1, EVLOG_MAX_STRINGS, 0))):
+        p = variant("bad.bin", data + rec + b"\0" * (RECORD_SIZE * (slots + 2)))
+        rc, text, err = muxevents(p)
+        check(1 == rc and "corrupt string record at offset %d" % len(data) in err
+              and text == full,
+              "a string record with %s is rejected" % what,
+              "rc=%d err=%r" % (rc, err))
+
+    print("=== event log: %d passed, %d failed ===" % (npass, nfail))
+    return 1 if nfail else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
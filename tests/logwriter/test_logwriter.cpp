@@ -0,0 +1,361 @@
+// Unit tests for CLogWriter, the thread that writes the log for the game
+// thread (log.cpp).
+//
+// The ring only misbehaves when the disk falls behind, which a running game
+// almost never shows on demand.  Here the log file's descriptor is replaced
+// with a pipe that the test has already filled, so the writer blocks in its
+// first write(2) and stays there until the test starts reading.  That makes
+// the ring's state exact: nothing leaves it, so every byte Put is either in
+// the ring or dropped, and the test knows which.
+//
+//   * drop: fill the ring to 32 bytes short, so the next piece -- the second
+//     half of a line -- must wait, give up, and be dropped, along with the
+//     entries after it.  The Dropped count must be exactly those bytes.
+//   * sync: with the writer still blocked, Sync() must not return; once the
+//     pipe is read, it must, with nothing left queued.
+//   * note: the first entry after that goes in behind the "fell behind"
+//     note.  The ring was left mid-line, so the note must start a new line,
+//     and the file must read exactly: what fit, the cut-off half line, the
+//     note, the new entry.
+//   * delay: with the ring exactly full, a Put that gets room within
+//     LOG_STALL_LIMIT is counted as Delayed and nothing is dropped.
+//
+// Build/run: make test
+
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "autoconf.h"
+#include "config.h"
+#include "externs.h"
+
+extern std::string g_notified;
+
+// --- tiny test framework ---------------------------------------------------
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void check(bool cond, const char *what)
+{
+    if (cond)
+    {
+        g_pass++;
+        printf("ok   - %s\n", what);
+    }
+    else
+    {
+        g_fail++;
+        printf("FAIL - %s\n", what);
+    }
+}
+
+// --- helpers ---------------------------------------------------------------
+
+// Mirrors log.cpp.
+//
+static const size_t LOG_RING_SIZE = 256*1024;
+static const size_t PIECE = 64;
+
+static char g_szDir[] = "/tmp/logwriter-XXXXXX";
+
+// Start logging to a new file in g_szDir and return its descriptor.  The
+// file is opened with the lowest free descriptor, so look that up first.
+//
+static int start_log(CLogFile &log, const char *szPrefix)
+{
+    const int fdFree = open("/dev/null", O_RDONLY);
+    close(fdFree);
+
+    log.SetBasename(reinterpret_cast<const UTF8 *>(g_szDir));
+    log.SetPrefix(reinterpret_cast<const UTF8 *>(szPrefix));
+    log.StartLogging();
+
+    struct stat st;
+    if (  0 != fstat(fdFree, &st)
+       || !S_ISREG(st.st_mode))
+    {
+        return -1;
+    }
+    return fdFree;
+}
+
+// A pipe standing in for the log file.  It starts full, so the writer's
+// first write blocks.
+//
+struct Sink
+{
+    int fdRead = -1;
+    size_t nPrefill = 0;
+    std::string got;
+    std::thread reader;
+
+    bool Attach(int fdLog)
+    {
+        int fds[2];
+        if (0 != pipe(fds))
+        {
+            return false;
+        }
+        fdRead = fds[0];
+
+        const int fl = fcntl(fds[1], F_GETFL);
+        fcntl(fds[1], F_SETFL, fl | O_NONBLOCK);
+        char aJunk[4096];
+        memset(aJunk, '#', sizeof(aJunk));
+        for (;;)
+        {
+            const ssize_t n = write(fds[1], aJunk, sizeof(aJunk));
+            if (n <= 0)
+            {
+                break;
+            }
+            nPrefill += static_cast<size_t>(n);
+        }
+        fcntl(fds[1], F_SETFL, fl);
+
+        const bool bOk = (fdLog == dup2(fds[1], fdLog));
+        close(fds[1]);
+        return bOk;
+    }
+
+    // Read until every write end is closed.
+    //
+    void StartReading(void)
+    {
+        reader = std::thread([this]
+        {
+            char buf[65536];
+            ssize_t n;
+            while (0 < (n = read(fdRead, buf, sizeof(buf))))
+            {
+                got.append(buf, static_cast<size_t>(n));
+            }
+        });
+    }
+
+    void Finish(void)
+    {
+        if (reader.joinable())
+        {
+            reader.join();
+        }
+        close(fdRead);
+    }
+};
+
+static void put(CLogFile &log, const std::string &s)
+{
+    log.WriteString(reinterpret_cast<const UTF8 *>(s.c_str()));
+}
+
+// A line of two 64-byte pieces: the first ends mid-line, the second ends it.
+//
+static std::string first_half(int i)
+{
+    char buf[PIECE + 1];
+    snprintf(buf, sizeof(buf), "E%05d ", i);
+    std::string s(buf);
+    s.resize(PIECE, 'a');
+    return s;
+}
+
+static std::string second_half(void)
+{
+    std::string s(PIECE - 1, 'b');
+    return s + "\n";
+}
+
+// The number after szLabel in what ListStats() reported.
+//
+static unsigned long long stat_of(CLogFile &log, const char *szLabel)
+{
+    g_notified.clear();
+    log.ListStats(1);
+    const size_t i = g_notified.find(szLabel);
+    if (std::string::npos == i)
+    {
+        return ~0ULL;
+    }
+    return strtoull(g_notified.c_str() + i + strlen(szLabel), nullptr, 10);
+}
+
+static void remove_logs(void)
+{
+    DIR *d = opendir(g_szDir);
+    if (nullptr == d)
+    {
+        return;
+    }
+    struct dirent *e;
+    while (nullptr != (e = readdir(d)))
+    {
+        if ('.' != e->d_name[0])
+        {
+            std::string path = std::string(g_szDir) + "/" + e->d_name;
+            unlink(path.c_str());
+        }
+    }
+    closedir(d);
+}
+
+// --- tests -----------------------------------------------------------------
+
+static void test_drop_sync_note()
+{
+    CLogFile log;
+    const int fdLog = start_log(log, "drop");
+    Sink sink;
+    if (  fdLog < 0
+       || !sink.Attach(fdLog))
+    {
+        check(false, "drop: could not put a pipe under the log");
+        return;
+    }
+
+    // 32 bytes, then 4095 pieces, leave 32 bytes free in the ring, with
+    // the last piece queued the first half of entry 2047.
+    //
+    std::string want(31, 's');
+    want += "\n";
+    put(log, want);
+    const int nFit = static_cast<int>((LOG_RING_SIZE - want.size()) / PIECE);
+    for (int k = 0; k < nFit; k++)
+    {
+        const std::string s = (0 == k % 2) ? first_half(k/2) : second_half();
+        put(log, s);
+        want += s;
+    }
+
+    // The second half of entry 2047 cannot fit, and the entries after it
+    // are dropped without waiting.
+    //
+    const int nDropEntries = 10;
+    put(log, second_half());
+    for (int i = 0; i < nDropEntries; i++)
+    {
+        put(log, first_half(nFit/2 + 1 + i));
+        put(log, second_half());
+    }
+    const unsigned long long nDropped = PIECE + nDropEntries*2*PIECE;
+    check(nDropped == stat_of(log, "Dropped: "), "drop: Dropped counts exactly the bytes that did not fit");
+    check(0 == stat_of(log, "Delayed: "), "drop: nothing counts as delayed");
+
+    // Sync() waits for the writer, which cannot move.
+    //
+    std::atomic<bool> bSynced(false);
+    std::thread syncer([&log, &bSynced]
+    {
+        log.Sync();
+        bSynced = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    check(!bSynced, "sync: Sync() does not return while the writer is blocked");
+
+    sink.StartReading();
+    syncer.join();
+    check(bSynced && 0 == stat_of(log, "Queued: "), "sync: Sync() returns once the ring is empty");
+
+    // The ring was left mid-line, so the note starts a new one.
+    //
+    char szNote[128];
+    snprintf(szNote, sizeof(szNote),
+        "\n*** Log writer fell behind; %llu bytes dropped. ***\n", nDropped);
+    const std::string last = first_half(9999) + second_half();
+    put(log, first_half(9999));
+    put(log, second_half());
+    want += szNote;
+    want += last;
+    log.Sync();
+    const unsigned long long nWritten = stat_of(log, "Written: ");
+
+    log.StopLogging();
+    sink.Finish();
+
+    const std::string got = sink.got.substr(sink.nPrefill);
+    const size_t iNote = got.find("*** Log writer fell behind");
+    check(  std::string::npos != iNote
+         && 0 < iNote
+         && '\n' == got[iNote - 1],
+        "note: the note starts a line after a line cut short");
+    check(got == want, "note: the file holds what fit, the note, then the next entry");
+    check(nWritten == want.size(), "note: Written counts every byte that reached the file");
+    remove_logs();
+}
+
+static bool delay_attempt(int iAttempt)
+{
+    CLogFile log;
+    char szPrefix[32];
+    snprintf(szPrefix, sizeof(szPrefix), "delay%d", iAttempt);
+    const int fdLog = start_log(log, szPrefix);
+    Sink sink;
+    if (  fdLog < 0
+       || !sink.Attach(fdLog))
+    {
+        return false;
+    }
+
+    for (size_t k = 0; k < LOG_RING_SIZE/PIECE; k++)
+    {
+        put(log, (0 == k % 2) ? first_half(static_cast<int>(k/2)) : second_half());
+    }
+
+    // The ring is exactly full.  Start reading a little after the next Put
+    // begins to wait, well inside LOG_STALL_LIMIT.
+    //
+    std::thread opener([&sink]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        sink.StartReading();
+    });
+    put(log, first_half(99999));
+    opener.join();
+
+    const unsigned long long nDelayed = stat_of(log, "Delayed: ");
+    const unsigned long long nDropped = stat_of(log, "Dropped: ");
+    log.StopLogging();
+    sink.Finish();
+    remove_logs();
+    return PIECE == nDelayed && 0 == nDropped;
+}
+
+// Timing decides whether the room comes in time, so allow a slow machine
+// a few tries.
+//
+static void test_delay()
+{
+    bool bOk = false;
+    for (int i = 0; i < 3 && !bOk; i++)
+    {
+        bOk = delay_attempt(i);
+    }
+    check(bOk, "delay: a Put that gets room in time counts as Delayed, not Dropped");
+}
+
+int main()
+{
+    printf("CLogWriter Test Suite\n");
+    printf("=====================\n\n");
+
+    if (nullptr == mkdtemp(g_szDir))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    test_drop_sync_note();
+    test_delay();
+
+    rmdir(g_szDir);
+    printf("\nResults: %d passed, %d failed\n", g_pass, g_fail);
+    return g_fail ? 1 : 0;
+}
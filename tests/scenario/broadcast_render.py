@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+#
+# broadcast_render.py — live scenario test for render-once broadcasts.
+#
+# Between begin_broadcast() and end_broadcast(), queue_string() renders each
+# text once per output encoding (color mode, NOBLEED, charset, WebSocket or
+# telnet) and hands every recipient with that encoding the same queue entry.
+# A wrong key shows up only on the wire: one recipient gets another's color
+# codes or charset, or a nested notify inside the broadcast comes out as the
+# outer message.
+#
+# This cannot be reached from the smoke corpus: muxscript has no descriptors,
+# and its BeginBroadcast/EndBroadcast do nothing.
+#
+# Four mortals take part:
+#   - ALIKE1 and ALIKE2: ANSI COLOR256 UNICODE, in the speaker's room.
+#   - PLAIN: no ANSI, ASCII, in the same room.
+#   - OWNER: same flags as ALIKE1, in another room.  OWNER's PUPPET sits in
+#     the speaker's room, so notify_check() relays each message to OWNER
+#     from inside the room broadcast -- a different text, queued at nesting
+#     depth 2.
+#
+# Driven by tests/scenario/run.sh.  Usage: broadcast_render.py [host] [port]
+
+import re
+import socket
+import sys
+import time
+
+HOST = sys.argv[1] if len(sys.argv) > 1 else "127.0.0.1"
+PORT = int(sys.argv[2]) if len(sys.argv) > 2 else 6250
+
+# Starter-DB #1 is "Wizard"; the traditional starter password is "potrzebie".
+WIZ_LOGIN = "connect Wizard potrzebie"
+
+# The scenario DB is a throwaway copy of the starter DB, so fixed names
+# cannot collide across runs.
+ALIKE1 = "brlike1"
+ALIKE2 = "brlike2"
+PLAIN = "brplain"
+OWNER = "browner"
+PASSWORD = "hunter2"
+PUPPET = "brpup"
+AWAY_ROOM = "BrAway"
+
+# @create costs money, and starting_money defaults to 0.
+START_MONEY = 1000
+
+COLOR_FLAGS = ("ANSI", "COLOR256", "UNICODE")
+PLAIN_FLAGS = ("!ANSI", "ASCII")
+
+# Red text and a non-ASCII letter: the color renderer and the charset
+# conversion both have something to do.
+MESSAGE = "%s [ansi(hr,red)] caf[chr(233)]"
+
+
+def sendline(sock, line):
+    sock.sendall(line.encode("utf-8") + b"\r\n")
+
+
+def read_for(sock, marker, timeout=5.0):
+    # Raw bytes, not decoded text: the point is what went out on the wire.
+    sock.settimeout(0.3)
+    deadline = time.monotonic() + timeout
+    buf = b""
+    while time.monotonic() < deadline:
+        try:
+            data = sock.recv(8192)
+            if not data:
+                break
+            buf += data
+            if marker is not None and marker in buf:
+                # The rest of the line may still be in flight.
+                if buf.find(b"\r\n", buf.find(marker)) >= 0:
+                    return buf
+        except socket.timeout:
+            pass
+    return buf
+
+
+def line_with(buf, marker):
+    for line in buf.split(b"\r\n"):
+        i = line.find(marker)
+        if i >= 0:
+            return line[i:]
+    return None
+
+
+def connect(login, timeout=2.0):
+    sock = socket.socket()
+    sock.settimeout(5)
+    sock.connect((HOST, PORT))
+    read_for(sock, None, 1.0)          # drain negotiation + welcome
+    sendline(sock, login)
+    read_for(sock, None, timeout)      # drain post-login room text
+    return sock
+
+
+def command(sock, line, timeout=1.0):
+    sendline(sock, line)
+    return read_for(sock, None, timeout)
+
+
+def emit(wiz, tag, listeners):
+    # Every listener reads until it has the whole line carrying the tag.
+    sendline(wiz, "@emit " + MESSAGE % tag)
+    got = {}
+    for name, (sock, marker) in listeners.items():
+        got[name] = line_with(read_for(sock, marker, 5.0), marker)
+    read_for(wiz, tag.encode("ascii"), 2.0)
+    return got
+
+
+def main():
+    npass = nfail = 0
+
+    def check(ok, msg, detail=""):
+        nonlocal npass, nfail
+        if ok:
+            npass += 1
+            print("ok %d - %s" % (npass + nfail, msg))
+        else:
+            nfail += 1
+            print("not ok %d - %s%s"
+                  % (npass + nfail, msg, (" (%s)" % detail) if detail else ""))
+
+    try:
+        wiz = connect(WIZ_LOGIN)
+    except OSError as e:
+        print("not ok - could not connect to %s:%d (%s)" % (HOST, PORT, e))
+        return 1
+
+    command(wiz, "@admin starting_money=%d" % START_MONEY)
+    for name in (ALIKE1, ALIKE2, PLAIN, OWNER):
+        command(wiz, "@pcreate %s=%s" % (name, PASSWORD))
+    dug = command(wiz, "@dig %s" % AWAY_ROOM, 2.0)
+    m = re.search(rb"created as room #(\d+)", dug)
+    if not m:
+        print("not ok - could not @dig %s (%r)" % (AWAY_ROOM, dug[-200:]))
+        return 1
+    away = int(m.group(1))
+
+    socks = {}
+    try:
+        for name in (ALIKE1, ALIKE2, PLAIN, OWNER):
+            socks[name] = connect("connect %s %s" % (name, PASSWORD))
+    except OSError as e:
+        print("not ok - a mortal could not connect (%s)" % e)
+        return 1
+
+    # Earlier drivers may have moved the starting room, so the speaker
+    # gathers everyone where it stands.
+    for name in (ALIKE1, ALIKE2, PLAIN, OWNER):
+        command(wiz, "@tel *%s=here" % name)
+        read_for(socks[name], None, 0.5)
+
+    for name in (ALIKE1, ALIKE2, OWNER):
+        for flag in COLOR_FLAGS:
+            command(socks[name], "@set me=%s" % flag, 0.5)
+    for flag in PLAIN_FLAGS:
+        command(socks[PLAIN], "@set me=%s" % flag, 0.5)
+
+    # The puppet stays in the speaker's room; its owner leaves for another,
+    # or notify_check() would not relay.
+    owner = socks[OWNER]
+    command(owner, "@create %s" % PUPPET)
+    command(owner, "@set %s=PUPPET" % PUPPET)
+    command(owner, "drop %s" % PUPPET)
+    command(wiz, "@tel *%s=#%d" % (OWNER, away))
+
+    listeners = {
+        ALIKE1: (socks[ALIKE1], b"BR1 "),
+        ALIKE2: (socks[ALIKE2], b"BR1 "),
+        PLAIN: (socks[PLAIN], b"BR1 "),
+        OWNER: (owner, b"%s> BR1 " % PUPPET.encode("ascii")),
+    }
+    got = emit(wiz, "BR1", listeners)
+    like1 = got[ALIKE1]
+    like2 = got[ALIKE2]
+    plain = got[PLAIN]
+    relay = got[OWNER]
+
+    # 1. Recipients with different settings each get their own rendering.
+    check(like1 is not None and b"\x1b[" in like1
+          and b"caf\xc3\xa9" in like1,
+          "ANSI UNICODE recipient gets color codes and UTF-8",
+          "line=%r" % like1)
+    check(plain is not None and b"\x1b" not in plain
+          and all(c < 0x80 for c in plain) and b"red caf" in plain,
+          "plain ASCII recipient in the same broadcast gets neither",
+          "line=%r" % plain)
+
+    # 2. Recipients with the same settings get the same bytes.
+    check(like1 is not None and like1 == like2,
+          "recipients with the same encoding get identical bytes",
+          "like1=%r like2=%r" % (like1, like2))
+
+    # 3. The puppet relay happens inside the room broadcast.  It carries the
+    #    puppet's prefix, and apart from that prefix it is rendered exactly
+    #    as the same-encoding recipients saw the message.
+    prefix = b"%s> " % PUPPET.encode("ascii")
+    check(relay is not None and like1 is not None
+          and relay == prefix + like1,
+          "nested puppet relay is rendered for its own text",
+          "relay=%r like1=%r" % (relay, like1))
+
+    # 4. Renders do not outlive the broadcast: the same text again, after
+    #    PLAIN turns color on, reaches PLAIN in color.
+    command(socks[PLAIN], "@set me=ANSI", 0.5)
+    command(socks[PLAIN], "@set me=COLOR256", 0.5)
+    command(socks[PLAIN], "@set me=!ASCII", 0.5)
+    command(socks[PLAIN], "@set me=UNICODE", 0.5)
+    got = emit(wiz, "BR1", listeners)
+    check(got[PLAIN] is not None and got[PLAIN] == got[ALIKE1],
+          "a later broadcast of the same text renders afresh",
+          "plain=%r like1=%r" % (got[PLAIN], got[ALIKE1]))
+
+    for s in [wiz] + list(socks.values()):
+        try:
+            s.close()
+        except OSError:
+            pass
+
+    print("=== broadcast-render scenario: %d passed, %d failed ===" % (npass, nfail))
+    return 1 if nfail else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+#
+# password_pending.py — logins and @password while the hash runs elsewhere.
+#
+# Password hashes run on a worker thread (CPasswordHasher).  A connection
+# whose password is being checked is held in DS_LOGIN_PENDING, and its input
+# waits until the answer comes back.  That leaves windows a synchronous check
+# never had, and each case below sits in one:
+#
+#   * @password followed at once by QUIT and a reconnect with the new
+#     password.  The reconnect's check must wait for the set to land, or it
+#     is checked against the old hash and refused.
+#
+#   * Two @passwords back to back, the second changing the password the
+#     first set.  The second must be checked against the first's result, so
+#     both succeed and the newest password is the one that works.
+#
+#   * A connection closed while its login is pending.  The login must be
+#     cancelled -- the player is not connected when the hash finishes -- and
+#     must charge nothing against the source's failed-login budget, even when
+#     the password was wrong.  The budget is set to 2 and four such closes go
+#     by; a login after them must still be let in, and a control then shows
+#     the budget does bite on ordinary failures.
+#
+# The hash is made slow (sha512 at 200000 rounds) so the windows are wide,
+# and players connect from their own loopback addresses so the per-source
+# budgets start full whatever ran before.  Settings are put back at the end.
+#
+# Driven by tests/scenario/run.sh.  Usage: password_pending.py [host] [port]
+
+import socket
+import sys
+import time
+
+HOST = sys.argv[1] if len(sys.argv) > 1 else "127.0.0.1"
+PORT = int(sys.argv[2]) if len(sys.argv) > 2 else 6250
+
+WIZ_LOGIN = "connect Wizard potrzebie"
+
+# Sources for the players.  Linux answers on all of 127/8.
+SRC_CHANGE = "127.0.0.61"
+SRC_CANCEL = "127.0.0.62"
+
+ROUNDS = 200000
+
+CONNECT_FAIL = "Either that player does not exist, or has a different password."
+THROTTLED = "Too many failed login attempts"
+
+
+def sendline(sock, line):
+    sock.sendall(line.encode("utf-8") + b"\r\n")
+
+
+def read_for(sock, marker, timeout=5.0):
+    sock.settimeout(0.3)
+    deadline = time.monotonic() + timeout
+    buf = ""
+    while time.monotonic() < deadline:
+        try:
+            data = sock.recv(8192)
+            if not data:
+                break
+            buf += data.decode("utf-8", "replace")
+            if marker is not None and marker in buf:
+                return buf
+        except socket.timeout:
+            pass
+    return buf
+
+
+def read_for_any(sock, markers, timeout=10.0):
+    sock.settimeout(0.3)
+    deadline = time.monotonic() + timeout
+    buf = ""
+    while time.monotonic() < deadline:
+        if any(m in buf for m in markers):
+            break
+        try:
+            data = sock.recv(8192)
+            if not data:
+                break
+            buf += data.decode("utf-8", "replace")
+        except socket.timeout:
+            pass
+    return buf
+
+
+def open_conn(src=None):
+    sock = socket.socket()
+    sock.settimeout(5)
+    if src is not None:
+        sock.bind((src, 0))
+    sock.connect((HOST, PORT))
+    read_for(sock, None, 0.5)
+    return sock
+
+
+def command(sock, line, marker, timeout=5.0):
+    sendline(sock, line)
+    return read_for(sock, marker, timeout)
+
+
+_tag = [0]
+
+
+def login(src, name, password, keep=False):
+    """Try a login; return (outcome, sock or None).
+
+    Input is held while the password is checked, so a 'think' sent behind
+    the connect line answers only once the login has been decided -- and only
+    a connected player gets its output.
+    """
+    _tag[0] += 1
+    tag = "PWPEND-%d-OK" % _tag[0]
+    sock = open_conn(src)
+    sock.sendall(("connect %s %s\r\nthink %s\r\n"
+                  % (name, password, tag)).encode("utf-8"))
+    out = read_for_any(sock, (tag, CONNECT_FAIL, THROTTLED))
+    if tag in out:
+        outcome = "connected"
+    elif THROTTLED in out:
+        outcome = "throttled"
+    elif CONNECT_FAIL in out:
+        outcome = "refused"
+    else:
+        outcome = "no answer"
+    if keep and "connected" == outcome:
+        return outcome, sock
+    sock.close()
+    return outcome, None
+
+
+def main():
+    npass = nfail = 0
+
+    def check(ok, msg, detail=""):
+        nonlocal npass, nfail
+        if ok:
+            npass += 1
+            print("ok %d - %s" % (npass + nfail, msg))
+        else:
+            nfail += 1
+            print("not ok %d - %s%s"
+                  % (npass + nfail, msg, (" (%s)" % detail) if detail else ""))
+
+    try:
+        wiz = open_conn()
+        sendline(wiz, WIZ_LOGIN)
+        read_for(wiz, None, 2.0)
+    except OSError as e:
+        print("not ok - could not connect to %s:%d (%s)" % (HOST, PORT, e))
+        return 1
+
+    command(wiz, "@admin password_methods=sha512", "Set.")
+    command(wiz, "@admin password_hash_rounds=%d" % ROUNDS, "Set.")
+
+    try:
+        for name in ("PwChange", "PwChain", "PwCancel"):
+            command(wiz, "@pcreate %s=alpha1" % name, "created")
+
+        # A login straight after @pcreate waits for the create's hash.
+        outcome, _ = login(SRC_CHANGE, "PwChange", "alpha1")
+        check("connected" == outcome,
+              "a login right after @pcreate waits for the new password", outcome)
+
+        # --- @password, QUIT, reconnect ---------------------------------------
+        outcome, sock = login(SRC_CHANGE, "PwChange", "alpha1", keep=True)
+        if sock is not None:
+            sock.sendall(b"@password alpha1=bravo2\r\nQUIT\r\n")
+            read_for(sock, None, 0.2)
+            sock.close()
+            outcome, _ = login(SRC_CHANGE, "PwChange", "bravo2")
+            check("connected" == outcome,
+                  "a reconnect right after @password takes the new password",
+                  outcome)
+            outcome, _ = login(SRC_CHANGE, "PwChange", "alpha1")
+            check("refused" == outcome,
+                  "the old password is refused after @password", outcome)
+        else:
+            check(False, "PwChange logs in before @password", outcome)
+
+        # --- Two @passwords back to back --------------------------------------
+        outcome, sock = login(SRC_CHANGE, "PwChain", "alpha1", keep=True)
+        if sock is not None:
+            sock.sendall(b"@password alpha1=bravo2\r\n"
+                         b"@password bravo2=charlie3\r\n")
+            out = read_for(sock, None, 0.1)
+            deadline = time.monotonic() + 10.0
+            while out.count("Password changed.") < 2 \
+                    and "Sorry." not in out and time.monotonic() < deadline:
+                out += read_for(sock, "Password changed.", 1.0)
+            check(2 == out.count("Password changed.") and "Sorry." not in out,
+                  "the second @password is checked against the first's result",
+                  repr(out[-200:]))
+            sock.close()
+            outcome, _ = login(SRC_CHANGE, "PwChain", "charlie3")
+            check("connected" == outcome,
+                  "the newest password is the one that works", outcome)
+            outcome, _ = login(SRC_CHANGE, "PwChain", "bravo2")
+            check("refused" == outcome,
+                  "the password in between is refused", outcome)
+        else:
+            check(False, "PwChain logs in before @password", outcome)
+
+        # --- Closed while pending ---------------------------------------------
+        command(wiz, "@admin login_fail_limit=2", "Set.")
+        command(wiz, "@admin login_fail_period=3600", "Set.")
+
+        for password in ("wrong1", "wrong2", "wrong3", "alpha1"):
+            sock = open_conn(SRC_CANCEL)
+            sendline(sock, "connect PwCancel %s" % password)
+            time.sleep(0.1)
+            sock.close()
+
+        # Let the hash that was running finish, then ask.
+        time.sleep(1.5)
+        out = command(wiz, "think PWCONN<[conn(*PwCancel)]>", "PWCONN<")
+        check("PWCONN<-1>" in out,
+              "a login closed while pending does not connect the player",
+              repr(out))
+
+        outcome, _ = login(SRC_CANCEL, "PwCancel", "alpha1")
+        check("connected" == outcome,
+              "logins closed while pending charge no failed-login budget",
+              outcome)
+
+        # Control: two ordinary failures spend the budget of 2.
+        login(SRC_CANCEL, "PwCancel", "wrong4")
+        login(SRC_CANCEL, "PwCancel", "wrong5")
+        outcome, _ = login(SRC_CANCEL, "PwCancel", "alpha1")
+        check("throttled" == outcome,
+              "control: two failed logins spend the budget", outcome)
+
+        out = command(wiz, "think PWALIVE", "PWALIVE")
+        check("PWALIVE" in out, "the server is still answering")
+    finally:
+        command(wiz, "@admin login_fail_limit=10", "Set.")
+        command(wiz, "@admin login_fail_period=60", "Set.")
+        command(wiz, "@admin password_hash_rounds=50000", "Set.")
+        command(wiz, "@admin password_methods=!sha512", "Set.")
+        wiz.close()
+
+    print("=== password pending: %d passed, %d failed ===" % (npass, nfail))
+    return 1 if nfail else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,397 @@
+// Unit tests for CTaskWheel, the timing wheel under CScheduler's timed
+// tasks (timer.cpp).
+//
+// The wheel keeps each task in a bucket chosen by the highest byte in which
+// its slot differs from the current one, so a task hours or days out sits
+// several levels up and only reaches the exact-order heap after one cascade
+// per level.  A smoke case cannot reach those levels: level 2 alone is half
+// an hour of @wait.  Here the clock is whatever the test says it is.
+//
+// What a mistake would look like, and which test sees it:
+//
+//   * Place() filing a task at the wrong level or bucket -- it comes out
+//     early, late, or never (order, levels).
+//   * FindEarliest() preferring a lower bucket at a higher level over an
+//     occupied lower level -- out of order (order, interleaved).
+//   * Expire() detaching a bucket that is not wholly in the past, or
+//     leaving one behind -- a task due in the future fires now, or a due one
+//     waits (expire).
+//   * Cancelling a pooled record that sits in a higher level without
+//     unlinking it -- the recycled record is reachable from two buckets, and
+//     the task that reuses it runs at the cancelled one's time or twice
+//     (cancel).
+//
+// Each case is checked against a model: the same tasks sorted by
+// CompareWhenGreater, which is the order the scheduler has always promised.
+//
+// Build/run: make test
+
+#include <cstdio>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <unistd.h>
+
+#include "autoconf.h"
+#include "config.h"
+#include "externs.h"
+
+// --- tiny test framework ---------------------------------------------------
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void check(bool cond, const char *what)
+{
+    if (cond)
+    {
+        g_pass++;
+        printf("ok   - %s\n", what);
+    }
+    else
+    {
+        g_fail++;
+        printf("FAIL - %s\n", what);
+    }
+}
+
+// --- helpers ---------------------------------------------------------------
+
+// Mirrors CTaskWheel's private geometry: a slot is 2^16 ticks of 100ns, a
+// level is one byte of the slot number, and m_iWheelSlot is
+// level*256 + bucket.
+//
+static const int64_t SLOT_TICKS = INT64_C(1) << 16;
+static const int     WHEEL_SIZE = 256;
+static const int     WHEEL_LEVELS = 6;
+
+// A fixed, unaligned starting point, so that level boundaries fall in
+// the middle of the test rather than at its start.
+//
+static const int64_t T0 = INT64_C(0x00E0123456789ABC);
+
+static CLinearTimeAbsolute at(int64_t t100ns)
+{
+    CLinearTimeAbsolute lta;
+    lta.Set100ns(t100ns);
+    return lta;
+}
+
+// Delays from under one slot to centuries, spread so every level of the
+// wheel is used.  The top level's span is cut short to stay inside int64_t.
+//
+static const int64_t MAX_DELAY = INT64_C(1) << 58;
+
+static int64_t random_delay(std::mt19937_64 &rng)
+{
+    std::uniform_int_distribution<int> level(0, WHEEL_LEVELS - 1);
+    const int l = level(rng);
+    const int64_t span = (WHEEL_LEVELS - 1 == l) ? MAX_DELAY : SLOT_TICKS << (8*l + 8);
+    std::uniform_int_distribution<int64_t> d(0, span);
+    return d(rng);
+}
+
+static bool when_less(PTASK_RECORD a, PTASK_RECORD b)
+{
+    const CompareWhenGreater cmp;
+    return cmp(b, a);
+}
+
+struct Pool
+{
+    std::vector<TASK_RECORD> recs;
+    explicit Pool(size_t n) : recs(n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            recs[i] = TASK_RECORD();
+            recs[i].m_iWheelSlot = -1;
+            recs[i].m_Ticket = i;
+            recs[i].iPriority = PRIORITY_PLAYER;
+        }
+    }
+};
+
+// --- CTaskWheel ------------------------------------------------------------
+
+// Every task comes out of RemoveTopmost() in CompareWhenGreater order, and
+// the tasks really were spread over all six levels.  Ties on time are
+// broken by ticket, so some tasks share a time on purpose.
+//
+static void test_order_across_levels()
+{
+    std::mt19937_64 rng(1);
+    const size_t n = 5000;
+    Pool pool(n);
+
+    CTaskWheel wheel;
+    // Pin the wheel's current slot near T0: a task at T0 is due at once
+    // and starts the cascade from there.
+    //
+    TASK_RECORD anchor = TASK_RECORD();
+    anchor.m_iWheelSlot = -1;
+    anchor.m_Ticket = n;
+    anchor.ltaWhen = at(T0);
+    wheel.Insert(&anchor);
+    wheel.RemoveTopmost();
+
+    int aLevels[WHEEL_LEVELS] = { 0 };
+    for (size_t i = 0; i < n; i++)
+    {
+        const int64_t d = (i % 10 == 0 && 0 < i) ? 0 : random_delay(rng);
+        pool.recs[i].ltaWhen = (0 == d)
+            ? pool.recs[i - 1].ltaWhen
+            : at(T0 + d);
+        wheel.Insert(&pool.recs[i]);
+        if (0 <= pool.recs[i].m_iWheelSlot)
+        {
+            aLevels[pool.recs[i].m_iWheelSlot / WHEEL_SIZE]++;
+        }
+    }
+    bool bAllLevels = true;
+    for (int l = 0; l < WHEEL_LEVELS; l++)
+    {
+        bAllLevels = bAllLevels && 0 < aLevels[l];
+    }
+    check(bAllLevels, "order: tasks were placed on every level");
+
+    std::vector<PTASK_RECORD> model;
+    for (auto &r : pool.recs)
+    {
+        model.push_back(&r);
+    }
+    std::sort(model.begin(), model.end(), when_less);
+
+    std::vector<PTASK_RECORD> got;
+    PTASK_RECORD p;
+    while (nullptr != (p = wheel.RemoveTopmost()))
+    {
+        got.push_back(p);
+    }
+    check(got == model, "order: RemoveTopmost follows CompareWhenGreater across levels");
+    check(!wheel.Contains(&pool.recs[0]), "order: a removed task is no longer contained");
+}
+
+// Tasks added while others are part-way through their cascades, some of
+// them earlier than anything already in the wheel, some later.  After
+// each pop the wheel's current slot has moved, so the same delay lands at
+// a different level each time.
+//
+static void test_interleaved()
+{
+    std::mt19937_64 rng(2);
+    const size_t n = 4000;
+    Pool pool(n);
+    CTaskWheel wheel;
+
+    std::set<PTASK_RECORD, bool (*)(PTASK_RECORD, PTASK_RECORD)> model(when_less);
+    int64_t now = T0;
+    size_t next = 0;
+    bool bOrdered = true;
+    while (next < n || !model.empty())
+    {
+        std::uniform_int_distribution<int> burst(0, 4);
+        for (int k = burst(rng); 0 < k && next < n; k--, next++)
+        {
+            pool.recs[next].ltaWhen = at(now + random_delay(rng));
+            wheel.Insert(&pool.recs[next]);
+            model.insert(&pool.recs[next]);
+        }
+        PTASK_RECORD p = wheel.RemoveTopmost();
+        if (model.empty())
+        {
+            bOrdered = bOrdered && nullptr == p;
+            continue;
+        }
+        if (p != *model.begin())
+        {
+            bOrdered = false;
+            break;
+        }
+        model.erase(model.begin());
+        now = p->ltaWhen.Return100ns();
+    }
+    check(bOrdered, "interleaved: inserts between pops keep the exact order");
+}
+
+// Expire(now) returns exactly the tasks due before now, in any order, and
+// leaves the rest in order.  Once now is an hour or more ahead, whole
+// buckets on the middle levels lie in the past and are taken in one batch.
+//
+static void test_expire()
+{
+    std::mt19937_64 rng(3);
+    const size_t n = 5000;
+    Pool pool(n);
+    CTaskWheel wheel;
+
+    TASK_RECORD anchor = TASK_RECORD();
+    anchor.m_iWheelSlot = -1;
+    anchor.m_Ticket = n;
+    anchor.ltaWhen = at(T0);
+    wheel.Insert(&anchor);
+    wheel.RemoveTopmost();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        pool.recs[i].ltaWhen = at(T0 + random_delay(rng));
+        wheel.Insert(&pool.recs[i]);
+    }
+
+    const int64_t aSteps[] =
+    {
+        SLOT_TICKS/2,                   // inside the first slot
+        SLOT_TICKS*300,                 // past the end of level 0
+        INT64_C(10000000)*3600,         // an hour
+        INT64_C(10000000)*3600*24*30,   // a month
+        MAX_DELAY + 1                   // past everything
+    };
+
+    std::vector<PTASK_RECORD> model;
+    for (auto &r : pool.recs)
+    {
+        model.push_back(&r);
+    }
+    std::sort(model.begin(), model.end(), when_less);
+
+    size_t iModel = 0;
+    bool bExact = true;
+    bool bNoneEarly = true;
+    for (int64_t step : aSteps)
+    {
+        const CLinearTimeAbsolute ltaNow = at(T0 + step);
+        std::vector<PTASK_RECORD> ready;
+        wheel.Expire(ltaNow, ready);
+
+        std::vector<PTASK_RECORD> want;
+        while (  iModel < model.size()
+              && model[iModel]->ltaWhen < ltaNow)
+        {
+            want.push_back(model[iModel++]);
+        }
+        for (auto p : ready)
+        {
+            bNoneEarly = bNoneEarly && p->ltaWhen < ltaNow;
+        }
+        std::sort(ready.begin(), ready.end());
+        std::sort(want.begin(), want.end());
+        bExact = bExact && ready == want;
+    }
+    check(bNoneEarly, "expire: nothing due after now is returned");
+    check(bExact, "expire: everything due before now is returned, once");
+    check(iModel == n && nullptr == wheel.PeekAtTopmost(),
+        "expire: the wheel is empty after the last step");
+}
+
+// --- CScheduler ------------------------------------------------------------
+
+static std::vector<int> g_fired;
+
+static void record_task(void *, int i)
+{
+    g_fired.push_back(i);
+}
+
+// Tasks days and months out are cancelled before any cascade reaches
+// them, and their records go back to the scheduler's pool.  The tasks
+// scheduled next reuse those records.  Nothing cancelled may run, every
+// other task must run exactly once, and they must become due in time
+// order.
+//
+static void test_cancel_pooled()
+{
+    mudconf.active_q_chunk = 0;
+
+    CScheduler sched;
+    std::mt19937_64 rng(4);
+    const int n = 2000;
+    std::vector<int64_t> when(2*n);
+    int tag[2] = { 0, 0 };
+
+    for (int i = 0; i < n; i++)
+    {
+        when[i] = T0 + random_delay(rng);
+        sched.DeferTask(at(when[i]), PRIORITY_PLAYER, record_task, &tag[0], i);
+    }
+
+    // Cancel the odd tasks.  CancelTask matches on the pair (arg, int).
+    //
+    std::set<int> cancelled;
+    for (int i = 1; i < n; i += 2)
+    {
+        sched.CancelTask(record_task, &tag[0], i);
+        cancelled.insert(i);
+    }
+
+    // These reuse the cancelled records.
+    //
+    for (int i = n; i < 2*n; i++)
+    {
+        when[i] = T0 + random_delay(rng);
+        sched.DeferTask(at(when[i]), PRIORITY_PLAYER, record_task, &tag[1], i);
+    }
+
+    // Step the clock to each next due time, so each run sees only the
+    // tasks that share that time.
+    //
+    g_fired.clear();
+    CLinearTimeAbsolute ltaNext;
+    int64_t prev = 0;
+    bool bMonotonic = true;
+    while (sched.WhenNext(&ltaNext))
+    {
+        const int64_t t = ltaNext.Return100ns();
+        bMonotonic = bMonotonic && prev <= t;
+        prev = t;
+        const size_t before = g_fired.size();
+        sched.RunTasks(at(t + 1));
+        for (size_t k = before; k < g_fired.size(); k++)
+        {
+            bMonotonic = bMonotonic && when[g_fired[k]] == t;
+        }
+        if (before == g_fired.size())
+        {
+            break;
+        }
+    }
+
+    std::vector<int> want;
+    for (int i = 0; i < 2*n; i++)
+    {
+        if (0 == cancelled.count(i))
+        {
+            want.push_back(i);
+        }
+    }
+    std::vector<int> got = g_fired;
+    std::sort(got.begin(), got.end());
+
+    bool bNoCancelled = true;
+    for (int i : g_fired)
+    {
+        bNoCancelled = bNoCancelled && 0 == cancelled.count(i);
+    }
+    check(bNoCancelled, "cancel: no cancelled task runs");
+    check(got == want, "cancel: every other task runs exactly once");
+    check(bMonotonic, "cancel: tasks become due in time order");
+}
+
+int main()
+{
+    // A task left linked from two buckets makes a cycle, and the wheel
+    // then loops forever instead of failing.  Turn that into a failure.
+    //
+    alarm(60);
+
+    printf("CTaskWheel Test Suite\n");
+    printf("=====================\n\n");
+
+    test_order_across_levels();
+    test_interleaved();
+    test_expire();
+    test_cancel_pooled();
+
+    printf("\nResults: %d passed, %d failed\n", g_pass, g_fail);
+    return g_fail ? 1 : 0;
+}